@@ -50,10 +50,17 @@ public class SurrealPilot : ModuleRules
 				"AssetRegistry",
 				"MaterialEditor",
 				"AnimGraph",
-				"Persona"
+				"Persona",
+				"Sockets",
+				"Networking",
+				"DirectoryWatcher",
+				"WebSockets"
 			}
 		);
 		
+		// Request body compression
+		AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
+		
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
 			{
@@ -1,4 +1,6 @@
 #include "ContextExporter.h"
+#include "SurrealPilotSettings.h"
+#include "SurrealPilotCompactBinary.h"
 #include "Engine/Blueprint.h"
 #include "BlueprintGraph/Classes/K2Node.h"
 #include "BlueprintGraph/Classes/K2Node_Event.h"
@@ -15,10 +17,501 @@
 #include "Dom/JsonObject.h"
 #include "Serialization/JsonSerializer.h"
 #include "Serialization/JsonWriter.h"
+#include "Async/ParallelFor.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/CompactBinary.h"
+#include "Serialization/CompactBinaryWriter.h"
 #include "Misc/DateTime.h"
 #include "HAL/PlatformFilemanager.h"
 #include "Misc/FileHelper.h"
 
+namespace SurrealPilotContextFields
+{
+    // Field names shared by the DOM and streaming exports, so their output cannot drift apart.
+    // FStrings rather than TCHAR literals, so writing a field does not build a temporary key
+    const FString Name(TEXT("name"));
+    const FString Path(TEXT("path"));
+    const FString Type(TEXT("type"));
+    const FString Timestamp(TEXT("timestamp"));
+    const FString ParentClass(TEXT("parentClass"));
+    const FString Variables(TEXT("variables"));
+    const FString Functions(TEXT("functions"));
+    const FString Graphs(TEXT("graphs"));
+    const FString Guid(TEXT("guid"));
+    const FString Schema(TEXT("schema"));
+    const FString Nodes(TEXT("nodes"));
+    const FString NodeCount(TEXT("nodeCount"));
+    const FString Class(TEXT("class"));
+    const FString Title(TEXT("title"));
+    const FString Tooltip(TEXT("tooltip"));
+    const FString PosX(TEXT("posX"));
+    const FString PosY(TEXT("posY"));
+    const FString Pins(TEXT("pins"));
+    const FString FunctionName(TEXT("functionName"));
+    const FString VariableName(TEXT("variableName"));
+    const FString EventName(TEXT("eventName"));
+    const FString Direction(TEXT("direction"));
+    const FString DefaultValue(TEXT("defaultValue"));
+    const FString IsConnected(TEXT("isConnected"));
+    const FString ConnectionCount(TEXT("connectionCount"));
+    const FString SubType(TEXT("subType"));
+    const FString IsArray(TEXT("isArray"));
+    const FString IsReference(TEXT("isReference"));
+    const FString Parameters(TEXT("parameters"));
+    const FString Returns(TEXT("returns"));
+}
+
+namespace SurrealPilotContextStream
+{
+    using namespace SurrealPilotContextFields;
+
+    // Same policy as JsonObjectToString, so the streamed export matches the DOM export byte for byte
+    using FWriter = TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>;
+
+    /** Key of the placeholder objects a graph's fragment is spliced over */
+    const FString FragmentMarker(TEXT("$fragment"));
+
+    /** Indent of an element of the root object's arrays */
+    constexpr int32 FragmentIndentLevel = 2;
+
+    // Plain copies of what the export reads from a graph, taken on the game thread so the JSON can be written on
+    // any thread. Node titles and tooltips are resolved here, since they can touch other UObjects.
+
+    struct FPinSnapshot
+    {
+        FString Guid;
+        FString Name;
+        FString Type;
+        FString DefaultValue;
+        TOptional<FString> SubType;
+        bool bInput = true;
+        int32 ConnectionCount = 0;
+    };
+
+    struct FNodeSnapshot
+    {
+        FString Guid;
+        FString Name;
+        FString Class;
+        FString Title;
+        FString Tooltip;
+        int32 PosX = 0;
+        int32 PosY = 0;
+        TArray<FPinSnapshot> Pins;
+
+        /** functionName, variableName or eventName, for the nodes that have one */
+        const FString* NameField = nullptr;
+        FString NameValue;
+    };
+
+    struct FGraphSnapshot
+    {
+        /** Written as it is when the graph context cache still has the graph */
+        TSharedPtr<FJsonObject> CachedFragment;
+
+        /** The graph and its fingerprint when it missed the cache, so its fragment can be cached once written */
+        UEdGraph* MissedGraph = nullptr;
+        uint32 Fingerprint = 0;
+
+        bool bFunction = false;
+        FString Guid;
+        FString Name;
+        FString Schema;
+        TArray<FNodeSnapshot> Nodes;
+
+        /** A function's parameters and returns, in the order the DOM export sets them */
+        TArray<TPair<const FString*, TArray<FPinSnapshot>>> Signature;
+    };
+
+    void SnapshotPins(UK2Node* Node, TArray<FPinSnapshot>& OutPins)
+    {
+        OutPins.Reserve(Node->Pins.Num());
+        for (UEdGraphPin* Pin : Node->Pins)
+        {
+            if (!Pin)
+            {
+                continue;
+            }
+            
+            FPinSnapshot& PinSnapshot = OutPins.AddDefaulted_GetRef();
+            PinSnapshot.Guid = Pin->PinId.ToString();
+            PinSnapshot.Name = Pin->PinName.ToString();
+            PinSnapshot.Type = Pin->PinType.PinCategory.ToString();
+            PinSnapshot.DefaultValue = Pin->DefaultValue;
+            PinSnapshot.bInput = Pin->Direction == EGPD_Input;
+            PinSnapshot.ConnectionCount = Pin->LinkedTo.Num();
+            if (Pin->PinType.PinSubCategoryObject.IsValid())
+            {
+                PinSnapshot.SubType = Pin->PinType.PinSubCategoryObject->GetName();
+            }
+        }
+    }
+
+    void SnapshotNode(UK2Node* Node, FNodeSnapshot& OutNode)
+    {
+        OutNode.Guid = Node->NodeGuid.ToString();
+        OutNode.Name = Node->GetName();
+        OutNode.Class = Node->GetClass()->GetName();
+        OutNode.Title = Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString();
+        OutNode.Tooltip = Node->GetTooltipText().ToString();
+        OutNode.PosX = Node->NodePosX;
+        OutNode.PosY = Node->NodePosY;
+        SnapshotPins(Node, OutNode.Pins);
+        
+        if (UK2Node_CallFunction* FunctionNode = Cast<UK2Node_CallFunction>(Node))
+        {
+            if (FunctionNode->GetTargetFunction())
+            {
+                OutNode.NameField = &FunctionName;
+                OutNode.NameValue = FunctionNode->GetTargetFunction()->GetName();
+            }
+        }
+        else if (UK2Node_VariableGet* VarGetNode = Cast<UK2Node_VariableGet>(Node))
+        {
+            OutNode.NameField = &VariableName;
+            OutNode.NameValue = VarGetNode->GetVarName().ToString();
+        }
+        else if (UK2Node_VariableSet* VarSetNode = Cast<UK2Node_VariableSet>(Node))
+        {
+            OutNode.NameField = &VariableName;
+            OutNode.NameValue = VarSetNode->GetVarName().ToString();
+        }
+        else if (UK2Node_Event* EventNode = Cast<UK2Node_Event>(Node))
+        {
+            OutNode.NameField = &EventName;
+            OutNode.NameValue = EventNode->GetFunctionName().ToString();
+        }
+    }
+
+    void SnapshotGraph(UEdGraph* Graph, FGraphSnapshot& OutGraph)
+    {
+        OutGraph.Guid = Graph->GraphGuid.ToString();
+        OutGraph.Name = Graph->GetName();
+        OutGraph.Schema = Graph->Schema ? Graph->Schema->GetName() : FString(TEXT("Unknown"));
+        OutGraph.Nodes.Reserve(Graph->Nodes.Num());
+        for (UEdGraphNode* GraphNode : Graph->Nodes)
+        {
+            if (UK2Node* K2Node = Cast<UK2Node>(GraphNode))
+            {
+                SnapshotNode(K2Node, OutGraph.Nodes.AddDefaulted_GetRef());
+            }
+        }
+    }
+
+    void SnapshotFunction(UEdGraph* FunctionGraph, FGraphSnapshot& OutGraph)
+    {
+        OutGraph.bFunction = true;
+        OutGraph.Name = FunctionGraph->GetName();
+        for (UEdGraphNode* GraphNode : FunctionGraph->Nodes)
+        {
+            const FString* Field = Cast<UK2Node_FunctionEntry>(GraphNode) ? &Parameters
+                : Cast<UK2Node_FunctionResult>(GraphNode) ? &Returns : nullptr;
+            if (!Field)
+            {
+                continue;
+            }
+            
+            // Like a field set twice on a JSON object: it keeps its first place and its last value
+            TPair<const FString*, TArray<FPinSnapshot>>* Existing = OutGraph.Signature.FindByPredicate(
+                [Field](const TPair<const FString*, TArray<FPinSnapshot>>& Pins) { return Pins.Key == Field; });
+            TArray<FPinSnapshot>& Pins = Existing ? Existing->Value : OutGraph.Signature.Emplace_GetRef(Field, TArray<FPinSnapshot>()).Value;
+            Pins.Reset();
+            SnapshotPins(CastChecked<UK2Node>(GraphNode), Pins);
+        }
+    }
+
+    /** Writes through FCbWriter under TJsonWriter's names, so the functions below write either encoding */
+    class FCbContextWriter
+    {
+    public:
+        explicit FCbContextWriter(FCbWriter& InWriter)
+            : Writer(InWriter)
+        {
+        }
+        
+        void WriteObjectStart() { Writer.BeginObject(); }
+        void WriteObjectEnd() { Writer.EndObject(); }
+        void WriteArrayStart(const FString& Field) { FSurrealPilotCompactBinary::SetName(Writer, Field); Writer.BeginArray(); }
+        void WriteArrayEnd() { Writer.EndArray(); }
+        
+        void WriteValue(const FString& Field, const FString& Value) { FSurrealPilotCompactBinary::SetName(Writer, Field); FSurrealPilotCompactBinary::WriteString(Writer, Value); }
+        void WriteValue(const FString& Field, const TCHAR* Value) { FSurrealPilotCompactBinary::SetName(Writer, Field); FSurrealPilotCompactBinary::WriteString(Writer, Value); }
+        void WriteValue(const FString& Field, bool Value) { FSurrealPilotCompactBinary::SetName(Writer, Field); Writer.AddBool(Value); }
+        void WriteValue(const FString& Field, double Value) { FSurrealPilotCompactBinary::SetName(Writer, Field); FSurrealPilotCompactBinary::WriteNumber(Writer, Value); }
+        
+    private:
+        FCbWriter& Writer;
+    };
+    
+    template <typename WriterType>
+    void WritePins(WriterType& Writer, const FString& Field, const TArray<FPinSnapshot>& Pins)
+    {
+        Writer.WriteArrayStart(Field);
+        for (const FPinSnapshot& Pin : Pins)
+        {
+            Writer.WriteObjectStart();
+            Writer.WriteValue(Guid, Pin.Guid);
+            Writer.WriteValue(Name, Pin.Name);
+            Writer.WriteValue(Type, Pin.Type);
+            Writer.WriteValue(Direction, Pin.bInput ? TEXT("Input") : TEXT("Output"));
+            Writer.WriteValue(DefaultValue, Pin.DefaultValue);
+            Writer.WriteValue(IsConnected, Pin.ConnectionCount > 0);
+            // Numbers go through double, as they do in an FJsonValueNumber
+            Writer.WriteValue(ConnectionCount, static_cast<double>(Pin.ConnectionCount));
+            if (Pin.SubType.IsSet())
+            {
+                Writer.WriteValue(SubType, Pin.SubType.GetValue());
+            }
+            Writer.WriteObjectEnd();
+        }
+        Writer.WriteArrayEnd();
+    }
+
+    template <typename WriterType>
+    void WriteNode(WriterType& Writer, const FNodeSnapshot& Node)
+    {
+        Writer.WriteObjectStart();
+        Writer.WriteValue(Guid, Node.Guid);
+        Writer.WriteValue(Name, Node.Name);
+        Writer.WriteValue(Class, Node.Class);
+        Writer.WriteValue(Title, Node.Title);
+        Writer.WriteValue(Tooltip, Node.Tooltip);
+        Writer.WriteValue(PosX, static_cast<double>(Node.PosX));
+        Writer.WriteValue(PosY, static_cast<double>(Node.PosY));
+        WritePins(Writer, Pins, Node.Pins);
+        if (Node.NameField)
+        {
+            Writer.WriteValue(*Node.NameField, Node.NameValue);
+        }
+        Writer.WriteObjectEnd();
+    }
+
+    /** Write one element of the functions or graphs array from its snapshot */
+    template <typename WriterType>
+    void WriteGraph(WriterType& Writer, const FGraphSnapshot& Graph)
+    {
+        Writer.WriteObjectStart();
+        if (Graph.bFunction)
+        {
+            Writer.WriteValue(Name, Graph.Name);
+            Writer.WriteValue(Type, TEXT("Function"));
+            for (const TPair<const FString*, TArray<FPinSnapshot>>& Pins : Graph.Signature)
+            {
+                WritePins(Writer, *Pins.Key, Pins.Value);
+            }
+        }
+        else
+        {
+            Writer.WriteValue(Guid, Graph.Guid);
+            Writer.WriteValue(Name, Graph.Name);
+            Writer.WriteValue(Schema, Graph.Schema);
+            Writer.WriteArrayStart(Nodes);
+            for (const FNodeSnapshot& Node : Graph.Nodes)
+            {
+                WriteNode(Writer, Node);
+            }
+            Writer.WriteArrayEnd();
+            Writer.WriteValue(NodeCount, static_cast<double>(Graph.Nodes.Num()));
+        }
+        Writer.WriteObjectEnd();
+    }
+
+    /** Write one element of the functions or graphs array as a standalone fragment; safe on any thread */
+    void WriteFragment(const FGraphSnapshot& Graph, FString& OutFragment)
+    {
+        TSharedRef<FWriter> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&OutFragment, FragmentIndentLevel);
+        if (Graph.CachedFragment.IsValid())
+        {
+            FJsonSerializer::Serialize(Graph.CachedFragment.ToSharedRef(), Writer);
+            return;
+        }
+        
+        WriteGraph(*Writer, Graph);
+        Writer->Close();
+    }
+
+    /** The same fragment encoded as a Compact Binary object; safe on any thread */
+    void WriteFragment(const FGraphSnapshot& Graph, TArray<uint8>& OutFragment)
+    {
+        FCbWriter Writer;
+        if (Graph.CachedFragment.IsValid())
+        {
+            // A cached fragment only holds the exporter's own field names, none of them empty
+            verify(FSurrealPilotCompactBinary::WriteJsonObject(Writer, *Graph.CachedFragment));
+        }
+        else
+        {
+            FCbContextWriter ContextWriter(Writer);
+            WriteGraph(ContextWriter, Graph);
+        }
+        OutFragment = FSurrealPilotCompactBinary::Save(Writer);
+    }
+
+    /** Read a fragment back into the object the graph context cache keeps; safe on any thread */
+    TSharedPtr<FJsonObject> ReadFragment(const FString& Fragment)
+    {
+        TSharedPtr<FJsonObject> Object;
+        TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Fragment);
+        return FJsonSerializer::Deserialize(Reader, Object) ? Object : nullptr;
+    }
+
+    TSharedPtr<FJsonObject> ReadFragment(const TArray<uint8>& Fragment)
+    {
+        return FSurrealPilotCompactBinary::ReadJsonObject(FCbFieldView(Fragment.GetData()).AsObjectView());
+    }
+
+    /** Open the root object and write every field that comes before the functions and graphs */
+    template <typename WriterType>
+    void WriteBlueprintHeader(WriterType& Writer, UBlueprint* Blueprint)
+    {
+        Writer.WriteObjectStart();
+        Writer.WriteValue(Name, Blueprint->GetName());
+        Writer.WriteValue(Path, Blueprint->GetPathName());
+        Writer.WriteValue(Type, TEXT("Blueprint"));
+        Writer.WriteValue(Timestamp, FDateTime::Now().ToString());
+        if (Blueprint->ParentClass)
+        {
+            Writer.WriteValue(ParentClass, Blueprint->ParentClass->GetName());
+        }
+        
+        Writer.WriteArrayStart(Variables);
+        for (const FBPVariableDescription& Variable : Blueprint->NewVariables)
+        {
+            Writer.WriteObjectStart();
+            Writer.WriteValue(Guid, Variable.VarGuid.ToString());
+            Writer.WriteValue(Name, Variable.VarName.ToString());
+            Writer.WriteValue(Type, Variable.VarType.PinCategory.ToString());
+            Writer.WriteValue(DefaultValue, Variable.DefaultValue);
+            Writer.WriteValue(IsArray, Variable.VarType.IsArray());
+            // A bitfield would be written as a number
+            Writer.WriteValue(IsReference, Variable.VarType.bIsReference != 0);
+            if (Variable.VarType.PinSubCategoryObject.IsValid())
+            {
+                Writer.WriteValue(SubType, Variable.VarType.PinSubCategoryObject->GetName());
+            }
+            Writer.WriteObjectEnd();
+        }
+        Writer.WriteArrayEnd();
+    }
+
+    /** Write a placeholder for each fragment, to be spliced over once the fragments are written */
+    void WritePlaceholders(const TSharedRef<FWriter>& Writer, const FString& Field, int32 First, int32 Count)
+    {
+        Writer->WriteArrayStart(Field);
+        for (int32 Index = First; Index < First + Count; ++Index)
+        {
+            Writer->WriteObjectStart();
+            Writer->WriteValue(FragmentMarker, Index);
+            Writer->WriteObjectEnd();
+        }
+        Writer->WriteArrayEnd();
+    }
+
+    /** Replace each placeholder object in Skeleton, in order, with its fragment */
+    FString Splice(const FString& Skeleton, const TArray<FString>& Fragments, int32 ReserveLength)
+    {
+        // Field values are escaped, so the quoted marker followed by a colon can only be a placeholder's key
+        const FString QuotedMarker = FString::Printf(TEXT("\"%s\":"), *FragmentMarker);
+        
+        FString Output;
+        Output.Reserve(ReserveLength);
+        int32 Cursor = 0;
+        for (const FString& Fragment : Fragments)
+        {
+            const int32 MarkerIndex = Skeleton.Find(QuotedMarker, ESearchCase::CaseSensitive, ESearchDir::FromStart, Cursor);
+            const int32 OpenIndex = Skeleton.Find(TEXT("{"), ESearchCase::CaseSensitive, ESearchDir::FromEnd, MarkerIndex);
+            const int32 CloseIndex = Skeleton.Find(TEXT("}"), ESearchCase::CaseSensitive, ESearchDir::FromStart, MarkerIndex);
+            check(MarkerIndex != INDEX_NONE && OpenIndex != INDEX_NONE && CloseIndex != INDEX_NONE);
+            
+            Output.AppendChars(*Skeleton + Cursor, OpenIndex - Cursor);
+            Output.Append(Fragment);
+            Cursor = CloseIndex + 1;
+        }
+        Output.AppendChars(*Skeleton + Cursor, Skeleton.Len() - Cursor);
+        return Output;
+    }
+    
+    /**
+     * Copy what the export needs out of a Blueprint's graphs, functions first, or take the cache's copy.
+     * Game thread only; returns how many of the snapshots are functions.
+     */
+    int32 SnapshotBlueprint(UBlueprint* Blueprint, FSurrealPilotGraphContextCache* Cache, TArray<FGraphSnapshot>& OutSnapshots)
+    {
+        TArray<UEdGraph*> Graphs;
+        Graphs.Reserve(Blueprint->FunctionGraphs.Num() + Blueprint->UbergraphPages.Num());
+        for (UEdGraph* Graph : Blueprint->FunctionGraphs)
+        {
+            if (Graph)
+            {
+                Graphs.Add(Graph);
+            }
+        }
+        const int32 FunctionCount = Graphs.Num();
+        for (UEdGraph* Graph : Blueprint->UbergraphPages)
+        {
+            if (Graph)
+            {
+                Graphs.Add(Graph);
+            }
+        }
+        
+        OutSnapshots.SetNum(Graphs.Num());
+        for (int32 Index = 0; Index < Graphs.Num(); ++Index)
+        {
+            OutSnapshots[Index].CachedFragment = Cache ? Cache->Find(Graphs[Index]) : nullptr;
+            if (OutSnapshots[Index].CachedFragment.IsValid())
+            {
+                continue;
+            }
+            if (Cache)
+            {
+                OutSnapshots[Index].MissedGraph = Graphs[Index];
+                OutSnapshots[Index].Fingerprint = FSurrealPilotGraphContextCache::ComputeFingerprint(Graphs[Index]);
+            }
+            
+            if (Index < FunctionCount)
+            {
+                SnapshotFunction(Graphs[Index], OutSnapshots[Index]);
+            }
+            else
+            {
+                SnapshotGraph(Graphs[Index], OutSnapshots[Index]);
+            }
+        }
+        return FunctionCount;
+    }
+    
+    /**
+     * Format each graph on its own, on worker threads when the settings allow, since that is most of the cost of a large Blueprint.
+     * Graphs that missed the cache are read back into objects on the same workers and cached on the game thread afterwards.
+     */
+    template <typename FragmentType>
+    void WriteFragments(UBlueprint* Blueprint, FSurrealPilotGraphContextCache* Cache, const TArray<FGraphSnapshot>& Snapshots, TArray<FragmentType>& OutFragments)
+    {
+        OutFragments.SetNum(Snapshots.Num());
+        TArray<TSharedPtr<FJsonObject>> Missed;
+        Missed.SetNum(Cache ? Snapshots.Num() : 0);
+        const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+        const bool bParallel = Settings && Settings->bParallelBlueprintExport && Snapshots.Num() > 1;
+        ParallelFor(Snapshots.Num(), [&Snapshots, &OutFragments, &Missed](int32 Index)
+        {
+            WriteFragment(Snapshots[Index], OutFragments[Index]);
+            if (Snapshots[Index].MissedGraph)
+            {
+                Missed[Index] = ReadFragment(OutFragments[Index]);
+            }
+        }, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+        
+        for (int32 Index = 0; Index < Missed.Num(); ++Index)
+        {
+            if (Missed[Index].IsValid())
+            {
+                Cache->Add(Blueprint, Snapshots[Index].MissedGraph, Missed[Index], Snapshots[Index].Fingerprint);
+            }
+        }
+    }
+}
+
 void UContextExporter::Initialize(FSubsystemCollectionBase& Collection)
 {
     Super::Initialize(Collection);
@@ -27,6 +520,9 @@ void UContextExporter::Initialize(FSubsystemCollectionBase& Collection)
 
 void UContextExporter::Deinitialize()
 {
+    GraphContextCache.Clear();
+    ProjectContext.SaveMemberCache();
+    ProjectContext.Reset();
     Super::Deinitialize();
     UE_LOG(LogTemp, Log, TEXT("SurrealPilot ContextExporter deinitialized"));
 }
@@ -42,33 +538,109 @@ UContextExporter* UContextExporter::Get()
 
 FString UContextExporter::ExportBlueprintContext(UBlueprint* Blueprint)
 {
+    using namespace SurrealPilotContextStream;
+    
     if (!Blueprint)
     {
         UE_LOG(LogTemp, Warning, TEXT("ContextExporter: Blueprint is null"));
         return TEXT("{}");
     }
+    
+    // Game thread: copy what the export needs out of the graphs; workers: format them
+    FSurrealPilotGraphContextCache* Cache = GetEnabledGraphContextCache();
+    TArray<FGraphSnapshot> Snapshots;
+    const int32 FunctionCount = SnapshotBlueprint(Blueprint, Cache, Snapshots);
+    TArray<FString> Fragments;
+    WriteFragments(Blueprint, Cache, Snapshots, Fragments);
+    
+    // Game thread again: the rest of the Blueprint, with a placeholder where each graph goes, in graph order
+    FString Skeleton;
+    TSharedRef<FWriter> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Skeleton);
+    WriteBlueprintHeader(*Writer, Blueprint);
+    WritePlaceholders(Writer, Functions, 0, FunctionCount);
+    WritePlaceholders(Writer, SurrealPilotContextFields::Graphs, FunctionCount, Snapshots.Num() - FunctionCount);
+    Writer->WriteObjectEnd();
+    Writer->Close();
+    
+    FString OutputString = Splice(Skeleton, Fragments, LastBlueprintContextLength + LastBlueprintContextLength / 8);
+    LastBlueprintContextLength = OutputString.Len();
+    return OutputString;
+}
+
+TArray<uint8> UContextExporter::ExportBlueprintContextBinary(UBlueprint* Blueprint)
+{
+    using namespace SurrealPilotContextStream;
+    
+    if (!Blueprint)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ContextExporter: Blueprint is null"));
+        return FSurrealPilotCompactBinary::Encode(MakeShared<FJsonObject>());
+    }
+    
+    FSurrealPilotGraphContextCache* Cache = GetEnabledGraphContextCache();
+    TArray<FGraphSnapshot> Snapshots;
+    const int32 FunctionCount = SnapshotBlueprint(Blueprint, Cache, Snapshots);
+    TArray<TArray<uint8>> Fragments;
+    WriteFragments(Blueprint, Cache, Snapshots, Fragments);
+    
+    // Compact Binary objects are self-delimiting, so the fragments are copied in whole rather than spliced
+    FCbWriter Writer;
+    FCbContextWriter ContextWriter(Writer);
+    FSurrealPilotCompactBinary::BeginEnvelope(Writer);
+    WriteBlueprintHeader(ContextWriter, Blueprint);
+    auto WriteFragmentArray = [&Writer, &ContextWriter, &Fragments](const FString& Field, int32 First, int32 Count)
+    {
+        ContextWriter.WriteArrayStart(Field);
+        for (int32 Index = First; Index < First + Count; ++Index)
+        {
+            Writer.AddObject(FCbFieldView(Fragments[Index].GetData()).AsObjectView());
+        }
+        ContextWriter.WriteArrayEnd();
+    };
+    WriteFragmentArray(Functions, 0, FunctionCount);
+    WriteFragmentArray(SurrealPilotContextFields::Graphs, FunctionCount, Fragments.Num() - FunctionCount);
+    ContextWriter.WriteObjectEnd();
+    FSurrealPilotCompactBinary::EndEnvelope(Writer);
+    
+    return FSurrealPilotCompactBinary::Save(Writer);
+}
+
+FString UContextExporter::ExportProjectContext(const FString& RootPath)
+{
+    const TArray<uint8> Utf8Json = ProjectContext.Export(RootPath);
+    FUTF8ToTCHAR Json(reinterpret_cast<const ANSICHAR*>(Utf8Json.GetData()), Utf8Json.Num());
+    return FString(Json.Length(), Json.Get());
+}
+
+TSharedPtr<FJsonObject> UContextExporter::ExportBlueprintContextObject(UBlueprint* Blueprint)
+{
+    if (!Blueprint)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ContextExporter: Blueprint is null"));
+        return nullptr;
+    }
 
     TSharedPtr<FJsonObject> ContextJson = MakeShareable(new FJsonObject);
     
     // Basic blueprint information
-    ContextJson->SetStringField(TEXT("name"), Blueprint->GetName());
-    ContextJson->SetStringField(TEXT("path"), Blueprint->GetPathName());
-    ContextJson->SetStringField(TEXT("type"), TEXT("Blueprint"));
-    ContextJson->SetStringField(TEXT("timestamp"), FDateTime::Now().ToString());
+    ContextJson->SetStringField(SurrealPilotContextFields::Name, Blueprint->GetName());
+    ContextJson->SetStringField(SurrealPilotContextFields::Path, Blueprint->GetPathName());
+    ContextJson->SetStringField(SurrealPilotContextFields::Type, TEXT("Blueprint"));
+    ContextJson->SetStringField(SurrealPilotContextFields::Timestamp, FDateTime::Now().ToString());
     
     // Parent class information
     if (Blueprint->ParentClass)
     {
-        ContextJson->SetStringField(TEXT("parentClass"), Blueprint->ParentClass->GetName());
+        ContextJson->SetStringField(SurrealPilotContextFields::ParentClass, Blueprint->ParentClass->GetName());
     }
     
     // Export variables
     TArray<TSharedPtr<FJsonValue>> VariablesArray = ExportBlueprintVariables(Blueprint);
-    ContextJson->SetArrayField(TEXT("variables"), VariablesArray);
+    ContextJson->SetArrayField(SurrealPilotContextFields::Variables, VariablesArray);
     
     // Export functions
     TArray<TSharedPtr<FJsonValue>> FunctionsArray = ExportBlueprintFunctions(Blueprint);
-    ContextJson->SetArrayField(TEXT("functions"), FunctionsArray);
+    ContextJson->SetArrayField(SurrealPilotContextFields::Functions, FunctionsArray);
     
     // Export graphs
     TArray<TSharedPtr<FJsonValue>> GraphsArray;
@@ -76,16 +648,16 @@ FString UContextExporter::ExportBlueprintContext(UBlueprint* Blueprint)
     {
         if (Graph)
         {
-            TSharedPtr<FJsonObject> GraphJson = ExportBlueprintGraph(Graph);
+            TSharedPtr<FJsonObject> GraphJson = ExportCachedGraph(Blueprint, Graph, [this, Graph]() { return ExportBlueprintGraph(Graph); });
             if (GraphJson.IsValid())
             {
                 GraphsArray.Add(MakeShareable(new FJsonValueObject(GraphJson)));
             }
         }
     }
-    ContextJson->SetArrayField(TEXT("graphs"), GraphsArray);
+    ContextJson->SetArrayField(SurrealPilotContextFields::Graphs, GraphsArray);
     
-    return JsonObjectToString(ContextJson);
+    return ContextJson;
 }
 
 FString UContextExporter::ExportErrorContext(const TArray<FString>& Errors)
@@ -204,8 +776,9 @@ TSharedPtr<FJsonObject> UContextExporter::ExportBlueprintGraph(UEdGraph* Graph)
     
     TSharedPtr<FJsonObject> GraphJson = MakeShareable(new FJsonObject);
     
-    GraphJson->SetStringField(TEXT("name"), Graph->GetName());
-    GraphJson->SetStringField(TEXT("schema"), Graph->Schema ? Graph->Schema->GetName() : TEXT("Unknown"));
+    GraphJson->SetStringField(SurrealPilotContextFields::Guid, Graph->GraphGuid.ToString());
+    GraphJson->SetStringField(SurrealPilotContextFields::Name, Graph->GetName());
+    GraphJson->SetStringField(SurrealPilotContextFields::Schema, Graph->Schema ? Graph->Schema->GetName() : TEXT("Unknown"));
     
     // Export nodes
     TArray<TSharedPtr<FJsonValue>> NodesArray;
@@ -221,8 +794,8 @@ TSharedPtr<FJsonObject> UContextExporter::ExportBlueprintGraph(UEdGraph* Graph)
         }
     }
     
-    GraphJson->SetArrayField(TEXT("nodes"), NodesArray);
-    GraphJson->SetNumberField(TEXT("nodeCount"), NodesArray.Num());
+    GraphJson->SetArrayField(SurrealPilotContextFields::Nodes, NodesArray);
+    GraphJson->SetNumberField(SurrealPilotContextFields::NodeCount, NodesArray.Num());
     
     return GraphJson;
 }
@@ -236,38 +809,39 @@ TSharedPtr<FJsonObject> UContextExporter::ExportNode(UK2Node* Node)
     
     TSharedPtr<FJsonObject> NodeJson = MakeShareable(new FJsonObject);
     
-    NodeJson->SetStringField(TEXT("name"), Node->GetName());
-    NodeJson->SetStringField(TEXT("class"), Node->GetClass()->GetName());
-    NodeJson->SetStringField(TEXT("title"), Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString());
-    NodeJson->SetStringField(TEXT("tooltip"), Node->GetTooltipText().ToString());
+    NodeJson->SetStringField(SurrealPilotContextFields::Guid, Node->NodeGuid.ToString());
+    NodeJson->SetStringField(SurrealPilotContextFields::Name, Node->GetName());
+    NodeJson->SetStringField(SurrealPilotContextFields::Class, Node->GetClass()->GetName());
+    NodeJson->SetStringField(SurrealPilotContextFields::Title, Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString());
+    NodeJson->SetStringField(SurrealPilotContextFields::Tooltip, Node->GetTooltipText().ToString());
     
     // Node position
-    NodeJson->SetNumberField(TEXT("posX"), Node->NodePosX);
-    NodeJson->SetNumberField(TEXT("posY"), Node->NodePosY);
+    NodeJson->SetNumberField(SurrealPilotContextFields::PosX, Node->NodePosX);
+    NodeJson->SetNumberField(SurrealPilotContextFields::PosY, Node->NodePosY);
     
     // Export pins
     TArray<TSharedPtr<FJsonValue>> PinsArray = ExportNodePins(Node);
-    NodeJson->SetArrayField(TEXT("pins"), PinsArray);
+    NodeJson->SetArrayField(SurrealPilotContextFields::Pins, PinsArray);
     
     // Special handling for different node types
     if (UK2Node_CallFunction* FunctionNode = Cast<UK2Node_CallFunction>(Node))
     {
         if (FunctionNode->GetTargetFunction())
         {
-            NodeJson->SetStringField(TEXT("functionName"), FunctionNode->GetTargetFunction()->GetName());
+            NodeJson->SetStringField(SurrealPilotContextFields::FunctionName, FunctionNode->GetTargetFunction()->GetName());
         }
     }
     else if (UK2Node_VariableGet* VarGetNode = Cast<UK2Node_VariableGet>(Node))
     {
-        NodeJson->SetStringField(TEXT("variableName"), VarGetNode->GetVarName().ToString());
+        NodeJson->SetStringField(SurrealPilotContextFields::VariableName, VarGetNode->GetVarName().ToString());
     }
     else if (UK2Node_VariableSet* VarSetNode = Cast<UK2Node_VariableSet>(Node))
     {
-        NodeJson->SetStringField(TEXT("variableName"), VarSetNode->GetVarName().ToString());
+        NodeJson->SetStringField(SurrealPilotContextFields::VariableName, VarSetNode->GetVarName().ToString());
     }
     else if (UK2Node_Event* EventNode = Cast<UK2Node_Event>(Node))
     {
-        NodeJson->SetStringField(TEXT("eventName"), EventNode->GetFunctionName().ToString());
+        NodeJson->SetStringField(SurrealPilotContextFields::EventName, EventNode->GetFunctionName().ToString());
     }
     
     return NodeJson;
@@ -288,17 +862,18 @@ TArray<TSharedPtr<FJsonValue>> UContextExporter::ExportNodePins(UK2Node* Node)
         {
             TSharedPtr<FJsonObject> PinJson = MakeShareable(new FJsonObject);
             
-            PinJson->SetStringField(TEXT("name"), Pin->PinName.ToString());
-            PinJson->SetStringField(TEXT("type"), Pin->PinType.PinCategory.ToString());
-            PinJson->SetStringField(TEXT("direction"), Pin->Direction == EGPD_Input ? TEXT("Input") : TEXT("Output"));
-            PinJson->SetStringField(TEXT("defaultValue"), Pin->DefaultValue);
-            PinJson->SetBoolField(TEXT("isConnected"), Pin->LinkedTo.Num() > 0);
-            PinJson->SetNumberField(TEXT("connectionCount"), Pin->LinkedTo.Num());
+            PinJson->SetStringField(SurrealPilotContextFields::Guid, Pin->PinId.ToString());
+            PinJson->SetStringField(SurrealPilotContextFields::Name, Pin->PinName.ToString());
+            PinJson->SetStringField(SurrealPilotContextFields::Type, Pin->PinType.PinCategory.ToString());
+            PinJson->SetStringField(SurrealPilotContextFields::Direction, Pin->Direction == EGPD_Input ? TEXT("Input") : TEXT("Output"));
+            PinJson->SetStringField(SurrealPilotContextFields::DefaultValue, Pin->DefaultValue);
+            PinJson->SetBoolField(SurrealPilotContextFields::IsConnected, Pin->LinkedTo.Num() > 0);
+            PinJson->SetNumberField(SurrealPilotContextFields::ConnectionCount, Pin->LinkedTo.Num());
             
             // Pin subtype information
             if (Pin->PinType.PinSubCategoryObject.IsValid())
             {
-                PinJson->SetStringField(TEXT("subType"), Pin->PinType.PinSubCategoryObject->GetName());
+                PinJson->SetStringField(SurrealPilotContextFields::SubType, Pin->PinType.PinSubCategoryObject->GetName());
             }
             
             PinsArray.Add(MakeShareable(new FJsonValueObject(PinJson)));
@@ -321,16 +896,17 @@ TArray<TSharedPtr<FJsonValue>> UContextExporter::ExportBlueprintVariables(UBluep
     {
         TSharedPtr<FJsonObject> VarJson = MakeShareable(new FJsonObject);
         
-        VarJson->SetStringField(TEXT("name"), Variable.VarName.ToString());
-        VarJson->SetStringField(TEXT("type"), Variable.VarType.PinCategory.ToString());
-        VarJson->SetStringField(TEXT("defaultValue"), Variable.DefaultValue);
-        VarJson->SetBoolField(TEXT("isArray"), Variable.VarType.IsArray());
-        VarJson->SetBoolField(TEXT("isReference"), Variable.VarType.bIsReference);
+        VarJson->SetStringField(SurrealPilotContextFields::Guid, Variable.VarGuid.ToString());
+        VarJson->SetStringField(SurrealPilotContextFields::Name, Variable.VarName.ToString());
+        VarJson->SetStringField(SurrealPilotContextFields::Type, Variable.VarType.PinCategory.ToString());
+        VarJson->SetStringField(SurrealPilotContextFields::DefaultValue, Variable.DefaultValue);
+        VarJson->SetBoolField(SurrealPilotContextFields::IsArray, Variable.VarType.IsArray());
+        VarJson->SetBoolField(SurrealPilotContextFields::IsReference, Variable.VarType.bIsReference);
         
         // Variable metadata
         if (Variable.VarType.PinSubCategoryObject.IsValid())
         {
-            VarJson->SetStringField(TEXT("subType"), Variable.VarType.PinSubCategoryObject->GetName());
+            VarJson->SetStringField(SurrealPilotContextFields::SubType, Variable.VarType.PinSubCategoryObject->GetName());
         }
         
         VariablesArray.Add(MakeShareable(new FJsonValueObject(VarJson)));
@@ -352,26 +928,7 @@ TArray<TSharedPtr<FJsonValue>> UContextExporter::ExportBlueprintFunctions(UBluep
     {
         if (FunctionGraph)
         {
-            TSharedPtr<FJsonObject> FuncJson = MakeShareable(new FJsonObject);
-            
-            FuncJson->SetStringField(TEXT("name"), FunctionGraph->GetName());
-            FuncJson->SetStringField(TEXT("type"), TEXT("Function"));
-            
-            // Find function entry and result nodes for parameter information
-            for (UEdGraphNode* GraphNode : FunctionGraph->Nodes)
-            {
-                if (UK2Node_FunctionEntry* EntryNode = Cast<UK2Node_FunctionEntry>(GraphNode))
-                {
-                    TArray<TSharedPtr<FJsonValue>> ParamsArray = ExportNodePins(EntryNode);
-                    FuncJson->SetArrayField(TEXT("parameters"), ParamsArray);
-                }
-                else if (UK2Node_FunctionResult* ResultNode = Cast<UK2Node_FunctionResult>(GraphNode))
-                {
-                    TArray<TSharedPtr<FJsonValue>> ReturnsArray = ExportNodePins(ResultNode);
-                    FuncJson->SetArrayField(TEXT("returns"), ReturnsArray);
-                }
-            }
-            
+            TSharedPtr<FJsonObject> FuncJson = ExportCachedGraph(Blueprint, FunctionGraph, [this, FunctionGraph]() { return ExportFunctionSignature(FunctionGraph); });
             FunctionsArray.Add(MakeShareable(new FJsonValueObject(FuncJson)));
         }
     }
@@ -379,6 +936,51 @@ TArray<TSharedPtr<FJsonValue>> UContextExporter::ExportBlueprintFunctions(UBluep
     return FunctionsArray;
 }
 
+TSharedPtr<FJsonObject> UContextExporter::ExportFunctionSignature(UEdGraph* FunctionGraph)
+{
+    TSharedPtr<FJsonObject> FuncJson = MakeShareable(new FJsonObject);
+    
+    FuncJson->SetStringField(SurrealPilotContextFields::Name, FunctionGraph->GetName());
+    FuncJson->SetStringField(SurrealPilotContextFields::Type, TEXT("Function"));
+    
+    // Find function entry and result nodes for parameter information
+    for (UEdGraphNode* GraphNode : FunctionGraph->Nodes)
+    {
+        if (UK2Node_FunctionEntry* EntryNode = Cast<UK2Node_FunctionEntry>(GraphNode))
+        {
+            TArray<TSharedPtr<FJsonValue>> ParamsArray = ExportNodePins(EntryNode);
+            FuncJson->SetArrayField(SurrealPilotContextFields::Parameters, ParamsArray);
+        }
+        else if (UK2Node_FunctionResult* ResultNode = Cast<UK2Node_FunctionResult>(GraphNode))
+        {
+            TArray<TSharedPtr<FJsonValue>> ReturnsArray = ExportNodePins(ResultNode);
+            FuncJson->SetArrayField(SurrealPilotContextFields::Returns, ReturnsArray);
+        }
+    }
+    
+    return FuncJson;
+}
+
+TSharedPtr<FJsonObject> UContextExporter::ExportCachedGraph(UBlueprint* Blueprint, UEdGraph* Graph, TFunctionRef<TSharedPtr<FJsonObject>()> Export)
+{
+    FSurrealPilotGraphContextCache* Cache = GetEnabledGraphContextCache();
+    return Cache ? Cache->FindOrExport(Blueprint, Graph, Export) : Export();
+}
+
+FSurrealPilotGraphContextCache* UContextExporter::GetEnabledGraphContextCache()
+{
+    const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+    const int64 MaxBytes = Settings ? static_cast<int64>(Settings->BlueprintContextCacheMemoryMB) * 1024 * 1024 : 0;
+    if (MaxBytes <= 0)
+    {
+        GraphContextCache.Clear();
+        return nullptr;
+    }
+    
+    GraphContextCache.SetMaxBytes(MaxBytes);
+    return &GraphContextCache;
+}
+
 TArray<UObject*> UContextExporter::GetSelectedObjects()
 {
     TArray<UObject*> SelectedObjects;
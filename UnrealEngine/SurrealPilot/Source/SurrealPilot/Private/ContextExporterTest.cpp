@@ -1,7 +1,25 @@
 #include "ContextExporter.h"
 #include "BuildErrorCapture.h"
+#include "SurrealPilotCompactBinary.h"
+#include "SurrealPilotContextStore.h"
+#include "SurrealPilotSettings.h"
 #include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "EdGraphSchema_K2.h"
+#include "GameFramework/Actor.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_VariableGet.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/MemoryBase.h"
 #include "Misc/AutomationTest.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/UObjectIterator.h"
 
 #if WITH_DEV_AUTOMATION_TESTS
 
@@ -65,4 +83,561 @@ bool FBuildErrorCaptureTest::RunTest(const FString& Parameters)
     return true;
 }
 
+namespace SurrealPilotContextExporterTest
+{
+    /** The exported graphs as one string, to compare exports without their timestamp */
+    FString DescribeGraphs(const TSharedPtr<FJsonObject>& Context)
+    {
+        TSharedPtr<FJsonObject> Graphs = MakeShareable(new FJsonObject);
+        Graphs->SetArrayField(TEXT("graphs"), Context->GetArrayField(TEXT("graphs")));
+        Graphs->SetArrayField(TEXT("functions"), Context->GetArrayField(TEXT("functions")));
+
+        FString GraphsString;
+        TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&GraphsString);
+        FJsonSerializer::Serialize(Graphs.ToSharedRef(), Writer);
+        return GraphsString;
+    }
+
+    /** Object serialized the way the exporter's string exports are */
+    FString ToPrettyString(const TSharedPtr<FJsonObject>& Object)
+    {
+        FString OutputString;
+        TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&OutputString);
+        FJsonSerializer::Serialize(Object.ToSharedRef(), Writer);
+        return OutputString;
+    }
+
+    /** An export without its timestamp line, which differs between two exports of the same Blueprint */
+    FString WithoutTimestamp(const FString& Context)
+    {
+        TArray<FString> Lines;
+        Context.ParseIntoArrayLines(Lines, false);
+        Lines.RemoveAll([](const FString& Line) { return Line.TrimStart().StartsWith(TEXT("\"timestamp\"")); });
+        return FString::Join(Lines, TEXT("\n"));
+    }
+
+    /** A gameplay-sized Blueprint: GraphCount event graphs of NodesPerGraph function calls each */
+    UBlueprint* CreateLargeBlueprint(const TCHAR* BaseName, int32 GraphCount, int32 NodesPerGraph, TArray<UEdGraph*>& OutGraphs)
+    {
+        UPackage* Package = GetTransientPackage();
+        UBlueprint* Blueprint = FKismetEditorUtilities::CreateBlueprint(AActor::StaticClass(), Package,
+            MakeUniqueObjectName(Package, UBlueprint::StaticClass(), BaseName), BPTYPE_Normal,
+            UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+        if (!Blueprint)
+        {
+            return nullptr;
+        }
+
+        UFunction* AddFunction = UKismetMathLibrary::StaticClass()->FindFunctionByName(GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Add_IntInt));
+        for (int32 GraphIndex = 0; GraphIndex < GraphCount; ++GraphIndex)
+        {
+            UEdGraph* Graph = nullptr;
+            if (GraphIndex == 0 && Blueprint->UbergraphPages.Num() > 0)
+            {
+                Graph = Blueprint->UbergraphPages[0];
+            }
+            else
+            {
+                Graph = FBlueprintEditorUtils::CreateNewGraph(Blueprint, *FString::Printf(TEXT("EventGraph_%d"), GraphIndex),
+                    UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
+                FBlueprintEditorUtils::AddUbergraphPage(Blueprint, Graph);
+            }
+            OutGraphs.Add(Graph);
+
+            for (int32 NodeIndex = 0; NodeIndex < NodesPerGraph; ++NodeIndex)
+            {
+                FGraphNodeCreator<UK2Node_CallFunction> NodeCreator(*Graph);
+                UK2Node_CallFunction* Node = NodeCreator.CreateNode(false);
+                Node->SetFromFunction(AddFunction);
+                Node->NodePosX = (NodeIndex % 40) * 300;
+                Node->NodePosY = (NodeIndex / 40) * 200;
+                NodeCreator.Finalize();
+            }
+        }
+        return Blueprint;
+    }
+
+    /** Seconds one export of Blueprint takes */
+    double TimeExport(UContextExporter* ContextExporter, UBlueprint* Blueprint, TSharedPtr<FJsonObject>& OutContext)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        OutContext = ContextExporter->ExportBlueprintContextObject(Blueprint);
+        return FPlatformTime::Seconds() - StartTime;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FContextExporterGraphCacheTest, "SurrealPilot.ContextExporter.GraphCacheBenchmark", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FContextExporterGraphCacheTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotContextExporterTest;
+
+    UContextExporter* ContextExporter = UContextExporter::Get();
+    if (!TestNotNull("ContextExporter should be available", ContextExporter))
+    {
+        return false;
+    }
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const int32 PreviousCacheMB = Settings->BlueprintContextCacheMemoryMB;
+    Settings->BlueprintContextCacheMemoryMB = 64;
+
+    // A large gameplay Blueprint: 5 event graphs of 1000 function calls each
+    const int32 GraphCount = 5;
+    const int32 NodesPerGraph = 1000;
+    TArray<UEdGraph*> Graphs;
+    UBlueprint* Blueprint = CreateLargeBlueprint(TEXT("BP_SurrealPilotGraphCache"), GraphCount, NodesPerGraph, Graphs);
+    if (!TestNotNull("Blueprint should be created", Blueprint))
+    {
+        Settings->BlueprintContextCacheMemoryMB = PreviousCacheMB;
+        return false;
+    }
+
+    // Cold: every graph is walked
+    ContextExporter->ClearGraphContextCache();
+    const FSurrealPilotGraphContextCacheStats StatsBefore = ContextExporter->GetGraphContextCache().GetStats();
+    TSharedPtr<FJsonObject> ColdContext;
+    const double ColdSeconds = TimeExport(ContextExporter, Blueprint, ColdContext);
+
+    // Warm: nothing changed, so nothing is walked
+    const int32 WarmRuns = 10;
+    double WarmSeconds = 0.0;
+    TSharedPtr<FJsonObject> WarmContext;
+    for (int32 Run = 0; Run < WarmRuns; ++Run)
+    {
+        WarmSeconds += TimeExport(ContextExporter, Blueprint, WarmContext) / WarmRuns;
+    }
+    const FSurrealPilotGraphContextCacheStats& Stats = ContextExporter->GetGraphContextCache().GetStats();
+    const int32 CachedGraphs = ContextExporter->GetGraphContextCache().Num();
+    TestTrue("Every graph should be cached after the first export", CachedGraphs >= GraphCount);
+    TestEqual("Only the cold export should walk the graphs", Stats.Misses - StatsBefore.Misses, CachedGraphs);
+    TestEqual("A warm export should match a cold one", DescribeGraphs(WarmContext), DescribeGraphs(ColdContext));
+    TestTrue("A warm export should be much faster than a cold one", WarmSeconds * 4.0 < ColdSeconds);
+
+    // Moving one node re-exports only its graph
+    UEdGraphNode* MovedNode = Graphs[2]->Nodes.Last();
+    MovedNode->Modify();
+    MovedNode->NodePosX += 16;
+    const int32 MissesBeforeEdit = Stats.Misses;
+    TSharedPtr<FJsonObject> EditedContext;
+    const double EditedSeconds = TimeExport(ContextExporter, Blueprint, EditedContext);
+    TestEqual("Only the edited graph should be walked again", Stats.Misses - MissesBeforeEdit, 1);
+    TestTrue("The edit should be in the export", DescribeGraphs(EditedContext).Contains(FString::Printf(TEXT("\"posX\":%d"), MovedNode->NodePosX)));
+
+    // A Blueprint-wide change checks each graph's fingerprint rather than walking it
+    const int32 MissesBeforeChange = Stats.Misses;
+    const int32 RevalidatedBeforeChange = Stats.Revalidated;
+    Blueprint->BroadcastChanged();
+    TSharedPtr<FJsonObject> ChangedContext;
+    const double ChangedSeconds = TimeExport(ContextExporter, Blueprint, ChangedContext);
+    TestEqual("Unchanged graphs should survive a Blueprint-wide change", Stats.Misses - MissesBeforeChange, 0);
+    TestEqual("Every graph should be checked after a Blueprint-wide change", Stats.Revalidated - RevalidatedBeforeChange, CachedGraphs);
+
+    // A variable renamed where only the Blueprint-wide change is heard: the fingerprint alone has to catch it
+    FBlueprintEditorUtils::AddMemberVariable(Blueprint, TEXT("bLocked"), FEdGraphPinType(UEdGraphSchema_K2::PC_Boolean, NAME_None, nullptr, EPinContainerType::None, false, FEdGraphTerminalType()));
+    FGraphNodeCreator<UK2Node_VariableGet> GetterCreator(*Graphs[1]);
+    UK2Node_VariableGet* Getter = GetterCreator.CreateNode(false);
+    Getter->VariableReference.SetSelfMember(TEXT("bLocked"));
+    GetterCreator.Finalize();
+    TimeExport(ContextExporter, Blueprint, ChangedContext);
+    const int32 MissesBeforeRename = Stats.Misses;
+    Getter->VariableReference.SetSelfMember(TEXT("bJammed"));
+    Blueprint->BroadcastChanged();
+    TSharedPtr<FJsonObject> RenamedContext;
+    TimeExport(ContextExporter, Blueprint, RenamedContext);
+    TestEqual("Renaming a variable should miss the cache for its graph", Stats.Misses - MissesBeforeRename, 1);
+    TestTrue("The new name should be in the export", DescribeGraphs(RenamedContext).Contains(TEXT("\"variableName\":\"bJammed\"")));
+
+    AddInfo(FString::Printf(TEXT("%d-node Blueprint: cold export %.1f ms, warm export %.2f ms, one graph edited %.1f ms, after OnChanged %.1f ms; %lld KB cached"),
+        GraphCount * NodesPerGraph, ColdSeconds * 1000.0, WarmSeconds * 1000.0, EditedSeconds * 1000.0, ChangedSeconds * 1000.0,
+        ContextExporter->GetGraphContextCache().GetBytes() / 1024));
+
+    // The streamed string export fills the same cache and is served from it once warm
+    ContextExporter->ClearGraphContextCache();
+    const int32 MissesBeforeString = Stats.Misses;
+    const int32 HitsBeforeString = Stats.Hits;
+    double StartTime = FPlatformTime::Seconds();
+    const FString ColdString = ContextExporter->ExportBlueprintContext(Blueprint);
+    const double ColdStringSeconds = FPlatformTime::Seconds() - StartTime;
+    TestEqual("A cold string export should cache every graph it walks", ContextExporter->GetGraphContextCache().Num(), CachedGraphs);
+
+    double WarmStringSeconds = 0.0;
+    FString WarmString;
+    for (int32 Run = 0; Run < WarmRuns; ++Run)
+    {
+        StartTime = FPlatformTime::Seconds();
+        WarmString = ContextExporter->ExportBlueprintContext(Blueprint);
+        WarmStringSeconds += (FPlatformTime::Seconds() - StartTime) / WarmRuns;
+    }
+    TestEqual("Only the cold string export should walk the graphs", Stats.Misses - MissesBeforeString, CachedGraphs);
+    TestEqual("Every warm string export should take each graph from the cache", Stats.Hits - HitsBeforeString, CachedGraphs * WarmRuns);
+    TestEqual("A warm string export should match a cold one", WithoutTimestamp(WarmString), WithoutTimestamp(ColdString));
+    TestEqual("A string export from the cache should match the object export", WithoutTimestamp(WarmString),
+        WithoutTimestamp(ToPrettyString(ContextExporter->ExportBlueprintContextObject(Blueprint))));
+    TestTrue("A warm string export should be faster than a cold one", WarmStringSeconds < ColdStringSeconds);
+
+    AddInfo(FString::Printf(TEXT("String export: cold %.1f ms, warm %.2f ms"), ColdStringSeconds * 1000.0, WarmStringSeconds * 1000.0));
+
+    // Under a tight cap the least recently used graphs make way
+    Settings->BlueprintContextCacheMemoryMB = 1;
+    ContextExporter->ExportBlueprintContextObject(Blueprint);
+    TestTrue("The cache should stay under its cap", ContextExporter->GetGraphContextCache().GetBytes() <= 1024 * 1024);
+
+    ContextExporter->ClearGraphContextCache();
+    Settings->BlueprintContextCacheMemoryMB = PreviousCacheMB;
+    Blueprint->MarkAsGarbage();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FContextExporterStableHashTest, "SurrealPilot.ContextExporter.StableContextHash", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FContextExporterStableHashTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotContextExporterTest;
+
+    UContextExporter* ContextExporter = UContextExporter::Get();
+    if (!TestNotNull("ContextExporter should be available", ContextExporter))
+    {
+        return false;
+    }
+
+    TArray<UEdGraph*> Graphs;
+    UBlueprint* Blueprint = CreateLargeBlueprint(TEXT("BP_SurrealPilotStableHash"), 2, 20, Graphs);
+    if (!TestNotNull("Blueprint should be created", Blueprint))
+    {
+        return false;
+    }
+
+    // Exports a second apart carry different timestamps but the same content, so they dedup
+    TSharedPtr<FJsonObject> First = ContextExporter->ExportBlueprintContextObject(Blueprint);
+    FPlatformProcess::Sleep(1.1f);
+    TSharedPtr<FJsonObject> Second = ContextExporter->ExportBlueprintContextObject(Blueprint);
+    TestNotEqual("The exports should be stamped with different times", First->GetStringField(TEXT("timestamp")), Second->GetStringField(TEXT("timestamp")));
+    TestEqual("Unchanged exports should hash equally", FSurrealPilotContextBlob::Encode(Second, true)->Hash, FSurrealPilotContextBlob::Encode(First, true)->Hash);
+
+    // An edit still changes the hash
+    UEdGraphNode* MovedNode = Graphs[1]->Nodes.Last();
+    MovedNode->Modify();
+    MovedNode->NodePosX += 16;
+    TSharedPtr<FJsonObject> Edited = ContextExporter->ExportBlueprintContextObject(Blueprint);
+    TestNotEqual("An edited export should hash differently", FSurrealPilotContextBlob::Encode(Edited, true)->Hash, FSurrealPilotContextBlob::Encode(First, true)->Hash);
+
+    ContextExporter->ClearGraphContextCache();
+    Blueprint->MarkAsGarbage();
+
+    return true;
+}
+
+namespace SurrealPilotContextExporterTest
+{
+    /** Counts the game thread's allocations while it stands in for GMalloc; everything else passes straight through */
+    class FCountingMalloc : public FMalloc
+    {
+    public:
+        explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+        virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+        {
+            Record(Count);
+            return Inner->Malloc(Count, Alignment);
+        }
+
+        virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+        {
+            Record(Count);
+            return Inner->Realloc(Original, Count, Alignment);
+        }
+
+        virtual void Free(void* Original) override { Inner->Free(Original); }
+        virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+        virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+        virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+        virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+        virtual const TCHAR* GetDescriptiveName() override { return TEXT("SurrealPilotCountingMalloc"); }
+
+        int64 Allocations = 0;
+        int64 Bytes = 0;
+
+    private:
+        void Record(SIZE_T Count)
+        {
+            if (IsInGameThread())
+            {
+                ++Allocations;
+                Bytes += Count;
+            }
+        }
+
+        FMalloc* Inner;
+    };
+
+    /** Allocations, bytes requested and seconds taken by one call of Export */
+    struct FExportCost
+    {
+        int64 Allocations = 0;
+        int64 Bytes = 0;
+        double Seconds = 0.0;
+    };
+
+    FExportCost MeasureExport(TFunctionRef<void()> Export)
+    {
+        FCountingMalloc CountingMalloc(GMalloc);
+        FMalloc* PreviousMalloc = GMalloc;
+        GMalloc = &CountingMalloc;
+        const double StartTime = FPlatformTime::Seconds();
+        Export();
+        const double Seconds = FPlatformTime::Seconds() - StartTime;
+        GMalloc = PreviousMalloc;
+
+        FExportCost Cost;
+        Cost.Allocations = CountingMalloc.Allocations;
+        Cost.Bytes = CountingMalloc.Bytes;
+        Cost.Seconds = Seconds;
+        return Cost;
+    }
+
+    /** Object serialized the way request bodies are */
+    FString ToCondensedString(const TSharedPtr<FJsonObject>& Object)
+    {
+        FString OutputString;
+        TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutputString);
+        FJsonSerializer::Serialize(Object.ToSharedRef(), Writer);
+        return OutputString;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FContextExporterStreamingTest, "SurrealPilot.ContextExporter.StreamingBenchmark", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FContextExporterStreamingTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotContextExporterTest;
+
+    UContextExporter* ContextExporter = UContextExporter::Get();
+    if (!TestNotNull("ContextExporter should be available", ContextExporter))
+    {
+        return false;
+    }
+
+    // Without the graph cache, so both paths walk every node
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const int32 PreviousCacheMB = Settings->BlueprintContextCacheMemoryMB;
+    Settings->BlueprintContextCacheMemoryMB = 0;
+
+    const int32 GraphCount = 5;
+    const int32 NodesPerGraph = 1000;
+    TArray<UEdGraph*> Graphs;
+    UBlueprint* Blueprint = CreateLargeBlueprint(TEXT("BP_SurrealPilotStreaming"), GraphCount, NodesPerGraph, Graphs);
+    if (!TestNotNull("Blueprint should be created", Blueprint))
+    {
+        Settings->BlueprintContextCacheMemoryMB = PreviousCacheMB;
+        return false;
+    }
+
+    // One reference and one plain variable: bIsReference is a bitfield, which must still be written as a bool
+    FBlueprintEditorUtils::AddMemberVariable(Blueprint, TEXT("DoorCount"),
+        FEdGraphPinType(UEdGraphSchema_K2::PC_Int, NAME_None, nullptr, EPinContainerType::None, false, FEdGraphTerminalType()));
+    FBlueprintEditorUtils::AddMemberVariable(Blueprint, TEXT("TargetDoor"),
+        FEdGraphPinType(UEdGraphSchema_K2::PC_Object, NAME_None, AActor::StaticClass(), EPinContainerType::None, true, FEdGraphTerminalType()));
+
+    // Before: the Blueprint built as a JSON DOM, then serialized
+    FString DomContext;
+    const FExportCost DomCost = MeasureExport([ContextExporter, Blueprint, &DomContext]()
+    {
+        DomContext = ToPrettyString(ContextExporter->ExportBlueprintContextObject(Blueprint));
+    });
+
+    // After: the Blueprint streamed straight to the writer; the first run sizes the buffer for the next
+    FString StreamedContext = ContextExporter->ExportBlueprintContext(Blueprint);
+    const FExportCost StreamedCost = MeasureExport([ContextExporter, Blueprint, &StreamedContext]()
+    {
+        StreamedContext = ContextExporter->ExportBlueprintContext(Blueprint);
+    });
+
+    TestEqual("The streamed export should match the DOM export", WithoutTimestamp(StreamedContext), WithoutTimestamp(DomContext));
+    TestTrue("A reference variable should be written as true", StreamedContext.Contains(TEXT("\"isReference\": true")));
+    TestTrue("A plain variable should be written as false", StreamedContext.Contains(TEXT("\"isReference\": false")));
+    TestTrue("The streamed export should allocate less than the DOM export", StreamedCost.Allocations < DomCost.Allocations);
+
+    AddInfo(FString::Printf(TEXT("%d-node Blueprint, %d KB of JSON: DOM %lld allocations, %lld KB, %.1f ms; streamed %lld allocations, %lld KB, %.1f ms"),
+        GraphCount * NodesPerGraph, StreamedContext.Len() * sizeof(TCHAR) / 1024,
+        DomCost.Allocations, DomCost.Bytes / 1024, DomCost.Seconds * 1000.0,
+        StreamedCost.Allocations, StreamedCost.Bytes / 1024, StreamedCost.Seconds * 1000.0));
+
+    Settings->BlueprintContextCacheMemoryMB = PreviousCacheMB;
+    Blueprint->MarkAsGarbage();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FContextExporterParallelTest, "SurrealPilot.ContextExporter.ParallelBenchmark", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FContextExporterParallelTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotContextExporterTest;
+
+    UContextExporter* ContextExporter = UContextExporter::Get();
+    if (!TestNotNull("ContextExporter should be available", ContextExporter))
+    {
+        return false;
+    }
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const int32 PreviousCacheMB = Settings->BlueprintContextCacheMemoryMB;
+    const bool bPreviousParallel = Settings->bParallelBlueprintExport;
+    Settings->BlueprintContextCacheMemoryMB = 0;
+
+    // Many mid-sized graphs, so there is work for every core
+    const int32 GraphCount = 48;
+    const int32 NodesPerGraph = 200;
+    TArray<UEdGraph*> Graphs;
+    UBlueprint* Blueprint = CreateLargeBlueprint(TEXT("BP_SurrealPilotParallel"), GraphCount, NodesPerGraph, Graphs);
+    if (!TestNotNull("Blueprint should be created", Blueprint))
+    {
+        Settings->BlueprintContextCacheMemoryMB = PreviousCacheMB;
+        return false;
+    }
+
+    auto TimeExports = [ContextExporter, Blueprint](bool bParallel, FString& OutContext)
+    {
+        GetMutableDefault<USurrealPilotSettings>()->bParallelBlueprintExport = bParallel;
+        const int32 Runs = 5;
+        double Seconds = 0.0;
+        for (int32 Run = 0; Run < Runs; ++Run)
+        {
+            const double StartTime = FPlatformTime::Seconds();
+            OutContext = ContextExporter->ExportBlueprintContext(Blueprint);
+            Seconds += (FPlatformTime::Seconds() - StartTime) / Runs;
+        }
+        return Seconds;
+    };
+
+    FString SerialContext;
+    FString ParallelContext;
+    const double SerialSeconds = TimeExports(false, SerialContext);
+    const double ParallelSeconds = TimeExports(true, ParallelContext);
+
+    TestEqual("A parallel export should match a serial one", WithoutTimestamp(ParallelContext), WithoutTimestamp(SerialContext));
+    TestEqual("A parallel export should match the DOM export", WithoutTimestamp(ParallelContext),
+        WithoutTimestamp(ToPrettyString(ContextExporter->ExportBlueprintContextObject(Blueprint))));
+
+    // Cached graphs are spliced in the same order as walked ones
+    Settings->BlueprintContextCacheMemoryMB = 64;
+    ContextExporter->ExportBlueprintContextObject(Blueprint);
+    TestEqual("An export from the cache should match a walked one", WithoutTimestamp(ContextExporter->ExportBlueprintContext(Blueprint)), WithoutTimestamp(SerialContext));
+    ContextExporter->ClearGraphContextCache();
+
+    AddInfo(FString::Printf(TEXT("%d graphs of %d nodes: serial %.1f ms, parallel %.1f ms on %d worker threads (%.2fx)"),
+        GraphCount, NodesPerGraph, SerialSeconds * 1000.0, ParallelSeconds * 1000.0,
+        FTaskGraphInterface::Get().GetNumWorkerThreads(), ParallelSeconds > 0.0 ? SerialSeconds / ParallelSeconds : 0.0));
+
+    Settings->BlueprintContextCacheMemoryMB = PreviousCacheMB;
+    Settings->bParallelBlueprintExport = bPreviousParallel;
+    Blueprint->MarkAsGarbage();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FContextExporterCompactBinaryTest, "SurrealPilot.ContextExporter.CompactBinaryBenchmark", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FContextExporterCompactBinaryTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotContextExporterTest;
+
+    UContextExporter* ContextExporter = UContextExporter::Get();
+    if (!TestNotNull("ContextExporter should be available", ContextExporter))
+    {
+        return false;
+    }
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const int32 PreviousCacheMB = Settings->BlueprintContextCacheMemoryMB;
+    Settings->BlueprintContextCacheMemoryMB = 0;
+
+    // Every Blueprint the editor already has loaded, plus a large one so there is always something to measure
+    TArray<UEdGraph*> Graphs;
+    UBlueprint* LargeBlueprint = CreateLargeBlueprint(TEXT("BP_SurrealPilotCompactBinary"), 8, 250, Graphs);
+    if (!TestNotNull("Blueprint should be created", LargeBlueprint))
+    {
+        Settings->BlueprintContextCacheMemoryMB = PreviousCacheMB;
+        return false;
+    }
+
+    const int32 MaxBlueprints = 200;
+    TArray<UBlueprint*> Blueprints = { LargeBlueprint };
+    for (TObjectIterator<UBlueprint> It; It && Blueprints.Num() < MaxBlueprints; ++It)
+    {
+        if (*It != LargeBlueprint && It->UbergraphPages.Num() + It->FunctionGraphs.Num() > 0)
+        {
+            Blueprints.Add(*It);
+        }
+    }
+
+    int64 JsonBytes = 0;
+    int64 BinaryBytes = 0;
+    double JsonEncodeSeconds = 0.0;
+    double BinaryEncodeSeconds = 0.0;
+    double JsonDecodeSeconds = 0.0;
+    double BinaryDecodeSeconds = 0.0;
+    int32 Mismatches = 0;
+    for (UBlueprint* Blueprint : Blueprints)
+    {
+        // JSON as it is sent: the streamed export, then UTF-8
+        double StartTime = FPlatformTime::Seconds();
+        const FString Json = ContextExporter->ExportBlueprintContext(Blueprint);
+        FTCHARToUTF8 JsonUtf8(*Json);
+        JsonEncodeSeconds += FPlatformTime::Seconds() - StartTime;
+
+        StartTime = FPlatformTime::Seconds();
+        const TArray<uint8> Binary = ContextExporter->ExportBlueprintContextBinary(Blueprint);
+        BinaryEncodeSeconds += FPlatformTime::Seconds() - StartTime;
+
+        // Request bodies are condensed, so that is the size to beat
+        FTCHARToUTF8 CondensedUtf8(*ToCondensedString(ContextExporter->ExportBlueprintContextObject(Blueprint)));
+        JsonBytes += CondensedUtf8.Length();
+        BinaryBytes += Binary.Num();
+
+        StartTime = FPlatformTime::Seconds();
+        FUTF8ToTCHAR JsonText(reinterpret_cast<const ANSICHAR*>(JsonUtf8.Get()), JsonUtf8.Length());
+        TSharedPtr<FJsonObject> FromJson;
+        FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(JsonText.Length(), JsonText.Get())), FromJson);
+        JsonDecodeSeconds += FPlatformTime::Seconds() - StartTime;
+
+        StartTime = FPlatformTime::Seconds();
+        TSharedPtr<FJsonObject> FromBinary = FSurrealPilotCompactBinary::Decode(Binary);
+        BinaryDecodeSeconds += FPlatformTime::Seconds() - StartTime;
+
+        if (!FromBinary.IsValid() || WithoutTimestamp(ToPrettyString(FromBinary)) != WithoutTimestamp(Json))
+        {
+            AddError(FString::Printf(TEXT("The Compact Binary export of %s should decode to its JSON export"), *Blueprint->GetPathName()));
+            ++Mismatches;
+        }
+    }
+    TestEqual("Every Compact Binary export should match its JSON export", Mismatches, 0);
+    TestTrue("Compact Binary should be smaller than condensed JSON", BinaryBytes < JsonBytes);
+
+    // Graphs from the cache are re-encoded from their JSON objects and must come out the same
+    Settings->BlueprintContextCacheMemoryMB = 64;
+    ContextExporter->ExportBlueprintContextObject(LargeBlueprint);
+    TSharedPtr<FJsonObject> FromCache = FSurrealPilotCompactBinary::Decode(ContextExporter->ExportBlueprintContextBinary(LargeBlueprint));
+    TestTrue("An export from the cache should match a walked one", FromCache.IsValid() &&
+        WithoutTimestamp(ToPrettyString(FromCache)) == WithoutTimestamp(ContextExporter->ExportBlueprintContext(LargeBlueprint)));
+    ContextExporter->ClearGraphContextCache();
+
+    AddInfo(FString::Printf(TEXT("%d Blueprints (%d loaded in the editor): condensed JSON %lld KB, Compact Binary %lld KB (%.0f%%)"),
+        Blueprints.Num(), Blueprints.Num() - 1, JsonBytes / 1024, BinaryBytes / 1024, JsonBytes > 0 ? 100.0 * BinaryBytes / JsonBytes : 0.0));
+    AddInfo(FString::Printf(TEXT("Encode: JSON %.1f ms, Compact Binary %.1f ms; decode to a JSON object: JSON %.1f ms, Compact Binary %.1f ms"),
+        JsonEncodeSeconds * 1000.0, BinaryEncodeSeconds * 1000.0, JsonDecodeSeconds * 1000.0, BinaryDecodeSeconds * 1000.0));
+
+    Settings->BlueprintContextCacheMemoryMB = PreviousCacheMB;
+    LargeBlueprint->MarkAsGarbage();
+
+    return true;
+}
+
 #endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
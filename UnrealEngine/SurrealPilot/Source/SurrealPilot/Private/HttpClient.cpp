@@ -1,21 +1,66 @@
 #include "HttpClient.h"
 #include "SurrealPilotSettings.h"
 #include "SurrealPilotErrorHandler.h"
+#include "SurrealPilotLocalConfig.h"
+#include "SurrealPilotJsonWriter.h"
+#include "SurrealPilotCompression.h"
+#include "SurrealPilotCompactBinary.h"
+#include "SurrealPilotTokenizer.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
 #include "Engine/Engine.h"
-#include "Misc/FileHelper.h"
-#include "Misc/Paths.h"
 #include "Dom/JsonValue.h"
 #include "Serialization/JsonSerializer.h"
-#include "Serialization/JsonWriter.h"
 
 TUniquePtr<FHttpClient> FHttpClient::Instance = nullptr;
 
+namespace SurrealPilotHttpClient
+{
+	/** Response bodies at least this large are parsed on a worker thread instead of the game thread */
+	constexpr int32 AsyncParseThresholdBytes = 64 * 1024;
+	
+	/** Whether what is left of a response after ConsumedBytes is parsed on a worker thread */
+	bool IsParsedOnWorker(const FHttpResponsePtr& Response, int32 ConsumedBytes)
+	{
+		return Response.IsValid() && Response->GetContent().Num() - ConsumedBytes >= AsyncParseThresholdBytes;
+	}
+	
+	/** A delta larger than this fraction of the full export is not worth the server applying it */
+	constexpr double MaxDeltaFraction = 0.5;
+}
+
 void FHttpClient::Initialize()
 {
 	if (!Instance.IsValid())
 	{
 		Instance = TUniquePtr<FHttpClient>(new FHttpClient());
 		Instance->HttpModule = &FHttpModule::Get();
+		Instance->RetryRandom.Initialize(static_cast<int32>(FPlatformTime::Cycles()));
+		
+		// Keep round-trip times current so requests go to the fastest healthy endpoint
+		const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+		const float ProbeInterval = Settings ? Settings->EndpointProbeIntervalSeconds : 10.0f;
+		if (ProbeInterval > 0.0f)
+		{
+			Instance->ProbeEndpoints();
+			Instance->EndpointProbeHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([](float DeltaTime)
+			{
+				// The channel follows the endpoint requests go to
+				FHttpClient::Get().ProbeEndpoints();
+				FHttpClient::Get().RefreshChannel();
+				
+				// Also how a journal left by a dropped connection gets through once the circuit allows a request again
+				FHttpClient::Get().ReplayContextJournal();
+				return true;
+			}), ProbeInterval);
+		}
+		
+		// Open the channel now so the desktop app can push to the editor before the first request
+		Instance->RefreshChannel();
+		
+		// Deliver what an earlier session could not
+		Instance->RefreshContextJournal();
+		Instance->ReplayContextJournal();
 		UE_LOG(LogTemp, Log, TEXT("SurrealPilot HTTP client initialized"));
 	}
 }
@@ -24,6 +69,52 @@ void FHttpClient::Shutdown()
 {
 	if (Instance.IsValid())
 	{
+		// Don't lose notifications that were still waiting for their batch window. Sending them now would start
+		// requests that are cancelled below, so they go to the journal for the next session to deliver
+		TArray<FQueuedContext> Queued = Instance->TakeQueuedContext();
+		if (Queued.Num() > 0)
+		{
+			if (Instance->ContextJournal.IsOpen())
+			{
+				Instance->JournalContext(Queued);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: Context journal is off, dropping %d queued context messages"), Queued.Num());
+			}
+		}
+		Instance->ContextJournal.Close();
+		
+		// Pending retries and probes would otherwise call into a destroyed client
+		for (const TPair<uint32, FTSTicker::FDelegateHandle>& DelayedCall : Instance->DelayedCalls)
+		{
+			FTSTicker::GetCoreTicker().RemoveTicker(DelayedCall.Value);
+		}
+		FTSTicker::GetCoreTicker().RemoveTicker(Instance->EndpointProbeHandle);
+		for (const TPair<FString, FHttpRequestPtr>& Probe : Instance->ActiveProbes)
+		{
+			Probe.Value->OnProcessRequestComplete().Unbind();
+			Probe.Value->CancelRequest();
+		}
+		
+		// So are the handlers of requests still queued or on the wire, the scheduler's included
+		for (const TWeakPtr<FSurrealPilotRequestState>& WeakState : Instance->LiveRequests)
+		{
+			TSharedPtr<FSurrealPilotRequestState> State = WeakState.Pin();
+			if (!State.IsValid() || State->IsFinished())
+			{
+				continue;
+			}
+			if (State->CurrentRequest.IsValid())
+			{
+				State->CurrentRequest->OnProcessRequestComplete().Unbind();
+				State->CurrentRequest->OnHeaderReceived().Unbind();
+				State->CurrentRequest->OnRequestProgress().Unbind();
+			}
+			FSurrealPilotRequestHandle::Stop(State.ToSharedRef(), ESurrealPilotRequestStatus::Cancelled);
+		}
+		Instance->LiveRequests.Reset();
+		Instance->Channel.Close();
 		Instance.Reset();
 		UE_LOG(LogTemp, Log, TEXT("SurrealPilot HTTP client shutdown"));
 	}
@@ -35,251 +126,1851 @@ FHttpClient& FHttpClient::Get()
 	return *Instance;
 }
 
-void FHttpClient::SendChatRequest(
+FSurrealPilotRequestHandle FHttpClient::SendChatRequest(
 	const TArray<TSharedPtr<FJsonObject>>& Messages,
 	const FString& Provider,
 	const TSharedPtr<FJsonObject>& Context,
 	FOnStreamingChunk OnChunk,
-	FOnHttpError OnError)
+	FOnHttpError OnError,
+	const FString& ConversationId,
+	FSimpleDelegate OnComplete)
 {
-	FHttpRequestPtr Request = CreateRequest(TEXT("POST"), TEXT("/api/chat"));
+	// The user has moved on; stop paying for the previous answer
+	if (!ConversationId.IsEmpty())
+	{
+		if (FSurrealPilotRequestHandle* Previous = ActiveChats.Find(ConversationId))
+		{
+			if (!Previous->IsFinished())
+			{
+				UE_LOG(LogTemp, Log, TEXT("SurrealPilot: cancelling superseded chat request in conversation %s"), *ConversationId);
+				Previous->Cancel();
+			}
+		}
+	}
 	
-	// Build request body
-	TSharedPtr<FJsonObject> RequestBody = MakeShareable(new FJsonObject);
-	RequestBody->SetStringField(TEXT("provider"), Provider);
+	// Deliver events while the body is still arriving rather than after the model has finished
+	TSharedRef<FSSEStreamState> StreamState = MakeShared<FSSEStreamState>();
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	const bool bStreamIncrementally = Settings && Settings->bEnableStreamingResponses;
 	
-	// Convert messages array to JSON
-	TArray<TSharedPtr<FJsonValue>> MessagesArray;
-	for (const auto& Message : Messages)
+	// Context the endpoint already stores goes out as a hash reference
+	TSharedPtr<const FSurrealPilotContextBlob> ContextBlob;
+	TSharedPtr<FJsonObject> FittedContext;
+	if (Context.IsValid())
 	{
-		MessagesArray.Add(MakeShareable(new FJsonValueObject(Message)));
+		FittedContext = Settings && Settings->bEnableContextTokenBudget ? FitContextToTokenBudget(Messages, Provider, Context) : Context;
+		ContextBlob = FSurrealPilotContextBlob::Encode(FittedContext, Settings && Settings->bEnableContextDedup);
 	}
-	RequestBody->SetArrayField(TEXT("messages"), MessagesArray);
 	
-	// Add context if provided
-	if (Context.IsValid())
+	TFunction<void()> OnStreamEnd = [OnComplete]()
+	{
+		OnComplete.ExecuteIfBound();
+	};
+	
+	// The same question about the same context is answered from the cache, without the provider
+	if (Settings && Settings->bEnableResponseCache)
 	{
-		RequestBody->SetObjectField(TEXT("context"), Context);
+		ResponseCache.Configure(static_cast<int64>(Settings->ResponseCacheMemoryMB) * 1024 * 1024, static_cast<int64>(Settings->ResponseCacheDiskMB) * 1024 * 1024,
+			Settings->ResponseCacheTtlSeconds, FSurrealPilotResponseCache::GetDefaultDirectory());
+		
+		// Only a canonical encoding hashes equal contexts equally
+		const FString ContextHash = !ContextBlob.IsValid() ? FString() :
+			!ContextBlob->Hash.IsEmpty() ? ContextBlob->Hash : FSurrealPilotContextBlob::Encode(FittedContext, true)->Hash;
+		const FString CacheKey = FSurrealPilotResponseCache::MakeKey(Provider, Messages, ContextHash);
+		
+		FSurrealPilotCachedResponse Cached;
+		if (ResponseCache.Find(CacheKey, FSurrealPilotResponseCache::GetWallClockSeconds(), Cached))
+		{
+			FSurrealPilotRequestHandle Handle = ReplayCachedChat(Cached, OnChunk, OnError, OnComplete);
+			if (!ConversationId.IsEmpty())
+			{
+				ActiveChats.Add(ConversationId, Handle);
+			}
+			return Handle;
+		}
+		
+		// Record the answer as it streams, and keep it once the whole of it has arrived
+		TSharedRef<FSurrealPilotCachedResponse> Recording = MakeShared<FSurrealPilotCachedResponse>();
+		Recording->CreatedSeconds = FSurrealPilotResponseCache::GetWallClockSeconds();
+		const double StartTime = FPlatformTime::Seconds();
+		OnChunk = FOnStreamingChunk::CreateLambda([Recording, CallerOnChunk = OnChunk](const FString& Data)
+		{
+			Recording->Chunks.Add(Data);
+			CallerOnChunk.ExecuteIfBound(Data);
+		});
+		OnStreamEnd = [Recording, CacheKey, StartTime, OnComplete]()
+		{
+			if (Recording->Chunks.Num() > 0 && FHttpClient::IsAvailable())
+			{
+				Recording->LatencySeconds = FPlatformTime::Seconds() - StartTime;
+				FHttpClient::Get().ResponseCache.Add(CacheKey, *Recording);
+			}
+			OnComplete.ExecuteIfBound();
+		};
 	}
 	
-	// Serialize to JSON string
-	FString RequestBodyString;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&RequestBodyString);
-	FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
+	FContextUpload ContextUpload;
+	TArray<uint8> Body = BuildBodyWithContext([this, Messages, Provider, ContextBlob](const FString& ReferenceBaseUrl, FContextUpload& Upload)
+	{
+		return BuildChatRequestBody(Messages, Provider, ContextBlob, ReferenceBaseUrl, Upload);
+	}, GetApiBaseUrl(), ContextUpload);
+	
+	// Over the channel the events arrive one per frame rather than as an SSE body
+	TSharedRef<FChannelCallbacks> ChannelCallbacks = MakeShared<FChannelCallbacks>();
+	ChannelCallbacks->OnEvent = [OnChunk](const FString& Data)
+	{
+		OnChunk.ExecuteIfBound(Data);
+	};
+	ChannelCallbacks->OnResponse = [OnStreamEnd](TSharedPtr<FJsonObject> Response)
+	{
+		OnStreamEnd();
+	};
+	ChannelCallbacks->OnFailure = [OnError](int32 ResponseCode, const FString& ResponseBody)
+	{
+		ReportChatError(ResponseCode, ResponseBody, OnError);
+	};
+	
+	// Encode the body straight to UTF-8 and hand the buffer over without copying it
+	FSurrealPilotRequestHandle Handle = SendJsonRequest(TEXT("/api/chat"), ESurrealPilotRequestPriority::InteractiveChat, MoveTemp(Body), [this, StreamState, bStreamIncrementally, OnChunk, OnError, OnStreamEnd](FHttpRequestPtr Request)
+	{
+		if (bStreamIncrementally)
+		{
+			Request->OnRequestProgress().BindLambda([this, StreamState, OnChunk](FHttpRequestPtr ProgressRequest, int32 BytesSent, int32 BytesReceived)
+			{
+				FHttpResponsePtr Response = ProgressRequest.IsValid() ? ProgressRequest->GetResponse() : nullptr;
+				if (BytesReceived > StreamState->ConsumedBytes && Response.IsValid() && Response->GetResponseCode() == 200)
+				{
+					ConsumeStreamedResponse(Response, *StreamState, false, OnChunk);
+				}
+			});
+		}
+		
+		// Handle streaming response
+		Request->OnProcessRequestComplete().BindLambda([this, StreamState, OnChunk, OnError, OnStreamEnd](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			HandleStreamingResponse(Request, Response, bWasSuccessful, StreamState, OnChunk, OnError, OnStreamEnd);
+		});
+	}, MoveTemp(ContextUpload), Provider, StreamState, ChannelCallbacks);
 	
-	Request->SetContentAsString(RequestBodyString);
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	if (!ConversationId.IsEmpty())
+	{
+		ActiveChats.Add(ConversationId, Handle);
+	}
+	return Handle;
+}
+
+FSurrealPilotRequestHandle FHttpClient::ReplayCachedChat(const FSurrealPilotCachedResponse& Cached, FOnStreamingChunk OnChunk, FOnHttpError OnError, FSimpleDelegate OnComplete)
+{
+	TSharedRef<FSurrealPilotRequestState> State = MakeShared<FSurrealPilotRequestState>();
+	State->Status = ESurrealPilotRequestStatus::InFlight;
+	State->Abort = [OnError](FHttpRequestPtr CurrentRequest, ESurrealPilotRequestStatus FinalStatus)
+	{
+		if (FinalStatus == ESurrealPilotRequestStatus::TimedOut)
+		{
+			ReportChatError(0, FString(), OnError);
+		}
+	};
+	ResponseCache.GetStats().SavedSeconds += Cached.LatencySeconds;
 	
-	// Handle streaming response
-	Request->OnProcessRequestComplete().BindLambda([this, OnChunk, OnError](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+	// Delivered on the next tick like any response, so the caller holds the handle before the first chunk arrives
+	TSharedRef<const TArray<FString>> Chunks = MakeShared<const TArray<FString>>(Cached.Chunks);
+	RunAfterDelay(0.0f, [State, Chunks, OnChunk, OnComplete]()
 	{
-		HandleStreamingResponse(Request, Response, bWasSuccessful, OnChunk, OnError);
+		for (const FString& Chunk : *Chunks)
+		{
+			// A chunk handler may cancel the request part way through
+			if (State->IsFinished())
+			{
+				return;
+			}
+			OnChunk.ExecuteIfBound(Chunk);
+		}
+		if (!State->IsFinished())
+		{
+			FSurrealPilotRequestHandle::Finish(*State, ESurrealPilotRequestStatus::Succeeded);
+			OnComplete.ExecuteIfBound();
+		}
 	});
+	return FSurrealPilotRequestHandle(State);
+}
+
+TSharedPtr<FJsonObject> FHttpClient::FitContextToTokenBudget(const TArray<TSharedPtr<FJsonObject>>& Messages, const FString& Provider, const TSharedPtr<FJsonObject>& Context)
+{
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	TSharedRef<const FSurrealPilotTokenizer> Tokenizer = FSurrealPilotTokenizer::ForProvider(Provider);
 	
-	Request->ProcessRequest();
+	// The conversation itself is never trimmed, so it comes out of the context's share
+	int32 MessageTokens = 0;
+	for (const TSharedPtr<FJsonObject>& Message : Messages)
+	{
+		MessageTokens += FSurrealPilotContextBudget::CountTokens(*Tokenizer, MakeShared<FJsonValueObject>(Message));
+	}
+	const int32 Budget = FMath::Max(0, Settings->GetContextTokenBudget(Provider) - MessageTokens);
+	
+	TSharedPtr<FJsonObject> Fitted = FSurrealPilotContextBudget::Trim(Context, *Tokenizer, Budget, LastTokenBudgetReport);
+	++TokenBudgetStats.Requests;
+	TokenBudgetStats.TokensUsed += LastTokenBudgetReport.TokensUsed;
+	TokenBudgetStats.TokensDropped += LastTokenBudgetReport.TokensDropped;
+	if (LastTokenBudgetReport.TokensDropped > 0)
+	{
+		++TokenBudgetStats.TrimmedRequests;
+		UE_LOG(LogTemp, Log, TEXT("SurrealPilot: trimmed chat context for %s: %s"), *Provider, *LastTokenBudgetReport.ToString());
+	}
+	else if (Settings->bEnableContextDebugLogging)
+	{
+		UE_LOG(LogTemp, Log, TEXT("SurrealPilot: chat context for %s: %s"), *Provider, *LastTokenBudgetReport.ToString());
+	}
+	return Fitted;
 }
 
-void FHttpClient::SendContextRequest(
+FSurrealPilotRequestHandle FHttpClient::SendContextRequest(
 	const FString& ContextType,
 	const TSharedPtr<FJsonObject>& ContextData,
 	FOnHttpResponse OnResponse,
-	FOnHttpError OnError)
+	FOnHttpError OnError,
+	ESurrealPilotRequestPriority Priority)
 {
-	FHttpRequestPtr Request = CreateRequest(TEXT("POST"), TEXT("/api/context"));
-	
-	// Build request body
-	TSharedPtr<FJsonObject> RequestBody = MakeShareable(new FJsonObject);
-	RequestBody->SetStringField(TEXT("type"), ContextType);
-	RequestBody->SetObjectField(TEXT("data"), ContextData);
+	// A large response is delivered after a parse on a worker, and only if the request was not cancelled meanwhile
+	TSharedRef<FSurrealPilotRequestState> State = MakeShared<FSurrealPilotRequestState>();
+	State->bFinishesOnDelivery = true;
+	TWeakPtr<FSurrealPilotRequestState> WeakState = State;
 	
-	// Serialize to JSON string
-	FString RequestBodyString;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&RequestBodyString);
-	FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
-	
-	Request->SetContentAsString(RequestBodyString);
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-	
-	Request->OnProcessRequestComplete().BindLambda([OnResponse, OnError](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+	auto BindHandlers = [OnResponse, OnError, WeakState](FHttpRequestPtr Request)
 	{
-		if (bWasSuccessful && Response.IsValid())
+		Request->OnProcessRequestComplete().BindLambda([OnResponse, OnError, WeakState](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
 		{
-			FString ResponseString = Response->GetContentAsString();
-			TSharedPtr<FJsonObject> JsonResponse;
-			TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseString);
-			
-			if (FJsonSerializer::Deserialize(Reader, JsonResponse) && JsonResponse.IsValid())
+			// Retries are already exhausted by the time an error status gets here
+			if (bWasSuccessful && Response.IsValid() && EHttpResponseCodes::IsOk(Response->GetResponseCode()))
 			{
-				OnResponse.ExecuteIfBound(JsonResponse);
+				ParseJsonResponse(Response, OnResponse, OnError, WeakState);
 			}
 			else
 			{
-				OnError.ExecuteIfBound(TEXT("Failed to parse JSON response"));
+				FString ErrorMessage = Response.IsValid() ? 
+					FString::Printf(TEXT("HTTP Error %d: %s"), Response->GetResponseCode(), *Response->GetContentAsString()) :
+					TEXT("Request failed");
+				OnError.ExecuteIfBound(ErrorMessage);
 			}
-		}
-		else
+		});
+	};
+	
+	// Only HTTP says what a body is through its Content-Type, so Compact Binary is not sent over the channel, and
+	// context goes inline since references are JSON fields
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	if (Settings && Settings->ContextEncoding == ESurrealPilotContextEncoding::CompactBinary &&
+		!UrlsWithoutCompactBinary.Contains(GetApiBaseUrl() + TEXT("/api/context")))
+	{
+		TSharedPtr<FJsonObject> RequestObject = MakeShared<FJsonObject>();
+		RequestObject->SetStringField(TEXT("type"), ContextType);
+		RequestObject->SetObjectField(TEXT("data"), ContextData);
+		
+		// Context with an empty key has no Compact Binary form and goes as JSON
+		TArray<uint8> Encoded = FSurrealPilotCompactBinary::Encode(RequestObject);
+		if (Encoded.Num() > 0)
 		{
-			FString ErrorMessage = Response.IsValid() ? 
-				FString::Printf(TEXT("HTTP Error %d: %s"), Response->GetResponseCode(), *Response->GetContentAsString()) :
-				TEXT("Request failed");
-			OnError.ExecuteIfBound(ErrorMessage);
+			return SendCompactBinaryRequest(TEXT("/api/context"), Priority, MoveTemp(Encoded), [this, ContextType, ContextData]()
+			{
+				FContextUpload Upload;
+				return BuildContextRequestBody(ContextType, *FSurrealPilotContextBlob::Encode(ContextData, false), FString(), Upload);
+			}, BindHandlers, State);
 		}
-	});
+	}
+	
+	TSharedRef<const FSurrealPilotContextBlob> DataBlob = FSurrealPilotContextBlob::Encode(ContextData, Settings && Settings->bEnableContextDedup);
+	FContextUpload ContextUpload;
+	TArray<uint8> Body = BuildBodyWithContext([this, ContextType, DataBlob](const FString& ReferenceBaseUrl, FContextUpload& Upload)
+	{
+		return BuildContextRequestBody(ContextType, *DataBlob, ReferenceBaseUrl, Upload);
+	}, GetApiBaseUrl(), ContextUpload);
+	
+	return SendJsonRequest(TEXT("/api/context"), Priority, MoveTemp(Body), BindHandlers, MoveTemp(ContextUpload), FString(), nullptr, MakeJsonChannelCallbacks(OnResponse, OnError),
+		State);
+}
+
+FSurrealPilotRequestHandle FHttpClient::SendAssetContext(
+	const FString& AssetPath,
+	const FString& ContextType,
+	const TSharedPtr<FJsonObject>& ContextData,
+	FOnHttpResponse OnResponse,
+	FOnHttpError OnError,
+	ESurrealPilotRequestPriority Priority)
+{
+	// The version is the content hash, so it is computed whether or not context dedup is on
+	TSharedRef<const FSurrealPilotContextBlob> DataBlob = FSurrealPilotContextBlob::Encode(ContextData, true);
+	FContextUpload ContextUpload;
+	TArray<uint8> Body = BuildBodyWithContext([this, AssetPath, ContextType, ContextData, DataBlob](const FString& ReferenceBaseUrl, FContextUpload& Upload)
+	{
+		return BuildAssetContextBody(AssetPath, ContextType, ContextData, *DataBlob, ReferenceBaseUrl, Upload);
+	}, GetApiBaseUrl(), ContextUpload);
+	ContextUpload.AssetPath = AssetPath;
+	ContextUpload.AssetVersion = DataBlob->Hash;
+	ContextUpload.AssetContext = ContextData;
 	
-	Request->ProcessRequest();
+	TSharedRef<FSurrealPilotRequestState> State = MakeShared<FSurrealPilotRequestState>();
+	State->bFinishesOnDelivery = true;
+	TWeakPtr<FSurrealPilotRequestState> WeakState = State;
+	
+	return SendJsonRequest(TEXT("/api/context"), Priority, MoveTemp(Body), [OnResponse, OnError, WeakState](FHttpRequestPtr Request)
+	{
+		Request->OnProcessRequestComplete().BindLambda([OnResponse, OnError, WeakState](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			if (bWasSuccessful && Response.IsValid() && EHttpResponseCodes::IsOk(Response->GetResponseCode()))
+			{
+				ParseJsonResponse(Response, OnResponse, OnError, WeakState);
+			}
+			else
+			{
+				OnError.ExecuteIfBound(Response.IsValid() ?
+					FString::Printf(TEXT("HTTP Error %d: %s"), Response->GetResponseCode(), *Response->GetContentAsString()) :
+					TEXT("Request failed"));
+			}
+		});
+	}, MoveTemp(ContextUpload), FString(), nullptr, MakeJsonChannelCallbacks(OnResponse, OnError), State);
 }
 
-void FHttpClient::TestConnection(FOnHttpResponse OnResponse, FOnHttpError OnError)
+void FHttpClient::ParseJsonResponse(FHttpResponsePtr Response, FOnHttpResponse OnResponse, FOnHttpError OnError, TWeakPtr<FSurrealPilotRequestState> RequestState)
 {
-	FHttpRequestPtr Request = CreateRequest(TEXT("GET"), TEXT("/api/health"));
+	auto Parse = [](const FHttpResponsePtr& Response) -> TSharedPtr<FJsonObject>
+	{
+		TSharedPtr<FJsonObject> JsonResponse;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Response->GetContentAsString());
+		return FJsonSerializer::Deserialize(Reader, JsonResponse) ? JsonResponse : nullptr;
+	};
 	
-	Request->OnProcessRequestComplete().BindLambda([OnResponse, OnError](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+	auto Deliver = [](const TSharedPtr<FJsonObject>& JsonResponse, const FOnHttpResponse& OnResponse, const FOnHttpError& OnError)
 	{
-		if (bWasSuccessful && Response.IsValid() && Response->GetResponseCode() == 200)
+		if (JsonResponse.IsValid())
 		{
-			TSharedPtr<FJsonObject> JsonResponse = MakeShareable(new FJsonObject);
-			JsonResponse->SetStringField(TEXT("status"), TEXT("connected"));
 			OnResponse.ExecuteIfBound(JsonResponse);
 		}
 		else
 		{
-			FString ErrorMessage = Response.IsValid() ? 
-				FString::Printf(TEXT("Connection test failed: %d"), Response->GetResponseCode()) :
-				TEXT("Connection test failed: No response");
-			OnError.ExecuteIfBound(ErrorMessage);
+			OnError.ExecuteIfBound(TEXT("Failed to parse JSON response"));
 		}
-	});
+	};
+	
+	if (!SurrealPilotHttpClient::IsParsedOnWorker(Response, 0))
+	{
+		Deliver(Parse(Response), OnResponse, OnError);
+		return;
+	}
 	
-	Request->ProcessRequest();
+	// Large bodies are decoded and parsed on a worker; only the finished object comes back to the game thread.
+	// SendAttempt left the request in flight meanwhile, so it finishes here unless it was cancelled or timed out first.
+	AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [Response, OnResponse, OnError, RequestState, Parse, Deliver]()
+	{
+		TSharedPtr<FJsonObject> JsonResponse = Parse(Response);
+		AsyncTask(ENamedThreads::GameThread, [JsonResponse, OnResponse, OnError, RequestState, Deliver]()
+		{
+			if (TSharedPtr<FSurrealPilotRequestState> State = RequestState.Pin())
+			{
+				if (State->IsFinished() && State->Status != ESurrealPilotRequestStatus::Succeeded)
+				{
+					return;
+				}
+				if (!State->IsFinished())
+				{
+					FSurrealPilotRequestHandle::Finish(*State, ESurrealPilotRequestStatus::Succeeded);
+				}
+			}
+			Deliver(JsonResponse, OnResponse, OnError);
+		});
+	});
 }
 
-FString FHttpClient::GetApiBaseUrl() const
+void FHttpClient::QueueContext(const FString& ContextType, const TSharedPtr<FJsonObject>& ContextData, const FString& SupersedeKey, ESurrealPilotRequestPriority Priority)
 {
-	if (!CachedApiUrl.IsEmpty())
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	if (!Settings || !Settings->bBatchContextUploads)
 	{
-		return CachedApiUrl;
+		++ContextBatchStats.Queued;
+		TArray<FQueuedContext> Items;
+		FQueuedContext& Item = Items.AddDefaulted_GetRef();
+		Item.Type = ContextType;
+		Item.Data = ContextData;
+		Item.SupersedeKey = SupersedeKey;
+		Item.Priority = Priority;
+		DeliverContext(MoveTemp(Items));
+		return;
 	}
 	
-	// Try to read local config first (desktop mode)
-	FString ConfigPath = FPaths::Combine(FPlatformMisc::GetEnvironmentVariable(TEXT("USERPROFILE")), TEXT(".surrealpilot"), TEXT("config.json"));
-	FString ConfigContent;
+	++ContextBatchStats.Queued;
 	
-	if (FFileHelper::LoadFileToString(ConfigContent, *ConfigPath))
+	// Only the newest message for a key is worth sending; leave a tombstone so the queue keeps its order
+	if (!SupersedeKey.IsEmpty())
 	{
-		TSharedPtr<FJsonObject> ConfigJson;
-		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ConfigContent);
-		
-		if (FJsonSerializer::Deserialize(Reader, ConfigJson) && ConfigJson.IsValid())
+		if (int32* ExistingIndex = QueuedContextIndexByKey.Find(SupersedeKey))
 		{
-			int32 Port = ConfigJson->GetIntegerField(TEXT("port"));
-			CachedApiUrl = FString::Printf(TEXT("http://127.0.0.1:%d"), Port);
-			return CachedApiUrl;
+			QueuedContexts[*ExistingIndex].bSuperseded = true;
+			QueuedContexts[*ExistingIndex].Data.Reset();
+			--LiveQueuedContextCount;
+			++ContextBatchStats.Superseded;
 		}
+		QueuedContextIndexByKey.Add(SupersedeKey, QueuedContexts.Num());
 	}
 	
-	// Fallback to default localhost
-	CachedApiUrl = TEXT("http://127.0.0.1:8000");
+	FQueuedContext& Queued = QueuedContexts.AddDefaulted_GetRef();
+	Queued.Type = ContextType;
+	Queued.Data = ContextData;
+	Queued.SupersedeKey = SupersedeKey;
+	Queued.Priority = Priority;
+	++LiveQueuedContextCount;
+	
+	// Patch results are what the chat is waiting on, so they don't wait out the window
+	if (LiveQueuedContextCount >= Settings->ContextBatchMaxItems || Priority <= ESurrealPilotRequestPriority::PatchFeedback)
+	{
+		FlushQueuedContext();
+	}
+	else if (!ContextFlushHandle.IsValid())
+	{
+		ContextFlushHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([this](float DeltaTime)
+		{
+			// The ticker removes this delegate when it returns false
+			ContextFlushHandle.Reset();
+			FlushQueuedContext();
+			return false;
+		}), Settings->ContextBatchWindowSeconds);
+	}
+}
+
+void FHttpClient::FlushQueuedContext()
+{
+	TArray<FQueuedContext> Items = TakeQueuedContext();
+	if (Items.Num() > 0)
+	{
+		DeliverContext(MoveTemp(Items));
+	}
+}
+
+TArray<FHttpClient::FQueuedContext> FHttpClient::TakeQueuedContext()
+{
+	if (ContextFlushHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(ContextFlushHandle);
+		ContextFlushHandle.Reset();
+	}
 	
-	// TODO: Add SaaS fallback URL from settings
-	// const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
-	// if (Settings && !Settings->SaaSApiUrl.IsEmpty())
-	// {
-	//     CachedApiUrl = Settings->SaaSApiUrl;
-	// }
+	TArray<FQueuedContext> Items = MoveTemp(QueuedContexts);
+	QueuedContexts.Reset();
+	QueuedContextIndexByKey.Reset();
+	LiveQueuedContextCount = 0;
 	
-	return CachedApiUrl;
+	Items.RemoveAll([](const FQueuedContext& Item) { return Item.bSuperseded; });
+	return Items;
 }
 
-TMap<FString, FString> FHttpClient::GetAuthHeaders() const
+void FHttpClient::DeliverContext(TArray<FQueuedContext>&& Items)
 {
-	TMap<FString, FString> Headers;
+	RefreshContextJournal();
 	
-	// Try to get API key from local config
-	FString ConfigPath = FPaths::Combine(FPlatformMisc::GetEnvironmentVariable(TEXT("USERPROFILE")), TEXT(".surrealpilot"), TEXT("config.json"));
-	FString ConfigContent;
+	// Sending past messages still in the journal would deliver them out of order
+	if (ContextJournal.IsOpen() && (!ContextJournal.IsEmpty() || CircuitBreaker.GetState(GetApiBaseUrl()) == ESurrealPilotCircuitState::Open))
+	{
+		JournalContext(Items);
+		ReplayContextJournal();
+		return;
+	}
 	
-	if (FFileHelper::LoadFileToString(ConfigContent, *ConfigPath))
+	TSharedRef<TArray<FQueuedContext>> Sent = MakeShared<TArray<FQueuedContext>>(MoveTemp(Items));
+	SendContextItems(*Sent, [Sent](int32 ResponseCode)
 	{
-		TSharedPtr<FJsonObject> ConfigJson;
-		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ConfigContent);
+		if (EHttpResponseCodes::IsOk(ResponseCode))
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("SurrealPilot: Sent %d context messages"), Sent->Num());
+			return;
+		}
 		
-		if (FJsonSerializer::Deserialize(Reader, ConfigJson) && ConfigJson.IsValid())
+		// A rejected message would only be rejected again, so only what the endpoint could not take is kept
+		if (IsEndpointUnavailable(ResponseCode) && FHttpClient::IsAvailable() && FHttpClient::Get().ContextJournal.IsOpen())
 		{
-			FString ApiKey;
-			if (ConfigJson->TryGetStringField(TEXT("api_key"), ApiKey) && !ApiKey.IsEmpty())
-			{
-				Headers.Add(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *ApiKey));
-			}
+			UE_LOG(LogTemp, Log, TEXT("SurrealPilot: Endpoint unavailable (%d), keeping %d context messages until it is back"), ResponseCode, Sent->Num());
+			FHttpClient::Get().JournalContext(*Sent);
+			return;
 		}
+		UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: Failed to send context: %s"), ResponseCode > 0 ? *FString::Printf(TEXT("HTTP Error %d"), ResponseCode) : TEXT("Request failed"));
+	});
+}
+
+void FHttpClient::SendContextItems(const TArray<FQueuedContext>& Items, TFunction<void(int32)> OnComplete)
+{
+	ContextBatchStats.Sent += Items.Num();
+	++ContextBatchStats.Requests;
+	
+	// The batch travels at the priority of its most urgent message
+	ESurrealPilotRequestPriority Priority = ESurrealPilotRequestPriority::HealthCheck;
+	for (const FQueuedContext& Item : Items)
+	{
+		Priority = FMath::Min(Priority, Item.Priority);
 	}
 	
-	return Headers;
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	const bool bHashContext = Settings && Settings->bEnableContextDedup;
+	TArray<TSharedRef<const FSurrealPilotContextBlob>> Blobs;
+	Blobs.Reserve(Items.Num());
+	for (const FQueuedContext& Item : Items)
+	{
+		Blobs.Add(FSurrealPilotContextBlob::Encode(Item.Data, bHashContext));
+	}
+	
+	// A lone message goes out in the plain format so servers without batch support still see it
+	FContextUpload ContextUpload;
+	TArray<uint8> Body = BuildBodyWithContext([this, Items, Blobs](const FString& ReferenceBaseUrl, FContextUpload& Upload)
+	{
+		return Items.Num() == 1 ?
+			BuildContextRequestBody(Items[0].Type, *Blobs[0], ReferenceBaseUrl, Upload) :
+			BuildContextBatchBody(Items, Blobs, ReferenceBaseUrl, Upload);
+	}, GetApiBaseUrl(), ContextUpload);
+	
+	TSharedRef<FChannelCallbacks> Callbacks = MakeShared<FChannelCallbacks>();
+	Callbacks->OnResponse = [OnComplete](TSharedPtr<FJsonObject> Response)
+	{
+		OnComplete(EHttpResponseCodes::Ok);
+	};
+	Callbacks->OnFailure = [OnComplete](int32 ResponseCode, const FString& ResponseBody)
+	{
+		OnComplete(ResponseCode);
+	};
+	
+	SendJsonRequest(TEXT("/api/context"), Priority, MoveTemp(Body), [OnComplete](FHttpRequestPtr Request)
+	{
+		Request->OnProcessRequestComplete().BindLambda([OnComplete](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			// Retries are already exhausted by the time an error status gets here
+			OnComplete(bWasSuccessful && Response.IsValid() ? Response->GetResponseCode() : 0);
+		});
+	}, MoveTemp(ContextUpload), FString(), nullptr, Callbacks);
 }
 
-void FHttpClient::HandleStreamingResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, FOnStreamingChunk OnChunk, FOnHttpError OnError)
+void FHttpClient::JournalContext(const TArray<FQueuedContext>& Items)
 {
-	if (!bWasSuccessful || !Response.IsValid())
+	for (const FQueuedContext& Item : Items)
+	{
+		ContextJournal.Append(Item.Type, Item.Data, Item.SupersedeKey, static_cast<uint8>(Item.Priority));
+	}
+}
+
+bool FHttpClient::IsEndpointUnavailable(int32 ResponseCode)
+{
+	// No response at all (including a request the open circuit failed fast), or a status that says to come back later
+	return ResponseCode == 0 || ResponseCode >= 500 || FSurrealPilotRetryPolicy::IsRetryableStatus(ResponseCode);
+}
+
+void FHttpClient::ReplayContextJournal()
+{
+	if (bReplayingContextJournal || ContextJournal.IsEmpty())
 	{
-		FSurrealPilotErrorHandler::HandleHttpError(0, TEXT("Request failed"));
-		OnError.ExecuteIfBound(TEXT("Request failed"));
 		return;
 	}
 	
-	if (Response->GetResponseCode() != 200)
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	const int32 BatchSize = FMath::Max(1, Settings ? Settings->ContextBatchMaxItems : 50);
+	TArray<FQueuedContext> Items;
+	TArray<int64> Sequences;
+	for (const FSurrealPilotJournalEntry& Entry : ContextJournal.Peek(BatchSize))
 	{
-		FSurrealPilotErrorHandler::HandleHttpError(Response->GetResponseCode(), Response->GetContentAsString());
-		FString ErrorMessage = FString::Printf(TEXT("HTTP Error %d: %s"), Response->GetResponseCode(), *Response->GetContentAsString());
-		OnError.ExecuteIfBound(ErrorMessage);
-		return;
+		FQueuedContext& Item = Items.AddDefaulted_GetRef();
+		Item.Type = Entry.Type;
+		Item.Data = Entry.Data;
+		Item.SupersedeKey = Entry.SupersedeKey;
+		Item.Priority = static_cast<ESurrealPilotRequestPriority>(Entry.Priority);
+		Sequences.Add(Entry.Sequence);
 	}
 	
-	// Parse Server-Sent Events
-	FString ResponseData = Response->GetContentAsString();
-	TArray<FString> Chunks = ParseSSEData(ResponseData);
+	// While the endpoint is still down this fails fast at the circuit breaker, or becomes its half-open trial request
+	bReplayingContextJournal = true;
+	SendContextItems(Items, [Sequences](int32 ResponseCode)
+	{
+		if (!FHttpClient::IsAvailable())
+		{
+			return;
+		}
+		
+		FHttpClient& Client = FHttpClient::Get();
+		Client.bReplayingContextJournal = false;
+		if (IsEndpointUnavailable(ResponseCode))
+		{
+			// Still away; the next probe tries again
+			return;
+		}
+		
+		if (EHttpResponseCodes::IsOk(ResponseCode))
+		{
+			UE_LOG(LogTemp, Log, TEXT("SurrealPilot: Delivered %d journaled context messages, %d left"), Sequences.Num(), Client.ContextJournal.Num() - Sequences.Num());
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: Dropping %d journaled context messages the endpoint rejected (HTTP Error %d)"), Sequences.Num(), ResponseCode);
+		}
+		Client.ContextJournal.Remove(Sequences);
+		Client.ReplayContextJournal();
+	});
+}
+
+void FHttpClient::SetContextJournalPath(const FString& FilePath)
+{
+	ContextJournalPathOverride = FilePath;
+	RefreshContextJournal();
+}
+
+void FHttpClient::RefreshContextJournal()
+{
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	if (!Settings || !Settings->bEnableOfflineContextJournal)
+	{
+		ContextJournal.Close();
+		return;
+	}
 	
-	for (const FString& Chunk : Chunks)
+	ContextJournal.SetMaxEntries(Settings->OfflineContextJournalMaxEntries);
+	const FString FilePath = ContextJournalPathOverride.IsEmpty() ? FSurrealPilotContextJournal::GetDefaultPath() : ContextJournalPathOverride;
+	if (ContextJournal.GetFilePath() != FilePath)
 	{
-		OnChunk.ExecuteIfBound(Chunk);
+		// Whatever a replay in flight was delivering belongs to the journal being closed
+		bReplayingContextJournal = false;
+		ContextJournal.Open(FilePath);
 	}
 }
 
-TArray<FString> FHttpClient::ParseSSEData(const FString& ResponseData) const
+FSurrealPilotRequestHandle FHttpClient::SendJsonRequest(const FString& Endpoint, ESurrealPilotRequestPriority Priority, TArray<uint8>&& Body, TFunction<void(FHttpRequestPtr)> BindHandlers,
+	FContextUpload ContextUpload, const FString& Provider, TSharedPtr<FSSEStreamState> StreamState, TSharedPtr<const FChannelCallbacks> ChannelCallbacks,
+	TSharedPtr<FSurrealPilotRequestState> InState)
 {
-	TArray<FString> Chunks;
-	TArray<FString> Lines;
-	ResponseData.ParseIntoArrayLines(Lines);
+	TSharedRef<FSurrealPilotRequestState> State = InState.IsValid() ? InState.ToSharedRef() : MakeShared<FSurrealPilotRequestState>();
+	if (StreamState.IsValid())
+	{
+		StreamState->RequestState = State;
+		State->bFinishesOnDelivery = true;
+	}
 	
-	for (const FString& Line : Lines)
+	// Only a channel to the endpoint HTTP would use carries the request; context references were made against it
+	const FString BaseUrl = GetApiBaseUrl();
+	RefreshChannel();
+	if (ChannelCallbacks.IsValid() && Channel.IsConnected() && Channel.GetBaseUrl() == BaseUrl)
 	{
-		if (Line.StartsWith(TEXT("data: ")))
-		{
-			FString Data = Line.Mid(6); // Remove "data: " prefix
-			if (!Data.IsEmpty() && Data != TEXT("[DONE]"))
-			{
-				Chunks.Add(Data);
-			}
-		}
+		TSharedRef<FChannelRequest> Request = MakeShared<FChannelRequest>();
+		Request->Endpoint = Endpoint;
+		Request->Priority = Priority;
+		Request->Body = MoveTemp(Body);
+		Request->BindHandlers = MoveTemp(BindHandlers);
+		Request->ContextUpload = MoveTemp(ContextUpload);
+		Request->Provider = Provider;
+		Request->StreamState = StreamState;
+		Request->Callbacks = ChannelCallbacks;
+		Request->State = State;
+		SendOverChannel(Request);
+		return FSurrealPilotRequestHandle(State);
 	}
 	
-	return Chunks;
+	return SendHttpRequest(Endpoint, Priority, MoveTemp(Body), MoveTemp(BindHandlers), MoveTemp(ContextUpload), Provider, StreamState, State);
 }
 
-FHttpRequestPtr FHttpClient::CreateRequest(const FString& Verb, const FString& Endpoint) const
+FSurrealPilotRequestHandle FHttpClient::SendHttpRequest(const FString& Endpoint, ESurrealPilotRequestPriority Priority, TArray<uint8>&& Body, TFunction<void(FHttpRequestPtr)> BindHandlers,
+	FContextUpload ContextUpload, const FString& Provider, TSharedPtr<FSSEStreamState> StreamState, TSharedRef<FSurrealPilotRequestState> State)
 {
-	FHttpRequestPtr Request = HttpModule->CreateRequest();
-	Request->SetVerb(Verb);
-	Request->SetURL(GetApiBaseUrl() + Endpoint);
+	TSharedRef<FRequestAttempt> Attempt = MakeShared<FRequestAttempt>();
+	Attempt->State = State;
+	Attempt->Verb = TEXT("POST");
+	Attempt->Endpoint = Endpoint;
+	Attempt->Priority = Priority;
+	Attempt->BindHandlers = MoveTemp(BindHandlers);
+	Attempt->BaseUrl = GetApiBaseUrl();
+	Attempt->Provider = Provider;
+	Attempt->StreamState = StreamState;
+	Attempt->ContextUpload = MoveTemp(ContextUpload);
 	
-	// Add authentication headers
-	TMap<FString, FString> AuthHeaders = GetAuthHeaders();
-	for (const auto& Header : AuthHeaders)
+	FHttpRequestPtr Request = CreateRequest(Attempt->Verb, Endpoint, Attempt->BaseUrl);
+	SetJsonBody(*Attempt, Request, MoveTemp(Body));
+	
+	Attempt->BindHandlers(Request);
+	return StartAttempt(Attempt, Request);
+}
+
+FSurrealPilotRequestHandle FHttpClient::SendCompactBinaryRequest(const FString& Endpoint, ESurrealPilotRequestPriority Priority, TArray<uint8>&& Body,
+	TFunction<TArray<uint8>()> BuildJsonBody, TFunction<void(FHttpRequestPtr)> BindHandlers, TSharedPtr<FSurrealPilotRequestState> State)
+{
+	TSharedRef<FRequestAttempt> Attempt = MakeShared<FRequestAttempt>();
+	if (State.IsValid())
 	{
-		Request->SetHeader(Header.Key, Header.Value);
+		Attempt->State = State.ToSharedRef();
 	}
+	Attempt->Verb = TEXT("POST");
+	Attempt->Endpoint = Endpoint;
+	Attempt->Priority = Priority;
+	Attempt->BindHandlers = MoveTemp(BindHandlers);
+	Attempt->BaseUrl = GetApiBaseUrl();
+	Attempt->ContentType = FSurrealPilotCompactBinary::GetContentType();
+	Attempt->BuildJsonBody = MoveTemp(BuildJsonBody);
 	
-	// Add common headers
-	Request->SetHeader(TEXT("User-Agent"), TEXT("SurrealPilot-UE-Plugin/1.0"));
-	Request->SetHeader(TEXT("Accept"), TEXT("text/event-stream, application/json"));
+	FHttpRequestPtr Request = CreateRequest(Attempt->Verb, Endpoint, Attempt->BaseUrl);
+	SetJsonBody(*Attempt, Request, MoveTemp(Body));
 	
-	return Request;
-}
\ No newline at end of file
+	Attempt->BindHandlers(Request);
+	return StartAttempt(Attempt, Request);
+}
+
+void FHttpClient::SetJsonBody(FRequestAttempt& Attempt, FHttpRequestPtr Request, TArray<uint8>&& Body)
+{
+	Request->SetHeader(TEXT("Content-Type"), Attempt.ContentType.IsEmpty() ? TEXT("application/json") : *Attempt.ContentType);
+	
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	const ESurrealPilotRequestCompression Compression = Settings ? Settings->RequestCompression : ESurrealPilotRequestCompression::None;
+	
+	TArray<uint8> CompressedBody;
+	const double CompressStartTime = FPlatformTime::Seconds();
+	if (Compression != ESurrealPilotRequestCompression::None &&
+		Body.Num() >= Settings->MinCompressedBodyBytes &&
+		!UrlsWithoutCompression.Contains(Request->GetURL()) &&
+		FSurrealPilotCompression::Compress(Body, Compression, CompressedBody) &&
+		CompressedBody.Num() < Body.Num())
+	{
+		// Only a body that goes out compressed counts towards the ratio and the bytes saved
+		FSurrealPilotCompression::RecordCompression(Body.Num(), CompressedBody.Num(), FPlatformTime::Seconds() - CompressStartTime);
+		Request->SetHeader(TEXT("Content-Encoding"), FSurrealPilotCompression::GetContentEncoding(Compression));
+		if (Compression == ESurrealPilotRequestCompression::DeflateDictionary)
+		{
+			Request->SetHeader(TEXT("X-SurrealPilot-Dictionary"), FSurrealPilotCompression::GetDictionaryId());
+		}
+		Request->SetContent(MoveTemp(CompressedBody));
+		
+		// Kept in case the server answers 415 and the body has to be resent as plain JSON
+		Attempt.PlainBody = MakeShared<TArray<uint8>>(MoveTemp(Body));
+	}
+	else
+	{
+		Attempt.PlainBody.Reset();
+		Request->SetContent(MoveTemp(Body));
+	}
+}
+
+TArray<uint8> FHttpClient::BuildBodyWithContext(TFunction<TArray<uint8>(const FString&, FContextUpload&)> Build, const FString& ReferenceBaseUrl, FContextUpload& OutUpload)
+{
+	TArray<uint8> Body = Build(ReferenceBaseUrl, OutUpload);
+	if (OutUpload.References > 0 || OutUpload.bAssetDelta)
+	{
+		OutUpload.BuildInlineBody = [Build]()
+		{
+			FContextUpload InlineUpload;
+			return Build(FString(), InlineUpload);
+		};
+		OutUpload.BuildForEndpoint = Build;
+	}
+	return Body;
+}
+
+void FHttpClient::WriteContextField(FSurrealPilotJsonWriter& Writer, const FString& Field, const FSurrealPilotContextBlob& Blob, const FString& ReferenceBaseUrl, FContextUpload& Upload) const
+{
+	if (!Blob.Hash.IsEmpty() && !ReferenceBaseUrl.IsEmpty() && ContextStore.IsStored(ReferenceBaseUrl, Blob.Hash))
+	{
+		Writer.WriteString(Field + TEXT("_ref"), Blob.Hash);
+		++Upload.References;
+		Upload.ReferencedBytes += Blob.Json.Num();
+		return;
+	}
+	
+	Writer.WriteRawValue(Field, Blob.Json);
+	if (!Blob.Hash.IsEmpty())
+	{
+		// Lets the server keep the blob and confirm it, so the next request can refer to it
+		Writer.WriteString(Field + TEXT("_hash"), Blob.Hash);
+		++Upload.Uploads;
+		Upload.UploadedBytes += Blob.Json.Num();
+	}
+}
+
+void FHttpClient::TrackRequest(const TSharedRef<FSurrealPilotRequestState>& State)
+{
+	LiveRequests.RemoveAllSwap([](const TWeakPtr<FSurrealPilotRequestState>& WeakState)
+	{
+		TSharedPtr<FSurrealPilotRequestState> Pinned = WeakState.Pin();
+		return !Pinned.IsValid() || Pinned->IsFinished();
+	});
+	
+	// A channel request that falls back to HTTP keeps its state
+	LiveRequests.AddUnique(State);
+}
+
+FSurrealPilotRequestHandle FHttpClient::StartAttempt(TSharedRef<FRequestAttempt> Attempt, FHttpRequestPtr Request)
+{
+	TrackRequest(Attempt->State);
+	
+	TWeakPtr<FRequestAttempt> WeakAttempt = Attempt;
+	Attempt->State->Abort = [this, WeakAttempt](FHttpRequestPtr CurrentRequest, ESurrealPilotRequestStatus FinalStatus)
+	{
+		TSharedPtr<FRequestAttempt> PinnedAttempt = WeakAttempt.Pin();
+		if (!PinnedAttempt.IsValid())
+		{
+			return;
+		}
+		
+		// Whatever the probe would have said is now ignored, so let a later request probe instead
+		if (PinnedAttempt->bCircuitProbe)
+		{
+			PinnedAttempt->bCircuitProbe = false;
+			CircuitBreaker.RecordAbandonedProbe(PinnedAttempt->BaseUrl, FPlatformTime::Seconds());
+		}
+		
+		// On the wire: closing the connection completes the request, and the completion handler reports a timeout
+		if (CurrentRequest.IsValid() && !Scheduler.Cancel(CurrentRequest))
+		{
+			CurrentRequest->CancelRequest();
+			return;
+		}
+		
+		// Queued or waiting to retry: nothing else will complete it
+		if (FinalStatus == ESurrealPilotRequestStatus::TimedOut)
+		{
+			PinnedAttempt->OnComplete.ExecuteIfBound(CurrentRequest, nullptr, false);
+		}
+	};
+	
+	SendAttempt(Attempt, Request);
+	return FSurrealPilotRequestHandle(Attempt->State);
+}
+
+void FHttpClient::SendAttempt(TSharedRef<FRequestAttempt> Attempt, FHttpRequestPtr Request)
+{
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	if (Settings)
+	{
+		RetryPolicy.MaxRetries = Settings->MaxRequestRetries;
+		RetryPolicy.BaseDelaySeconds = Settings->RetryBaseDelaySeconds;
+		RetryPolicy.MaxDelaySeconds = Settings->RetryMaxDelaySeconds;
+		CircuitBreaker.Configure(Settings->CircuitBreakerFailureThreshold, Settings->CircuitBreakerCooldownSeconds);
+	}
+	
+	FHttpRequestCompleteDelegate OnComplete = Request->OnProcessRequestComplete();
+	Attempt->OnComplete = OnComplete;
+	
+	// While the endpoint is known to be down, report failure straight away instead of waiting for a timeout
+	Attempt->bCircuitProbe = false;
+	if (!CircuitBreaker.AllowRequest(Attempt->BaseUrl, FPlatformTime::Seconds()))
+	{
+		++RetryStats.FailedFast;
+		UE_LOG(LogTemp, Verbose, TEXT("SurrealPilot: %s is unavailable, failing %s immediately"), *Attempt->BaseUrl, *Attempt->Endpoint);
+		RunAfterDelay(0.0f, [Attempt, Request, OnComplete]()
+		{
+			if (!Attempt->State->IsFinished())
+			{
+				FSurrealPilotRequestHandle::Finish(*Attempt->State, ESurrealPilotRequestStatus::Failed);
+				OnComplete.ExecuteIfBound(Request, nullptr, false);
+			}
+		});
+		return;
+	}
+	
+	Attempt->bCircuitProbe = CircuitBreaker.GetState(Attempt->BaseUrl) == ESurrealPilotCircuitState::HalfOpen;
+	
+	// A cancelled stream must not deliver another chunk
+	if (Request->OnRequestProgress().IsBound())
+	{
+		FHttpRequestProgressDelegate OnProgress = Request->OnRequestProgress();
+		TSharedRef<FSurrealPilotRequestState> State = Attempt->State;
+		Request->OnRequestProgress().BindLambda([State, OnProgress](FHttpRequestPtr ProgressRequest, int32 BytesSent, int32 BytesReceived)
+		{
+			if (!State->IsFinished())
+			{
+				OnProgress.ExecuteIfBound(ProgressRequest, BytesSent, BytesReceived);
+			}
+		});
+	}
+	
+	// Time to first byte: the HTTP module only reports elapsed time, so sample it when the first header arrives
+	Attempt->FirstByteSeconds = -1.0;
+	TWeakPtr<FRequestAttempt> WeakAttempt = Attempt;
+	Request->OnHeaderReceived().BindLambda([WeakAttempt](FHttpRequestPtr HeaderRequest, const FString& HeaderName, const FString& HeaderValue)
+	{
+		TSharedPtr<FRequestAttempt> PinnedAttempt = WeakAttempt.Pin();
+		if (PinnedAttempt.IsValid() && PinnedAttempt->FirstByteSeconds < 0.0 && HeaderRequest.IsValid())
+		{
+			PinnedAttempt->FirstByteSeconds = HeaderRequest->GetElapsedTime();
+		}
+	});
+	
+	Request->OnProcessRequestComplete().BindLambda([this, Attempt, OnComplete](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+	{
+		Attempt->State->CurrentRequest.Reset();
+		
+		// Cancelled requests report nothing; timed-out ones report a failure once
+		if (Attempt->State->IsFinished())
+		{
+			if (Attempt->State->Status == ESurrealPilotRequestStatus::TimedOut)
+			{
+				OnComplete.ExecuteIfBound(Request, nullptr, false);
+			}
+			return;
+		}
+		
+		const int32 ResponseCode = Response.IsValid() ? Response->GetResponseCode() : 0;
+		
+		Attempt->bCircuitProbe = false;
+		RecordEndpointResult(Attempt->BaseUrl, ResponseCode);
+		
+		// The server no longer has a context this body referred to (it restarted, or evicted it), or its version
+		// of an asset is not the one a delta was made against, so send everything inline and in full
+		TArray<uint8> InlineBody;
+		if (PrepareInlineResend(Attempt->BaseUrl, ResponseCode, Attempt->ContextUpload, InlineBody))
+		{
+			Attempt->ReplacementBody = MakeShared<TArray<uint8>>(MoveTemp(InlineBody));
+			RecordAttemptMetrics(*Attempt, Request, Response);
+			ResendAttempt(Attempt, Request);
+			return;
+		}
+		
+		// A server that does not read Compact Binary answers 415; remember that and resend the body as JSON.
+		// This comes first: the server may have rejected the encoding rather than the compression, and a JSON body
+		// it still cannot decompress gets the fallback below
+		if (ResponseCode == EHttpResponseCodes::UnsupportedMedia && Attempt->BuildJsonBody)
+		{
+			UE_LOG(LogTemp, Log, TEXT("SurrealPilot: %s rejected a Compact Binary body, resending as JSON"), *Request->GetURL());
+			UrlsWithoutCompactBinary.Add(Request->GetURL());
+			Attempt->ContentType.Reset();
+			Attempt->ReplacementBody = MakeShared<TArray<uint8>>(Attempt->BuildJsonBody());
+			Attempt->BuildJsonBody = nullptr;
+			RecordAttemptMetrics(*Attempt, Request, Response);
+			ResendAttempt(Attempt, Request);
+			return;
+		}
+		
+		// A server that cannot decode the body answers 415; remember that and resend it as plain JSON
+		if (ResponseCode == EHttpResponseCodes::UnsupportedMedia && Attempt->PlainBody.IsValid())
+		{
+			UE_LOG(LogTemp, Log, TEXT("SurrealPilot: %s rejected a compressed body, resending uncompressed"), *Request->GetURL());
+			UrlsWithoutCompression.Add(Request->GetURL());
+			FSurrealPilotCompression::RecordFallback();
+			RecordAttemptMetrics(*Attempt, Request, Response);
+			ResendAttempt(Attempt, Request);
+			return;
+		}
+		
+		double DelaySeconds = 0.0;
+		if (Attempt->bAllowRetry &&
+			Attempt->RetryCount < RetryPolicy.MaxRetries &&
+			FSurrealPilotRetryPolicy::IsRetryable(Response, bWasSuccessful) &&
+			RetryPolicy.GetRetryDelay(Attempt->RetryCount + 1, Response, RetryRandom, DelaySeconds))
+		{
+			++Attempt->RetryCount;
+			++RetryStats.Retries;
+			UE_LOG(LogTemp, Log, TEXT("SurrealPilot: %s failed (%d), retry %d of %d in %.2f s"),
+				*Attempt->Endpoint, ResponseCode, Attempt->RetryCount, RetryPolicy.MaxRetries, DelaySeconds);
+			RecordAttemptMetrics(*Attempt, Request, Response);
+			
+			RunAfterDelay(DelaySeconds, [this, Attempt, Request]()
+			{
+				ResendAttempt(Attempt, Request);
+			});
+			return;
+		}
+		
+		if (Attempt->RetryCount > 0 && FSurrealPilotRetryPolicy::IsRetryable(Response, bWasSuccessful))
+		{
+			++RetryStats.Exhausted;
+		}
+		
+		const bool bSucceeded = bWasSuccessful && EHttpResponseCodes::IsOk(ResponseCode);
+		if (bSucceeded)
+		{
+			RecordContextUploaded(Attempt->BaseUrl, Attempt->ContextUpload, [&Response](const FString& Name) { return Response->GetHeader(Name); });
+		}
+		
+		// A large body goes to a worker and the handler finishes the request once it has been delivered, so until
+		// then it can still be cancelled or time out
+		const int32 ConsumedBytes = Attempt->StreamState.IsValid() ? Attempt->StreamState->ConsumedBytes : 0;
+		if (!bSucceeded || !Attempt->State->bFinishesOnDelivery || !SurrealPilotHttpClient::IsParsedOnWorker(Response, ConsumedBytes))
+		{
+			FSurrealPilotRequestHandle::Finish(*Attempt->State, bSucceeded
+				? ESurrealPilotRequestStatus::Succeeded
+				: ESurrealPilotRequestStatus::Failed);
+		}
+		OnComplete.ExecuteIfBound(Request, Response, bWasSuccessful);
+		
+		// After OnComplete, so events a chat delivers from the tail of its body are counted
+		RecordAttemptMetrics(*Attempt, Request, Response);
+	});
+	
+	Attempt->State->CurrentRequest = Request;
+	SubmitRequest(Attempt->Priority, Request);
+}
+
+void FHttpClient::ResendAttempt(TSharedRef<FRequestAttempt> Attempt, FHttpRequestPtr PreviousRequest)
+{
+	// Cancelled or timed out while waiting to retry
+	if (Attempt->State->IsFinished())
+	{
+		return;
+	}
+	
+	// Pick the endpoint again, it may have changed since the last attempt
+	const FString PreviousBaseUrl = Attempt->BaseUrl;
+	Attempt->BaseUrl = GetApiBaseUrl();
+	FHttpRequestPtr Request = CreateRequest(Attempt->Verb, Attempt->Endpoint, Attempt->BaseUrl);
+	
+	// References and deltas were made against what the previous endpoint keeps, so build them again for this one
+	if (!Attempt->ReplacementBody.IsValid() && Attempt->BaseUrl != PreviousBaseUrl && Attempt->ContextUpload.BuildForEndpoint)
+	{
+		FContextUpload Upload;
+		Upload.AssetPath = Attempt->ContextUpload.AssetPath;
+		Upload.AssetVersion = Attempt->ContextUpload.AssetVersion;
+		Upload.AssetContext = Attempt->ContextUpload.AssetContext;
+		Attempt->ReplacementBody = MakeShared<TArray<uint8>>(BuildBodyWithContext(Attempt->ContextUpload.BuildForEndpoint, Attempt->BaseUrl, Upload));
+		Attempt->ContextUpload = MoveTemp(Upload);
+	}
+	
+	if (Attempt->ReplacementBody.IsValid())
+	{
+		TSharedPtr<TArray<uint8>> Body = MoveTemp(Attempt->ReplacementBody);
+		SetJsonBody(*Attempt, Request, MoveTemp(*Body));
+		Attempt->BindHandlers(Request);
+		SendAttempt(Attempt, Request);
+		return;
+	}
+	
+	const FString ContentType = PreviousRequest->GetHeader(TEXT("Content-Type"));
+	if (!ContentType.IsEmpty())
+	{
+		Request->SetHeader(TEXT("Content-Type"), ContentType);
+	}
+	
+	if (Attempt->PlainBody.IsValid() && UrlsWithoutCompression.Contains(Request->GetURL()))
+	{
+		Request->SetContent(MoveTemp(*Attempt->PlainBody));
+		Attempt->PlainBody.Reset();
+	}
+	else if (PreviousRequest->GetContentLength() > 0)
+	{
+		// The previous request still owns the body it sent, encoding included
+		for (const TCHAR* Header : { TEXT("Content-Encoding"), TEXT("X-SurrealPilot-Dictionary") })
+		{
+			const FString Value = PreviousRequest->GetHeader(Header);
+			if (!Value.IsEmpty())
+			{
+				Request->SetHeader(Header, Value);
+			}
+		}
+		Request->SetContent(CopyTemp(PreviousRequest->GetContent()));
+	}
+	
+	Attempt->BindHandlers(Request);
+	SendAttempt(Attempt, Request);
+}
+
+bool FHttpClient::PrepareInlineResend(const FString& BaseUrl, int32 ResponseCode, FContextUpload& Upload, TArray<uint8>& OutBody)
+{
+	// The server no longer has a context this body referred to (it restarted, or evicted it), or its version
+	// of an asset is not the one a delta was made against, so send everything inline and in full
+	if ((ResponseCode != EHttpResponseCodes::NotFound && ResponseCode != EHttpResponseCodes::Conflict && ResponseCode != EHttpResponseCodes::PreconditionFailed) ||
+		!Upload.BuildInlineBody)
+	{
+		return false;
+	}
+	
+	if (Upload.References > 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("SurrealPilot: %s did not have referenced context (%d), resending it inline"), *BaseUrl, ResponseCode);
+		ContextStore.Forget(BaseUrl);
+		++ContextStore.GetStats().Misses;
+	}
+	if (Upload.bAssetDelta)
+	{
+		UE_LOG(LogTemp, Log, TEXT("SurrealPilot: %s rejected a delta for %s (%d), resending the full export"), *BaseUrl, *Upload.AssetPath, ResponseCode);
+		ContextVersions.Forget(BaseUrl, Upload.AssetPath);
+		++ContextVersions.GetStats().Divergences;
+	}
+	
+	OutBody = Upload.BuildInlineBody();
+	Upload.BuildInlineBody = nullptr;
+	Upload.BuildForEndpoint = nullptr;
+	Upload.Uploads += Upload.References;
+	Upload.UploadedBytes += Upload.ReferencedBytes;
+	Upload.References = 0;
+	Upload.ReferencedBytes = 0;
+	Upload.bAssetDelta = false;
+	return true;
+}
+
+void FHttpClient::RecordContextUploaded(const FString& BaseUrl, const FContextUpload& Upload, TFunctionRef<FString(const FString&)> GetHeader)
+{
+	// Count what the context references saved, and learn which blobs the server now keeps
+	FSurrealPilotContextDedupStats& DedupStats = ContextStore.GetStats();
+	DedupStats.References += Upload.References;
+	DedupStats.BytesSaved += Upload.ReferencedBytes;
+	DedupStats.Uploads += Upload.Uploads;
+	DedupStats.BytesUploaded += Upload.UploadedBytes;
+	ContextStore.MarkStored(BaseUrl, GetHeader(FSurrealPilotContextStore::StoredHeader));
+	
+	// Only a server that confirms the version keeps it, and can take a delta against it next time
+	if (!Upload.AssetPath.IsEmpty())
+	{
+		FSurrealPilotContextDeltaStats& DeltaStats = ContextVersions.GetStats();
+		if (Upload.bAssetDelta)
+		{
+			++DeltaStats.Deltas;
+			DeltaStats.DeltaBytes += Upload.DeltaBytes;
+			DeltaStats.FullBytesReplaced += Upload.AssetBytes;
+		}
+		else
+		{
+			++DeltaStats.FullUploads;
+		}
+		
+		if (GetHeader(FSurrealPilotContextVersions::VersionHeader) == Upload.AssetVersion)
+		{
+			ContextVersions.Acknowledge(BaseUrl, Upload.AssetPath, Upload.AssetVersion, Upload.AssetContext);
+		}
+		else
+		{
+			ContextVersions.Forget(BaseUrl, Upload.AssetPath);
+		}
+	}
+}
+
+void FHttpClient::RefreshChannel()
+{
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	if (!Settings || !Settings->bEnableWebSocketChannel)
+	{
+		if (Channel.GetState() != ESurrealPilotChannelState::Closed)
+		{
+			Channel.Close();
+		}
+		return;
+	}
+	
+	// Does nothing while the channel already belongs to this endpoint
+	Channel.Open(GetApiBaseUrl(), GetAuthHeaders());
+}
+
+void FHttpClient::SendOverChannel(TSharedRef<FChannelRequest> Request)
+{
+	// Cancelled or timed out while its previous attempt was on the way back
+	if (Request->State->IsFinished())
+	{
+		return;
+	}
+	
+	// The channel multiplexes every request over one connection to a local app, so there is no scheduler queue to
+	// wait in; retries, backoff and the circuit breaker only apply once a request has moved to HTTP
+	Request->BaseUrl = Channel.GetBaseUrl();
+	Request->SentTime = FPlatformTime::Seconds();
+	Request->FirstFrameSeconds = -1.0;
+	Request->ResponseBytes = 0;
+	Request->RequestId = Channel.Send(Request->Endpoint, Request->Body,
+		[this, Request](const FSurrealPilotChannelFrame& Frame)
+		{
+			HandleChannelFrame(Request, Frame);
+		},
+		[this, Request]()
+		{
+			HandleChannelLost(Request);
+		});
+	if (Request->RequestId == INDEX_NONE)
+	{
+		FallBackToHttp(Request);
+		return;
+	}
+	
+	Request->State->Status = ESurrealPilotRequestStatus::InFlight;
+	TrackRequest(Request->State);
+	TWeakPtr<FChannelRequest> WeakRequest = Request;
+	Request->State->Abort = [this, WeakRequest](FHttpRequestPtr CurrentRequest, ESurrealPilotRequestStatus FinalStatus)
+	{
+		if (TSharedPtr<FChannelRequest> PinnedRequest = WeakRequest.Pin())
+		{
+			Channel.Cancel(PinnedRequest->RequestId);
+			if (FinalStatus == ESurrealPilotRequestStatus::TimedOut && PinnedRequest->Callbacks->OnFailure)
+			{
+				PinnedRequest->Callbacks->OnFailure(0, FString());
+			}
+		}
+	};
+}
+
+void FHttpClient::HandleChannelFrame(TSharedRef<FChannelRequest> Request, const FSurrealPilotChannelFrame& Frame)
+{
+	if (Request->State->IsFinished())
+	{
+		return;
+	}
+	
+	const double Elapsed = FPlatformTime::Seconds() - Request->SentTime;
+	Request->ResponseBytes += Frame.FrameBytes;
+	if (Request->FirstFrameSeconds < 0.0)
+	{
+		Request->FirstFrameSeconds = Elapsed;
+	}
+	
+	const FChannelCallbacks& Callbacks = *Request->Callbacks;
+	if (Frame.Op == TEXT("event"))
+	{
+		if (!Frame.Data.IsEmpty() && Frame.Data != TEXT("[DONE]"))
+		{
+			if (Request->EventCount++ == 0)
+			{
+				Request->FirstEventSeconds = Elapsed;
+			}
+			if (Callbacks.OnEvent)
+			{
+				Callbacks.OnEvent(Frame.Data);
+			}
+		}
+		return;
+	}
+	
+	RecordChannelMetrics(*Request, Frame.Status);
+	
+	if (EHttpResponseCodes::IsOk(Frame.Status))
+	{
+		RecordContextUploaded(Request->BaseUrl, Request->ContextUpload, [&Frame](const FString& Name)
+		{
+			const FString* Value = Frame.Headers.Find(Name);
+			return Value ? *Value : FString();
+		});
+		FSurrealPilotRequestHandle::Finish(*Request->State, ESurrealPilotRequestStatus::Succeeded);
+		if (Callbacks.OnResponse)
+		{
+			Callbacks.OnResponse(Frame.Body);
+		}
+		return;
+	}
+	
+	TArray<uint8> InlineBody;
+	if (PrepareInlineResend(Request->BaseUrl, Frame.Status, Request->ContextUpload, InlineBody))
+	{
+		Request->Body = MoveTemp(InlineBody);
+		SendOverChannel(Request);
+		return;
+	}
+	
+	// The app is busy or its upstream is failing; HTTP retries with backoff, which the channel does not
+	if (Request->EventCount == 0 && FSurrealPilotRetryPolicy::IsRetryableStatus(Frame.Status))
+	{
+		FallBackToHttp(Request);
+		return;
+	}
+	
+	FString ResponseBody;
+	if (Frame.Body.IsValid())
+	{
+		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&ResponseBody);
+		FJsonSerializer::Serialize(Frame.Body.ToSharedRef(), Writer);
+	}
+	FSurrealPilotRequestHandle::Finish(*Request->State, ESurrealPilotRequestStatus::Failed);
+	if (Callbacks.OnFailure)
+	{
+		Callbacks.OnFailure(Frame.Status, ResponseBody);
+	}
+}
+
+void FHttpClient::HandleChannelLost(TSharedRef<FChannelRequest> Request)
+{
+	if (Request->State->IsFinished())
+	{
+		return;
+	}
+	
+	// Nothing has reached the caller yet, so the request can start over on HTTP
+	if (Request->EventCount == 0)
+	{
+		FallBackToHttp(Request);
+		return;
+	}
+	
+	UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: channel dropped partway through %s"), *Request->Endpoint);
+	RecordChannelMetrics(*Request, 0);
+	FSurrealPilotRequestHandle::Finish(*Request->State, ESurrealPilotRequestStatus::Failed);
+	if (Request->Callbacks->OnFailure)
+	{
+		Request->Callbacks->OnFailure(0, FString());
+	}
+}
+
+void FHttpClient::FallBackToHttp(TSharedRef<FChannelRequest> Request)
+{
+	++Channel.GetStats().HttpFallbacks;
+	UE_LOG(LogTemp, Verbose, TEXT("SurrealPilot: sending %s over HTTP instead of the channel"), *Request->Endpoint);
+	
+	Request->State->Status = ESurrealPilotRequestStatus::Queued;
+	Request->State->Abort.Reset();
+	SendHttpRequest(Request->Endpoint, Request->Priority, MoveTemp(Request->Body), Request->BindHandlers, Request->ContextUpload,
+		Request->Provider, Request->StreamState, Request->State);
+}
+
+void FHttpClient::RecordChannelMetrics(const FChannelRequest& Request, int32 ResponseCode)
+{
+	FSurrealPilotRequestSample Sample;
+	Sample.Verb = TEXT("WS");
+	
+	// A series of its own (ws://host:port), so the channel and HTTP to the same endpoint can be compared
+	Sample.BaseUrl = FSurrealPilotWebSocketChannel::MakeChannelUrl(Request.BaseUrl).LeftChop(FCString::Strlen(FSurrealPilotWebSocketChannel::ChannelPath));
+	Sample.Route = Request.Endpoint;
+	Sample.Provider = Request.Provider;
+	Sample.ResponseCode = ResponseCode;
+	Sample.FirstByteSeconds = Request.FirstFrameSeconds;
+	Sample.TotalSeconds = FPlatformTime::Seconds() - Request.SentTime;
+	Sample.RequestBytes = Request.Body.Num();
+	Sample.ResponseBytes = Request.ResponseBytes;
+	if (Request.EventCount > 0)
+	{
+		Sample.EventCount = Request.EventCount;
+		Sample.FirstEventSeconds = Request.FirstEventSeconds;
+	}
+	
+	Metrics.Record(Sample);
+	
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	if (Settings && Settings->bEnableHttpDebugLogging)
+	{
+		UE_LOG(LogTemp, Log, TEXT("SurrealPilot HTTP: %s"), *Sample.ToString());
+	}
+}
+
+TSharedRef<const FHttpClient::FChannelCallbacks> FHttpClient::MakeJsonChannelCallbacks(FOnHttpResponse OnResponse, FOnHttpError OnError)
+{
+	TSharedRef<FChannelCallbacks> Callbacks = MakeShared<FChannelCallbacks>();
+	Callbacks->OnResponse = [OnResponse, OnError](TSharedPtr<FJsonObject> Response)
+	{
+		if (Response.IsValid())
+		{
+			OnResponse.ExecuteIfBound(Response);
+		}
+		else
+		{
+			OnError.ExecuteIfBound(TEXT("Failed to parse JSON response"));
+		}
+	};
+	Callbacks->OnFailure = [OnError](int32 ResponseCode, const FString& ResponseBody)
+	{
+		OnError.ExecuteIfBound(ResponseCode > 0 ?
+			FString::Printf(TEXT("HTTP Error %d: %s"), ResponseCode, *ResponseBody) :
+			TEXT("Request failed"));
+	};
+	return Callbacks;
+}
+
+void FHttpClient::RunAfterDelay(float DelaySeconds, TFunction<void()> Callback)
+{
+	const uint32 CallId = ++LastDelayedCallId;
+	FTSTicker::FDelegateHandle Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([this, CallId, Callback](float DeltaTime)
+	{
+		DelayedCalls.Remove(CallId);
+		Callback();
+		return false;
+	}), DelaySeconds);
+	DelayedCalls.Add(CallId, Handle);
+}
+
+TArray<uint8> FHttpClient::BuildChatRequestBody(
+	const TArray<TSharedPtr<FJsonObject>>& Messages,
+	const FString& Provider,
+	const TSharedPtr<const FSurrealPilotContextBlob>& Context,
+	const FString& ReferenceBaseUrl,
+	FContextUpload& Upload)
+{
+	// Size the buffer from the previous chat payload, which the next one usually resembles
+	FSurrealPilotJsonWriter Writer(LastChatBodySize + LastChatBodySize / 8);
+	
+	Writer.BeginObject();
+	Writer.WriteString(TEXT("provider"), Provider);
+	
+	Writer.BeginArray(TEXT("messages"));
+	for (const auto& Message : Messages)
+	{
+		Writer.WriteJsonObject(Message);
+	}
+	Writer.EndArray();
+	
+	// Add context if provided
+	if (Context.IsValid())
+	{
+		WriteContextField(Writer, TEXT("context"), *Context, ReferenceBaseUrl, Upload);
+	}
+	Writer.EndObject();
+	
+	LastChatBodySize = Writer.GetBuffer().Num();
+	return Writer.MoveBuffer();
+}
+
+TArray<uint8> FHttpClient::BuildContextRequestBody(const FString& ContextType, const FSurrealPilotContextBlob& ContextData, const FString& ReferenceBaseUrl, FContextUpload& Upload)
+{
+	FSurrealPilotJsonWriter Writer(LastContextBodySize + LastContextBodySize / 8);
+	
+	Writer.BeginObject();
+	Writer.WriteString(TEXT("type"), ContextType);
+	WriteContextField(Writer, TEXT("data"), ContextData, ReferenceBaseUrl, Upload);
+	Writer.EndObject();
+	
+	LastContextBodySize = Writer.GetBuffer().Num();
+	return Writer.MoveBuffer();
+}
+
+TArray<uint8> FHttpClient::BuildAssetContextBody(const FString& AssetPath, const FString& ContextType, const TSharedPtr<FJsonObject>& ContextData, const FSurrealPilotContextBlob& ContextBlob,
+	const FString& ReferenceBaseUrl, FContextUpload& Upload)
+{
+	FSurrealPilotJsonWriter Writer(LastContextBodySize + LastContextBodySize / 8);
+	
+	Writer.BeginObject();
+	Writer.WriteString(TEXT("type"), ContextType);
+	Writer.WriteString(TEXT("asset"), AssetPath);
+	Writer.WriteString(TEXT("version"), ContextBlob.Hash);
+	
+	// A delta only makes sense against a version this endpoint confirmed, and only if it is much smaller than the export
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	const FSurrealPilotContextVersions::FVersion* Acknowledged = !ReferenceBaseUrl.IsEmpty() && Settings && Settings->bEnableContextDeltas
+		? ContextVersions.Find(ReferenceBaseUrl, AssetPath)
+		: nullptr;
+	
+	TArray<uint8> DeltaJson;
+	if (Acknowledged)
+	{
+		FSurrealPilotJsonWriter DeltaWriter;
+		DeltaWriter.BeginArray();
+		for (const TSharedPtr<FJsonValue>& Operation : FSurrealPilotContextDelta::Diff(Acknowledged->Context, ContextData))
+		{
+			DeltaWriter.WriteJsonValue(Operation);
+		}
+		DeltaWriter.EndArray();
+		DeltaJson = DeltaWriter.MoveBuffer();
+	}
+	
+	if (Acknowledged && DeltaJson.Num() <= ContextBlob.Json.Num() * SurrealPilotHttpClient::MaxDeltaFraction)
+	{
+		Writer.WriteString(TEXT("base_version"), Acknowledged->Hash);
+		Writer.WriteRawValue(TEXT("patch"), DeltaJson);
+		Upload.bAssetDelta = true;
+		Upload.DeltaBytes = DeltaJson.Num();
+		Upload.AssetBytes = ContextBlob.Json.Num();
+	}
+	else
+	{
+		WriteContextField(Writer, TEXT("data"), ContextBlob, ReferenceBaseUrl, Upload);
+	}
+	Writer.EndObject();
+	
+	LastContextBodySize = Writer.GetBuffer().Num();
+	return Writer.MoveBuffer();
+}
+
+TArray<uint8> FHttpClient::BuildContextBatchBody(const TArray<FQueuedContext>& Items, const TArray<TSharedRef<const FSurrealPilotContextBlob>>& Blobs,
+	const FString& ReferenceBaseUrl, FContextUpload& Upload)
+{
+	FSurrealPilotJsonWriter Writer(LastContextBodySize + LastContextBodySize / 8);
+	
+	Writer.BeginObject();
+	Writer.WriteString(TEXT("type"), TEXT("batch"));
+	Writer.BeginArray(TEXT("items"));
+	for (int32 Index = 0; Index < Items.Num(); ++Index)
+	{
+		Writer.BeginObject();
+		Writer.WriteString(TEXT("type"), Items[Index].Type);
+		WriteContextField(Writer, TEXT("data"), *Blobs[Index], ReferenceBaseUrl, Upload);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+	
+	LastContextBodySize = Writer.GetBuffer().Num();
+	return Writer.MoveBuffer();
+}
+
+FSurrealPilotRequestHandle FHttpClient::TestConnection(FOnHttpResponse OnResponse, FOnHttpError OnError)
+{
+	// Connectivity probes report the first failure rather than retrying
+	TSharedRef<FRequestAttempt> Attempt = MakeShared<FRequestAttempt>();
+	Attempt->Verb = TEXT("GET");
+	Attempt->Endpoint = TEXT("/api/health");
+	Attempt->Priority = ESurrealPilotRequestPriority::HealthCheck;
+	Attempt->bAllowRetry = false;
+	Attempt->BaseUrl = GetApiBaseUrl();
+	Attempt->BindHandlers = [OnResponse, OnError](FHttpRequestPtr Request)
+	{
+		Request->OnProcessRequestComplete().BindLambda([OnResponse, OnError](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			if (bWasSuccessful && Response.IsValid() && Response->GetResponseCode() == 200)
+			{
+				TSharedPtr<FJsonObject> JsonResponse = MakeShareable(new FJsonObject);
+				JsonResponse->SetStringField(TEXT("status"), TEXT("connected"));
+				OnResponse.ExecuteIfBound(JsonResponse);
+			}
+			else
+			{
+				FString ErrorMessage = Response.IsValid() ? 
+					FString::Printf(TEXT("Connection test failed: %d"), Response->GetResponseCode()) :
+					TEXT("Connection test failed: No response");
+				OnError.ExecuteIfBound(ErrorMessage);
+			}
+		});
+	};
+	
+	FHttpRequestPtr Request = CreateRequest(Attempt->Verb, Attempt->Endpoint, Attempt->BaseUrl);
+	Attempt->BindHandlers(Request);
+	return StartAttempt(Attempt, Request);
+}
+
+void FHttpClient::SetBaseUrlOverride(const FString& BaseUrl)
+{
+	EndpointOverrides.Reset();
+	if (!BaseUrl.IsEmpty())
+	{
+		EndpointOverrides.Add(BaseUrl);
+	}
+}
+
+void FHttpClient::SetEndpointOverrides(const TArray<FString>& BaseUrls)
+{
+	EndpointOverrides = BaseUrls;
+}
+
+void FHttpClient::ProbeEndpoints()
+{
+	RefreshEndpoints();
+	
+	// With a single endpoint there is nothing to choose between, but one whose circuit has tripped is still probed
+	// so it recovers without waiting for a request to be let through
+	const TArray<FSurrealPilotEndpointStatus>& Endpoints = EndpointManager.GetEndpoints();
+	if (Endpoints.Num() == 0 || (Endpoints.Num() == 1 && CircuitBreaker.GetState(Endpoints[0].BaseUrl) == ESurrealPilotCircuitState::Closed))
+	{
+		return;
+	}
+	
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	const float ProbeTimeout = Settings ? Settings->EndpointProbeTimeoutSeconds : 2.0f;
+	
+	for (const FSurrealPilotEndpointStatus& Endpoint : Endpoints)
+	{
+		if (ActiveProbes.Contains(Endpoint.BaseUrl))
+		{
+			continue;
+		}
+		
+		// Probes skip the scheduler and circuit breaker: they measure the endpoint itself, and are how a tripped one recovers
+		FHttpRequestPtr Probe = CreateRequest(TEXT("GET"), TEXT("/api/health"), Endpoint.BaseUrl);
+		Probe->SetTimeout(ProbeTimeout);
+		
+		const FString BaseUrl = Endpoint.BaseUrl;
+		const double StartTime = FPlatformTime::Seconds();
+		Probe->OnProcessRequestComplete().BindLambda([this, BaseUrl, StartTime](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			ActiveProbes.Remove(BaseUrl);
+			
+			const bool bHealthy = bWasSuccessful && Response.IsValid() && EHttpResponseCodes::IsOk(Response->GetResponseCode());
+			EndpointManager.RecordProbe(BaseUrl, bHealthy, FPlatformTime::Seconds() - StartTime);
+			if (bHealthy)
+			{
+				// The HTTP module reports no connect timing; a health probe's round trip is the closest measure of it
+				Metrics.RecordProbe(BaseUrl, FPlatformTime::Seconds() - StartTime);
+				CircuitBreaker.RecordSuccess(BaseUrl);
+			}
+		});
+		
+		ActiveProbes.Add(BaseUrl, Probe);
+		Probe->ProcessRequest();
+	}
+}
+
+void FHttpClient::RefreshEndpoints()
+{
+	if (EndpointOverrides.Num() > 0)
+	{
+		EndpointManager.SetEndpoints(EndpointOverrides);
+		return;
+	}
+	
+	TArray<FString> BaseUrls;
+	
+	// Desktop first: the local config names the port the desktop app listens on
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	TSharedRef<const FSurrealPilotLocalConfigSnapshot> Config = FSurrealPilotLocalConfig::Get().GetSnapshot();
+	const int32 DesktopPort = Config->Port > 0 ? Config->Port : (Settings ? Settings->DesktopApiPort : 8000);
+	BaseUrls.Add(FString::Printf(TEXT("http://127.0.0.1:%d"), DesktopPort));
+	
+	// SaaS can only serve requests once an API key is configured
+	if (Settings && !Settings->SaaSApiUrl.IsEmpty() && !Config->ApiKey.IsEmpty())
+	{
+		FString SaaSUrl = Settings->SaaSApiUrl;
+		SaaSUrl.RemoveFromEnd(TEXT("/"));
+		BaseUrls.Add(SaaSUrl);
+	}
+	
+	EndpointManager.SetEndpoints(BaseUrls);
+}
+
+void FHttpClient::RecordEndpointResult(const FString& BaseUrl, int32 ResponseCode)
+{
+	// Unreachable or failing server-side counts against the endpoint; 429 means it is up but busy
+	if (ResponseCode == 0 || ResponseCode >= 500)
+	{
+		CircuitBreaker.RecordFailure(BaseUrl, FPlatformTime::Seconds());
+		EndpointManager.RecordFailure(BaseUrl);
+	}
+	else
+	{
+		CircuitBreaker.RecordSuccess(BaseUrl);
+		EndpointManager.RecordSuccess(BaseUrl);
+		
+		// The endpoint is back: deliver what piled up while it was away
+		ReplayContextJournal();
+	}
+}
+
+void FHttpClient::RecordAttemptMetrics(const FRequestAttempt& Attempt, FHttpRequestPtr Request, FHttpResponsePtr Response)
+{
+	FSurrealPilotRequestSample Sample;
+	Sample.Verb = Attempt.Verb;
+	Sample.BaseUrl = Attempt.BaseUrl;
+	Sample.Route = Attempt.Endpoint;
+	Sample.Provider = Attempt.Provider;
+	Sample.ResponseCode = Response.IsValid() ? Response->GetResponseCode() : 0;
+	Sample.FirstByteSeconds = Attempt.FirstByteSeconds;
+	Sample.TotalSeconds = Request->GetElapsedTime();
+	Sample.RequestBytes = Request->GetContentLength();
+	Sample.ResponseBytes = Response.IsValid() ? Response->GetContent().Num() : 0;
+	
+	if (Attempt.StreamState.IsValid() && Attempt.StreamState->EventCount > 0)
+	{
+		// Elapsed time is only known now, so work back from how long ago the first event arrived
+		Sample.EventCount = Attempt.StreamState->EventCount;
+		Sample.FirstEventSeconds = FMath::Max(0.0, Sample.TotalSeconds - (FPlatformTime::Seconds() - Attempt.StreamState->FirstEventTime));
+	}
+	
+	Metrics.Record(Sample);
+	
+	const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>();
+	if (Settings && Settings->bEnableHttpDebugLogging)
+	{
+		UE_LOG(LogTemp, Log, TEXT("SurrealPilot HTTP: %s"), *Sample.ToString());
+	}
+}
+
+void FHttpClient::SubmitRequest(ESurrealPilotRequestPriority Priority, FHttpRequestPtr Request)
+{
+	// Limits are read per request so settings changes apply without a restart
+	if (const USurrealPilotSettings* Settings = GetDefault<USurrealPilotSettings>())
+	{
+		Scheduler.SetMaxTotalInFlight(Settings->MaxConcurrentRequests);
+		Scheduler.SetMaxInFlight(ESurrealPilotRequestPriority::BackgroundContext, Settings->MaxConcurrentBackgroundRequests);
+	}
+	
+	Scheduler.Submit(Priority, Request);
+}
+
+FString FHttpClient::GetApiBaseUrl()
+{
+	RefreshEndpoints();
+	return EndpointManager.GetActiveEndpoint();
+}
+
+TMap<FString, FString> FHttpClient::GetAuthHeaders() const
+{
+	TMap<FString, FString> Headers;
+	
+	// API key comes from the cached local config snapshot, not from disk
+	TSharedRef<const FSurrealPilotLocalConfigSnapshot> Config = FSurrealPilotLocalConfig::Get().GetSnapshot();
+	if (!Config->AuthorizationHeader.IsEmpty())
+	{
+		Headers.Add(TEXT("Authorization"), Config->AuthorizationHeader);
+	}
+	
+	return Headers;
+}
+
+void FHttpClient::HandleStreamingResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, TSharedRef<FSSEStreamState> StreamState, FOnStreamingChunk OnChunk, FOnHttpError OnError,
+	TFunction<void()> OnStreamEnd)
+{
+	// A large body was left in flight for the worker below; any other outcome finishes it here
+	TSharedPtr<FSurrealPilotRequestState> State = StreamState->RequestState.Pin();
+	auto FinishIfInFlight = [&State](ESurrealPilotRequestStatus FinalStatus)
+	{
+		if (State.IsValid() && !State->IsFinished())
+		{
+			FSurrealPilotRequestHandle::Finish(*State, FinalStatus);
+		}
+	};
+	
+	if (!bWasSuccessful || !Response.IsValid())
+	{
+		ReportChatError(0, FString(), OnError);
+		return;
+	}
+	
+	if (Response->GetResponseCode() != 200)
+	{
+		FinishIfInFlight(ESurrealPilotRequestStatus::Failed);
+		ReportChatError(Response->GetResponseCode(), Response->GetContentAsString(), OnError);
+		return;
+	}
+	
+	// Parse whatever the progress callbacks have not already delivered
+	if (!SurrealPilotHttpClient::IsParsedOnWorker(Response, StreamState->ConsumedBytes))
+	{
+		FinishIfInFlight(ESurrealPilotRequestStatus::Succeeded);
+		ConsumeStreamedResponse(Response, *StreamState, true, OnChunk);
+		if (OnStreamEnd)
+		{
+			OnStreamEnd();
+		}
+		return;
+	}
+	
+	// A large remainder (streaming disabled, or a slow frame) is parsed on a worker and the events delivered together.
+	// No progress callback can touch the stream state once the request has completed.
+	// SendAttempt left the request in flight, so until the events are delivered it can be cancelled or time out.
+	AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [Response, StreamState, State, OnChunk, OnStreamEnd]()
+	{
+		TSharedRef<TArray<FString>> EventData = MakeShared<TArray<FString>>();
+		ConsumeStreamedResponse(Response, *StreamState, true, FOnStreamingChunk::CreateLambda([EventData](const FString& Data)
+		{
+			EventData->Add(Data);
+		}));
+		
+		AsyncTask(ENamedThreads::GameThread, [EventData, State, OnChunk, OnStreamEnd]()
+		{
+			for (const FString& Data : *EventData)
+			{
+				// A chunk handler may cancel the request part way through
+				if (State.IsValid() && State->IsFinished())
+				{
+					return;
+				}
+				OnChunk.ExecuteIfBound(Data);
+			}
+			if (State.IsValid())
+			{
+				if (State->IsFinished())
+				{
+					return;
+				}
+				FSurrealPilotRequestHandle::Finish(*State, ESurrealPilotRequestStatus::Succeeded);
+			}
+			if (OnStreamEnd)
+			{
+				OnStreamEnd();
+			}
+		});
+	});
+}
+
+void FHttpClient::ReportChatError(int32 ResponseCode, const FString& Body, const FOnHttpError& OnError)
+{
+	if (ResponseCode == 0)
+	{
+		FSurrealPilotErrorHandler::HandleHttpError(0, TEXT("Request failed"));
+		OnError.ExecuteIfBound(TEXT("Request failed"));
+		return;
+	}
+	
+	FSurrealPilotErrorHandler::HandleHttpError(ResponseCode, Body);
+	OnError.ExecuteIfBound(FString::Printf(TEXT("HTTP Error %d: %s"), ResponseCode, *Body));
+}
+
+void FHttpClient::ConsumeStreamedResponse(FHttpResponsePtr Response, FSSEStreamState& StreamState, bool bFinal, const FOnStreamingChunk& OnChunk)
+{
+	const TArray<uint8>& Content = Response->GetContent();
+	
+	// A large body parsed on a worker was not streamed, so only game-thread deliveries count towards stream timing
+	const bool bRecordTiming = IsInGameThread();
+	auto HandleEvent = [&OnChunk, &StreamState, bRecordTiming](const FSurrealPilotSSEEvent& Event)
+	{
+		if (!Event.Data.IsEmpty() && Event.Data != TEXT("[DONE]"))
+		{
+			if (bRecordTiming && StreamState.EventCount++ == 0)
+			{
+				StreamState.FirstEventTime = FPlatformTime::Seconds();
+			}
+			OnChunk.ExecuteIfBound(Event.Data);
+		}
+	};
+	
+	// Only the bytes that arrived since the previous read are parsed
+	if (Content.Num() > StreamState.ConsumedBytes)
+	{
+		StreamState.Parser.Feed(Content.GetData() + StreamState.ConsumedBytes, Content.Num() - StreamState.ConsumedBytes, HandleEvent);
+		StreamState.ConsumedBytes = Content.Num();
+	}
+	
+	if (bFinal)
+	{
+		StreamState.Parser.Finish(HandleEvent);
+	}
+}
+
+FHttpRequestPtr FHttpClient::CreateRequest(const FString& Verb, const FString& Endpoint, const FString& BaseUrl) const
+{
+	FHttpRequestPtr Request = HttpModule->CreateRequest();
+	Request->SetVerb(Verb);
+	Request->SetURL(BaseUrl + Endpoint);
+	
+	// Add authentication headers
+	TMap<FString, FString> AuthHeaders = GetAuthHeaders();
+	for (const auto& Header : AuthHeaders)
+	{
+		Request->SetHeader(Header.Key, Header.Value);
+	}
+	
+	// Add common headers
+	Request->SetHeader(TEXT("User-Agent"), TEXT("SurrealPilot-UE-Plugin/1.0"));
+	Request->SetHeader(TEXT("Accept"), TEXT("text/event-stream, application/json"));
+	
+	return Request;
+}
+
+static FAutoConsoleCommand HttpStatsCommand(
+	TEXT("SurrealPilot.HttpStats"),
+	TEXT("Print SurrealPilot HTTP latency and throughput per endpoint, route and provider; 'SurrealPilot.HttpStats reset' clears them"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (!FHttpClient::IsAvailable())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SurrealPilot HTTP client is not initialized"));
+			return;
+		}
+		
+		if (Args.Num() > 0 && Args[0].Equals(TEXT("reset"), ESearchCase::IgnoreCase))
+		{
+			FHttpClient::Get().ResetMetrics();
+			UE_LOG(LogTemp, Log, TEXT("SurrealPilot HTTP metrics reset"));
+			return;
+		}
+		
+		TArray<FString> Lines;
+		FHttpClient::Get().GetMetrics().ToReport().ParseIntoArrayLines(Lines);
+		for (const FString& Line : Lines)
+		{
+			UE_LOG(LogTemp, Display, TEXT("%s"), *Line);
+		}
+		
+		const FSurrealPilotContextDedupStats& Dedup = FHttpClient::Get().GetContextDedupStats();
+		UE_LOG(LogTemp, Display, TEXT("Context dedup: %d by reference, %d uploaded, %d misses, %lld bytes saved, %lld bytes uploaded"),
+			Dedup.References, Dedup.Uploads, Dedup.Misses, Dedup.BytesSaved, Dedup.BytesUploaded);
+		const FSurrealPilotContextDeltaStats& Delta = FHttpClient::Get().GetContextDeltaStats();
+		UE_LOG(LogTemp, Display, TEXT("Context deltas: %d deltas (%lld bytes for %lld of exports), %d full uploads, %d divergences"),
+			Delta.Deltas, Delta.DeltaBytes, Delta.FullBytesReplaced, Delta.FullUploads, Delta.Divergences);
+		const FSurrealPilotTokenBudgetStats& Tokens = FHttpClient::Get().GetTokenBudgetStats();
+		UE_LOG(LogTemp, Display, TEXT("Context tokens: %lld sent, %lld trimmed from %d of %d chat requests"),
+			Tokens.TokensUsed, Tokens.TokensDropped, Tokens.TrimmedRequests, Tokens.Requests);
+		if (Tokens.Requests > 0)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Last chat context: %s"), *FHttpClient::Get().GetLastTokenBudgetReport().ToString());
+		}
+		const FSurrealPilotWebSocketChannel& Channel = FHttpClient::Get().GetChannel();
+		if (Channel.GetState() != ESurrealPilotChannelState::Closed)
+		{
+			const FSurrealPilotChannelStats& ChannelStats = Channel.GetStats();
+			UE_LOG(LogTemp, Display, TEXT("Channel: %s, %d requests (%d lost, %d sent over HTTP instead), %d pushes, %d connects, %d disconnects, %d failed connects"),
+				Channel.IsConnected() ? TEXT("connected") : TEXT("reconnecting"), ChannelStats.Requests, ChannelStats.RequestsLost, ChannelStats.HttpFallbacks,
+				ChannelStats.Pushes, ChannelStats.Connects, ChannelStats.Disconnects, ChannelStats.FailedConnects);
+		}
+		const FSurrealPilotResponseCacheStats& Cache = FHttpClient::Get().GetResponseCache().GetStats();
+		if (Cache.Lookups > 0)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Response cache: %.1f%% hit rate (%d memory hits, %d disk hits, %d lookups, %d expired), %.1f s of provider latency saved, %d stored, %d evicted"),
+				Cache.GetHitRate() * 100.0, Cache.MemoryHits, Cache.DiskHits, Cache.Lookups, Cache.Expired, Cache.SavedSeconds, Cache.Stores, Cache.Evictions);
+		}
+		const FSurrealPilotContextJournal& Journal = FHttpClient::Get().GetContextJournal();
+		if (Journal.IsOpen())
+		{
+			const FSurrealPilotJournalStats& JournalStats = Journal.GetStats();
+			UE_LOG(LogTemp, Display, TEXT("Context journal: %d waiting, %d journaled (%d superseded, %d dropped), %d delivered, %d disk writes (%lld bytes), %d compactions"),
+				Journal.Num(), JournalStats.Appended, JournalStats.Superseded, JournalStats.Dropped, JournalStats.Delivered,
+				JournalStats.DiskWrites, JournalStats.BytesWritten, JournalStats.Compactions);
+		}
+	})
+);
\ No newline at end of file
@@ -1,312 +1,2131 @@
 #include "HttpClient.h"
 #include "SurrealPilotErrorHandler.h"
 #include "SurrealPilotSettings.h"
+#include "SurrealPilotLocalConfig.h"
+#include "SurrealPilotCompression.h"
+#include "SurrealPilotCompactBinary.h"
+#include "SurrealPilotStandInServer.h"
+#include "SurrealPilotChatJobs.h"
+#include "RemoteControlIntegration.h"
+#include "HttpManager.h"
+#include "HttpModule.h"
+#include "HAL/FileManager.h"
 #include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Serialization/JsonSerializer.h"
 #include "Engine/Engine.h"
 
 #if WITH_DEV_AUTOMATION_TESTS
 
+namespace SurrealPilotHttpTest
+{
+    /** Run one frame's worth of game-thread work: HTTP completions, tickers and tasks marshalled back from workers */
+    void TickGameThread()
+    {
+        FHttpModule::Get().GetHttpManager().Tick(0.01f);
+        FTSTicker::GetCoreTicker().Tick(0.01f);
+        FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+    }
+
+    /** Tick the game thread until the condition holds or the timeout elapses */
+    bool WaitFor(TFunctionRef<bool()> Condition, double TimeoutSeconds)
+    {
+        const double Deadline = FPlatformTime::Seconds() + TimeoutSeconds;
+        while (!Condition())
+        {
+            if (FPlatformTime::Seconds() > Deadline)
+            {
+                return false;
+            }
+            TickGameThread();
+            FPlatformProcess::Sleep(0.01f);
+        }
+        return true;
+    }
+}
+
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientTest, "SurrealPilot.HttpClient.BasicFunctionality", 
     EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
 
-bool FHttpClientTest::RunTest(const FString& Parameters)
+bool FHttpClientTest::RunTest(const FString& Parameters)
+{
+    TestTrue("HttpClient should be initialized", FHttpClient::IsAvailable());
+    if (!FHttpClient::IsAvailable())
+    {
+        return false;
+    }
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+
+    // Test URL construction
+    const FString DefaultUrl = HttpClient.GetApiBaseUrl();
+    TestTrue("Base URL should not be empty", !DefaultUrl.IsEmpty());
+    TestTrue("Base URL should be valid format", DefaultUrl.StartsWith(TEXT("http")));
+
+    // An override replaces the configured endpoints until it is cleared
+    HttpClient.SetBaseUrlOverride(TEXT("http://127.0.0.1:9"));
+    TestEqual("Override should be used", HttpClient.GetApiBaseUrl(), FString(TEXT("http://127.0.0.1:9")));
+    HttpClient.SetBaseUrlOverride(FString());
+    TestEqual("Clearing the override should restore the default", HttpClient.GetApiBaseUrl(), DefaultUrl);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientRequestTest, "SurrealPilot.HttpClient.RequestConstruction", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientRequestTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    TArray<FString> Events;
+    Events.Add(TEXT("{\"content\":\"ok\"}"));
+    Server.SetChatEvents(Events, 0.0f);
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    // Test chat request construction
+    TArray<TSharedPtr<FJsonObject>> Messages;
+    for (const TCHAR* Content : { TEXT("Hello, I need help with my Blueprint"), TEXT("Can you help me fix this error?") })
+    {
+        TSharedPtr<FJsonObject> Message = MakeShareable(new FJsonObject);
+        Message->SetStringField(TEXT("role"), TEXT("user"));
+        Message->SetStringField(TEXT("content"), Content);
+        Messages.Add(Message);
+    }
+
+    TSharedPtr<FJsonObject> Context = MakeShareable(new FJsonObject);
+    Context->SetStringField(TEXT("blueprint"), TEXT("TestBlueprint"));
+    Context->SetStringField(TEXT("selection"), TEXT("VariableNode"));
+
+    TSharedRef<bool> bDelivered = MakeShared<bool>(false);
+    HttpClient.SendChatRequest(Messages, TEXT("anthropic"), Context,
+        FOnStreamingChunk::CreateLambda([bDelivered](const FString& Chunk) { *bDelivered = true; }),
+        FOnHttpError::CreateLambda([bDelivered](const FString& Error) { *bDelivered = true; }));
+
+    const bool bCompleted = SurrealPilotHttpTest::WaitFor([bDelivered]() { return *bDelivered; }, 10.0);
+
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    TestTrue("Chat request should reach the server", bCompleted);
+
+    // The server decodes any Content-Encoding, so this is the JSON the client built
+    const TArray<uint8> Body = Server.GetLastRequestBody();
+    const FString RequestJson(Body.Num(), reinterpret_cast<const UTF8CHAR*>(Body.GetData()));
+    TSharedPtr<FJsonObject> Request;
+    if (!TestTrue("Request should be valid JSON", FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(RequestJson), Request) && Request.IsValid()))
+    {
+        return false;
+    }
+
+    TestEqual("Request should contain every message", Request->GetArrayField(TEXT("messages")).Num(), Messages.Num());
+    TestEqual("Request should contain provider", Request->GetStringField(TEXT("provider")), FString(TEXT("anthropic")));
+    TestTrue("Request should contain context", Request->HasTypedField<EJson::Object>(TEXT("context")));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientErrorHandlingTest, "SurrealPilot.HttpClient.ErrorHandling", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientErrorHandlingTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    // Neither status is retryable, so each reaches the caller on the first attempt
+    Server.SetScriptedFailures(TEXT("/api/chat"), { 401 });
+    Server.SetScriptedFailures(TEXT("/api/context"), { 402 });
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    TSharedRef<FString> ChatError = MakeShared<FString>();
+    TSharedRef<FString> ContextError = MakeShared<FString>();
+
+    TArray<TSharedPtr<FJsonObject>> Messages;
+    TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+    UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+    UserMessage->SetStringField(TEXT("content"), TEXT("Hello"));
+    Messages.Add(UserMessage);
+
+    HttpClient.SendChatRequest(Messages, TEXT("openai"), nullptr, FOnStreamingChunk(),
+        FOnHttpError::CreateLambda([ChatError](const FString& Error) { *ChatError = Error; }));
+
+    TSharedPtr<FJsonObject> Export = MakeShareable(new FJsonObject);
+    Export->SetStringField(TEXT("name"), TEXT("BP_Door"));
+    HttpClient.SendContextRequest(TEXT("blueprint"), Export, FOnHttpResponse(),
+        FOnHttpError::CreateLambda([ContextError](const FString& Error) { *ContextError = Error; }));
+
+    const bool bCompleted = SurrealPilotHttpTest::WaitFor([ChatError, ContextError]()
+    {
+        return !ChatError->IsEmpty() && !ContextError->IsEmpty();
+    }, 10.0);
+
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    TestTrue("Both requests should fail before the timeout", bCompleted);
+    TestTrue(FString::Printf(TEXT("Chat error should carry the status (%s)"), **ChatError), ChatError->Contains(TEXT("401")));
+    TestTrue(FString::Printf(TEXT("Context error should carry the status (%s)"), **ContextError), ContextError->Contains(TEXT("402")));
+    TestEqual("Non-retryable failures should not be retried", Server.GetRequestCount(), 2);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientIncrementalStreamingTest, "SurrealPilot.HttpClient.IncrementalStreaming", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientIncrementalStreamingTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    // Space the events out so the whole response takes well over a second to complete
+    TArray<FString> Events;
+    Events.Add(TEXT("{\"content\":\"Hello\"}"));
+    Events.Add(TEXT("{\"content\":\" from\"}"));
+    Events.Add(TEXT("{\"content\":\" SurrealPilot\"}"));
+    Server.SetChatEvents(Events, 0.5f);
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    // Shared state so late callbacks stay safe if the test times out
+    struct FStreamResult
+    {
+        TArray<FString> Chunks;
+        int32 EventsSentAtFirstChunk = INDEX_NONE;
+        FString Error;
+    };
+    TSharedRef<FStreamResult> Result = MakeShared<FStreamResult>();
+
+    TArray<TSharedPtr<FJsonObject>> Messages;
+    TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+    UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+    UserMessage->SetStringField(TEXT("content"), TEXT("Stream a short greeting"));
+    Messages.Add(UserMessage);
+
+    FSurrealPilotStandInServer* ServerPtr = &Server;
+    HttpClient.SendChatRequest(
+        Messages,
+        TEXT("openai"),
+        nullptr,
+        FOnStreamingChunk::CreateLambda([Result, ServerPtr](const FString& Chunk)
+        {
+            if (Result->Chunks.Num() == 0)
+            {
+                Result->EventsSentAtFirstChunk = ServerPtr->GetEventsSent();
+            }
+            Result->Chunks.Add(Chunk);
+        }),
+        FOnHttpError::CreateLambda([Result](const FString& Error)
+        {
+            Result->Error = Error;
+        })
+    );
+
+    const int32 ExpectedChunks = Events.Num();
+    const bool bCompleted = SurrealPilotHttpTest::WaitFor([Result, ExpectedChunks]()
+    {
+        return !Result->Error.IsEmpty() || Result->Chunks.Num() >= ExpectedChunks;
+    }, 10.0);
+
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    TestTrue("Stream should complete before the timeout", bCompleted);
+    TestTrue(FString::Printf(TEXT("Stream should not fail (%s)"), *Result->Error), Result->Error.IsEmpty());
+    TestEqual("Every scripted event should be delivered", Result->Chunks.Num(), ExpectedChunks);
+    TestTrue("First chunk should arrive before the server finished writing the stream",
+        Result->EventsSentAtFirstChunk != INDEX_NONE && Result->EventsSentAtFirstChunk < ExpectedChunks);
+
+    if (Result->Chunks.Num() == ExpectedChunks)
+    {
+        TestEqual("Chunks should arrive in order", Result->Chunks[0], Events[0]);
+        TestEqual("Last chunk should match the script", Result->Chunks.Last(), Events.Last());
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientConfigCachingTest, "SurrealPilot.HttpClient.ConfigCaching", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientConfigCachingTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    FSurrealPilotLocalConfig& LocalConfig = FSurrealPilotLocalConfig::Get();
+
+    // Warm the snapshot, then every request should be served from memory
+    LocalConfig.GetSnapshot();
+    const int32 ReadsBefore = LocalConfig.GetFileReadCount();
+
+    // Requests go to the stand-in server; the API key still comes from the local config
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    const int32 RequestCount = 50;
+    TSharedRef<int32> Completed = MakeShared<int32>(0);
+    for (int32 Index = 0; Index < RequestCount; ++Index)
+    {
+        HttpClient.TestConnection(
+            FOnHttpResponse::CreateLambda([Completed](TSharedPtr<FJsonObject> Response) { ++(*Completed); }),
+            FOnHttpError::CreateLambda([Completed](const FString& Error) { ++(*Completed); })
+        );
+    }
+
+    SurrealPilotHttpTest::WaitFor([Completed, RequestCount]() { return *Completed >= RequestCount; }, 10.0);
+
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    TestEqual("All requests should complete", *Completed, RequestCount);
+    TestEqual("Steady-state requests should not read the config file", LocalConfig.GetFileReadCount(), ReadsBefore);
+
+    // An explicit invalidation (as the directory watcher does on change) re-reads exactly once
+    LocalConfig.Invalidate();
+    LocalConfig.GetSnapshot();
+    LocalConfig.GetSnapshot();
+    TestEqual("Invalidation should trigger a single reload", LocalConfig.GetFileReadCount(), ReadsBefore + 1);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientCompressionFallbackTest, "SurrealPilot.HttpClient.CompressionFallback", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientCompressionFallbackTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const ESurrealPilotRequestCompression PreviousCompression = Settings->RequestCompression;
+    const int32 PreviousMinBytes = Settings->MinCompressedBodyBytes;
+    const bool bPreviousDedup = Settings->bEnableContextDedup;
+    Settings->RequestCompression = ESurrealPilotRequestCompression::DeflateDictionary;
+    Settings->MinCompressedBodyBytes = 0;
+
+    // The same context is sent three times; keep it inline so every request carries a compressible body
+    Settings->bEnableContextDedup = false;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+    FSurrealPilotCompression::ResetStats();
+
+    TSharedPtr<FJsonObject> ContextData = MakeShareable(new FJsonObject);
+    TArray<TSharedPtr<FJsonValue>> Nodes;
+    for (int32 Index = 0; Index < 50; ++Index)
+    {
+        TSharedPtr<FJsonObject> Node = MakeShareable(new FJsonObject);
+        Node->SetStringField(TEXT("name"), FString::Printf(TEXT("K2Node_CallFunction_%d"), Index));
+        Node->SetStringField(TEXT("class"), TEXT("K2Node_CallFunction"));
+        Nodes.Add(MakeShareable(new FJsonValueObject(Node)));
+    }
+    ContextData->SetArrayField(TEXT("nodes"), Nodes);
+
+    TSharedRef<int32> Succeeded = MakeShared<int32>(0);
+    TSharedRef<int32> Failed = MakeShared<int32>(0);
+    auto SendContext = [&HttpClient, ContextData, Succeeded, Failed]()
+    {
+        HttpClient.SendContextRequest(TEXT("blueprint"), ContextData,
+            FOnHttpResponse::CreateLambda([Succeeded](TSharedPtr<FJsonObject> Response) { ++(*Succeeded); }),
+            FOnHttpError::CreateLambda([Failed](const FString& Error) { ++(*Failed); }));
+    };
+
+    // Accepting server: the body arrives compressed and decodes to the original JSON
+    SendContext();
+    SurrealPilotHttpTest::WaitFor([Succeeded, Failed]() { return *Succeeded + *Failed >= 1; }, 10.0);
+    TestEqual("Compressed upload should succeed", *Succeeded, 1);
+    TestEqual("Body should be sent with deflate encoding", Server.GetLastContentEncoding(), FString(TEXT("deflate")));
+
+    const TArray<uint8> DecodedBody = Server.GetLastRequestBody();
+    FUTF8ToTCHAR DecodedText(reinterpret_cast<const ANSICHAR*>(DecodedBody.GetData()), DecodedBody.Num());
+    TSharedPtr<FJsonObject> Received;
+    FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(DecodedText.Length(), DecodedText.Get())), Received);
+    TestTrue("Decoded body should contain the context data",
+        Received.IsValid() && Received->HasField(TEXT("data")) && Received->GetObjectField(TEXT("data"))->GetArrayField(TEXT("nodes")).Num() == Nodes.Num());
+
+    // Rejecting server: 415, then the same body is resent uncompressed and later requests skip compression
+    Server.SetAcceptsCompressedBodies(false);
+    const int32 RequestsBefore = Server.GetRequestCount();
+    SendContext();
+    SurrealPilotHttpTest::WaitFor([Succeeded, Failed]() { return *Succeeded + *Failed >= 2; }, 10.0);
+    TestEqual("Upload should succeed after falling back", *Succeeded, 2);
+    TestEqual("Fallback should cost exactly one extra request", Server.GetRequestCount() - RequestsBefore, 2);
+    TestTrue("Resent body should be uncompressed", Server.GetLastContentEncoding().IsEmpty());
+
+    SendContext();
+    SurrealPilotHttpTest::WaitFor([Succeeded, Failed]() { return *Succeeded + *Failed >= 3; }, 10.0);
+    TestEqual("Later uploads should go straight through uncompressed", Server.GetRequestCount() - RequestsBefore, 3);
+
+    const FSurrealPilotCompressionStats Stats = FSurrealPilotCompression::GetStats();
+    TestEqual("One fallback should be recorded", Stats.Fallbacks, 1);
+    TestEqual("Only the bodies sent compressed should be counted", Stats.CompressedRequests, 2);
+    TestTrue("Compression ratio should be reported", Stats.GetRatio() > 1.0);
+    AddInfo(FString::Printf(TEXT("Compression ratio %.2f, %.3f ms CPU"), Stats.GetRatio(), Stats.CompressSeconds * 1000.0));
+
+    Settings->RequestCompression = PreviousCompression;
+    Settings->MinCompressedBodyBytes = PreviousMinBytes;
+    Settings->bEnableContextDedup = bPreviousDedup;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientCompactBinaryTest, "SurrealPilot.HttpClient.CompactBinaryNegotiation", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientCompactBinaryTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const ESurrealPilotContextEncoding PreviousEncoding = Settings->ContextEncoding;
+    Settings->ContextEncoding = ESurrealPilotContextEncoding::CompactBinary;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    TSharedPtr<FJsonObject> ContextData = MakeShareable(new FJsonObject);
+    TArray<TSharedPtr<FJsonValue>> Nodes;
+    for (int32 Index = 0; Index < 50; ++Index)
+    {
+        TSharedPtr<FJsonObject> Node = MakeShareable(new FJsonObject);
+        Node->SetStringField(TEXT("name"), FString::Printf(TEXT("K2Node_CallFunction_%d"), Index));
+        Node->SetNumberField(TEXT("posX"), Index * 240);
+        Nodes.Add(MakeShareable(new FJsonValueObject(Node)));
+    }
+    ContextData->SetArrayField(TEXT("nodes"), Nodes);
+
+    TSharedRef<int32> Succeeded = MakeShared<int32>(0);
+    TSharedRef<int32> Failed = MakeShared<int32>(0);
+    auto SendContext = [&HttpClient, ContextData, Succeeded, Failed]()
+    {
+        HttpClient.SendContextRequest(TEXT("blueprint"), ContextData,
+            FOnHttpResponse::CreateLambda([Succeeded](TSharedPtr<FJsonObject> Response) { ++(*Succeeded); }),
+            FOnHttpError::CreateLambda([Failed](const FString& Error) { ++(*Failed); }));
+    };
+
+    // Accepting server: the body arrives as Compact Binary and decodes to the request
+    SendContext();
+    SurrealPilotHttpTest::WaitFor([Succeeded, Failed]() { return *Succeeded + *Failed >= 1; }, 10.0);
+    TestEqual("Compact Binary upload should succeed", *Succeeded, 1);
+    TestTrue("Body should be sent as Compact Binary", Server.GetLastContentType().StartsWith(FSurrealPilotCompactBinary::GetContentType()));
+
+    TSharedPtr<FJsonObject> Received = FSurrealPilotCompactBinary::Decode(Server.GetLastRequestBody());
+    TestTrue("Decoded body should contain the context data",
+        Received.IsValid() && Received->GetStringField(TEXT("type")) == TEXT("blueprint") &&
+        Received->GetObjectField(TEXT("data"))->GetArrayField(TEXT("nodes")).Num() == Nodes.Num());
+
+    // A key Compact Binary cannot name: the context goes as JSON in the first request
+    TSharedPtr<FJsonObject> UnnamedData = MakeShareable(new FJsonObject);
+    UnnamedData->SetStringField(FString(), TEXT("unnamed"));
+    const int32 RequestsBeforeUnnamed = Server.GetRequestCount();
+    HttpClient.SendContextRequest(TEXT("blueprint"), UnnamedData,
+        FOnHttpResponse::CreateLambda([Succeeded](TSharedPtr<FJsonObject> Response) { ++(*Succeeded); }),
+        FOnHttpError::CreateLambda([Failed](const FString& Error) { ++(*Failed); }));
+    SurrealPilotHttpTest::WaitFor([Succeeded, Failed]() { return *Succeeded + *Failed >= 2; }, 10.0);
+    TestEqual("Context with an empty key should be uploaded", *Succeeded, 2);
+    TestEqual("Context with an empty key should take one request", Server.GetRequestCount() - RequestsBeforeUnnamed, 1);
+    TestTrue("Context with an empty key should be sent as JSON", Server.GetLastContentType().StartsWith(TEXT("application/json")));
+
+    // Rejecting server: 415, then the same context is resent as JSON and later requests go as JSON straight away
+    Server.SetAcceptsCompactBinary(false);
+    const int32 RequestsBefore = Server.GetRequestCount();
+    SendContext();
+    SurrealPilotHttpTest::WaitFor([Succeeded, Failed]() { return *Succeeded + *Failed >= 3; }, 10.0);
+    TestEqual("Upload should succeed after falling back", *Succeeded, 3);
+    TestEqual("Fallback should cost exactly one extra request", Server.GetRequestCount() - RequestsBefore, 2);
+    TestTrue("Resent body should be JSON", Server.GetLastContentType().StartsWith(TEXT("application/json")));
+
+    SendContext();
+    SurrealPilotHttpTest::WaitFor([Succeeded, Failed]() { return *Succeeded + *Failed >= 4; }, 10.0);
+    TestEqual("Later uploads should go straight through as JSON", Server.GetRequestCount() - RequestsBefore, 3);
+    TestEqual("No upload should fail", *Failed, 0);
+
+    Settings->ContextEncoding = PreviousEncoding;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientContextBatchingTest, "SurrealPilot.HttpClient.ContextBatching", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientContextBatchingTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const bool bPreviousBatching = Settings->bBatchContextUploads;
+    const float PreviousWindow = Settings->ContextBatchWindowSeconds;
+    const int32 PreviousMaxItems = Settings->ContextBatchMaxItems;
+    Settings->bBatchContextUploads = true;
+    Settings->ContextBatchWindowSeconds = 0.1f;
+    Settings->ContextBatchMaxItems = 50;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    const int32 NotificationCount = 1000;
+    auto SendPropertyChanges = [&HttpClient](int32 DistinctProperties)
+    {
+        for (int32 Index = 0; Index < NotificationCount; ++Index)
+        {
+            const FString PropertyPath = FString::Printf(TEXT("/Game/Maps/Main.Main:PersistentLevel.PointLight_%d.Intensity"), Index % DistinctProperties);
+            TSharedPtr<FJsonObject> Notification = MakeShareable(new FJsonObject);
+            Notification->SetStringField(TEXT("type"), TEXT("property_changed"));
+            Notification->SetStringField(TEXT("property_path"), PropertyPath);
+            Notification->SetStringField(TEXT("new_value"), FString::FromInt(Index));
+            HttpClient.QueueContext(TEXT("notification"), Notification, TEXT("property_changed:") + PropertyPath);
+        }
+    };
+
+    // Dragging a slider on 20 lights: every change supersedes the previous one for that light
+    FSurrealPilotContextBatchStats Before = HttpClient.GetContextBatchStats();
+    int32 ServerRequestsBefore = Server.GetRequestCount();
+    SendPropertyChanges(20);
+    SurrealPilotHttpTest::WaitFor([&HttpClient, &Server, Before, ServerRequestsBefore]()
+    {
+        const FSurrealPilotContextBatchStats& Stats = HttpClient.GetContextBatchStats();
+        return Stats.Sent + Stats.Superseded - Before.Sent - Before.Superseded >= NotificationCount &&
+            Server.GetRequestCount() - ServerRequestsBefore >= Stats.Requests - Before.Requests;
+    }, 10.0);
+
+    const int32 DragRequests = Server.GetRequestCount() - ServerRequestsBefore;
+    TestEqual("Superseded changes should collapse into one batch", DragRequests, 1);
+    TestEqual("Only the latest change per property should be kept", HttpClient.GetContextBatchStats().Superseded - Before.Superseded, NotificationCount - 20);
+
+    const TArray<uint8> BatchBody = Server.GetLastRequestBody();
+    FUTF8ToTCHAR BatchText(reinterpret_cast<const ANSICHAR*>(BatchBody.GetData()), BatchBody.Num());
+    TSharedPtr<FJsonObject> Batch;
+    FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(BatchText.Length(), BatchText.Get())), Batch);
+    const TArray<TSharedPtr<FJsonValue>>* Items = nullptr;
+    if (TestTrue("Batch body should carry an items array", Batch.IsValid() && Batch->TryGetArrayField(TEXT("items"), Items)))
+    {
+        TestEqual("Batch should hold one entry per property", Items->Num(), 20);
+        for (const TSharedPtr<FJsonValue>& Item : *Items)
+        {
+            const int32 Value = FCString::Atoi(*Item->AsObject()->GetObjectField(TEXT("data"))->GetStringField(TEXT("new_value")));
+            TestTrue("Each property should carry its final value", Value >= NotificationCount - 20);
+        }
+    }
+
+    // Touching 1000 different properties: nothing is superseded, so the size threshold drives batching
+    Before = HttpClient.GetContextBatchStats();
+    ServerRequestsBefore = Server.GetRequestCount();
+    SendPropertyChanges(NotificationCount);
+    SurrealPilotHttpTest::WaitFor([&HttpClient, &Server, Before, ServerRequestsBefore]()
+    {
+        const FSurrealPilotContextBatchStats& Stats = HttpClient.GetContextBatchStats();
+        return Stats.Sent - Before.Sent >= NotificationCount &&
+            Server.GetRequestCount() - ServerRequestsBefore >= Stats.Requests - Before.Requests;
+    }, 10.0);
+
+    const int32 BulkRequests = Server.GetRequestCount() - ServerRequestsBefore;
+    TestEqual("Distinct changes should be sent in full batches", BulkRequests, NotificationCount / Settings->ContextBatchMaxItems);
+
+    AddInfo(FString::Printf(TEXT("%d property changes on 20 properties: %d request(s) instead of %d"), NotificationCount, DragRequests, NotificationCount));
+    AddInfo(FString::Printf(TEXT("%d property changes on distinct properties: %d request(s) instead of %d"), NotificationCount, BulkRequests, NotificationCount));
+
+    Settings->bBatchContextUploads = bPreviousBatching;
+    Settings->ContextBatchWindowSeconds = PreviousWindow;
+    Settings->ContextBatchMaxItems = PreviousMaxItems;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientPrioritySchedulingTest, "SurrealPilot.HttpClient.PriorityScheduling", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientPrioritySchedulingTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    TArray<FString> Events;
+    Events.Add(TEXT("{\"content\":\"Sure\"}"));
+    Events.Add(TEXT("{\"content\":\" thing\"}"));
+    Server.SetChatEvents(Events, 0.0f);
+
+    // Every context upload holds its connection for half a second, like a large export on a slow link
+    Server.SetContextResponseDelay(0.5f);
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const int32 PreviousMaxRequests = Settings->MaxConcurrentRequests;
+    const int32 PreviousMaxBackground = Settings->MaxConcurrentBackgroundRequests;
+    Settings->MaxConcurrentRequests = 6;
+    Settings->MaxConcurrentBackgroundRequests = 2;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    TArray<TSharedPtr<FJsonObject>> Messages;
+    TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+    UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+    UserMessage->SetStringField(TEXT("content"), TEXT("Why does my door not open?"));
+    Messages.Add(UserMessage);
+
+    // Seconds from sending a chat request until its last chunk arrives
+    auto MeasureChatLatency = [&HttpClient, &Messages, &Events]() -> double
+    {
+        TSharedRef<int32> Chunks = MakeShared<int32>(0);
+        const double Start = FPlatformTime::Seconds();
+        HttpClient.SendChatRequest(Messages, TEXT("openai"), nullptr,
+            FOnStreamingChunk::CreateLambda([Chunks](const FString& Chunk) { ++(*Chunks); }),
+            FOnHttpError::CreateLambda([Chunks](const FString& Error) { *Chunks = MAX_int32; }));
+        const int32 ExpectedChunks = Events.Num();
+        SurrealPilotHttpTest::WaitFor([Chunks, ExpectedChunks]() { return *Chunks >= ExpectedChunks; }, 10.0);
+        return *Chunks == ExpectedChunks ? FPlatformTime::Seconds() - Start : -1.0;
+    };
+
+    const double IdleLatency = MeasureChatLatency();
+
+    // Saturate the background class, then ask a question while the uploads are queued
+    const int32 BackgroundCount = 30;
+    TSharedRef<int32> BackgroundDone = MakeShared<int32>(0);
+    for (int32 Index = 0; Index < BackgroundCount; ++Index)
+    {
+        TSharedPtr<FJsonObject> Export = MakeShareable(new FJsonObject);
+        Export->SetNumberField(TEXT("index"), Index);
+        HttpClient.SendContextRequest(TEXT("blueprint"), Export,
+            FOnHttpResponse::CreateLambda([BackgroundDone](TSharedPtr<FJsonObject> Response) { ++(*BackgroundDone); }),
+            FOnHttpError::CreateLambda([BackgroundDone](const FString& Error) { ++(*BackgroundDone); }));
+    }
+
+    const FSurrealPilotRequestScheduler& Scheduler = HttpClient.GetScheduler();
+    const FSurrealPilotSchedulerClassStats ChatBefore = Scheduler.GetStats(ESurrealPilotRequestPriority::InteractiveChat);
+    TestTrue("Background uploads should be queued behind the class limit",
+        Scheduler.GetStats(ESurrealPilotRequestPriority::BackgroundContext).Queued >= BackgroundCount - Settings->MaxConcurrentBackgroundRequests);
+
+    const double LoadedLatency = MeasureChatLatency();
+    const int32 BackgroundDoneAtChat = *BackgroundDone;
+    const FSurrealPilotSchedulerClassStats ChatAfter = Scheduler.GetStats(ESurrealPilotRequestPriority::InteractiveChat);
+
+    SurrealPilotHttpTest::WaitFor([BackgroundDone, BackgroundCount]() { return *BackgroundDone >= BackgroundCount; }, 20.0);
+    const FSurrealPilotSchedulerClassStats Background = Scheduler.GetStats(ESurrealPilotRequestPriority::BackgroundContext);
+
+    TestTrue("Chat should complete without background load", IdleLatency >= 0.0);
+    TestTrue("Chat should complete under background load", LoadedLatency >= 0.0);
+    TestTrue("Chat should not wait for a slot", ChatAfter.TotalWaitSeconds - ChatBefore.TotalWaitSeconds < 0.05);
+    TestTrue("Chat should finish long before the background uploads", BackgroundDoneAtChat < BackgroundCount / 2);
+    TestTrue("Background uploads should never exceed their concurrency cap",
+        Server.GetPeakConcurrentContextRequests() <= Settings->MaxConcurrentBackgroundRequests);
+    TestEqual("Every background upload should complete", *BackgroundDone, BackgroundCount);
+
+    AddInfo(FString::Printf(TEXT("Chat latency idle %.1f ms, under %d queued uploads %.1f ms"), IdleLatency * 1000.0, BackgroundCount, LoadedLatency * 1000.0));
+    AddInfo(FString::Printf(TEXT("Background: peak queue %d, average wait %.1f ms, max wait %.1f ms, peak server concurrency %d"),
+        Background.PeakQueued, Background.GetAverageWaitSeconds() * 1000.0, Background.MaxWaitSeconds * 1000.0, Server.GetPeakConcurrentContextRequests()));
+
+    Settings->MaxConcurrentRequests = PreviousMaxRequests;
+    Settings->MaxConcurrentBackgroundRequests = PreviousMaxBackground;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientRetryTest, "SurrealPilot.HttpClient.RetryAndCircuitBreaker", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientRetryTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const int32 PreviousMaxRetries = Settings->MaxRequestRetries;
+    const float PreviousBaseDelay = Settings->RetryBaseDelaySeconds;
+    const float PreviousMaxDelay = Settings->RetryMaxDelaySeconds;
+    const int32 PreviousThreshold = Settings->CircuitBreakerFailureThreshold;
+    const float PreviousCooldown = Settings->CircuitBreakerCooldownSeconds;
+    Settings->MaxRequestRetries = 3;
+    Settings->RetryBaseDelaySeconds = 0.05f;
+    Settings->RetryMaxDelaySeconds = 5.0f;
+    Settings->CircuitBreakerFailureThreshold = 3;
+    Settings->CircuitBreakerCooldownSeconds = 60.0f;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    // Send one context upload and wait for its outcome: 1 for success, -1 for failure
+    auto SendAndWait = [&HttpClient]() -> int32
+    {
+        TSharedRef<int32> Outcome = MakeShared<int32>(0);
+        TSharedPtr<FJsonObject> Export = MakeShareable(new FJsonObject);
+        Export->SetStringField(TEXT("name"), TEXT("BP_Door"));
+        HttpClient.SendContextRequest(TEXT("blueprint"), Export,
+            FOnHttpResponse::CreateLambda([Outcome](TSharedPtr<FJsonObject> Response) { *Outcome = 1; }),
+            FOnHttpError::CreateLambda([Outcome](const FString& Error) { *Outcome = -1; }));
+        SurrealPilotHttpTest::WaitFor([Outcome]() { return *Outcome != 0; }, 10.0);
+        return *Outcome;
+    };
+
+    // Transient overload: 503 then 429, both asking to retry straight away, then the real answer
+    const FSurrealPilotRetryStats StatsBefore = HttpClient.GetRetryStats();
+    int32 RequestsBefore = Server.GetRequestCount();
+    Server.SetScriptedFailures(TEXT("/api/context"), { 503, 429 }, TEXT("0"));
+    TestEqual("An upload should survive transient 503/429 responses", SendAndWait(), 1);
+    TestEqual("The upload should take three attempts", Server.GetRequestCount() - RequestsBefore, 3);
+    TestEqual("Two retries should be counted", HttpClient.GetRetryStats().Retries - StatsBefore.Retries, 2);
+
+    // A Retry-After longer than the configured maximum is reported instead of waited out
+    RequestsBefore = Server.GetRequestCount();
+    Server.SetScriptedFailures(TEXT("/api/context"), { 503 }, TEXT("120"));
+    TestEqual("A long Retry-After should surface the error", SendAndWait(), -1);
+    TestEqual("No retry should be made for a long Retry-After", Server.GetRequestCount() - RequestsBefore, 1);
+
+    // Persistent outage: once the circuit opens, uploads fail without touching the server
+    Settings->MaxRequestRetries = 0;
+    TArray<int32> Outage;
+    Outage.Init(503, 20);
+    Server.SetScriptedFailures(TEXT("/api/context"), Outage);
+
+    RequestsBefore = Server.GetRequestCount();
+    for (int32 Index = 0; Index < Settings->CircuitBreakerFailureThreshold - 1; ++Index)
+    {
+        TestEqual("Uploads should fail during the outage", SendAndWait(), -1);
+    }
+    TestEqual("The circuit should stay closed below the threshold", HttpClient.GetCircuitState(Server.GetBaseUrl()), ESurrealPilotCircuitState::Closed);
+    TestEqual("Uploads should fail during the outage", SendAndWait(), -1);
+    TestEqual("The circuit should open at the threshold", HttpClient.GetCircuitState(Server.GetBaseUrl()), ESurrealPilotCircuitState::Open);
+    const int32 RequestsAtOpen = Server.GetRequestCount();
+
+    const int32 FailedFastBefore = HttpClient.GetRetryStats().FailedFast;
+    const double FailFastStart = FPlatformTime::Seconds();
+    for (int32 Index = 0; Index < 10; ++Index)
+    {
+        TestEqual("Uploads should fail fast while the circuit is open", SendAndWait(), -1);
+    }
+    const double FailFastSeconds = FPlatformTime::Seconds() - FailFastStart;
+
+    TestEqual("Only the threshold requests should reach the server", RequestsAtOpen - RequestsBefore, Settings->CircuitBreakerFailureThreshold);
+    TestEqual("No request should reach the server while the circuit is open", Server.GetRequestCount(), RequestsAtOpen);
+    TestEqual("Every rejected upload should be counted", HttpClient.GetRetryStats().FailedFast - FailedFastBefore, 10);
+
+    AddInfo(FString::Printf(TEXT("10 uploads against an open circuit failed in %.1f ms"), FailFastSeconds * 1000.0));
+
+    Settings->MaxRequestRetries = PreviousMaxRetries;
+    Settings->RetryBaseDelaySeconds = PreviousBaseDelay;
+    Settings->RetryMaxDelaySeconds = PreviousMaxDelay;
+    Settings->CircuitBreakerFailureThreshold = PreviousThreshold;
+    Settings->CircuitBreakerCooldownSeconds = PreviousCooldown;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientEndpointFailoverTest, "SurrealPilot.HttpClient.EndpointFailover", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientEndpointFailoverTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Desktop;
+    FSurrealPilotStandInServer SaaS;
+    if (!TestTrue("Desktop stand-in should start", Desktop.Start()) || !TestTrue("SaaS stand-in should start", SaaS.Start()))
+    {
+        return false;
+    }
+
+    // The SaaS endpoint is further away than the desktop app
+    SaaS.SetHealthResponseDelay(0.05f);
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const int32 PreviousMaxRetries = Settings->MaxRequestRetries;
+    const float PreviousBaseDelay = Settings->RetryBaseDelaySeconds;
+    const bool bPreviousDedup = Settings->bEnableContextDedup;
+    Settings->MaxRequestRetries = 3;
+    Settings->RetryBaseDelaySeconds = 0.01f;
+    Settings->bEnableContextDedup = true;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    const FString DesktopUrl = Desktop.GetBaseUrl();
+    const FString SaaSUrl = SaaS.GetBaseUrl();
+    HttpClient.SetEndpointOverrides({ DesktopUrl, SaaSUrl });
+
+    // Probe every endpoint, then wait for the condition
+    auto ProbeAndWait = [&HttpClient](TFunctionRef<bool()> Condition)
+    {
+        HttpClient.ProbeEndpoints();
+        return SurrealPilotHttpTest::WaitFor(Condition, 5.0);
+    };
+
+    auto SendAndWait = [&HttpClient]() -> bool
+    {
+        TSharedRef<int32> Outcome = MakeShared<int32>(0);
+        TSharedPtr<FJsonObject> Export = MakeShareable(new FJsonObject);
+        Export->SetStringField(TEXT("name"), TEXT("BP_Door"));
+        HttpClient.SendContextRequest(TEXT("blueprint"), Export,
+            FOnHttpResponse::CreateLambda([Outcome](TSharedPtr<FJsonObject> Response) { *Outcome = 1; }),
+            FOnHttpError::CreateLambda([Outcome](const FString& Error) { *Outcome = -1; }));
+        SurrealPilotHttpTest::WaitFor([Outcome]() { return *Outcome != 0; }, 10.0);
+        return *Outcome == 1;
+    };
+
+    const FSurrealPilotEndpointManager& Endpoints = HttpClient.GetEndpointManager();
+    TestTrue("Both endpoints should be probed", ProbeAndWait([&Endpoints]()
+    {
+        return Endpoints.GetEndpoints().Num() == 2 && Endpoints.GetEndpoints()[0].bMeasured && Endpoints.GetEndpoints()[1].bMeasured;
+    }));
+    TestEqual("Requests should go to the faster desktop endpoint", HttpClient.GetApiBaseUrl(), DesktopUrl);
+
+    // Twice, so the desktop app stores the context and the second upload refers to it
+    int32 DesktopRequests = Desktop.GetRequestCount();
+    TestTrue("Upload to the desktop app should succeed", SendAndWait());
+    TestTrue("Repeated upload to the desktop app should succeed", SendAndWait());
+    TestEqual("The uploads should reach the desktop app", Desktop.GetRequestCount() - DesktopRequests, 2);
+
+    // The desktop app goes away: the next upload fails over on its first retry, with the context the SaaS endpoint
+    // has never seen sent inline rather than by a reference it would reject
+    Desktop.Stop();
+    const int32 SaaSRequests = SaaS.GetRequestCount();
+    const double FailoverStart = FPlatformTime::Seconds();
+    TestTrue("Upload should succeed after the desktop app stops", SendAndWait());
+    const double FailoverSeconds = FPlatformTime::Seconds() - FailoverStart;
+    TestEqual("The upload should reach the SaaS endpoint in one request", SaaS.GetRequestCount() - SaaSRequests, 1);
+    const TArray<uint8> FailoverBody = SaaS.GetLastRequestBody();
+    const FString FailoverJson(FailoverBody.Num(), reinterpret_cast<const UTF8CHAR*>(FailoverBody.GetData()));
+    TestTrue("The failed-over upload should carry the context inline", FailoverJson.Contains(TEXT("\"data\":")) && !FailoverJson.Contains(TEXT("\"data_ref\"")));
+    TestEqual("Requests should now go to the SaaS endpoint", HttpClient.GetApiBaseUrl(), SaaSUrl);
+    TestTrue("Failover should not wait for a timeout", FailoverSeconds < 1.0);
+
+    // Once the desktop app is back, the next probe moves requests back to it
+    if (TestTrue("Desktop stand-in should restart", Desktop.Start(Desktop.GetPort())))
+    {
+        TestTrue("Requests should return to the desktop app", ProbeAndWait([&HttpClient, &DesktopUrl]() { return HttpClient.GetApiBaseUrl() == DesktopUrl; }));
+        DesktopRequests = Desktop.GetRequestCount();
+        TestTrue("Upload to the restarted desktop app should succeed", SendAndWait());
+        TestEqual("The upload should reach the restarted desktop app", Desktop.GetRequestCount() - DesktopRequests, 1);
+    }
+
+    AddInfo(FString::Printf(TEXT("Failover from desktop to SaaS took %.1f ms; %d endpoint switches"), FailoverSeconds * 1000.0, Endpoints.GetSwitchCount()));
+
+    Settings->MaxRequestRetries = PreviousMaxRetries;
+    Settings->RetryBaseDelaySeconds = PreviousBaseDelay;
+    Settings->bEnableContextDedup = bPreviousDedup;
+    HttpClient.SetEndpointOverrides(TArray<FString>());
+    Desktop.Stop();
+    SaaS.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientCancellationTest, "SurrealPilot.HttpClient.Cancellation", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientCancellationTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    const int32 EventCount = 20;
+    TArray<FString> Events;
+    for (int32 Index = 0; Index < EventCount; ++Index)
+    {
+        Events.Add(FString::Printf(TEXT("{\"content\":\"token %d\"}"), Index));
+    }
+    Server.SetChatEvents(Events, 0.05f);
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const bool bPreviousStreaming = Settings->bEnableStreamingResponses;
+    const int32 PreviousMaxBackground = Settings->MaxConcurrentBackgroundRequests;
+    Settings->bEnableStreamingResponses = true;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    TArray<TSharedPtr<FJsonObject>> Messages;
+    TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+    UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+    UserMessage->SetStringField(TEXT("content"), TEXT("Why does my door not open?"));
+    Messages.Add(UserMessage);
+
+    // A newer question in the same conversation cancels the answer still streaming
+    TSharedRef<int32> FirstChunks = MakeShared<int32>(0);
+    TSharedRef<int32> FirstErrors = MakeShared<int32>(0);
+    FSurrealPilotRequestHandle First = HttpClient.SendChatRequest(Messages, TEXT("openai"), nullptr,
+        FOnStreamingChunk::CreateLambda([FirstChunks](const FString& Chunk) { ++(*FirstChunks); }),
+        FOnHttpError::CreateLambda([FirstErrors](const FString& Error) { ++(*FirstErrors); }),
+        TEXT("conversation-1"));
+    TestTrue("First chat should start streaming", SurrealPilotHttpTest::WaitFor([FirstChunks]() { return *FirstChunks >= 2; }, 5.0));
+    TestEqual("First chat should be in flight", First.GetStatus(), ESurrealPilotRequestStatus::InFlight);
+
+    TSharedRef<int32> SecondChunks = MakeShared<int32>(0);
+    FSurrealPilotRequestHandle Second = HttpClient.SendChatRequest(Messages, TEXT("openai"), nullptr,
+        FOnStreamingChunk::CreateLambda([SecondChunks](const FString& Chunk) { ++(*SecondChunks); }),
+        FOnHttpError(),
+        TEXT("conversation-1"));
+    const int32 FirstChunksAtCancel = *FirstChunks;
+    TestEqual("First chat should be cancelled", First.GetStatus(), ESurrealPilotRequestStatus::Cancelled);
+
+    TestTrue("Second chat should complete", SurrealPilotHttpTest::WaitFor([&Second]() { return Second.IsFinished(); }, 10.0));
+    TestEqual("Second chat should succeed", Second.GetStatus(), ESurrealPilotRequestStatus::Succeeded);
+    TestEqual("Second chat should receive every chunk", *SecondChunks, EventCount);
+    TestEqual("Cancelled chat should receive no more chunks", *FirstChunks, FirstChunksAtCancel);
+    TestEqual("Cancelled chat should not report an error", *FirstErrors, 0);
+    TestTrue("The server should stop streaming the cancelled answer", Server.GetEventsSent() < EventCount + FirstChunksAtCancel + 5);
+
+    // A deadline fails a slow request once, with an error
+    Server.SetContextResponseDelay(1.0f);
+    TSharedRef<int32> DeadlineErrors = MakeShared<int32>(0);
+    TSharedPtr<FJsonObject> Export = MakeShareable(new FJsonObject);
+    Export->SetStringField(TEXT("name"), TEXT("BP_Door"));
+    const double DeadlineStart = FPlatformTime::Seconds();
+    FSurrealPilotRequestHandle Slow = HttpClient.SendContextRequest(TEXT("blueprint"), Export, FOnHttpResponse(),
+        FOnHttpError::CreateLambda([DeadlineErrors](const FString& Error) { ++(*DeadlineErrors); }));
+    Slow.SetDeadline(0.2);
+    TestTrue("Deadline should report an error", SurrealPilotHttpTest::WaitFor([DeadlineErrors]() { return *DeadlineErrors > 0; }, 5.0));
+    const double DeadlineSeconds = FPlatformTime::Seconds() - DeadlineStart;
+    TestEqual("Request should be timed out", Slow.GetStatus(), ESurrealPilotRequestStatus::TimedOut);
+    TestTrue("Deadline should fire well before the response", DeadlineSeconds < 0.8);
+    SurrealPilotHttpTest::WaitFor([]() { return false; }, 1.0);
+    TestEqual("Timeout should be reported exactly once", *DeadlineErrors, 1);
+
+    // A request cancelled while queued never reaches the server
+    Settings->MaxConcurrentBackgroundRequests = 1;
+    Server.SetContextResponseDelay(0.2f);
+    const int32 RequestsBefore = Server.GetRequestCount();
+    TSharedRef<int32> Completed = MakeShared<int32>(0);
+    TArray<FSurrealPilotRequestHandle> Uploads;
+    for (int32 Index = 0; Index < 3; ++Index)
+    {
+        Uploads.Add(HttpClient.SendContextRequest(TEXT("blueprint"), Export,
+            FOnHttpResponse::CreateLambda([Completed](TSharedPtr<FJsonObject> Response) { ++(*Completed); }),
+            FOnHttpError::CreateLambda([Completed](const FString& Error) { ++(*Completed); })));
+    }
+    TestEqual("Last upload should be queued", Uploads[2].GetStatus(), ESurrealPilotRequestStatus::Queued);
+    const int32 QueuedBefore = HttpClient.GetScheduler().GetTotalQueued();
+    Uploads[2].Cancel();
+    TestEqual("Cancelling should free the queue slot", HttpClient.GetScheduler().GetTotalQueued(), QueuedBefore - 1);
+
+    SurrealPilotHttpTest::WaitFor([Completed]() { return *Completed >= 2; }, 5.0);
+    SurrealPilotHttpTest::WaitFor([]() { return false; }, 0.3);
+    TestEqual("Only the uncancelled uploads should complete", *Completed, 2);
+    TestEqual("The cancelled upload should never reach the server", Server.GetRequestCount() - RequestsBefore, 2);
+
+    // A large answer is parsed on a worker after the request completes; cancelling during delivery stops it there,
+    // and nothing partial is kept in the response cache
+    const bool bPreviousResponseCache = Settings->bEnableResponseCache;
+    Settings->bEnableStreamingResponses = false;
+    Settings->bEnableResponseCache = true;
+    TArray<FString> LargeEvents;
+    for (int32 Index = 0; Index < 100; ++Index)
+    {
+        LargeEvents.Add(FString::Printf(TEXT("{\"content\":\"%d %s\"}"), Index, *FString::ChrN(1024, TEXT('x'))));
+    }
+    Server.SetChatEvents(LargeEvents, 0.0f);
+    UserMessage->SetStringField(TEXT("content"), FString::Printf(TEXT("Explain the whole Blueprint (%s)"), *FGuid::NewGuid().ToString()));
+    const int32 CachedBefore = HttpClient.GetResponseCache().GetMemoryEntryCount();
+    TSharedRef<int32> LargeChunks = MakeShared<int32>(0);
+    TSharedRef<bool> bLargeCompleted = MakeShared<bool>(false);
+    TSharedRef<ESurrealPilotRequestStatus> LargeStatusAtChunk = MakeShared<ESurrealPilotRequestStatus>(ESurrealPilotRequestStatus::Queued);
+    TSharedRef<FSurrealPilotRequestHandle> Large = MakeShared<FSurrealPilotRequestHandle>();
+    *Large = HttpClient.SendChatRequest(Messages, TEXT("openai"), nullptr,
+        FOnStreamingChunk::CreateLambda([LargeChunks, LargeStatusAtChunk, Large](const FString& Chunk)
+        {
+            ++(*LargeChunks);
+            *LargeStatusAtChunk = Large->GetStatus();
+            Large->Cancel();
+        }),
+        FOnHttpError(), FString(),
+        FSimpleDelegate::CreateLambda([bLargeCompleted]() { *bLargeCompleted = true; }));
+    TestTrue("Large answer should start delivering", SurrealPilotHttpTest::WaitFor([LargeChunks]() { return *LargeChunks > 0; }, 10.0));
+    SurrealPilotHttpTest::WaitFor([]() { return false; }, 0.3);
+    TestEqual("Large answer should stay in flight until it has been delivered", *LargeStatusAtChunk, ESurrealPilotRequestStatus::InFlight);
+    TestEqual("Cancelling from the first chunk should stop delivery", *LargeChunks, 1);
+    TestEqual("Large answer should be cancelled", Large->GetStatus(), ESurrealPilotRequestStatus::Cancelled);
+    TestFalse("A cancelled answer should not complete", *bLargeCompleted);
+    TestEqual("A cancelled answer should not be cached", HttpClient.GetResponseCache().GetMemoryEntryCount(), CachedBefore);
+
+    AddInfo(FString::Printf(TEXT("Superseded chat stopped after %d of %d chunks; deadline fired after %.1f ms"), FirstChunksAtCancel, EventCount, DeadlineSeconds * 1000.0));
+
+    Settings->bEnableStreamingResponses = bPreviousStreaming;
+    Settings->bEnableResponseCache = bPreviousResponseCache;
+    Settings->MaxConcurrentBackgroundRequests = PreviousMaxBackground;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientLargeResponseTest, "SurrealPilot.HttpClient.LargeResponseParsing", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientLargeResponseTest::RunTest(const FString& Parameters)
+{
+    // Most game-thread time a single frame may spend while a 10 MB response completes
+    const double FrameBudgetSeconds = 0.025;
+
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    // About 10 MB of analysis results
+    const int32 ItemCount = 100000;
+    TStringBuilder<1024> Body;
+    Body << TEXT("{\"status\":\"received\",\"items\":[");
+    for (int32 Index = 0; Index < ItemCount; ++Index)
+    {
+        Body.Appendf(TEXT("%s{\"name\":\"K2Node_CallFunction_%d\",\"severity\":\"info\",\"message\":\"Pin connections verified for node\",\"x\":%d}"),
+            Index > 0 ? TEXT(",") : TEXT(""), Index, Index * 16);
+    }
+    Body << TEXT("]}");
+    const FString ResponseBody = Body.ToString();
+    Server.SetContextResponseBody(ResponseBody);
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    TSharedRef<int32> ParsedItems = MakeShared<int32>(-1);
+    TSharedRef<bool> bDone = MakeShared<bool>(false);
+    TSharedPtr<FJsonObject> Export = MakeShareable(new FJsonObject);
+    Export->SetStringField(TEXT("name"), TEXT("BP_Door"));
+    HttpClient.SendContextRequest(TEXT("blueprint"), Export,
+        FOnHttpResponse::CreateLambda([ParsedItems, bDone](TSharedPtr<FJsonObject> Response)
+        {
+            const TArray<TSharedPtr<FJsonValue>>* Items = nullptr;
+            *ParsedItems = Response->TryGetArrayField(TEXT("items"), Items) ? Items->Num() : 0;
+            *bDone = true;
+        }),
+        FOnHttpError::CreateLambda([bDone](const FString& Error) { *bDone = true; }));
+
+    // Time each frame of game-thread work separately
+    double WorstFrameSeconds = 0.0;
+    const double Deadline = FPlatformTime::Seconds() + 30.0;
+    while (!*bDone && FPlatformTime::Seconds() < Deadline)
+    {
+        const double FrameStart = FPlatformTime::Seconds();
+        SurrealPilotHttpTest::TickGameThread();
+        WorstFrameSeconds = FMath::Max(WorstFrameSeconds, FPlatformTime::Seconds() - FrameStart);
+        FPlatformProcess::Sleep(0.005f);
+    }
+
+    TestTrue("Response should complete", *bDone);
+    TestEqual("Every item should be parsed", *ParsedItems, ItemCount);
+    TestTrue(FString::Printf(TEXT("Worst game-thread frame (%.1f ms) should stay within %.0f ms"), WorstFrameSeconds * 1000.0, FrameBudgetSeconds * 1000.0),
+        WorstFrameSeconds <= FrameBudgetSeconds);
+
+    // What the same parse costs when it runs inline, for comparison
+    const double InlineStart = FPlatformTime::Seconds();
+    TSharedPtr<FJsonObject> Inline;
+    FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(ResponseBody), Inline);
+    const double InlineSeconds = FPlatformTime::Seconds() - InlineStart;
+
+    AddInfo(FString::Printf(TEXT("%.1f MB response: worst game-thread frame %.1f ms, inline parse would take %.1f ms"),
+        ResponseBody.Len() / (1024.0 * 1024.0), WorstFrameSeconds * 1000.0, InlineSeconds * 1000.0));
+
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientMetricsTest, "SurrealPilot.HttpClient.LatencyMetrics", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientMetricsTest::RunTest(const FString& Parameters)
 {
-    // Test HttpClient creation
-    USurrealPilotHttpClient* HttpClient = USurrealPilotHttpClient::Get();
-    TestNotNull("HttpClient should be available", HttpClient);
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
 
-    if (HttpClient)
+    // Five events 0.2 s apart: the first arrives well before the stream ends
+    TArray<FString> Events;
+    for (int32 Index = 0; Index < 5; ++Index)
     {
-        // Test URL construction
-        FString BaseUrl = HttpClient->GetBaseUrl();
-        TestTrue("Base URL should not be empty", !BaseUrl.IsEmpty());
-        TestTrue("Base URL should be valid format", BaseUrl.StartsWith(TEXT("http")));
+        Events.Add(FString::Printf(TEXT("{\"content\":\"token %d\"}"), Index));
+    }
+    Server.SetChatEvents(Events, 0.2f);
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+    HttpClient.ResetMetrics();
 
-        // Test endpoint construction
-        FString ChatEndpoint = HttpClient->BuildEndpointUrl(TEXT("chat"));
-        TestTrue("Chat endpoint should contain base URL", ChatEndpoint.Contains(BaseUrl));
-        TestTrue("Chat endpoint should contain 'chat'", ChatEndpoint.Contains(TEXT("chat")));
+    TArray<TSharedPtr<FJsonObject>> Messages;
+    TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+    UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+    UserMessage->SetStringField(TEXT("content"), TEXT("Count to five"));
+    Messages.Add(UserMessage);
 
-        FString AssistEndpoint = HttpClient->BuildEndpointUrl(TEXT("assist"));
-        TestTrue("Assist endpoint should contain 'assist'", AssistEndpoint.Contains(TEXT("assist")));
+    FSurrealPilotRequestHandle Handle = HttpClient.SendChatRequest(Messages, TEXT("anthropic"));
 
-        // Test header construction
-        TMap<FString, FString> Headers = HttpClient->BuildRequestHeaders();
-        TestTrue("Headers should contain Content-Type", Headers.Contains(TEXT("Content-Type")));
-        TestTrue("Headers should contain Accept", Headers.Contains(TEXT("Accept")));
-        TestEqual("Content-Type should be JSON", Headers[TEXT("Content-Type")], TEXT("application/json"));
+    const FString BaseUrl = Server.GetBaseUrl();
+    const bool bRecorded = SurrealPilotHttpTest::WaitFor([&HttpClient, &BaseUrl]()
+    {
+        return HttpClient.GetMetrics().Find(BaseUrl, TEXT("/api/chat"), TEXT("anthropic")) != nullptr;
+    }, 10.0);
+
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    const FSurrealPilotEndpointMetrics* Metrics = HttpClient.GetMetrics().Find(BaseUrl, TEXT("/api/chat"), TEXT("anthropic"));
+    if (!TestTrue("Chat request should be recorded", bRecorded) || !TestNotNull("Series for the endpoint and provider", Metrics))
+    {
+        return false;
     }
 
+    TestEqual("One request", Metrics->Requests, 1);
+    TestEqual("No failures", Metrics->Failures, 0);
+    TestEqual("Time to first byte should be recorded", Metrics->FirstByteMs.GetCount(), static_cast<int64>(1));
+    TestEqual("Time to first event should be recorded", Metrics->FirstEventMs.GetCount(), static_cast<int64>(1));
+    TestTrue("Request size should be recorded", Metrics->RequestBytes.GetMax() > 0.0);
+    TestTrue("Response size should be recorded", Metrics->ResponseBytes.GetMax() > 0.0);
+
+    const double FirstByteMs = Metrics->FirstByteMs.GetMax();
+    const double FirstEventMs = Metrics->FirstEventMs.GetMax();
+    const double TotalMs = Metrics->TotalMs.GetMax();
+    TestTrue(FString::Printf(TEXT("First byte (%.1f ms) <= first event (%.1f ms) < total (%.1f ms)"), FirstByteMs, FirstEventMs, TotalMs),
+        FirstByteMs <= FirstEventMs + 1.0 && FirstEventMs < TotalMs);
+    TestTrue("The stream should take at least the scripted delays", TotalMs >= 700.0);
+    TestTrue("Streamed events should have a rate", Metrics->EventsPerSecond.GetCount() == 1);
+
+    AddInfo(FString::Printf(TEXT("ttfb %.1f ms, first event %.1f ms, total %.1f ms, %.1f events/s"),
+        FirstByteMs, FirstEventMs, TotalMs, Metrics->EventsPerSecond.GetMax()));
+
     return true;
 }
 
-IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientRequestTest, "SurrealPilot.HttpClient.RequestConstruction", 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientLoadTest, "SurrealPilot.HttpClient.LoadTest", 
     EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
 
-bool FHttpClientRequestTest::RunTest(const FString& Parameters)
+bool FHttpClientLoadTest::RunTest(const FString& Parameters)
 {
-    USurrealPilotHttpClient* HttpClient = USurrealPilotHttpClient::Get();
-    TestNotNull("HttpClient should be available", HttpClient);
+    // -SurrealPilotLoadChats=N on the command line scales the test up
+    int32 ChatCount = 32;
+    FParse::Value(FCommandLine::Get(), TEXT("SurrealPilotLoadChats="), ChatCount);
+    ChatCount = FMath::Max(1, ChatCount);
+    const int32 EventsPerChat = 20;
+
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    // Model-like pacing, events split across TCP writes, and occasional overload the client has to retry through
+    TArray<FString> Events;
+    for (int32 Index = 0; Index < EventsPerChat; ++Index)
+    {
+        Events.Add(FString::Printf(TEXT("{\"content\":\"token %d of a streamed answer\"}"), Index));
+    }
+    Server.SetChatEvents(Events, 0.02f);
+    Server.SetChatFirstEventDelay(0.1f);
+    Server.SetChatChunkBytes(16);
+    Server.SetErrorRate(TEXT("/api/chat"), 0.05f, 503);
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+    HttpClient.ResetMetrics();
+
+    struct FLoadResult
+    {
+        int32 Events = 0;
+        int32 CompletedChats = 0;
+        int32 FailedChats = 0;
+    };
+    TSharedRef<FLoadResult> Result = MakeShared<FLoadResult>();
+
+    const double StartTime = FPlatformTime::Seconds();
+    for (int32 ChatIndex = 0; ChatIndex < ChatCount; ++ChatIndex)
+    {
+        TArray<TSharedPtr<FJsonObject>> Messages;
+        TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+        UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+        UserMessage->SetStringField(TEXT("content"), FString::Printf(TEXT("Load test chat %d"), ChatIndex));
+        Messages.Add(UserMessage);
 
-    if (HttpClient)
+        TSharedRef<int32> ChatEvents = MakeShared<int32>(0);
+        HttpClient.SendChatRequest(Messages, TEXT("openai"), nullptr,
+            FOnStreamingChunk::CreateLambda([Result, ChatEvents, EventsPerChat](const FString& Chunk)
+            {
+                ++Result->Events;
+                if (++*ChatEvents == EventsPerChat)
+                {
+                    ++Result->CompletedChats;
+                }
+            }),
+            FOnHttpError::CreateLambda([Result](const FString& Error)
+            {
+                ++Result->FailedChats;
+            }),
+            FString::Printf(TEXT("load-%d"), ChatIndex));
+    }
+
+    const bool bFinished = SurrealPilotHttpTest::WaitFor([Result, ChatCount]()
     {
-        // Test chat request construction
-        TArray<FString> Messages;
-        Messages.Add(TEXT("Hello, I need help with my Blueprint"));
-        Messages.Add(TEXT("Can you help me fix this error?"));
+        return Result->CompletedChats + Result->FailedChats >= ChatCount;
+    }, 60.0);
+    const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
 
-        FString ContextJson = TEXT(R"({
-            "blueprint": "TestBlueprint",
-            "errors": ["Error 1", "Error 2"],
-            "selection": "VariableNode"
-        })");
+    // Let the last completions reach the metrics
+    SurrealPilotHttpTest::TickGameThread();
 
-        FString RequestJson = HttpClient->BuildChatRequest(Messages, TEXT("openai"), ContextJson);
-        
-        TestTrue("Request JSON should not be empty", !RequestJson.IsEmpty());
-        TestTrue("Request should contain messages", RequestJson.Contains(TEXT("messages")));
-        TestTrue("Request should contain provider", RequestJson.Contains(TEXT("openai")));
-        TestTrue("Request should contain context", RequestJson.Contains(TEXT("context")));
-        TestTrue("Request should be valid JSON", RequestJson.StartsWith(TEXT("{")));
+    const FString BaseUrl = Server.GetBaseUrl();
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
 
-        // Test assist request construction
-        FString AssistRequestJson = HttpClient->BuildAssistRequest(TEXT("anthropic"));
-        TestTrue("Assist request should not be empty", !AssistRequestJson.IsEmpty());
-        TestTrue("Assist request should contain provider", AssistRequestJson.Contains(TEXT("anthropic")));
+    TestTrue("Every chat should finish before the timeout", bFinished);
+    TestEqual("Every chat should succeed after retries", Result->CompletedChats, ChatCount);
+    TestEqual("Every event should be delivered", Result->Events, ChatCount * EventsPerChat);
+
+    const FSurrealPilotEndpointMetrics* Metrics = HttpClient.GetMetrics().Find(BaseUrl, TEXT("/api/chat"), TEXT("openai"));
+    if (!TestNotNull("Chat metrics should be recorded", Metrics))
+    {
+        return false;
     }
 
+    AddInfo(FString::Printf(TEXT("%d chats, %d events in %.2f s: %.1f chats/s, %.0f events/s, %d attempts (%d failed and retried)"),
+        ChatCount, Result->Events, ElapsedSeconds, ChatCount / ElapsedSeconds, Result->Events / ElapsedSeconds, Metrics->Requests, Metrics->Failures));
+    AddInfo(FString::Printf(TEXT("First event ms: p50 %.1f, p95 %.1f, p99 %.1f"),
+        Metrics->FirstEventMs.GetPercentile(50.0), Metrics->FirstEventMs.GetPercentile(95.0), Metrics->FirstEventMs.GetPercentile(99.0)));
+    AddInfo(FString::Printf(TEXT("Total ms: p50 %.1f, p95 %.1f, p99 %.1f"),
+        Metrics->TotalMs.GetPercentile(50.0), Metrics->TotalMs.GetPercentile(95.0), Metrics->TotalMs.GetPercentile(99.0)));
+
     return true;
 }
 
-IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientErrorHandlingTest, "SurrealPilot.HttpClient.ErrorHandling", 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientContextDedupTest, "SurrealPilot.HttpClient.ContextDedup", 
     EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
 
-bool FHttpClientErrorHandlingTest::RunTest(const FString& Parameters)
+bool FHttpClientContextDedupTest::RunTest(const FString& Parameters)
 {
-    USurrealPilotHttpClient* HttpClient = USurrealPilotHttpClient::Get();
-    TestNotNull("HttpClient should be available", HttpClient);
-
-    if (HttpClient)
-    {
-        // Test error response parsing
-        FString ErrorResponse401 = TEXT(R"({
-            "error": "authentication_required",
-            "message": "Invalid or missing API token",
-            "error_code": "AUTHENTICATION_REQUIRED"
-        })");
-
-        FString ErrorResponse402 = TEXT(R"({
-            "error": "insufficient_credits",
-            "message": "Company has insufficient credits",
-            "credits_available": 50,
-            "estimated_tokens_needed": 100
-        })");
-
-        FString ErrorResponse503 = TEXT(R"({
-            "error": "provider_unavailable",
-            "message": "OpenAI is temporarily unavailable",
-            "available_providers": ["anthropic", "gemini"]
-        })");
-
-        // Test that error responses can be parsed without crashing
-        bool CanParse401 = HttpClient->IsValidJsonResponse(ErrorResponse401);
-        bool CanParse402 = HttpClient->IsValidJsonResponse(ErrorResponse402);
-        bool CanParse503 = HttpClient->IsValidJsonResponse(ErrorResponse503);
-
-        TestTrue("Should parse 401 error response", CanParse401);
-        TestTrue("Should parse 402 error response", CanParse402);
-        TestTrue("Should parse 503 error response", CanParse503);
-
-        // Test invalid JSON handling
-        FString InvalidJson = TEXT("{ invalid json }");
-        bool CanParseInvalid = HttpClient->IsValidJsonResponse(InvalidJson);
-        TestFalse("Should not parse invalid JSON", CanParseInvalid);
+    // Field order does not change the hash
+    TSharedPtr<FJsonObject> Forward = MakeShareable(new FJsonObject);
+    Forward->SetStringField(TEXT("blueprint"), TEXT("BP_Door"));
+    Forward->SetNumberField(TEXT("node_count"), 42);
+    TSharedPtr<FJsonObject> Reversed = MakeShareable(new FJsonObject);
+    Reversed->SetNumberField(TEXT("node_count"), 42);
+    Reversed->SetStringField(TEXT("blueprint"), TEXT("BP_Door"));
+    TestEqual("Equal contexts should hash equally", FSurrealPilotContextBlob::Encode(Forward, true)->Hash, FSurrealPilotContextBlob::Encode(Reversed, true)->Hash);
+
+    // Nor does the time it was exported, which is still sent
+    TSharedPtr<FJsonObject> Stamped = MakeShared<FJsonObject>(*Forward);
+    Stamped->SetStringField(TEXT("timestamp"), TEXT("2024.01.01-12.00.00"));
+    TSharedRef<const FSurrealPilotContextBlob> StampedBlob = FSurrealPilotContextBlob::Encode(Stamped, true);
+    TestEqual("The timestamp should not change the hash", StampedBlob->Hash, FSurrealPilotContextBlob::Encode(Forward, true)->Hash);
+    TestTrue("The timestamp should still be encoded", FString(StampedBlob->Json.Num(), reinterpret_cast<const UTF8CHAR*>(StampedBlob->Json.GetData())).Contains(TEXT("2024.01.01-12.00.00")));
+
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const bool bPreviousDedup = Settings->bEnableContextDedup;
+    Settings->bEnableContextDedup = true;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    // A Blueprint export big enough for the savings to matter
+    TSharedPtr<FJsonObject> ContextData = MakeShareable(new FJsonObject);
+    TArray<TSharedPtr<FJsonValue>> Nodes;
+    for (int32 Index = 0; Index < 200; ++Index)
+    {
+        TSharedPtr<FJsonObject> Node = MakeShareable(new FJsonObject);
+        Node->SetStringField(TEXT("name"), FString::Printf(TEXT("K2Node_CallFunction_%d"), Index));
+        Node->SetStringField(TEXT("class"), TEXT("K2Node_CallFunction"));
+        Nodes.Add(MakeShareable(new FJsonValueObject(Node)));
     }
+    ContextData->SetArrayField(TEXT("nodes"), Nodes);
+
+    TSharedRef<int32> Succeeded = MakeShared<int32>(0);
+    TSharedRef<int32> Failed = MakeShared<int32>(0);
+    auto SendContext = [&HttpClient, ContextData, Succeeded, Failed](int32 ExpectedTotal)
+    {
+        HttpClient.SendContextRequest(TEXT("blueprint"), ContextData,
+            FOnHttpResponse::CreateLambda([Succeeded](TSharedPtr<FJsonObject> Response) { ++(*Succeeded); }),
+            FOnHttpError::CreateLambda([Failed](const FString& Error) { ++(*Failed); }));
+        SurrealPilotHttpTest::WaitFor([Succeeded, Failed, ExpectedTotal]() { return *Succeeded + *Failed >= ExpectedTotal; }, 10.0);
+    };
+
+    auto ReceivedBody = [&Server]()
+    {
+        const TArray<uint8> Body = Server.GetLastRequestBody();
+        TSharedPtr<FJsonObject> Received;
+        FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(Body.Num(), reinterpret_cast<const UTF8CHAR*>(Body.GetData()))), Received);
+        return Received.IsValid() ? Received.ToSharedRef() : MakeShared<FJsonObject>();
+    };
+
+    const FSurrealPilotContextDedupStats Before = HttpClient.GetContextDedupStats();
+
+    // First upload: inline with its hash, which the server confirms
+    SendContext(1);
+    TestTrue("First upload should carry the context inline", ReceivedBody()->HasField(TEXT("data")));
+    TestTrue("First upload should carry the hash", ReceivedBody()->HasField(TEXT("data_hash")));
+
+    // Second upload: only the hash
+    SendContext(2);
+    TestFalse("Repeated context should not be uploaded again", ReceivedBody()->HasField(TEXT("data")));
+    TestTrue("Repeated context should be sent by reference", ReceivedBody()->HasField(TEXT("data_ref")));
+
+    // A chat about the same Blueprint refers to the same blob
+    TArray<TSharedPtr<FJsonObject>> Messages;
+    TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+    UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+    UserMessage->SetStringField(TEXT("content"), TEXT("Why does this door not open?"));
+    Messages.Add(UserMessage);
+    Server.SetChatEvents({ TEXT("{\"content\":\"ok\"}") }, 0.0f);
+    TSharedRef<bool> bChatDone = MakeShared<bool>(false);
+    HttpClient.SendChatRequest(Messages, TEXT("openai"), ContextData,
+        FOnStreamingChunk::CreateLambda([bChatDone](const FString& Chunk) { *bChatDone = true; }),
+        FOnHttpError::CreateLambda([bChatDone](const FString& Error) { *bChatDone = true; }));
+    SurrealPilotHttpTest::WaitFor([bChatDone]() { return *bChatDone; }, 10.0);
+    TestTrue("Chat should refer to the stored context", ReceivedBody()->HasField(TEXT("context_ref")));
+
+    // A restarted server has lost the blob: the reference fails once and the context is resent inline
+    Server.ForgetContextBlobs();
+    const int32 RequestsBefore = Server.GetRequestCount();
+    SendContext(3);
+    TestEqual("Every upload should succeed", *Succeeded, 3);
+    TestEqual("A miss should cost exactly one extra request", Server.GetRequestCount() - RequestsBefore, 2);
+    TestTrue("The resent body should carry the context inline", ReceivedBody()->HasField(TEXT("data")));
+
+    // Wait for the chat's completion to be counted
+    SurrealPilotHttpTest::WaitFor([&HttpClient, Before]() { return HttpClient.GetContextDedupStats().References - Before.References >= 2; }, 5.0);
+
+    const FSurrealPilotContextDedupStats& Stats = HttpClient.GetContextDedupStats();
+    TestEqual("Two contexts should go by reference", Stats.References - Before.References, 2);
+    TestEqual("Two contexts should be uploaded inline", Stats.Uploads - Before.Uploads, 2);
+    TestEqual("One miss should be recorded", Stats.Misses - Before.Misses, 1);
+    TestTrue("Bytes saved should cover the referenced contexts", Stats.BytesSaved - Before.BytesSaved >= 2 * FSurrealPilotContextBlob::Encode(ContextData, true)->Json.Num());
+    AddInfo(FString::Printf(TEXT("Saved %lld bytes, uploaded %lld bytes"), Stats.BytesSaved - Before.BytesSaved, Stats.BytesUploaded - Before.BytesUploaded));
+
+    Settings->bEnableContextDedup = bPreviousDedup;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
 
     return true;
 }
 
-#endif // WITH_DEV_AUTOMATION_TESTS
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientContextDeltaTest, "SurrealPilot.HttpClient.ContextDeltas", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
 
-/**
- * Console commands for manual testing
- */
-class SURREALPILOT_API FHttpClientTestCommands
+bool FHttpClientContextDeltaTest::RunTest(const FString& Parameters)
 {
-public:
-    /**
-     * Test connection to local server
-     */
-    static void TestLocalConnection()
-    {
-        USurrealPilotHttpClient* HttpClient = USurrealPilotHttpClient::Get();
-        if (!HttpClient)
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const bool bPreviousDeltas = Settings->bEnableContextDeltas;
+    Settings->bEnableContextDeltas = true;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    // A Blueprint export whose nodes carry GUIDs, with the first node at a given position
+    auto MakeExport = [](int32 FirstNodeX)
+    {
+        TSharedPtr<FJsonObject> Export = MakeShareable(new FJsonObject);
+        Export->SetStringField(TEXT("name"), TEXT("BP_Door"));
+        TArray<TSharedPtr<FJsonValue>> Nodes;
+        for (int32 Index = 0; Index < 300; ++Index)
         {
-            UE_LOG(LogTemp, Error, TEXT("HttpClient not available"));
-            return;
+            TSharedPtr<FJsonObject> Node = MakeShareable(new FJsonObject);
+            Node->SetStringField(TEXT("guid"), FGuid(Index, 0, 0, 1).ToString());
+            Node->SetStringField(TEXT("name"), FString::Printf(TEXT("K2Node_CallFunction_%d"), Index));
+            Node->SetStringField(TEXT("class"), TEXT("K2Node_CallFunction"));
+            Node->SetNumberField(TEXT("posX"), Index == 0 ? FirstNodeX : Index * 10);
+            Nodes.Add(MakeShareable(new FJsonValueObject(Node)));
         }
+        TSharedPtr<FJsonObject> Graph = MakeShareable(new FJsonObject);
+        Graph->SetStringField(TEXT("guid"), FGuid(0, 0, 0, 2).ToString());
+        Graph->SetArrayField(TEXT("nodes"), Nodes);
+        TArray<TSharedPtr<FJsonValue>> Graphs;
+        Graphs.Add(MakeShareable(new FJsonValueObject(Graph)));
+        Export->SetArrayField(TEXT("graphs"), Graphs);
+        return Export;
+    };
+
+    TSharedRef<int32> Succeeded = MakeShared<int32>(0);
+    TSharedRef<int32> Failed = MakeShared<int32>(0);
+    auto SendExport = [&HttpClient, Succeeded, Failed](const FString& AssetPath, const TSharedPtr<FJsonObject>& Export)
+    {
+        const int32 ExpectedTotal = *Succeeded + *Failed + 1;
+        HttpClient.SendAssetContext(AssetPath, TEXT("blueprint"), Export,
+            FOnHttpResponse::CreateLambda([Succeeded](TSharedPtr<FJsonObject> Response) { ++(*Succeeded); }),
+            FOnHttpError::CreateLambda([Failed](const FString& Error) { ++(*Failed); }));
+        SurrealPilotHttpTest::WaitFor([Succeeded, Failed, ExpectedTotal]() { return *Succeeded + *Failed >= ExpectedTotal; }, 10.0);
+    };
+
+    auto ReceivedBody = [&Server]()
+    {
+        const TArray<uint8> Body = Server.GetLastRequestBody();
+        TSharedPtr<FJsonObject> Received;
+        FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(Body.Num(), reinterpret_cast<const UTF8CHAR*>(Body.GetData()))), Received);
+        return Received.IsValid() ? Received.ToSharedRef() : MakeShared<FJsonObject>();
+    };
+
+    auto ServerHash = [&Server](const FString& AssetPath)
+    {
+        TSharedPtr<FJsonObject> Context = Server.GetAssetContext(AssetPath);
+        return Context.IsValid() ? FSurrealPilotContextBlob::Encode(Context, true)->Hash : FString();
+    };
+
+    const FString Door = TEXT("/Game/BP_Door.BP_Door");
+    const FSurrealPilotContextDeltaStats Before = HttpClient.GetContextDeltaStats();
+
+    // First upload of an asset goes in full
+    TSharedPtr<FJsonObject> Version1 = MakeExport(0);
+    SendExport(Door, Version1);
+    TestTrue("First upload should carry the full export", ReceivedBody()->HasField(TEXT("data")));
+    TestEqual("Server should keep the first version", ServerHash(Door), FSurrealPilotContextBlob::Encode(Version1, true)->Hash);
+
+    // Moving one node sends only that change, which the server applies to its copy
+    TSharedPtr<FJsonObject> Version2 = MakeExport(500);
+    SendExport(Door, Version2);
+    TestFalse("An edit should not re-send the export", ReceivedBody()->HasField(TEXT("data")));
+    TestTrue("An edit should be sent as a delta", ReceivedBody()->HasField(TEXT("patch")));
+    TestEqual("The delta should name the acknowledged version", ReceivedBody()->GetStringField(TEXT("base_version")), FSurrealPilotContextBlob::Encode(Version1, true)->Hash);
+    TestEqual("Server should rebuild the edited export", ServerHash(Door), FSurrealPilotContextBlob::Encode(Version2, true)->Hash);
+
+    // A restarted server no longer has the base: the delta is rejected once and the export resent in full
+    Server.ForgetAssetVersions();
+    const int32 RequestsBefore = Server.GetRequestCount();
+    TSharedPtr<FJsonObject> Version3 = MakeExport(1000);
+    SendExport(Door, Version3);
+    TestEqual("A divergence should cost exactly one extra request", Server.GetRequestCount() - RequestsBefore, 2);
+    TestTrue("The resent body should carry the full export", ReceivedBody()->HasField(TEXT("data")));
+    TestEqual("Server should keep the resent version", ServerHash(Door), FSurrealPilotContextBlob::Encode(Version3, true)->Hash);
+
+    // And deltas resume against the resent version
+    TSharedPtr<FJsonObject> Version4 = MakeExport(1500);
+    SendExport(Door, Version4);
+    TestTrue("Deltas should resume after a full upload", ReceivedBody()->HasField(TEXT("patch")));
+    TestEqual("Server should rebuild the latest export", ServerHash(Door), FSurrealPilotContextBlob::Encode(Version4, true)->Hash);
+
+    // A server that does not confirm versions keeps receiving full exports
+    Server.SetKeepsAssetVersions(false);
+    const FString Window = TEXT("/Game/BP_Window.BP_Window");
+    SendExport(Window, MakeExport(7));
+    SendExport(Window, MakeExport(8));
+    TestTrue("Without confirmation an edit should be sent in full", ReceivedBody()->HasField(TEXT("data")));
+
+    TestEqual("Every upload should succeed", *Succeeded, 6);
+    const FSurrealPilotContextDeltaStats& Stats = HttpClient.GetContextDeltaStats();
+    TestEqual("Two uploads should go as deltas", Stats.Deltas - Before.Deltas, 2);
+    TestEqual("Four uploads should go in full", Stats.FullUploads - Before.FullUploads, 4);
+    TestEqual("One divergence should be recorded", Stats.Divergences - Before.Divergences, 1);
+    TestTrue("Deltas should be far smaller than the exports they replace",
+        (Stats.DeltaBytes - Before.DeltaBytes) * 20 < Stats.FullBytesReplaced - Before.FullBytesReplaced);
+    AddInfo(FString::Printf(TEXT("Deltas: %lld bytes instead of %lld"), Stats.DeltaBytes - Before.DeltaBytes, Stats.FullBytesReplaced - Before.FullBytesReplaced));
+
+    Settings->bEnableContextDeltas = bPreviousDeltas;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientWebSocketChannelTest, "SurrealPilot.HttpClient.WebSocketChannel", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientWebSocketChannelTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    TArray<FString> Events;
+    Events.Add(TEXT("{\"content\":\"Hello\"}"));
+    Events.Add(TEXT("{\"content\":\" over the channel\"}"));
+    Server.SetChatEvents(Events, 0.0f);
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const bool bPreviousChannel = Settings->bEnableWebSocketChannel;
+    Settings->bEnableWebSocketChannel = true;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+    HttpClient.RefreshChannel();
+    const FSurrealPilotWebSocketChannel& Channel = HttpClient.GetChannel();
+    const FSurrealPilotChannelStats StartStats = Channel.GetStats();
+    TestTrue("Channel should connect", SurrealPilotHttpTest::WaitFor([&Channel]() { return Channel.IsConnected(); }, 5.0));
 
-        UE_LOG(LogTemp, Log, TEXT("Testing connection to local server..."));
-        
-        // Test providers endpoint
-        HttpClient->GetProviders(FOnHttpResponse::CreateLambda([](bool bSuccess, const FString& Response, int32 StatusCode)
+    struct FChatResult
+    {
+        TArray<FString> Chunks;
+        FString Error;
+    };
+    auto SendChat = [&HttpClient](const TSharedRef<FChatResult>& Result)
+    {
+        TArray<TSharedPtr<FJsonObject>> Messages;
+        TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+        UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+        UserMessage->SetStringField(TEXT("content"), TEXT("Hello"));
+        Messages.Add(UserMessage);
+        return HttpClient.SendChatRequest(Messages, TEXT("openai"), nullptr,
+            FOnStreamingChunk::CreateLambda([Result](const FString& Chunk) { Result->Chunks.Add(Chunk); }),
+            FOnHttpError::CreateLambda([Result](const FString& Error) { Result->Error = Error; }));
+    };
+
+    // Chat streams its events as frames
+    TSharedRef<FChatResult> Chat = MakeShared<FChatResult>();
+    FSurrealPilotRequestHandle ChatHandle = SendChat(Chat);
+    SurrealPilotHttpTest::WaitFor([&ChatHandle]() { return ChatHandle.IsFinished(); }, 5.0);
+    TestEqual("Chat should succeed over the channel", ChatHandle.GetStatus(), ESurrealPilotRequestStatus::Succeeded);
+    TestEqual("Every event should be delivered", FString::Join(Chat->Chunks, TEXT("|")), FString::Join(Events, TEXT("|")));
+    TestEqual("Chat should go over the channel", Server.GetChannelRequestCount(), 1);
+
+    auto MakeMessages = []()
+    {
+        TArray<TSharedPtr<FJsonObject>> Messages;
+        TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+        UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+        UserMessage->SetStringField(TEXT("content"), TEXT("Hello"));
+        Messages.Add(UserMessage);
+        return Messages;
+    };
+
+    // A chunk handler that cancels its own request stops the rest of the frames
+    TSharedRef<FChatResult> CancelledChat = MakeShared<FChatResult>();
+    TSharedRef<FSurrealPilotRequestHandle> CancelledHandle = MakeShared<FSurrealPilotRequestHandle>();
+    *CancelledHandle = HttpClient.SendChatRequest(MakeMessages(), TEXT("openai"), nullptr,
+        FOnStreamingChunk::CreateLambda([CancelledChat, CancelledHandle](const FString& Chunk)
         {
-            if (bSuccess)
-            {
-                UE_LOG(LogTemp, Log, TEXT("Providers endpoint test - SUCCESS: %s"), *Response);
-            }
-            else
+            CancelledChat->Chunks.Add(Chunk);
+            CancelledHandle->Cancel();
+        }),
+        FOnHttpError::CreateLambda([CancelledChat](const FString& Error) { CancelledChat->Error = Error; }));
+    SurrealPilotHttpTest::WaitFor([CancelledHandle]() { return CancelledHandle->IsFinished(); }, 5.0);
+    SurrealPilotHttpTest::WaitFor([]() { return false; }, 0.2);
+    TestEqual("Chat cancelled from its chunk handler should be cancelled", CancelledHandle->GetStatus(), ESurrealPilotRequestStatus::Cancelled);
+    TestEqual("No chunk should follow the cancel", CancelledChat->Chunks.Num(), 1);
+    TestEqual("The cancelled request should leave the channel", Channel.GetPendingCount(), 0);
+
+    // A chunk handler that sends another request over the same channel
+    TSharedRef<FChatResult> OuterChat = MakeShared<FChatResult>();
+    TSharedRef<FChatResult> InnerChat = MakeShared<FChatResult>();
+    TSharedRef<FSurrealPilotRequestHandle> InnerHandle = MakeShared<FSurrealPilotRequestHandle>();
+    FSurrealPilotRequestHandle OuterHandle = HttpClient.SendChatRequest(MakeMessages(), TEXT("openai"), nullptr,
+        FOnStreamingChunk::CreateLambda([OuterChat, InnerHandle, &SendChat, InnerChat](const FString& Chunk)
+        {
+            OuterChat->Chunks.Add(Chunk);
+            if (!InnerHandle->IsValid())
             {
-                UE_LOG(LogTemp, Warning, TEXT("Providers endpoint test - FAILED: Status %d, Response: %s"), StatusCode, *Response);
+                *InnerHandle = SendChat(InnerChat);
             }
-        }));
+        }),
+        FOnHttpError::CreateLambda([OuterChat](const FString& Error) { OuterChat->Error = Error; }));
+    SurrealPilotHttpTest::WaitFor([&OuterHandle, InnerHandle]() { return OuterHandle.IsFinished() && InnerHandle->IsFinished(); }, 5.0);
+    TestEqual("Chat that sends from its chunk handler should succeed", OuterHandle.GetStatus(), ESurrealPilotRequestStatus::Succeeded);
+    TestEqual("It should still get every event", FString::Join(OuterChat->Chunks, TEXT("|")), FString::Join(Events, TEXT("|")));
+    TestEqual("The request sent from the handler should succeed", InnerHandle->GetStatus(), ESurrealPilotRequestStatus::Succeeded);
+    TestEqual("The request sent from the handler should get every event", FString::Join(InnerChat->Chunks, TEXT("|")), FString::Join(Events, TEXT("|")));
+    TestEqual("Every chat so far should have gone over the channel", Server.GetChannelRequestCount(), 4);
+
+    // Context gets its JSON response back the same way as over HTTP
+    Server.SetContextResponseBody(TEXT("{\"status\":\"received\",\"suggestions\":3}"));
+    TSharedRef<int32> Suggestions = MakeShared<int32>(0);
+    TSharedPtr<FJsonObject> ContextData = MakeShareable(new FJsonObject);
+    ContextData->SetStringField(TEXT("blueprint"), TEXT("BP_Player"));
+    FSurrealPilotRequestHandle ContextHandle = HttpClient.SendContextRequest(TEXT("blueprint"), ContextData,
+        FOnHttpResponse::CreateLambda([Suggestions](TSharedPtr<FJsonObject> Response) { *Suggestions = Response->GetIntegerField(TEXT("suggestions")); }),
+        FOnHttpError());
+    SurrealPilotHttpTest::WaitFor([&ContextHandle]() { return ContextHandle.IsFinished(); }, 5.0);
+    TestEqual("Context response should reach the caller", *Suggestions, 3);
+    TestEqual("Context should go over the channel", Server.GetChannelRequestCount(), 5);
+
+    // Messages the server pushes arrive without a request
+    TSharedRef<FString> PushedValue = MakeShared<FString>();
+    FDelegateHandle PushHandle = HttpClient.OnServerPush().AddLambda([PushedValue](const FString& Type, const TSharedPtr<FJsonObject>& Body)
+    {
+        if (Type == TEXT("test_push") && Body.IsValid())
+        {
+            *PushedValue = Body->GetStringField(TEXT("value"));
+        }
+    });
+    TSharedRef<FJsonObject> PushBody = MakeShared<FJsonObject>();
+    PushBody->SetStringField(TEXT("value"), TEXT("pushed"));
+    TestEqual("Push should reach the open channel", Server.PushToChannels(TEXT("test_push"), PushBody), 1);
+    SurrealPilotHttpTest::WaitFor([PushedValue]() { return !PushedValue->IsEmpty(); }, 5.0);
+    TestEqual("Pushed message should be delivered", *PushedValue, FString(TEXT("pushed")));
+    HttpClient.OnServerPush().Remove(PushHandle);
+
+    // A channel that drops before any event has been delivered hands the request to HTTP
+    Server.SetChatFirstEventDelay(0.5f);
+    TSharedRef<FChatResult> DroppedChat = MakeShared<FChatResult>();
+    FSurrealPilotRequestHandle DroppedHandle = SendChat(DroppedChat);
+    SurrealPilotHttpTest::WaitFor([&Server]() { return Server.GetChannelRequestCount() == 6; }, 5.0);
+    Server.CloseChannels();
+    SurrealPilotHttpTest::WaitFor([&DroppedHandle]() { return DroppedHandle.IsFinished(); }, 10.0);
+    TestEqual("Dropped chat should succeed over HTTP", DroppedHandle.GetStatus(), ESurrealPilotRequestStatus::Succeeded);
+    TestEqual("Dropped chat should deliver every event once", FString::Join(DroppedChat->Chunks, TEXT("|")), FString::Join(Events, TEXT("|")));
+    TestEqual("Dropped chat should fall back to HTTP", Channel.GetStats().HttpFallbacks - StartStats.HttpFallbacks, 1);
+    Server.SetChatFirstEventDelay(0.0f);
+
+    // The channel comes back by itself
+    TestTrue("Channel should reconnect", SurrealPilotHttpTest::WaitFor([&Channel]() { return Channel.IsConnected(); }, 10.0));
+    TestTrue("Reconnect should be a new connection", Channel.GetStats().Connects - StartStats.Connects >= 2);
+
+    // A server without the channel is still reached over HTTP
+    Server.SetAcceptsWebSockets(false);
+    Server.CloseChannels();
+    SurrealPilotHttpTest::WaitFor([&Channel]() { return !Channel.IsConnected(); }, 5.0);
+    const int32 ChannelRequests = Server.GetChannelRequestCount();
+    TSharedRef<FChatResult> HttpChat = MakeShared<FChatResult>();
+    FSurrealPilotRequestHandle HttpHandle = SendChat(HttpChat);
+    SurrealPilotHttpTest::WaitFor([&HttpHandle]() { return HttpHandle.IsFinished(); }, 5.0);
+    TestEqual("Chat should succeed over HTTP while the channel is down", HttpHandle.GetStatus(), ESurrealPilotRequestStatus::Succeeded);
+    TestEqual("Chat should not use the channel while it is down", Server.GetChannelRequestCount(), ChannelRequests);
+
+    Settings->bEnableWebSocketChannel = bPreviousChannel;
+    Server.SetContextResponseBody(FString());
+    HttpClient.SetBaseUrlOverride(FString());
+    HttpClient.RefreshChannel();
+    Server.Stop();
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientChannelLatencyTest, "SurrealPilot.HttpClient.ChannelLatency", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientChannelLatencyTest::RunTest(const FString& Parameters)
+{
+    // -SurrealPilotChannelIterations=N on the command line takes more samples
+    int32 Iterations = 50;
+    FParse::Value(FCommandLine::Get(), TEXT("SurrealPilotChannelIterations="), Iterations);
+    Iterations = FMath::Max(1, Iterations);
+
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    TArray<FString> Events;
+    for (int32 Index = 0; Index < 5; ++Index)
+    {
+        Events.Add(FString::Printf(TEXT("{\"content\":\"token %d\"}"), Index));
+    }
+    Server.SetChatEvents(Events, 0.0f);
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const bool bPreviousChannel = Settings->bEnableWebSocketChannel;
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+    HttpClient.ResetMetrics();
+
+    // One request at a time, so what is measured is round-trip latency rather than throughput
+    auto RunRoundTrips = [&HttpClient, Iterations]()
+    {
+        int32 Succeeded = 0;
+        for (int32 Index = 0; Index < Iterations; ++Index)
+        {
+            TArray<TSharedPtr<FJsonObject>> Messages;
+            TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+            UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+            UserMessage->SetStringField(TEXT("content"), FString::Printf(TEXT("Latency sample %d"), Index));
+            Messages.Add(UserMessage);
+            FSurrealPilotRequestHandle Chat = HttpClient.SendChatRequest(Messages);
+            SurrealPilotHttpTest::WaitFor([&Chat]() { return Chat.IsFinished(); }, 5.0);
+
+            TSharedPtr<FJsonObject> ContextData = MakeShareable(new FJsonObject);
+            ContextData->SetNumberField(TEXT("sample"), Index);
+            FSurrealPilotRequestHandle Context = HttpClient.SendContextRequest(TEXT("scene"), ContextData, FOnHttpResponse(), FOnHttpError());
+            SurrealPilotHttpTest::WaitFor([&Context]() { return Context.IsFinished(); }, 5.0);
+
+            Succeeded += Chat.GetStatus() == ESurrealPilotRequestStatus::Succeeded && Context.GetStatus() == ESurrealPilotRequestStatus::Succeeded;
+        }
+        return Succeeded;
+    };
+
+    Settings->bEnableWebSocketChannel = false;
+    HttpClient.RefreshChannel();
+    const int32 HttpSucceeded = RunRoundTrips();
+
+    Settings->bEnableWebSocketChannel = true;
+    HttpClient.RefreshChannel();
+    const FSurrealPilotWebSocketChannel& Channel = HttpClient.GetChannel();
+    const bool bConnected = SurrealPilotHttpTest::WaitFor([&Channel]() { return Channel.IsConnected(); }, 5.0);
+    const int32 ChannelSucceeded = bConnected ? RunRoundTrips() : 0;
+
+    const FString HttpBaseUrl = Server.GetBaseUrl();
+    const FString ChannelBaseUrl = FSurrealPilotWebSocketChannel::MakeChannelUrl(HttpBaseUrl).LeftChop(FCString::Strlen(FSurrealPilotWebSocketChannel::ChannelPath));
+    Settings->bEnableWebSocketChannel = bPreviousChannel;
+    HttpClient.SetBaseUrlOverride(FString());
+    HttpClient.RefreshChannel();
+    Server.Stop();
+
+    TestTrue("Channel should connect", bConnected);
+    TestEqual("Every HTTP round trip should succeed", HttpSucceeded, Iterations);
+    TestEqual("Every channel round trip should succeed", ChannelSucceeded, Iterations);
+
+    for (const TCHAR* Route : { TEXT("/api/chat"), TEXT("/api/context") })
+    {
+        const FString Provider = FString(Route) == TEXT("/api/chat") ? TEXT("openai") : FString();
+        const FSurrealPilotEndpointMetrics* Http = HttpClient.GetMetrics().Find(HttpBaseUrl, Route, Provider);
+        const FSurrealPilotEndpointMetrics* OverChannel = HttpClient.GetMetrics().Find(ChannelBaseUrl, Route, Provider);
+        if (!TestNotNull("HTTP metrics should be recorded", Http) || !TestNotNull("Channel metrics should be recorded", OverChannel))
+        {
+            return false;
+        }
+
+        AddInfo(FString::Printf(TEXT("%s over HTTP: total ms p50 %.2f, p95 %.2f; first byte ms p50 %.2f"), Route,
+            Http->TotalMs.GetPercentile(50.0), Http->TotalMs.GetPercentile(95.0), Http->FirstByteMs.GetPercentile(50.0)));
+        AddInfo(FString::Printf(TEXT("%s over the channel: total ms p50 %.2f, p95 %.2f; first frame ms p50 %.2f"), Route,
+            OverChannel->TotalMs.GetPercentile(50.0), OverChannel->TotalMs.GetPercentile(95.0), OverChannel->FirstByteMs.GetPercentile(50.0)));
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientOfflineJournalTest, "SurrealPilot.HttpClient.OfflineJournal", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientOfflineJournalTest::RunTest(const FString& Parameters)
+{
+    // Start once for a free port, then take the desktop app away
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
     }
+    const int32 Port = Server.GetPort();
+    const FString BaseUrl = Server.GetBaseUrl();
+    Server.Stop();
+
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const bool bPreviousBatching = Settings->bBatchContextUploads;
+    const float PreviousWindow = Settings->ContextBatchWindowSeconds;
+    const int32 PreviousMaxItems = Settings->ContextBatchMaxItems;
+    const int32 PreviousMaxRetries = Settings->MaxRequestRetries;
+    const bool bPreviousJournal = Settings->bEnableOfflineContextJournal;
+    Settings->bBatchContextUploads = true;
+    Settings->ContextBatchWindowSeconds = 0.05f;
+    Settings->ContextBatchMaxItems = 50;
+    Settings->MaxRequestRetries = 0;
+    Settings->bEnableOfflineContextJournal = true;
+
+    const FString JournalPath = FPaths::ProjectSavedDir() / TEXT("Automation") / TEXT("SurrealPilot") / TEXT("HttpClientOfflineJournal.jsonl");
+    IFileManager::Get().Delete(*JournalPath, false, false, true);
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(BaseUrl);
+    HttpClient.SetContextJournalPath(JournalPath);
+    const FSurrealPilotContextJournal& Journal = HttpClient.GetContextJournal();
+
+    // Two bursts of edits to the same 10 lights while the desktop app is away
+    const int32 LightCount = 10;
+    auto SendBurst = [&HttpClient, LightCount](int32 Burst)
+    {
+        for (int32 Index = 0; Index < LightCount; ++Index)
+        {
+            const FString PropertyPath = FString::Printf(TEXT("/Game/Maps/Main.Main:PersistentLevel.PointLight_%d.Intensity"), Index);
+            TSharedPtr<FJsonObject> Notification = MakeShareable(new FJsonObject);
+            Notification->SetStringField(TEXT("type"), TEXT("property_changed"));
+            Notification->SetStringField(TEXT("property_path"), PropertyPath);
+            Notification->SetStringField(TEXT("new_value"), FString::FromInt(Burst * 100 + Index));
+            HttpClient.QueueContext(TEXT("notification"), Notification, TEXT("property_changed:") + PropertyPath);
+        }
+        HttpClient.FlushQueuedContext();
+    };
+
+    SendBurst(0);
+    TestTrue("Context the endpoint could not take should be journaled", SurrealPilotHttpTest::WaitFor([&Journal, LightCount]() { return Journal.Num() == LightCount; }, 10.0));
 
-    /**
-     * Test chat request with sample data
-     */
-    static void TestChatRequest()
+    // Later edits queue behind the journal, replacing what they supersede
+    SendBurst(1);
+    TSharedPtr<FJsonObject> PatchNotification = MakeShareable(new FJsonObject);
+    PatchNotification->SetStringField(TEXT("type"), TEXT("patch_applied"));
+    HttpClient.QueueContext(TEXT("notification"), PatchNotification, FString(), ESurrealPilotRequestPriority::PatchFeedback);
+    TestEqual("Newer edits should supersede journaled ones", Journal.Num(), LightCount + 1);
+    TestTrue("Superseded journal entries should be counted", Journal.GetStats().Superseded >= LightCount);
+
+    // The desktop app comes back on the same port: everything goes out in one batch, in order
+    if (TestTrue("Stand-in server should restart", Server.Start(Port)))
     {
-        USurrealPilotHttpClient* HttpClient = USurrealPilotHttpClient::Get();
-        if (!HttpClient)
+        const int32 RequestsBefore = Server.GetRequestCount();
+        TestTrue("The journal should be delivered once the endpoint is back", SurrealPilotHttpTest::WaitFor([&HttpClient, &Journal]()
+        {
+            HttpClient.ReplayContextJournal();
+            return Journal.IsEmpty();
+        }, 10.0));
+        TestEqual("The journal should be replayed in one request", Server.GetRequestCount() - RequestsBefore, 1);
+
+        const TArray<uint8> BatchBody = Server.GetLastRequestBody();
+        FUTF8ToTCHAR BatchText(reinterpret_cast<const ANSICHAR*>(BatchBody.GetData()), BatchBody.Num());
+        TSharedPtr<FJsonObject> Batch;
+        FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(BatchText.Length(), BatchText.Get())), Batch);
+        const TArray<TSharedPtr<FJsonValue>>* Items = nullptr;
+        if (TestTrue("Replay should carry an items array", Batch.IsValid() && Batch->TryGetArrayField(TEXT("items"), Items)) &&
+            TestEqual("Replay should carry each light once plus the patch result", Items->Num(), LightCount + 1))
         {
-            UE_LOG(LogTemp, Error, TEXT("HttpClient not available"));
-            return;
+            TArray<FString> Values;
+            for (const TSharedPtr<FJsonValue>& Item : *Items)
+            {
+                const TSharedPtr<FJsonObject> Data = Item->AsObject()->GetObjectField(TEXT("data"));
+                Values.Add(Data->HasField(TEXT("new_value")) ? Data->GetStringField(TEXT("new_value")) : Data->GetStringField(TEXT("type")));
+            }
+            TestEqual("Replay should keep the order the edits were made in",
+                FString::Join(Values, TEXT("|")), FString(TEXT("100|101|102|103|104|105|106|107|108|109|patch_applied")));
         }
+    }
+
+    const FSurrealPilotJournalStats& JournalStats = Journal.GetStats();
+    AddInfo(FString::Printf(TEXT("Offline journal: %d appended, %d superseded, %d delivered, %d disk writes (%lld bytes), %d compactions"),
+        JournalStats.Appended, JournalStats.Superseded, JournalStats.Delivered, JournalStats.DiskWrites, JournalStats.BytesWritten, JournalStats.Compactions));
+
+    Settings->bBatchContextUploads = bPreviousBatching;
+    Settings->ContextBatchWindowSeconds = PreviousWindow;
+    Settings->ContextBatchMaxItems = PreviousMaxItems;
+    Settings->MaxRequestRetries = PreviousMaxRetries;
+    Settings->bEnableOfflineContextJournal = bPreviousJournal;
+    HttpClient.SetContextJournalPath(FString());
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+    IFileManager::Get().Delete(*JournalPath, false, false, true);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientResponseCacheTest, "SurrealPilot.HttpClient.ResponseCache", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientResponseCacheTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    // A slow provider: the answer takes about a second to stream
+    TArray<FString> Events;
+    Events.Add(TEXT("{\"content\":\"Use\"}"));
+    Events.Add(TEXT("{\"content\":\" a Timeline\"}"));
+    Events.Add(TEXT("{\"content\":\" node\"}"));
+    Server.SetChatEvents(Events, 0.3f);
+
+    // Memory only, so the test neither reads nor leaves answers in the project's cache directory
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const bool bPreviousCache = Settings->bEnableResponseCache;
+    const int32 PreviousDiskMB = Settings->ResponseCacheDiskMB;
+    Settings->bEnableResponseCache = true;
+    Settings->ResponseCacheDiskMB = 0;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+    HttpClient.ClearResponseCache();
+    const FSurrealPilotResponseCacheStats StatsBefore = HttpClient.GetResponseCache().GetStats();
 
-        UE_LOG(LogTemp, Log, TEXT("Testing chat request..."));
+    struct FStreamResult
+    {
+        TArray<FString> Chunks;
+        FString Error;
+        double Seconds = 0.0;
+    };
+
+    auto SendChat = [this, &HttpClient, &Events](const FString& Question)
+    {
+        TSharedRef<FStreamResult> Result = MakeShared<FStreamResult>();
 
-        TArray<FString> Messages;
-        Messages.Add(TEXT("Hello, I'm working on a Blueprint and need help"));
-        Messages.Add(TEXT("Can you help me create a simple health system?"));
+        TArray<TSharedPtr<FJsonObject>> Messages;
+        TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+        UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+        UserMessage->SetStringField(TEXT("content"), Question);
+        Messages.Add(UserMessage);
 
-        FString Context = TEXT(R"({
-            "blueprint": "/Game/Characters/PlayerCharacter",
-            "selection": "HealthVariable",
-            "errors": []
-        })");
+        TSharedPtr<FJsonObject> Context = MakeShareable(new FJsonObject);
+        Context->SetStringField(TEXT("blueprint"), TEXT("/Game/Blueprints/BP_Door"));
 
-        HttpClient->SendChatRequest(
+        const double StartTime = FPlatformTime::Seconds();
+        HttpClient.SendChatRequest(
             Messages,
             TEXT("openai"),
             Context,
-            false, // Non-streaming for test
-            FOnHttpResponse::CreateLambda([](bool bSuccess, const FString& Response, int32 StatusCode)
+            FOnStreamingChunk::CreateLambda([Result](const FString& Chunk)
             {
-                if (bSuccess)
-                {
-                    UE_LOG(LogTemp, Log, TEXT("Chat request test - SUCCESS: %s"), *Response);
-                }
-                else
-                {
-                    UE_LOG(LogTemp, Warning, TEXT("Chat request test - FAILED: Status %d, Response: %s"), StatusCode, *Response);
-                    
-                    // Handle specific error cases
-                    if (StatusCode == 401)
-                    {
-                        FSurrealPilotErrorHandler::HandleHttpError(401, Response);
-                    }
-                    else if (StatusCode == 402)
-                    {
-                        FSurrealPilotErrorHandler::HandleHttpError(402, Response);
-                    }
-                    else if (StatusCode == 503)
-                    {
-                        FSurrealPilotErrorHandler::HandleHttpError(503, Response);
-                    }
-                }
+                Result->Chunks.Add(Chunk);
+            }),
+            FOnHttpError::CreateLambda([Result](const FString& Error)
+            {
+                Result->Error = Error;
             })
         );
+
+        const int32 ExpectedChunks = Events.Num();
+        TestTrue(FString::Printf(TEXT("\"%s\" should be answered before the timeout"), *Question), SurrealPilotHttpTest::WaitFor([Result, ExpectedChunks]()
+        {
+            return !Result->Error.IsEmpty() || Result->Chunks.Num() >= ExpectedChunks;
+        }, 10.0));
+        Result->Seconds = FPlatformTime::Seconds() - StartTime;
+        TestTrue(FString::Printf(TEXT("Chat should not fail (%s)"), *Result->Error), Result->Error.IsEmpty());
+        return Result;
+    };
+
+    const TSharedRef<FStreamResult> First = SendChat(TEXT("How do I animate a door opening?"));
+    TestTrue("The streamed answer should be recorded", SurrealPilotHttpTest::WaitFor([&HttpClient, &StatsBefore]()
+    {
+        return HttpClient.GetResponseCache().GetStats().Stores > StatsBefore.Stores;
+    }, 5.0));
+
+    // The same question about the same Blueprint is answered without the provider
+    const int32 RequestsBefore = Server.GetRequestCount();
+    const TSharedRef<FStreamResult> Second = SendChat(TEXT("How do I animate a door opening?"));
+    TestEqual("A cache hit should not reach the server", Server.GetRequestCount(), RequestsBefore);
+    TestEqual("A cache hit should replay the same chunks", FString::Join(Second->Chunks, TEXT("|")), FString::Join(First->Chunks, TEXT("|")));
+    TestTrue("A cache hit should not wait for the provider's pacing", Second->Seconds < First->Seconds / 2.0);
+
+    // Another question still goes to the provider
+    SendChat(TEXT("How do I animate a door closing?"));
+    TestTrue("A different question should reach the server", Server.GetRequestCount() > RequestsBefore);
+
+    const FSurrealPilotResponseCacheStats& Stats = HttpClient.GetResponseCache().GetStats();
+    TestEqual("Exactly one lookup should hit", Stats.MemoryHits + Stats.DiskHits - StatsBefore.MemoryHits - StatsBefore.DiskHits, 1);
+    AddInfo(FString::Printf(TEXT("Response cache: %.0f%% hit rate, first answer %.2fs, cached answer %.3fs, %.2fs of provider latency saved"),
+        Stats.GetHitRate() * 100.0, First->Seconds, Second->Seconds, Stats.SavedSeconds - StatsBefore.SavedSeconds));
+
+    HttpClient.ClearResponseCache();
+    Settings->bEnableResponseCache = bPreviousCache;
+    Settings->ResponseCacheDiskMB = PreviousDiskMB;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientChatJobsTest, "SurrealPilot.HttpClient.ChatJobs", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientChatJobsTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
+    }
+
+    TArray<FString> Events;
+    Events.Add(TEXT("{\"content\":\"Add\"}"));
+    Events.Add(TEXT("{\"content\":\" a Box\"}"));
+    Events.Add(TEXT("{\"content\":\" Collision\"}"));
+    Events.Add(TEXT("{\"content\":\" component\"}"));
+    Server.SetChatEvents(Events, 0.2f);
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+
+    // Several external tools asking at once, each with its own question
+    FSurrealPilotChatJobs Jobs;
+    const int32 JobCount = 4;
+    TArray<FString> JobIds;
+    for (int32 Index = 0; Index < JobCount; ++Index)
+    {
+        TArray<TSharedPtr<FJsonObject>> Messages;
+        TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+        UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+        UserMessage->SetStringField(TEXT("content"), FString::Printf(TEXT("How do I detect overlaps on actor %d?"), Index));
+        Messages.Add(UserMessage);
+        JobIds.Add(Jobs.Start(Messages, TEXT("openai"), nullptr));
     }
+    TestEqual("Every job should be running at once", Jobs.GetRunningCount(), JobCount);
 
-    /**
-     * Test streaming chat request
-     */
-    static void TestStreamingRequest()
+    // Poll each job with its cursor, as a Remote Control client would, until every job has finished
+    TArray<TArray<FString>> Received;
+    TArray<int32> Cursors;
+    TArray<FString> Statuses;
+    Received.SetNum(JobCount);
+    Cursors.Init(0, JobCount);
+    Statuses.Init(TEXT("running"), JobCount);
+    int32 Polls = 0;
+    bool bSawPartialAnswer = false;
+    const bool bFinished = SurrealPilotHttpTest::WaitFor([&]()
     {
-        USurrealPilotHttpClient* HttpClient = USurrealPilotHttpClient::Get();
-        if (!HttpClient)
+        bool bAllFinished = true;
+        for (int32 Index = 0; Index < JobCount; ++Index)
         {
-            UE_LOG(LogTemp, Error, TEXT("HttpClient not available"));
-            return;
+            TSharedPtr<FJsonObject> Poll = Jobs.Poll(JobIds[Index], Cursors[Index]);
+            if (!Poll.IsValid())
+            {
+                return true;
+            }
+            ++Polls;
+            for (const TSharedPtr<FJsonValue>& Chunk : Poll->GetArrayField(TEXT("chunks")))
+            {
+                Received[Index].Add(Chunk->AsString());
+            }
+            Cursors[Index] = static_cast<int32>(Poll->GetNumberField(TEXT("next")));
+            Statuses[Index] = Poll->GetStringField(TEXT("status"));
+            bSawPartialAnswer |= Statuses[Index] == TEXT("running") && Cursors[Index] > 0;
+            bAllFinished &= Statuses[Index] != TEXT("running");
         }
+        return bAllFinished;
+    }, 10.0);
 
-        UE_LOG(LogTemp, Log, TEXT("Testing streaming chat request..."));
+    TestTrue("Every job should finish before the timeout", bFinished);
+    TestTrue("Chunks should be readable while the answer is still streaming", bSawPartialAnswer);
+    for (int32 Index = 0; Index < JobCount; ++Index)
+    {
+        TestEqual(FString::Printf(TEXT("Job %d should succeed"), Index), Statuses[Index], FString(TEXT("succeeded")));
+        TestEqual(FString::Printf(TEXT("Job %d should get each chunk once, in order"), Index),
+            FString::Join(Received[Index], TEXT("|")), FString::Join(Events, TEXT("|")));
+    }
+    AddInfo(FString::Printf(TEXT("%d concurrent chat jobs answered over %d polls"), JobCount, Polls));
 
-        TArray<FString> Messages;
-        Messages.Add(TEXT("Explain how to create a Blueprint function that calculates damage"));
+    // A finished job can be read again from the start
+    TSharedPtr<FJsonObject> Repeat = Jobs.Poll(JobIds[0], 0);
+    TestTrue("A finished job should keep its whole answer", Repeat.IsValid() && Repeat->GetArrayField(TEXT("chunks")).Num() == Events.Num());
+    TestFalse("An unknown job should not be found", Jobs.Poll(TEXT("no-such-job"), 0).IsValid());
 
-        HttpClient->SendChatRequest(
-            Messages,
-            TEXT("openai"),
-            TEXT("{}"),
-            true, // Streaming enabled
-            FOnHttpResponse::CreateLambda([](bool bSuccess, const FString& Response, int32 StatusCode)
-            {
-                if (bSuccess)
-                {
-                    UE_LOG(LogTemp, Log, TEXT("Streaming chunk received: %s"), *Response);
-                }
-                else
-                {
-                    UE_LOG(LogTemp, Warning, TEXT("Streaming request failed: Status %d, Response: %s"), StatusCode, *Response);
-                }
-            })
-        );
+    // A cancelled job stops taking chunks
+    TArray<TSharedPtr<FJsonObject>> Messages;
+    TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
+    UserMessage->SetStringField(TEXT("role"), TEXT("user"));
+    UserMessage->SetStringField(TEXT("content"), TEXT("Never mind"));
+    Messages.Add(UserMessage);
+    const FString CancelledId = Jobs.Start(Messages, TEXT("openai"), nullptr);
+    TestTrue("A running job should cancel", Jobs.Cancel(CancelledId));
+    TestFalse("A finished job should not cancel again", Jobs.Cancel(CancelledId));
+    SurrealPilotHttpTest::WaitFor([]() { return false; }, 1.0);
+    TSharedPtr<FJsonObject> Cancelled = Jobs.Poll(CancelledId, 0);
+    TestTrue("A cancelled job should report it", Cancelled.IsValid() && Cancelled->GetStringField(TEXT("status")) == TEXT("cancelled"));
+    TestEqual("No job should still be running", Jobs.GetRunningCount(), 0);
+
+    // Finished jobs are forgotten once their retention passes
+    Jobs.SetRetentionSeconds(0.0);
+    FPlatformProcess::Sleep(0.01f);
+    TestEqual("Expired jobs should be dropped", Jobs.List()->GetArrayField(TEXT("jobs")).Num(), 0);
+
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHttpClientRemoteChatCacheTest, "SurrealPilot.HttpClient.RemoteChatResponseCache", 
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHttpClientRemoteChatCacheTest::RunTest(const FString& Parameters)
+{
+    URemoteControlIntegration* RemoteControl = URemoteControlIntegration::Get();
+    if (!TestNotNull("Remote Control integration should be available", RemoteControl))
+    {
+        return false;
+    }
+
+    FSurrealPilotStandInServer Server;
+    if (!TestTrue("Stand-in server should start", Server.Start()))
+    {
+        return false;
     }
 
-    /**
-     * Test assist endpoint
-     */
-    static void TestAssistRequest()
+    TArray<FString> Events;
+    Events.Add(TEXT("{\"content\":\"Use\"}"));
+    Events.Add(TEXT("{\"content\":\" a Timeline\"}"));
+    Server.SetChatEvents(Events, 0.1f);
+
+    // Memory only, so the test neither reads nor leaves answers in the project's cache directory
+    USurrealPilotSettings* Settings = GetMutableDefault<USurrealPilotSettings>();
+    const bool bPreviousCache = Settings->bEnableResponseCache;
+    const int32 PreviousDiskMB = Settings->ResponseCacheDiskMB;
+    Settings->bEnableResponseCache = true;
+    Settings->ResponseCacheDiskMB = 0;
+
+    FHttpClient& HttpClient = FHttpClient::Get();
+    HttpClient.SetBaseUrlOverride(Server.GetBaseUrl());
+    HttpClient.ClearResponseCache();
+    const FSurrealPilotResponseCacheStats StatsBefore = HttpClient.GetResponseCache().GetStats();
+
+    // Ask through Remote Control, as an external tool would, and poll the job until it is done
+    auto Ask = [this, RemoteControl]()
     {
-        USurrealPilotHttpClient* HttpClient = USurrealPilotHttpClient::Get();
-        if (!HttpClient)
+        TSharedPtr<FJsonObject> Job;
+        TSharedRef<TJsonReader<>> JobReader = TJsonReaderFactory<>::Create(RemoteControl->HandleChatRequest(TEXT("How do I animate a door opening?"), TEXT("openai")));
+        FString Status;
+        if (FJsonSerializer::Deserialize(JobReader, Job) && Job.IsValid())
         {
-            UE_LOG(LogTemp, Error, TEXT("HttpClient not available"));
-            return;
+            const FString JobId = Job->GetStringField(TEXT("job_id"));
+            SurrealPilotHttpTest::WaitFor([RemoteControl, &JobId, &Status]()
+            {
+                TSharedPtr<FJsonObject> Poll;
+                TSharedRef<TJsonReader<>> PollReader = TJsonReaderFactory<>::Create(RemoteControl->PollChatJob(JobId, 0));
+                Status = FJsonSerializer::Deserialize(PollReader, Poll) && Poll.IsValid() ? Poll->GetStringField(TEXT("status")) : FString();
+                return Status != TEXT("running");
+            }, 10.0);
         }
+        TestEqual("The chat job should succeed", Status, FString(TEXT("succeeded")));
+    };
 
-        UE_LOG(LogTemp, Log, TEXT("Testing assist request..."));
+    Ask();
+    TestTrue("The streamed answer should be recorded", SurrealPilotHttpTest::WaitFor([&HttpClient, &StatsBefore]()
+    {
+        return HttpClient.GetResponseCache().GetStats().Stores > StatsBefore.Stores;
+    }, 5.0));
 
-        HttpClient->SendAssistRequest(
-            TEXT("anthropic"),
-            FOnHttpResponse::CreateLambda([](bool bSuccess, const FString& Response, int32 StatusCode)
-            {
-                if (bSuccess)
-                {
-                    UE_LOG(LogTemp, Log, TEXT("Assist request test - SUCCESS: %s"), *Response);
-                }
-                else
-                {
-                    UE_LOG(LogTemp, Warning, TEXT("Assist request test - FAILED: Status %d, Response: %s"), StatusCode, *Response);
-                }
-            })
-        );
-    }
-};
-
-// Console commands
-static FAutoConsoleCommand TestLocalConnectionCommand(
-    TEXT("SurrealPilot.TestConnection"),
-    TEXT("Test connection to local SurrealPilot server"),
-    FConsoleCommandDelegate::CreateStatic(&FHttpClientTestCommands::TestLocalConnection)
-);
-
-static FAutoConsoleCommand TestChatRequestCommand(
-    TEXT("SurrealPilot.TestChat"),
-    TEXT("Test chat request to SurrealPilot API"),
-    FConsoleCommandDelegate::CreateStatic(&FHttpClientTestCommands::TestChatRequest)
-);
-
-static FAutoConsoleCommand TestStreamingRequestCommand(
-    TEXT("SurrealPilot.TestStreaming"),
-    TEXT("Test streaming chat request"),
-    FConsoleCommandDelegate::CreateStatic(&FHttpClientTestCommands::TestStreamingRequest)
-);
-
-static FAutoConsoleCommand TestAssistRequestCommand(
-    TEXT("SurrealPilot.TestAssist"),
-    TEXT("Test assist request"),
-    FConsoleCommandDelegate::CreateStatic(&FHttpClientTestCommands::TestAssistRequest)
-);
\ No newline at end of file
+    // The context is stamped with the time on every request; a later second must not make it a different context
+    FPlatformProcess::Sleep(1.1f);
+    const int32 RequestsBefore = Server.GetRequestCount();
+    Ask();
+    TestEqual("The same question about the same editor state should not reach the server", Server.GetRequestCount(), RequestsBefore);
+
+    const FSurrealPilotResponseCacheStats& Stats = HttpClient.GetResponseCache().GetStats();
+    TestEqual("The second request should hit the cache", Stats.MemoryHits + Stats.DiskHits - StatsBefore.MemoryHits - StatsBefore.DiskHits, 1);
+
+    HttpClient.ClearResponseCache();
+    Settings->bEnableResponseCache = bPreviousCache;
+    Settings->ResponseCacheDiskMB = PreviousDiskMB;
+    HttpClient.SetBaseUrlOverride(FString());
+    Server.Stop();
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -18,6 +18,17 @@
 #include "RemoteControlPreset.h"
 #include "RemoteControlBinding.h"
 
+namespace SurrealPilotRemoteControl
+{
+    FString ToJsonString(const TSharedPtr<FJsonObject>& Object)
+    {
+        FString JsonString;
+        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+        FJsonSerializer::Serialize(Object.ToSharedRef(), Writer);
+        return JsonString;
+    }
+}
+
 void URemoteControlIntegration::Initialize(FSubsystemCollectionBase& Collection)
 {
     Super::Initialize(Collection);
@@ -30,11 +41,24 @@ void URemoteControlIntegration::Initialize(FSubsystemCollectionBase& Collection)
     // Test desktop chat connection
     TestDesktopChatConnection();
     
+    // Patches the desktop app pushes arrive without the editor having to ask for them
+    if (FHttpClient::IsAvailable())
+    {
+        ServerPushHandle = FHttpClient::Get().OnServerPush().AddUObject(this, &URemoteControlIntegration::OnServerPush);
+    }
+    
     UE_LOG(LogTemp, Log, TEXT("RemoteControlIntegration initialized"));
 }
 
 void URemoteControlIntegration::Deinitialize()
 {
+    if (FHttpClient::IsAvailable())
+    {
+        FHttpClient::Get().OnServerPush().Remove(ServerPushHandle);
+    }
+    ServerPushHandle.Reset();
+    ChatJobs.CancelAll();
+    
     Super::Deinitialize();
     UE_LOG(LogTemp, Log, TEXT("RemoteControlIntegration deinitialized"));
 }
@@ -68,9 +92,6 @@ FString URemoteControlIntegration::HandleChatRequest(const FString& Message, con
 {
     UE_LOG(LogTemp, Log, TEXT("Handling chat request via Remote Control: %s"), *Message);
     
-    // Send chat request to desktop application
-    FHttpClient& HttpClient = FHttpClient::Get();
-    
     // Build message array
     TArray<TSharedPtr<FJsonObject>> Messages;
     TSharedPtr<FJsonObject> UserMessage = MakeShareable(new FJsonObject);
@@ -83,32 +104,57 @@ FString URemoteControlIntegration::HandleChatRequest(const FString& Message, con
     Context->SetStringField(TEXT("source"), TEXT("ue_remote_control"));
     Context->SetStringField(TEXT("timestamp"), FDateTime::Now().ToIso8601());
     
-    // Add current UE context
+    // Add current UE context as objects rather than JSON text, so the token budget can cut it short section by
+    // section instead of keeping or dropping one long string
     UContextExporter* ContextExporter = UContextExporter::Get();
     if (ContextExporter)
     {
-        FString CurrentContext = ContextExporter->ExportSelectionContext();
-        Context->SetStringField(TEXT("ue_context"), CurrentContext);
-    }
-    
-    FString ResponseContent;
-    
-    // Send request with callbacks
-    HttpClient.SendChatRequest(
-        Messages,
-        Provider,
-        Context,
-        FHttpClient::FOnStreamingChunk::CreateLambda([&ResponseContent](const FString& Chunk)
+        FString SelectionContext = ContextExporter->ExportSelectionContext();
+        TSharedPtr<FJsonObject> SelectionJson;
+        TSharedRef<TJsonReader<>> SelectionReader = TJsonReaderFactory<>::Create(SelectionContext);
+        if (FJsonSerializer::Deserialize(SelectionReader, SelectionJson))
         {
-            ResponseContent += Chunk;
-        }),
-        FHttpClient::FOnHttpError::CreateLambda([](const FString& Error)
+            // The context carries its own timestamp, which the context hash ignores; one nested in the selection
+            // would change the hash every second and the same question would never be answered from the cache
+            SelectionJson->RemoveField(TEXT("timestamp"));
+            Context->SetObjectField(TEXT("selection"), SelectionJson);
+        }
+
+        FString SceneContext = GetSceneInfo();
+        TSharedPtr<FJsonObject> SceneJson;
+        TSharedRef<TJsonReader<>> SceneReader = TJsonReaderFactory<>::Create(SceneContext);
+        if (FJsonSerializer::Deserialize(SceneReader, SceneJson))
         {
-            UE_LOG(LogTemp, Error, TEXT("Chat request failed: %s"), *Error);
-        })
-    );
+            Context->SetObjectField(TEXT("scene"), SceneJson);
+        }
+    }
     
-    return ResponseContent;
+    // The answer streams in over several frames; the caller polls for it rather than holding the game thread
+    TSharedPtr<FJsonObject> Job = MakeShareable(new FJsonObject);
+    Job->SetStringField(TEXT("job_id"), ChatJobs.Start(Messages, Provider, Context));
+    return SurrealPilotRemoteControl::ToJsonString(Job);
+}
+
+FString URemoteControlIntegration::PollChatJob(const FString& JobId, int32 FromChunk)
+{
+    TSharedPtr<FJsonObject> Result = ChatJobs.Poll(JobId, FromChunk);
+    if (!Result.IsValid())
+    {
+        Result = MakeShareable(new FJsonObject);
+        Result->SetStringField(TEXT("job_id"), JobId);
+        Result->SetStringField(TEXT("error"), TEXT("Unknown or expired chat job"));
+    }
+    return SurrealPilotRemoteControl::ToJsonString(Result);
+}
+
+bool URemoteControlIntegration::CancelChatJob(const FString& JobId)
+{
+    return ChatJobs.Cancel(JobId);
+}
+
+FString URemoteControlIntegration::ListChatJobs()
+{
+    return SurrealPilotRemoteControl::ToJsonString(ChatJobs.List());
 }
 
 FString URemoteControlIntegration::ExportCurrentContext()
@@ -163,12 +209,27 @@ FString URemoteControlIntegration::ExportCurrentContext()
     TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ContextString);
     FJsonSerializer::Serialize(FullContext.ToSharedRef(), Writer);
     
-    // Send to desktop chat if available
-    SendContextToDesktopChat(TEXT("full_context"), FullContext);
+    // Send to desktop chat if available; only the newest full export is worth sending
+    SendContextToDesktopChat(TEXT("full_context"), FullContext, TEXT("full_context"));
     
     return ContextString;
 }
 
+void URemoteControlIntegration::OnServerPush(const FString& Type, const TSharedPtr<FJsonObject>& Body)
+{
+    if (Type != TEXT("patch") || !Body.IsValid())
+    {
+        UE_LOG(LogTemp, Verbose, TEXT("SurrealPilot: ignoring pushed message of type '%s'"), *Type);
+        return;
+    }
+    
+    // Same path as a patch sent through Remote Control, including the result sent back to the desktop app
+    FString PatchJson;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&PatchJson);
+    FJsonSerializer::Serialize(Body.ToSharedRef(), Writer);
+    ApplyPatchFromRemote(PatchJson);
+}
+
 bool URemoteControlIntegration::ApplyPatchFromRemote(const FString& PatchJson)
 {
     UPatchApplier* PatchApplier = UPatchApplier::Get();
@@ -189,7 +250,7 @@ bool URemoteControlIntegration::ApplyPatchFromRemote(const FString& PatchJson)
         Notification->SetStringField(TEXT("type"), TEXT("patch_applied"));
         Notification->SetBoolField(TEXT("success"), true);
         Notification->SetStringField(TEXT("message"), TEXT("Patch applied successfully"));
-        SendContextToDesktopChat(TEXT("notification"), Notification);
+        SendContextToDesktopChat(TEXT("notification"), Notification, FString(), ESurrealPilotRequestPriority::PatchFeedback);
     }
     else
     {
@@ -201,7 +262,7 @@ bool URemoteControlIntegration::ApplyPatchFromRemote(const FString& PatchJson)
         Notification->SetStringField(TEXT("type"), TEXT("patch_failed"));
         Notification->SetBoolField(TEXT("success"), false);
         Notification->SetStringField(TEXT("error"), Error);
-        SendContextToDesktopChat(TEXT("notification"), Notification);
+        SendContextToDesktopChat(TEXT("notification"), Notification, FString(), ESurrealPilotRequestPriority::PatchFeedback);
     }
     
     return bSuccess;
@@ -313,27 +374,40 @@ FString URemoteControlIntegration::GetCppProjectInfo()
     return CppString;
 }
 
-void URemoteControlIntegration::SendContextToDesktopChat(const FString& ContextType, const TSharedPtr<FJsonObject>& ContextData)
+FString URemoteControlIntegration::GetProjectContext(const FString& RootPath)
+{
+    UContextExporter* ContextExporter = UContextExporter::Get();
+    return ContextExporter ? ContextExporter->ExportProjectContext(RootPath) : TEXT("{}");
+}
+
+FString URemoteControlIntegration::GetHttpMetrics()
 {
-    if (!IsDesktopChatAvailable())
+    if (!FHttpClient::IsAvailable())
     {
-        return;
+        return TEXT("{}");
     }
     
-    FHttpClient& HttpClient = FHttpClient::Get();
+    FString MetricsString;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&MetricsString);
+    FJsonSerializer::Serialize(FHttpClient::Get().GetMetrics().ToJson(), Writer);
     
-    HttpClient.SendContextRequest(
-        ContextType,
-        ContextData,
-        FHttpClient::FOnHttpResponse::CreateLambda([](TSharedPtr<FJsonObject> Response)
-        {
-            UE_LOG(LogTemp, Log, TEXT("Context sent to desktop chat successfully"));
-        }),
-        FHttpClient::FOnHttpError::CreateLambda([](const FString& Error)
-        {
-            UE_LOG(LogTemp, Warning, TEXT("Failed to send context to desktop chat: %s"), *Error);
-        })
-    );
+    return MetricsString;
+}
+
+void URemoteControlIntegration::SendContextToDesktopChat(
+    const FString& ContextType,
+    const TSharedPtr<FJsonObject>& ContextData,
+    const FString& SupersedeKey,
+    ESurrealPilotRequestPriority Priority)
+{
+    if (!FHttpClient::IsAvailable())
+    {
+        return;
+    }
+    
+    // Sent even while the desktop app is away: the client journals what it cannot deliver and replays it on reconnect.
+    // Notifications are batched, so a bulk edit becomes a handful of requests
+    FHttpClient::Get().QueueContext(ContextType, ContextData, SupersedeKey, Priority);
 }
 
 bool URemoteControlIntegration::IsDesktopChatAvailable() const
@@ -357,6 +431,24 @@ void URemoteControlIntegration::CreateRemoteControlPreset()
             TEXT("HandleChatRequest")
         );
         
+        SurrealPilotPreset->ExposeFunction(
+            this,
+            URemoteControlIntegration::StaticClass()->FindFunctionByName(TEXT("PollChatJob")),
+            TEXT("PollChatJob")
+        );
+        
+        SurrealPilotPreset->ExposeFunction(
+            this,
+            URemoteControlIntegration::StaticClass()->FindFunctionByName(TEXT("CancelChatJob")),
+            TEXT("CancelChatJob")
+        );
+        
+        SurrealPilotPreset->ExposeFunction(
+            this,
+            URemoteControlIntegration::StaticClass()->FindFunctionByName(TEXT("ListChatJobs")),
+            TEXT("ListChatJobs")
+        );
+        
         SurrealPilotPreset->ExposeFunction(
             this,
             URemoteControlIntegration::StaticClass()->FindFunctionByName(TEXT("ExportCurrentContext")),
@@ -387,6 +479,18 @@ void URemoteControlIntegration::CreateRemoteControlPreset()
             TEXT("GetCppProjectInfo")
         );
         
+        SurrealPilotPreset->ExposeFunction(
+            this,
+            URemoteControlIntegration::StaticClass()->FindFunctionByName(TEXT("GetHttpMetrics")),
+            TEXT("GetHttpMetrics")
+        );
+        
+        SurrealPilotPreset->ExposeFunction(
+            this,
+            URemoteControlIntegration::StaticClass()->FindFunctionByName(TEXT("GetProjectContext")),
+            TEXT("GetProjectContext")
+        );
+        
         UE_LOG(LogTemp, Log, TEXT("Remote Control preset created for SurrealPilot"));
     }
 }
@@ -420,5 +524,6 @@ void URemoteControlIntegration::OnRemoteControlPropertyChange(const FString& Pro
     Notification->SetStringField(TEXT("property_path"), PropertyPath);
     Notification->SetStringField(TEXT("new_value"), NewValue);
     
-    SendContextToDesktopChat(TEXT("notification"), Notification);
+    // A later change to the same property replaces this one if both are still queued
+    SendContextToDesktopChat(TEXT("notification"), Notification, TEXT("property_changed:") + PropertyPath);
 }
\ No newline at end of file
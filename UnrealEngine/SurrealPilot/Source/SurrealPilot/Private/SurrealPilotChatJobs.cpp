@@ -0,0 +1,174 @@
+#include "SurrealPilotChatJobs.h"
+#include "HttpClient.h"
+#include "Dom/JsonValue.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Guid.h"
+
+FSurrealPilotChatJobs::~FSurrealPilotChatJobs()
+{
+	CancelAll();
+}
+
+const TCHAR* FSurrealPilotChatJobs::LexToString(ESurrealPilotChatJobStatus Status)
+{
+	switch (Status)
+	{
+	case ESurrealPilotChatJobStatus::Running: return TEXT("running");
+	case ESurrealPilotChatJobStatus::Succeeded: return TEXT("succeeded");
+	case ESurrealPilotChatJobStatus::Failed: return TEXT("failed");
+	case ESurrealPilotChatJobStatus::Cancelled: return TEXT("cancelled");
+	}
+	return TEXT("unknown");
+}
+
+FString FSurrealPilotChatJobs::Start(const TArray<TSharedPtr<FJsonObject>>& Messages, const FString& Provider, const TSharedPtr<FJsonObject>& Context)
+{
+	PruneFinished();
+
+	const FString JobId = FGuid::NewGuid().ToString(EGuidFormats::DigitsWithHyphensLower);
+	TSharedRef<FJob> Job = MakeShared<FJob>();
+	Jobs.Add(JobId, Job);
+
+	if (!FHttpClient::IsAvailable())
+	{
+		Job->Error = TEXT("HTTP client not available");
+		Finish(*Job, ESurrealPilotChatJobStatus::Failed);
+		return JobId;
+	}
+
+	// No conversation ID: jobs run side by side rather than cancelling each other
+	Job->Handle = FHttpClient::Get().SendChatRequest(
+		Messages,
+		Provider,
+		Context,
+		FOnStreamingChunk::CreateLambda([Job](const FString& Chunk)
+		{
+			if (Job->Status == ESurrealPilotChatJobStatus::Running)
+			{
+				Job->Chunks.Add(Chunk);
+			}
+		}),
+		FOnHttpError::CreateLambda([Job](const FString& Error)
+		{
+			if (Job->Status == ESurrealPilotChatJobStatus::Running)
+			{
+				Job->Error = Error;
+				Finish(*Job, ESurrealPilotChatJobStatus::Failed);
+			}
+		}),
+		FString(),
+		FSimpleDelegate::CreateLambda([Job]()
+		{
+			Finish(*Job, ESurrealPilotChatJobStatus::Succeeded);
+		})
+	);
+	return JobId;
+}
+
+TSharedPtr<FJsonObject> FSurrealPilotChatJobs::Poll(const FString& JobId, int32 FromChunk)
+{
+	PruneFinished();
+
+	const TSharedRef<FJob>* Found = Jobs.Find(JobId);
+	if (!Found)
+	{
+		return nullptr;
+	}
+	const FJob& Job = **Found;
+
+	TArray<TSharedPtr<FJsonValue>> Chunks;
+	for (int32 Index = FMath::Max(0, FromChunk); Index < Job.Chunks.Num(); ++Index)
+	{
+		Chunks.Add(MakeShared<FJsonValueString>(Job.Chunks[Index]));
+	}
+
+	TSharedPtr<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetStringField(TEXT("job_id"), JobId);
+	Result->SetStringField(TEXT("status"), LexToString(Job.Status));
+	Result->SetArrayField(TEXT("chunks"), Chunks);
+	Result->SetNumberField(TEXT("next"), Job.Chunks.Num());
+	if (!Job.Error.IsEmpty())
+	{
+		Result->SetStringField(TEXT("error"), Job.Error);
+	}
+	return Result;
+}
+
+bool FSurrealPilotChatJobs::Cancel(const FString& JobId)
+{
+	const TSharedRef<FJob>* Found = Jobs.Find(JobId);
+	if (!Found || (*Found)->Status != ESurrealPilotChatJobStatus::Running)
+	{
+		return false;
+	}
+
+	FJob& Job = **Found;
+	Finish(Job, ESurrealPilotChatJobStatus::Cancelled);
+	Job.Handle.Cancel();
+	return true;
+}
+
+void FSurrealPilotChatJobs::CancelAll()
+{
+	for (const TPair<FString, TSharedRef<FJob>>& Pair : Jobs)
+	{
+		if (Pair.Value->Status == ESurrealPilotChatJobStatus::Running)
+		{
+			Finish(*Pair.Value, ESurrealPilotChatJobStatus::Cancelled);
+			Pair.Value->Handle.Cancel();
+		}
+	}
+	Jobs.Reset();
+}
+
+TSharedPtr<FJsonObject> FSurrealPilotChatJobs::List()
+{
+	PruneFinished();
+
+	TArray<TSharedPtr<FJsonValue>> JobValues;
+	for (const TPair<FString, TSharedRef<FJob>>& Pair : Jobs)
+	{
+		TSharedPtr<FJsonObject> JobObject = MakeShared<FJsonObject>();
+		JobObject->SetStringField(TEXT("job_id"), Pair.Key);
+		JobObject->SetStringField(TEXT("status"), LexToString(Pair.Value->Status));
+		JobObject->SetNumberField(TEXT("chunks"), Pair.Value->Chunks.Num());
+		JobValues.Add(MakeShared<FJsonValueObject>(JobObject));
+	}
+
+	TSharedPtr<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetArrayField(TEXT("jobs"), JobValues);
+	Result->SetNumberField(TEXT("running"), GetRunningCount());
+	return Result;
+}
+
+int32 FSurrealPilotChatJobs::GetRunningCount() const
+{
+	int32 Running = 0;
+	for (const TPair<FString, TSharedRef<FJob>>& Pair : Jobs)
+	{
+		Running += Pair.Value->Status == ESurrealPilotChatJobStatus::Running ? 1 : 0;
+	}
+	return Running;
+}
+
+void FSurrealPilotChatJobs::Finish(FJob& Job, ESurrealPilotChatJobStatus Status)
+{
+	if (Job.Status == ESurrealPilotChatJobStatus::Running)
+	{
+		Job.Status = Status;
+		Job.FinishedSeconds = FPlatformTime::Seconds();
+	}
+}
+
+void FSurrealPilotChatJobs::PruneFinished()
+{
+	const double Now = FPlatformTime::Seconds();
+	for (auto It = Jobs.CreateIterator(); It; ++It)
+	{
+		const FJob& Job = *It.Value();
+		if (Job.Status != ESurrealPilotChatJobStatus::Running && Now - Job.FinishedSeconds > RetentionSeconds)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "SurrealPilotCircuitBreaker.h"
+
+FSurrealPilotCircuitBreaker::FSurrealPilotCircuitBreaker(int32 InFailureThreshold, double InCooldownSeconds)
+	: FailureThreshold(FMath::Max(1, InFailureThreshold))
+	, CooldownSeconds(FMath::Max(0.0, InCooldownSeconds))
+{
+}
+
+bool FSurrealPilotCircuitBreaker::AllowRequest(const FString& EndpointKey, double Now)
+{
+	FEndpointState* Endpoint = Endpoints.Find(EndpointKey);
+	if (!Endpoint)
+	{
+		return true;
+	}
+
+	switch (Endpoint->State)
+	{
+	case ESurrealPilotCircuitState::Open:
+		if (Now - Endpoint->OpenedAt >= CooldownSeconds)
+		{
+			// Let exactly one probe through; everything else keeps failing fast until it reports back
+			Endpoint->State = ESurrealPilotCircuitState::HalfOpen;
+			return true;
+		}
+		return false;
+
+	case ESurrealPilotCircuitState::HalfOpen:
+		return false;
+
+	case ESurrealPilotCircuitState::Closed:
+	default:
+		return true;
+	}
+}
+
+void FSurrealPilotCircuitBreaker::RecordSuccess(const FString& EndpointKey)
+{
+	if (FEndpointState* Endpoint = Endpoints.Find(EndpointKey))
+	{
+		if (Endpoint->State != ESurrealPilotCircuitState::Closed)
+		{
+			UE_LOG(LogTemp, Log, TEXT("SurrealPilot: %s is reachable again"), *EndpointKey);
+		}
+		Endpoint->State = ESurrealPilotCircuitState::Closed;
+		Endpoint->ConsecutiveFailures = 0;
+	}
+}
+
+void FSurrealPilotCircuitBreaker::RecordFailure(const FString& EndpointKey, double Now)
+{
+	FEndpointState& Endpoint = Endpoints.FindOrAdd(EndpointKey);
+	++Endpoint.ConsecutiveFailures;
+
+	// A failed probe re-opens immediately; otherwise wait for the threshold
+	if (Endpoint.State == ESurrealPilotCircuitState::HalfOpen ||
+		(Endpoint.State == ESurrealPilotCircuitState::Closed && Endpoint.ConsecutiveFailures >= FailureThreshold))
+	{
+		if (Endpoint.State == ESurrealPilotCircuitState::Closed)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: %s failed %d times in a row, failing fast for %.0f seconds"),
+				*EndpointKey, Endpoint.ConsecutiveFailures, CooldownSeconds);
+		}
+		Endpoint.State = ESurrealPilotCircuitState::Open;
+		Endpoint.OpenedAt = Now;
+	}
+}
+
+void FSurrealPilotCircuitBreaker::RecordAbandonedProbe(const FString& EndpointKey, double Now)
+{
+	FEndpointState* Endpoint = Endpoints.Find(EndpointKey);
+	if (Endpoint && Endpoint->State == ESurrealPilotCircuitState::HalfOpen)
+	{
+		Endpoint->State = ESurrealPilotCircuitState::Open;
+		Endpoint->OpenedAt = Now;
+	}
+}
+
+ESurrealPilotCircuitState FSurrealPilotCircuitBreaker::GetState(const FString& EndpointKey) const
+{
+	const FEndpointState* Endpoint = Endpoints.Find(EndpointKey);
+	return Endpoint ? Endpoint->State : ESurrealPilotCircuitState::Closed;
+}
+
+void FSurrealPilotCircuitBreaker::Configure(int32 InFailureThreshold, double InCooldownSeconds)
+{
+	FailureThreshold = FMath::Max(1, InFailureThreshold);
+	CooldownSeconds = FMath::Max(0.0, InCooldownSeconds);
+}
+
+void FSurrealPilotCircuitBreaker::Reset()
+{
+	Endpoints.Reset();
+}
\ No newline at end of file
@@ -0,0 +1,342 @@
+#include "SurrealPilotCompactBinary.h"
+#include "Memory/MemoryView.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/CompactBinary.h"
+#include "Serialization/CompactBinaryValidation.h"
+#include "Serialization/CompactBinaryWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace SurrealPilotCompactBinary
+{
+	const TCHAR* ContentType = TEXT("application/x-ue-cb");
+
+	/** Doubles with an integral value below this magnitude are written as integers */
+	constexpr double MaxExactInteger = 9007199254740992.0; // 2^53
+
+	/** Nesting beyond this is treated as malformed rather than walked, so a hostile payload cannot exhaust the stack */
+	constexpr int32 MaxDepth = 256;
+
+	FString ToString(FUtf8StringView Utf8)
+	{
+		FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Utf8.GetData()), Utf8.Len());
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	TSharedPtr<FJsonValue> ReadValue(FCbFieldView Field, int32 Depth);
+
+	TSharedPtr<FJsonObject> ReadObject(FCbObjectView Object, int32 Depth)
+	{
+		if (Depth > MaxDepth)
+		{
+			return nullptr;
+		}
+
+		TSharedPtr<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+		for (FCbFieldView Field : Object)
+		{
+			TSharedPtr<FJsonValue> Value = ReadValue(Field, Depth + 1);
+			if (!Value.IsValid())
+			{
+				return nullptr;
+			}
+			JsonObject->SetField(ToString(Field.GetName()), Value);
+		}
+		return JsonObject;
+	}
+
+	TSharedPtr<FJsonValue> ReadValue(FCbFieldView Field, int32 Depth)
+	{
+		if (Depth > MaxDepth)
+		{
+			return nullptr;
+		}
+
+		if (Field.IsNull())
+		{
+			return MakeShared<FJsonValueNull>();
+		}
+		if (Field.IsBool())
+		{
+			return MakeShared<FJsonValueBoolean>(Field.AsBool());
+		}
+		if (Field.IsString())
+		{
+			return MakeShared<FJsonValueString>(ToString(Field.AsString()));
+		}
+		if (Field.IsInteger())
+		{
+			return MakeShared<FJsonValueNumber>(static_cast<double>(Field.AsInt64()));
+		}
+		if (Field.IsFloat())
+		{
+			return MakeShared<FJsonValueNumber>(Field.AsDouble());
+		}
+		if (Field.IsObject())
+		{
+			TSharedPtr<FJsonObject> Object = ReadObject(Field.AsObjectView(), Depth);
+			return Object.IsValid() ? MakeShared<FJsonValueObject>(Object) : nullptr;
+		}
+		if (Field.IsArray())
+		{
+			TArray<TSharedPtr<FJsonValue>> Elements;
+			FCbArrayView Array = Field.AsArrayView();
+			Elements.Reserve(IntCastChecked<int32>(Array.Num()));
+			for (FCbFieldView Element : Array)
+			{
+				TSharedPtr<FJsonValue> Value = ReadValue(Element, Depth + 1);
+				if (!Value.IsValid())
+				{
+					return nullptr;
+				}
+				Elements.Add(Value);
+			}
+			return MakeShared<FJsonValueArray>(Elements);
+		}
+
+		// Binary attachments, hashes, dates and the like have no place in the JSON schema
+		return nullptr;
+	}
+
+	bool CanWriteValue(const TSharedPtr<FJsonValue>& Value);
+
+	/** FCbWriter cannot name a field with an empty string, which JSON allows as a key */
+	bool CanWriteObject(const FJsonObject& Object)
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Object.Values)
+		{
+			if (Field.Key.IsEmpty() || !CanWriteValue(Field.Value))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool CanWriteValue(const TSharedPtr<FJsonValue>& Value)
+	{
+		if (!Value.IsValid())
+		{
+			return true;
+		}
+		if (Value->Type == EJson::Object)
+		{
+			const TSharedPtr<FJsonObject>& Object = Value->AsObject();
+			return !Object.IsValid() || CanWriteObject(*Object);
+		}
+		if (Value->Type == EJson::Array)
+		{
+			for (const TSharedPtr<FJsonValue>& Element : Value->AsArray())
+			{
+				if (!CanWriteValue(Element))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void WriteValue(FCbWriter& Writer, const TSharedPtr<FJsonValue>& Value);
+
+	void WriteObject(FCbWriter& Writer, const FJsonObject& Object)
+	{
+		Writer.BeginObject();
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Object.Values)
+		{
+			FSurrealPilotCompactBinary::SetName(Writer, Field.Key);
+			WriteValue(Writer, Field.Value);
+		}
+		Writer.EndObject();
+	}
+
+	void WriteValue(FCbWriter& Writer, const TSharedPtr<FJsonValue>& Value)
+	{
+		switch (Value.IsValid() ? Value->Type : EJson::Null)
+		{
+		case EJson::String:
+			FSurrealPilotCompactBinary::WriteString(Writer, Value->AsString());
+			break;
+		case EJson::Number:
+			FSurrealPilotCompactBinary::WriteNumber(Writer, Value->AsNumber());
+			break;
+		case EJson::Boolean:
+			Writer.AddBool(Value->AsBool());
+			break;
+		case EJson::Array:
+			Writer.BeginArray();
+			for (const TSharedPtr<FJsonValue>& Element : Value->AsArray())
+			{
+				WriteValue(Writer, Element);
+			}
+			Writer.EndArray();
+			break;
+		case EJson::Object:
+		{
+			const TSharedPtr<FJsonObject>& Object = Value->AsObject();
+			WriteObject(Writer, Object.IsValid() ? *Object : FJsonObject());
+			break;
+		}
+		default:
+			Writer.AddNull();
+			break;
+		}
+	}
+
+	void SetError(FString* OutError, const TCHAR* Error)
+	{
+		if (OutError)
+		{
+			*OutError = Error;
+		}
+	}
+}
+
+const TCHAR* FSurrealPilotCompactBinary::GetContentType()
+{
+	return SurrealPilotCompactBinary::ContentType;
+}
+
+TArray<uint8> FSurrealPilotCompactBinary::Encode(const TSharedPtr<FJsonObject>& Object)
+{
+	FCbWriter Writer;
+	BeginEnvelope(Writer);
+	if (!WriteJsonObject(Writer, Object.IsValid() ? *Object : FJsonObject()))
+	{
+		return TArray<uint8>();
+	}
+	EndEnvelope(Writer);
+	return Save(Writer);
+}
+
+void FSurrealPilotCompactBinary::BeginEnvelope(FCbWriter& Writer)
+{
+	Writer.BeginObject();
+	Writer.SetName(UTF8TEXTVIEW("version"));
+	Writer.AddInteger(Version);
+	Writer.SetName(UTF8TEXTVIEW("payload"));
+}
+
+void FSurrealPilotCompactBinary::EndEnvelope(FCbWriter& Writer)
+{
+	Writer.EndObject();
+}
+
+bool FSurrealPilotCompactBinary::WriteJsonObject(FCbWriter& Writer, const FJsonObject& Object)
+{
+	// Checked before anything is written, so a refused object leaves Writer as it was
+	if (!SurrealPilotCompactBinary::CanWriteObject(Object))
+	{
+		return false;
+	}
+	SurrealPilotCompactBinary::WriteObject(Writer, Object);
+	return true;
+}
+
+bool FSurrealPilotCompactBinary::WriteJsonValue(FCbWriter& Writer, const TSharedPtr<FJsonValue>& Value)
+{
+	if (!SurrealPilotCompactBinary::CanWriteValue(Value))
+	{
+		return false;
+	}
+	SurrealPilotCompactBinary::WriteValue(Writer, Value);
+	return true;
+}
+
+void FSurrealPilotCompactBinary::WriteNumber(FCbWriter& Writer, double Value)
+{
+	using namespace SurrealPilotCompactBinary;
+
+	// Negative zero has no integer form; it stays a double so it reads back as the same number
+	if (FMath::Abs(Value) < MaxExactInteger && Value == FMath::RoundToZero(Value) && !(Value == 0.0 && FMath::IsNegativeOrNegativeZero(Value)))
+	{
+		Writer.AddInteger(static_cast<int64>(Value));
+	}
+	else
+	{
+		Writer.AddFloat(Value);
+	}
+}
+
+void FSurrealPilotCompactBinary::SetName(FCbWriter& Writer, FStringView Name)
+{
+	FTCHARToUTF8 Utf8(Name.GetData(), Name.Len());
+	Writer.SetName(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Utf8.Get()), Utf8.Length()));
+}
+
+void FSurrealPilotCompactBinary::WriteString(FCbWriter& Writer, FStringView Value)
+{
+	FTCHARToUTF8 Utf8(Value.GetData(), Value.Len());
+	Writer.AddString(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Utf8.Get()), Utf8.Length()));
+}
+
+TArray<uint8> FSurrealPilotCompactBinary::Save(const FCbWriter& Writer)
+{
+	TArray<uint8> Bytes;
+	Bytes.SetNumUninitialized(IntCastChecked<int32>(Writer.GetSaveSize()));
+	Writer.Save(MakeMemoryView(Bytes));
+	return Bytes;
+}
+
+TSharedPtr<FJsonObject> FSurrealPilotCompactBinary::Decode(TArrayView<const uint8> Data, FString* OutError)
+{
+	using namespace SurrealPilotCompactBinary;
+
+	// Validation bounds every read that follows to Data, so a truncated or corrupt body fails here instead
+	const FMemoryView View = MakeMemoryView(Data.GetData(), Data.Num());
+	if (Data.Num() == 0 || ValidateCompactBinary(View, ECbValidateMode::Default) != ECbValidateError::None)
+	{
+		SetError(OutError, TEXT("not valid Compact Binary"));
+		return nullptr;
+	}
+
+	const FCbFieldView Root(Data.GetData());
+	if (!Root.IsObject() || Root.GetSize() != static_cast<uint64>(Data.Num()))
+	{
+		SetError(OutError, TEXT("not a single envelope object"));
+		return nullptr;
+	}
+
+	const FCbObjectView Envelope = Root.AsObjectView();
+	const FCbFieldView VersionField = Envelope.FindView(UTF8TEXTVIEW("version"));
+	if (!VersionField.IsInteger() || VersionField.AsInt64() != Version)
+	{
+		SetError(OutError, TEXT("unsupported envelope version"));
+		return nullptr;
+	}
+
+	const FCbFieldView Payload = Envelope.FindView(UTF8TEXTVIEW("payload"));
+	if (!Payload.IsObject())
+	{
+		SetError(OutError, TEXT("envelope has no payload object"));
+		return nullptr;
+	}
+
+	TSharedPtr<FJsonObject> Object = ReadObject(Payload.AsObjectView(), 0);
+	if (!Object.IsValid())
+	{
+		SetError(OutError, TEXT("payload has a field JSON cannot represent"));
+	}
+	return Object;
+}
+
+TSharedPtr<FJsonObject> FSurrealPilotCompactBinary::ReadJsonObject(const FCbObjectView& Object)
+{
+	return SurrealPilotCompactBinary::ReadObject(Object, 0);
+}
+
+bool FSurrealPilotCompactBinary::ToJsonString(TArrayView<const uint8> Data, FString& OutJson, bool bPretty)
+{
+	TSharedPtr<FJsonObject> Object = Decode(Data);
+	if (!Object.IsValid())
+	{
+		return false;
+	}
+
+	OutJson.Reset();
+	if (bPretty)
+	{
+		return FJsonSerializer::Serialize(Object.ToSharedRef(), TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&OutJson));
+	}
+	return FJsonSerializer::Serialize(Object.ToSharedRef(), TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutJson));
+}
\ No newline at end of file
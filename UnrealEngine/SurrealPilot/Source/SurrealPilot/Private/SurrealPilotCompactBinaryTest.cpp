@@ -0,0 +1,165 @@
+#include "SurrealPilotCompactBinary.h"
+#include "Misc/AutomationTest.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/CompactBinary.h"
+#include "Serialization/CompactBinaryWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SurrealPilotCompactBinaryTest
+{
+    FString ToCondensedString(const TSharedPtr<FJsonObject>& Object)
+    {
+        FString Json;
+        TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
+        FJsonSerializer::Serialize(Object.ToSharedRef(), Writer);
+        return Json;
+    }
+
+    /** One field of every JSON type, with the numbers and strings most likely to be mangled */
+    TSharedPtr<FJsonObject> MakeEveryType()
+    {
+        TSharedPtr<FJsonObject> Nested = MakeShared<FJsonObject>();
+        Nested->SetStringField(TEXT("empty"), FString());
+        Nested->SetObjectField(TEXT("emptyObject"), MakeShared<FJsonObject>());
+        Nested->SetArrayField(TEXT("emptyArray"), TArray<TSharedPtr<FJsonValue>>());
+
+        TArray<TSharedPtr<FJsonValue>> Mixed;
+        Mixed.Add(MakeShared<FJsonValueNumber>(1.0));
+        Mixed.Add(MakeShared<FJsonValueString>(TEXT("two")));
+        Mixed.Add(MakeShared<FJsonValueBoolean>(false));
+        Mixed.Add(MakeShared<FJsonValueNull>());
+        Mixed.Add(MakeShared<FJsonValueObject>(Nested));
+
+        TSharedPtr<FJsonObject> Object = MakeShared<FJsonObject>();
+        Object->SetStringField(TEXT("name"), TEXT("BP_Door"));
+        Object->SetStringField(TEXT("escaped"), TEXT("quote \" backslash \\ newline \n tab \t"));
+        Object->SetStringField(TEXT("unicode"), TEXT("T\u00FCr \u6249 \U0001F6AA"));
+        Object->SetNumberField(TEXT("zero"), 0.0);
+        Object->SetNumberField(TEXT("negative"), -240.0);
+        Object->SetNumberField(TEXT("fraction"), 0.1);
+        Object->SetNumberField(TEXT("large"), 9007199254740991.0);
+        Object->SetNumberField(TEXT("beyondExact"), 1.0e300);
+        Object->SetBoolField(TEXT("isConnected"), true);
+        Object->SetField(TEXT("nothing"), MakeShared<FJsonValueNull>());
+        Object->SetArrayField(TEXT("mixed"), Mixed);
+        Object->SetObjectField(TEXT("nested"), Nested);
+        return Object;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotCompactBinaryRoundTripTest, "SurrealPilot.CompactBinary.RoundTrip",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotCompactBinaryRoundTripTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotCompactBinaryTest;
+
+    const TSharedPtr<FJsonObject> Original = MakeEveryType();
+    const TArray<uint8> Encoded = FSurrealPilotCompactBinary::Encode(Original);
+
+    FString Error;
+    TSharedPtr<FJsonObject> Decoded = FSurrealPilotCompactBinary::Decode(Encoded, &Error);
+    if (!TestTrue(FString::Printf(TEXT("Encoded object should decode (%s)"), *Error), Decoded.IsValid()))
+    {
+        return false;
+    }
+    TestEqual("Decoding should give back every field, value and order", ToCondensedString(Decoded), ToCondensedString(Original));
+
+    FString Json;
+    TestTrue("Debug conversion should succeed", FSurrealPilotCompactBinary::ToJsonString(Encoded, Json, false));
+    TestEqual("Debug conversion should give the JSON of the original", Json, ToCondensedString(Original));
+
+    // JSON to Compact Binary and back is the identity, so a second pass encodes to the same bytes
+    TestTrue("Re-encoding the decoded object should give the same bytes", FSurrealPilotCompactBinary::Encode(Decoded) == Encoded);
+
+    const TArray<uint8> Empty = FSurrealPilotCompactBinary::Encode(nullptr);
+    TSharedPtr<FJsonObject> DecodedEmpty = FSurrealPilotCompactBinary::Decode(Empty);
+    TestTrue("A null object should encode as an empty one", DecodedEmpty.IsValid() && DecodedEmpty->Values.Num() == 0);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotCompactBinaryEmptyKeyTest, "SurrealPilot.CompactBinary.EmptyKey",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotCompactBinaryEmptyKeyTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotCompactBinaryTest;
+
+    // Valid JSON, but a Compact Binary field cannot have an empty name
+    TSharedPtr<FJsonObject> Nested = MakeShared<FJsonObject>();
+    Nested->SetStringField(FString(), TEXT("unnamed"));
+    TArray<TSharedPtr<FJsonValue>> Elements;
+    Elements.Add(MakeShared<FJsonValueObject>(Nested));
+    TSharedPtr<FJsonObject> Object = MakeShared<FJsonObject>();
+    Object->SetStringField(TEXT("type"), TEXT("Blueprint"));
+    Object->SetArrayField(TEXT("nodes"), Elements);
+
+    TestEqual("An object with an empty key should not encode", FSurrealPilotCompactBinary::Encode(Object).Num(), 0);
+
+    FCbWriter Writer;
+    Writer.BeginObject();
+    FSurrealPilotCompactBinary::SetName(Writer, TEXT("first"));
+    TestFalse("Writing an object with an empty key should fail", FSurrealPilotCompactBinary::WriteJsonObject(Writer, *Object));
+    TestFalse("Writing a value holding an empty key should fail", FSurrealPilotCompactBinary::WriteJsonValue(Writer, MakeShared<FJsonValueArray>(Elements)));
+
+    // Nothing was written, so the writer takes the next field as if the refused ones had never been offered
+    const TSharedPtr<FJsonObject> EveryType = MakeEveryType();
+    TestTrue("An object without empty keys should still be written", FSurrealPilotCompactBinary::WriteJsonObject(Writer, *EveryType));
+    Writer.EndObject();
+    const TArray<uint8> Bytes = FSurrealPilotCompactBinary::Save(Writer);
+    TSharedPtr<FJsonObject> Read = FSurrealPilotCompactBinary::ReadJsonObject(FCbFieldView(Bytes.GetData()).AsObjectView());
+    TestTrue("The written object should read back under its name",
+        Read.IsValid() && Read->HasTypedField<EJson::Object>(TEXT("first")) && ToCondensedString(Read->GetObjectField(TEXT("first"))) == ToCondensedString(EveryType));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotCompactBinaryMalformedTest, "SurrealPilot.CompactBinary.RejectsMalformed",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotCompactBinaryMalformedTest::RunTest(const FString& Parameters)
+{
+    TSharedPtr<FJsonObject> Object = MakeShared<FJsonObject>();
+    Object->SetStringField(TEXT("type"), TEXT("Blueprint"));
+    const TArray<uint8> Encoded = FSurrealPilotCompactBinary::Encode(Object);
+
+    FString Error;
+    TestFalse("Empty input should be rejected", FSurrealPilotCompactBinary::Decode(TArray<uint8>(), &Error).IsValid());
+
+    const TArray<uint8> Json = { '{', '"', 'a', '"', ':', '1', '}' };
+    TestFalse("JSON text should be rejected", FSurrealPilotCompactBinary::Decode(Json, &Error).IsValid());
+
+    TArray<uint8> Truncated = Encoded;
+    Truncated.SetNum(Truncated.Num() - 3);
+    TestFalse("A truncated envelope should be rejected", FSurrealPilotCompactBinary::Decode(Truncated, &Error).IsValid());
+
+    TArray<uint8> Trailing = Encoded;
+    Trailing.Append(Encoded);
+    TestFalse("Bytes after the envelope should be rejected", FSurrealPilotCompactBinary::Decode(Trailing, &Error).IsValid());
+
+    // The same payload under a version this build does not know
+    FCbWriter Writer;
+    Writer.BeginObject();
+    FSurrealPilotCompactBinary::SetName(Writer, TEXT("version"));
+    Writer.AddInteger(FSurrealPilotCompactBinary::Version + 1);
+    FSurrealPilotCompactBinary::SetName(Writer, TEXT("payload"));
+    FSurrealPilotCompactBinary::WriteJsonObject(Writer, *Object);
+    Writer.EndObject();
+    TestFalse("An unknown version should be rejected", FSurrealPilotCompactBinary::Decode(FSurrealPilotCompactBinary::Save(Writer), &Error).IsValid());
+    TestTrue("The reason should name the version", Error.Contains(TEXT("version")));
+
+    // A bare object, without the envelope
+    Writer.Reset();
+    FSurrealPilotCompactBinary::WriteJsonObject(Writer, *Object);
+    TestFalse("An object without an envelope should be rejected", FSurrealPilotCompactBinary::Decode(FSurrealPilotCompactBinary::Save(Writer), &Error).IsValid());
+
+    FString DebugJson;
+    TestFalse("Debug conversion should fail on garbage", FSurrealPilotCompactBinary::ToJsonString(Json, DebugJson));
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
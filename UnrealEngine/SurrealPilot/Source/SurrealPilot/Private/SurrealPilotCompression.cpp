@@ -0,0 +1,213 @@
+#include "SurrealPilotCompression.h"
+#include "SurrealPilotStats.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+DECLARE_CYCLE_STAT(TEXT("Compress Request Body"), STAT_SurrealPilot_CompressBody, STATGROUP_SurrealPilot);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Compressed Requests"), STAT_SurrealPilot_CompressedRequests, STATGROUP_SurrealPilot);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Compression Fallbacks"), STAT_SurrealPilot_CompressionFallbacks, STATGROUP_SurrealPilot);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Compression Ratio"), STAT_SurrealPilot_CompressionRatio, STATGROUP_SurrealPilot);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Compression CPU Time (ms)"), STAT_SurrealPilot_CompressionMs, STATGROUP_SurrealPilot);
+
+FCriticalSection FSurrealPilotCompression::StatsLock;
+FSurrealPilotCompressionStats FSurrealPilotCompression::Stats;
+
+namespace SurrealPilotCompression
+{
+	/**
+	 * Preset dictionary built from the JSON ContextExporter and RemoteControlIntegration produce.
+	 * zlib favours matches near the end of the dictionary, so the most frequent fragments come last.
+	 * Changing the contents requires a new DictionaryId so servers can keep the old one.
+	 */
+	const ANSICHAR Dictionary[] =
+		"{\"type\":\"BuildErrors\",\"errorCount\":,\"errors\":[{\"index\":,\"severity\":\"Error\",\"description\":\"\",\"file\":\"\",\"line\":\"\"}"
+		"{\"type\":\"Selection\",\"selectionCount\":,\"selectedObjects\":[{\"nodeData\":"
+		"{\"type\":\"notification\",\"source\":\"ue_remote_control\",\"property_changed\",\"property_path\":\"\",\"new_value\":"
+		"\"patch_applied\",\"patch_failed\",\"success\":true,\"message\":\"\""
+		"{\"type\":\"Blueprint\",\"parentClass\":\"Actor\",\"Character\",\"Pawn\",\"timestamp\":\"\",\"path\":\"/Game/Blueprints/"
+		"\"functions\":[{\"type\":\"Function\",\"parameters\":[],\"returns\":[]}"
+		"\"variables\":[{\"isArray\":false,\"isReference\":false,\"subType\":\"Vector\",\"Rotator\",\"Transform\"}"
+		"\"graphs\":[{\"name\":\"EventGraph\",\"schema\":\"EdGraphSchema_K2\",\"nodeCount\":,\"nodes\":["
+		"\"functionName\":\"\",\"variableName\":\"\",\"eventName\":\"ReceiveBeginPlay\",\"ReceiveTick\","
+		"{\"name\":\"K2Node_CallFunction_\",\"class\":\"K2Node_CallFunction\",\"K2Node_VariableGet\",\"K2Node_VariableSet\",\"K2Node_Event\","
+		"\"title\":\"\",\"tooltip\":\"\",\"posX\":,\"posY\":,\"pins\":["
+		"\"type\":\"exec\",\"bool\",\"int\",\"real\",\"float\",\"double\",\"string\",\"name\",\"text\",\"struct\",\"object\",\"class\","
+		"{\"name\":\"self\",\"execute\",\"then\",\"ReturnValue\",\"Target\","
+		"\"direction\":\"Output\",\"defaultValue\":\"\",\"isConnected\":false,\"connectionCount\":0}"
+		"\"direction\":\"Input\",\"defaultValue\":\"\",\"isConnected\":true,\"connectionCount\":1},";
+
+	const TCHAR* DictionaryId = TEXT("sp-context-v1");
+
+	/** Bytes appended to the output buffer per deflate/inflate round when it runs out of space */
+	constexpr int32 OutputChunkSize = 64 * 1024;
+}
+
+bool FSurrealPilotCompression::Compress(TArrayView<const uint8> Input, ESurrealPilotRequestCompression Mode, TArray<uint8>& OutCompressed)
+{
+	if (Mode == ESurrealPilotRequestCompression::None)
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SurrealPilot_CompressBody);
+
+	z_stream Stream;
+	FMemory::Memzero(Stream);
+
+	// 15 window bits produce a zlib stream (HTTP "deflate"); +16 wraps it in a gzip header instead
+	const int32 WindowBits = Mode == ESurrealPilotRequestCompression::Gzip ? 15 + 16 : 15;
+	if (deflateInit2(&Stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, WindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		return false;
+	}
+
+	if (Mode == ESurrealPilotRequestCompression::DeflateDictionary)
+	{
+		TArrayView<const uint8> Dictionary = GetDictionary();
+		deflateSetDictionary(&Stream, Dictionary.GetData(), Dictionary.Num());
+	}
+
+	OutCompressed.Reset();
+	OutCompressed.SetNumUninitialized(deflateBound(&Stream, Input.Num()));
+
+	Stream.next_in = const_cast<Bytef*>(Input.GetData());
+	Stream.avail_in = Input.Num();
+	Stream.next_out = OutCompressed.GetData();
+	Stream.avail_out = OutCompressed.Num();
+
+	// deflateBound guarantees the output fits, so a single call finishes the stream
+	const int32 Result = deflate(&Stream, Z_FINISH);
+	const int64 CompressedSize = Stream.total_out;
+	deflateEnd(&Stream);
+
+	if (Result != Z_STREAM_END)
+	{
+		OutCompressed.Reset();
+		return false;
+	}
+
+	OutCompressed.SetNum(CompressedSize, EAllowShrinking::No);
+	return true;
+}
+
+bool FSurrealPilotCompression::Decompress(TArrayView<const uint8> Input, const FString& ContentEncoding, TArray<uint8>& OutDecompressed)
+{
+	int32 WindowBits;
+	if (ContentEncoding.Equals(TEXT("gzip"), ESearchCase::IgnoreCase))
+	{
+		WindowBits = 15 + 16;
+	}
+	else if (ContentEncoding.Equals(TEXT("deflate"), ESearchCase::IgnoreCase))
+	{
+		WindowBits = 15;
+	}
+	else
+	{
+		return false;
+	}
+
+	z_stream Stream;
+	FMemory::Memzero(Stream);
+	if (inflateInit2(&Stream, WindowBits) != Z_OK)
+	{
+		return false;
+	}
+
+	Stream.next_in = const_cast<Bytef*>(Input.GetData());
+	Stream.avail_in = Input.Num();
+
+	OutDecompressed.Reset();
+	int32 Result = Z_OK;
+	while (Result == Z_OK)
+	{
+		const int32 Offset = OutDecompressed.Num();
+		OutDecompressed.AddUninitialized(SurrealPilotCompression::OutputChunkSize);
+		Stream.next_out = OutDecompressed.GetData() + Offset;
+		Stream.avail_out = SurrealPilotCompression::OutputChunkSize;
+
+		Result = inflate(&Stream, Z_NO_FLUSH);
+		if (Result == Z_NEED_DICT)
+		{
+			// Only one dictionary exists so far; its adler32 id is checked by inflateSetDictionary
+			TArrayView<const uint8> Dictionary = GetDictionary();
+			Result = inflateSetDictionary(&Stream, Dictionary.GetData(), Dictionary.Num());
+			if (Result == Z_OK)
+			{
+				Result = inflate(&Stream, Z_NO_FLUSH);
+			}
+		}
+
+		OutDecompressed.SetNum(Offset + SurrealPilotCompression::OutputChunkSize - Stream.avail_out, EAllowShrinking::No);
+
+		if (Result == Z_BUF_ERROR && Stream.avail_out > 0)
+		{
+			// Truncated input
+			break;
+		}
+		if (Result == Z_BUF_ERROR)
+		{
+			Result = Z_OK;
+		}
+	}
+
+	inflateEnd(&Stream);
+	return Result == Z_STREAM_END;
+}
+
+const TCHAR* FSurrealPilotCompression::GetContentEncoding(ESurrealPilotRequestCompression Mode)
+{
+	switch (Mode)
+	{
+	case ESurrealPilotRequestCompression::Gzip:
+		return TEXT("gzip");
+	case ESurrealPilotRequestCompression::DeflateDictionary:
+		return TEXT("deflate");
+	default:
+		return TEXT("identity");
+	}
+}
+
+const TCHAR* FSurrealPilotCompression::GetDictionaryId()
+{
+	return SurrealPilotCompression::DictionaryId;
+}
+
+TArrayView<const uint8> FSurrealPilotCompression::GetDictionary()
+{
+	// Exclude the string literal's terminator
+	return TArrayView<const uint8>(reinterpret_cast<const uint8*>(SurrealPilotCompression::Dictionary), UE_ARRAY_COUNT(SurrealPilotCompression::Dictionary) - 1);
+}
+
+void FSurrealPilotCompression::RecordFallback()
+{
+	FScopeLock Lock(&StatsLock);
+	++Stats.Fallbacks;
+	INC_DWORD_STAT(STAT_SurrealPilot_CompressionFallbacks);
+}
+
+FSurrealPilotCompressionStats FSurrealPilotCompression::GetStats()
+{
+	FScopeLock Lock(&StatsLock);
+	return Stats;
+}
+
+void FSurrealPilotCompression::ResetStats()
+{
+	FScopeLock Lock(&StatsLock);
+	Stats = FSurrealPilotCompressionStats();
+}
+
+void FSurrealPilotCompression::RecordCompression(int64 UncompressedSize, int64 CompressedSize, double Seconds)
+{
+	FScopeLock Lock(&StatsLock);
+	++Stats.CompressedRequests;
+	Stats.UncompressedBytes += UncompressedSize;
+	Stats.CompressedBytes += CompressedSize;
+	Stats.CompressSeconds += Seconds;
+
+	INC_DWORD_STAT(STAT_SurrealPilot_CompressedRequests);
+	SET_FLOAT_STAT(STAT_SurrealPilot_CompressionRatio, Stats.GetRatio());
+	SET_FLOAT_STAT(STAT_SurrealPilot_CompressionMs, Stats.CompressSeconds * 1000.0);
+}
\ No newline at end of file
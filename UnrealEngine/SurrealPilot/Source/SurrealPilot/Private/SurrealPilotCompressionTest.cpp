@@ -0,0 +1,106 @@
+#include "SurrealPilotCompression.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SurrealPilotCompressionTest
+{
+    /** A Blueprint export shaped like UContextExporter::ExportBlueprintContext output */
+    FString MakeBlueprintExport(int32 NodeCount)
+    {
+        FString Json = TEXT("{\"name\":\"BP_Door\",\"path\":\"/Game/Blueprints/BP_Door.BP_Door\",\"type\":\"Blueprint\",\"timestamp\":\"2024.01.01-12.00.00\",\"parentClass\":\"Actor\",\"variables\":[],\"functions\":[],\"graphs\":[{\"name\":\"EventGraph\",\"schema\":\"EdGraphSchema_K2\",\"nodes\":[");
+        for (int32 NodeIndex = 0; NodeIndex < NodeCount; ++NodeIndex)
+        {
+            Json += FString::Printf(
+                TEXT("%s{\"name\":\"K2Node_CallFunction_%d\",\"class\":\"K2Node_CallFunction\",\"title\":\"Set Relative Rotation\",\"tooltip\":\"Set the rotation of the component relative to its parent\",\"posX\":%d,\"posY\":%d,\"pins\":["
+                     "{\"name\":\"execute\",\"type\":\"exec\",\"direction\":\"Input\",\"defaultValue\":\"\",\"isConnected\":true,\"connectionCount\":1},"
+                     "{\"name\":\"then\",\"type\":\"exec\",\"direction\":\"Output\",\"defaultValue\":\"\",\"isConnected\":false,\"connectionCount\":0},"
+                     "{\"name\":\"self\",\"type\":\"object\",\"direction\":\"Input\",\"defaultValue\":\"\",\"isConnected\":true,\"connectionCount\":1,\"subType\":\"SceneComponent\"}],"
+                     "\"functionName\":\"K2_SetRelativeRotation\"}"),
+                NodeIndex > 0 ? TEXT(",") : TEXT(""), NodeIndex, NodeIndex * 240, NodeIndex * -16);
+        }
+        Json += TEXT("],\"nodeCount\":") + FString::FromInt(NodeCount) + TEXT("}]}");
+        return Json;
+    }
+
+    TArray<uint8> ToUtf8(const FString& Text)
+    {
+        FTCHARToUTF8 Utf8(*Text);
+        return TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotCompressionTest, "SurrealPilot.Compression.RoundTrip",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotCompressionTest::RunTest(const FString& Parameters)
+{
+    const TArray<uint8> Body = SurrealPilotCompressionTest::ToUtf8(SurrealPilotCompressionTest::MakeBlueprintExport(200));
+
+    for (ESurrealPilotRequestCompression Mode : { ESurrealPilotRequestCompression::Gzip, ESurrealPilotRequestCompression::DeflateDictionary })
+    {
+        const FString Encoding = FSurrealPilotCompression::GetContentEncoding(Mode);
+
+        TArray<uint8> Compressed;
+        if (!TestTrue(FString::Printf(TEXT("%s compression should succeed"), *Encoding), FSurrealPilotCompression::Compress(Body, Mode, Compressed)))
+        {
+            continue;
+        }
+        TestTrue(FString::Printf(TEXT("%s output should be smaller"), *Encoding), Compressed.Num() < Body.Num());
+
+        TArray<uint8> Decompressed;
+        TestTrue(FString::Printf(TEXT("%s output should decompress"), *Encoding), FSurrealPilotCompression::Decompress(Compressed, Encoding, Decompressed));
+        TestTrue(FString::Printf(TEXT("%s round trip should be lossless"), *Encoding), Decompressed == Body);
+
+        // A truncated stream must be reported rather than silently accepted
+        TArray<uint8> Truncated(Compressed.GetData(), Compressed.Num() / 2);
+        TestFalse(FString::Printf(TEXT("Truncated %s input should fail"), *Encoding), FSurrealPilotCompression::Decompress(Truncated, Encoding, Decompressed));
+    }
+
+    TArray<uint8> Unused;
+    TestFalse("None should not compress", FSurrealPilotCompression::Compress(Body, ESurrealPilotRequestCompression::None, Unused));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotCompressionBenchmark, "SurrealPilot.Compression.Benchmark",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSurrealPilotCompressionBenchmark::RunTest(const FString& Parameters)
+{
+    // Small exports are where the dictionary matters; large ones build their own history quickly
+    for (int32 NodeCount : { 2, 20, 200, 5000 })
+    {
+        const TArray<uint8> Body = SurrealPilotCompressionTest::ToUtf8(SurrealPilotCompressionTest::MakeBlueprintExport(NodeCount));
+
+        for (ESurrealPilotRequestCompression Mode : { ESurrealPilotRequestCompression::Gzip, ESurrealPilotRequestCompression::DeflateDictionary })
+        {
+            FSurrealPilotCompression::ResetStats();
+
+            TArray<uint8> Compressed;
+            const int32 Iterations = 10;
+            const double StartTime = FPlatformTime::Seconds();
+            for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+            {
+                FSurrealPilotCompression::Compress(Body, Mode, Compressed);
+            }
+            const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+            // The totals are for bodies actually sent compressed, which only the HTTP client knows
+            TestEqual("Compressing alone should not be counted as a compressed request", FSurrealPilotCompression::GetStats().CompressedRequests, 0);
+
+            AddInfo(FString::Printf(TEXT("%d nodes, %s: %d -> %d bytes (ratio %.2f), %.3f ms per body"),
+                NodeCount,
+                Mode == ESurrealPilotRequestCompression::Gzip ? TEXT("gzip") : TEXT("deflate+dictionary"),
+                Body.Num(),
+                Compressed.Num(),
+                Compressed.Num() > 0 ? static_cast<double>(Body.Num()) / Compressed.Num() : 1.0,
+                Seconds * 1000.0 / Iterations));
+        }
+    }
+
+    FSurrealPilotCompression::ResetStats();
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "SurrealPilotContextBudget.h"
+#include "SurrealPilotTokenizer.h"
+#include "SurrealPilotJsonWriter.h"
+
+namespace SurrealPilotContextBudget
+{
+	/** Below this many tokens, what is left of a section is not worth sending */
+	constexpr int32 MinUsefulTokens = 32;
+
+	/** Top-level scalars up to this many tokens identify the context and are kept first; longer ones are sections */
+	constexpr int32 MaxIdentifyingTokens = 32;
+
+	/** Appended to a string that was cut short */
+	const TCHAR* const TruncationMarker = TEXT("...");
+
+	/** Top-level sections by priority; anything not listed comes after all of them */
+	struct FSectionPriority
+	{
+		const TCHAR* Key;
+		int32 Priority;
+	};
+
+	constexpr FSectionPriority SectionPriorities[] =
+	{
+		{ TEXT("selection"), 0 },
+		{ TEXT("build_errors"), 1 },
+		{ TEXT("errors"), 1 },
+		{ TEXT("blueprint"), 2 },
+		{ TEXT("graphs"), 2 },
+		{ TEXT("variables"), 2 },
+		{ TEXT("functions"), 2 },
+		{ TEXT("scene"), 3 },
+	};
+
+	constexpr int32 OtherSectionPriority = 4;
+
+	bool IsContainer(const TSharedPtr<FJsonValue>& Value)
+	{
+		return Value.IsValid() && (Value->Type == EJson::Object || Value->Type == EJson::Array);
+	}
+
+	/** Tokens of "Key": and the separator before the next field */
+	int32 CountKey(const FSurrealPilotTokenizer& Tokenizer, const FString& Key)
+	{
+		return Tokenizer.CountTokens(FString::Printf(TEXT("\"%s\":"), *Key)) + 1;
+	}
+
+	/** The longest start of a string that fits in Remaining tokens, marked as cut short; null if none does */
+	TSharedPtr<FJsonValue> FitString(const FSurrealPilotTokenizer& Tokenizer, const FString& String, int32 Remaining,
+		const FString& Path, FSurrealPilotTokenBudgetReport& Report, int32& OutTokens)
+	{
+		// Tokens grow with the length kept, so a binary search over it needs only a handful of counts
+		int32 Low = 1;
+		int32 High = String.Len() - 1;
+		int32 BestLen = 0;
+		int32 BestTokens = 0;
+		while (Low <= High)
+		{
+			const int32 Len = Low + (High - Low) / 2;
+			const int32 Tokens = FSurrealPilotContextBudget::CountTokens(Tokenizer, MakeShared<FJsonValueString>(String.Left(Len) + TruncationMarker));
+			if (Tokens <= Remaining)
+			{
+				BestLen = Len;
+				BestTokens = Tokens;
+				Low = Len + 1;
+			}
+			else
+			{
+				High = Len - 1;
+			}
+		}
+
+		// Never end on half of a surrogate pair
+		if (BestLen > 0 && FChar::IsHighSurrogate(String[BestLen - 1]))
+		{
+			--BestLen;
+		}
+		if (BestLen == 0)
+		{
+			return nullptr;
+		}
+
+		Report.TruncatedSections.Add(FString::Printf(TEXT("%s (%d of %d characters)"), *Path, BestLen, String.Len()));
+		OutTokens = BestTokens;
+		return MakeShared<FJsonValueString>(String.Left(BestLen) + TruncationMarker);
+	}
+
+	/**
+	 * Fit a value whose full cost is Tokens into Remaining tokens, cutting arrays and strings short and fitting
+	 * objects field by field. Returns null if nothing useful fits; OutTokens is the cost of what was kept.
+	 */
+	TSharedPtr<FJsonValue> Fit(const FSurrealPilotTokenizer& Tokenizer, const TSharedPtr<FJsonValue>& Value, int32 Tokens, int32 Remaining,
+		const FString& Path, FSurrealPilotTokenBudgetReport& Report, int32& OutTokens)
+	{
+		if (Tokens <= Remaining)
+		{
+			OutTokens = Tokens;
+			return Value;
+		}
+		if (Remaining < MinUsefulTokens || !Value.IsValid())
+		{
+			return nullptr;
+		}
+		if (Value->Type == EJson::String)
+		{
+			return FitString(Tokenizer, Value->AsString(), Remaining, Path, Report, OutTokens);
+		}
+		if (!IsContainer(Value))
+		{
+			return nullptr;
+		}
+
+		// Brackets or braces
+		int32 Used = 2;
+
+		if (Value->Type == EJson::Array)
+		{
+			const TArray<TSharedPtr<FJsonValue>>& Elements = Value->AsArray();
+			TArray<TSharedPtr<FJsonValue>> Kept;
+			for (int32 Index = 0; Index < Elements.Num(); ++Index)
+			{
+				const int32 ElementTokens = FSurrealPilotContextBudget::CountTokens(Tokenizer, Elements[Index]) + 1;
+				if (Used + ElementTokens <= Remaining)
+				{
+					Kept.Add(Elements[Index]);
+					Used += ElementTokens;
+					continue;
+				}
+
+				// Elements are kept in order, so the first that does not fit is the last one considered
+				int32 PartialTokens = 0;
+				if (TSharedPtr<FJsonValue> Partial = Fit(Tokenizer, Elements[Index], ElementTokens - 1, Remaining - Used - 1,
+					FString::Printf(TEXT("%s[%d]"), *Path, Index), Report, PartialTokens))
+				{
+					Kept.Add(Partial);
+					Used += PartialTokens + 1;
+				}
+				break;
+			}
+
+			if (Kept.Num() == 0)
+			{
+				return nullptr;
+			}
+			if (Kept.Num() < Elements.Num())
+			{
+				Report.TruncatedSections.Add(FString::Printf(TEXT("%s (%d of %d)"), *Path, Kept.Num(), Elements.Num()));
+			}
+			OutTokens = Used;
+			return MakeShared<FJsonValueArray>(Kept);
+		}
+
+		// Identifying scalar fields first, then nested sections in their original order
+		const TSharedPtr<FJsonObject>& Object = Value->AsObject();
+		TSharedPtr<FJsonObject> Kept = MakeShared<FJsonObject>();
+		for (const bool bContainers : { false, true })
+		{
+			for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Object->Values)
+			{
+				if (IsContainer(Field.Value) != bContainers)
+				{
+					continue;
+				}
+
+				const int32 KeyTokens = CountKey(Tokenizer, Field.Key);
+				const int32 FieldTokens = FSurrealPilotContextBudget::CountTokens(Tokenizer, Field.Value);
+				int32 FittedTokens = 0;
+				if (TSharedPtr<FJsonValue> Fitted = Fit(Tokenizer, Field.Value, FieldTokens, Remaining - Used - KeyTokens,
+					Path + TEXT(".") + Field.Key, Report, FittedTokens))
+				{
+					Kept->Values.Add(Field.Key, Fitted);
+					Used += KeyTokens + FittedTokens;
+				}
+			}
+		}
+
+		if (Kept->Values.Num() == 0)
+		{
+			return nullptr;
+		}
+		OutTokens = Used;
+		return MakeShared<FJsonValueObject>(Kept);
+	}
+}
+
+FString FSurrealPilotTokenBudgetReport::ToString() const
+{
+	FString Summary = FString::Printf(TEXT("%d of %d context tokens used, %d dropped (%s%s)"),
+		TokensUsed, Budget, TokensDropped, *Tokenizer, bExact ? TEXT("") : TEXT(", estimated"));
+	if (DroppedSections.Num() > 0)
+	{
+		Summary += TEXT("; dropped ") + FString::Join(DroppedSections, TEXT(", "));
+	}
+	if (TruncatedSections.Num() > 0)
+	{
+		Summary += TEXT("; cut short ") + FString::Join(TruncatedSections, TEXT(", "));
+	}
+	return Summary;
+}
+
+int32 FSurrealPilotContextBudget::CountTokens(const FSurrealPilotTokenizer& Tokenizer, const TSharedPtr<FJsonValue>& Value)
+{
+	FSurrealPilotJsonWriter Writer;
+	Writer.WriteJsonValue(Value);
+	return Tokenizer.CountTokens(Writer.GetBuffer());
+}
+
+int32 FSurrealPilotContextBudget::GetSectionPriority(const FString& Key)
+{
+	for (const SurrealPilotContextBudget::FSectionPriority& Entry : SurrealPilotContextBudget::SectionPriorities)
+	{
+		if (Key.Equals(Entry.Key, ESearchCase::IgnoreCase))
+		{
+			return Entry.Priority;
+		}
+	}
+	return SurrealPilotContextBudget::OtherSectionPriority;
+}
+
+TSharedPtr<FJsonObject> FSurrealPilotContextBudget::Trim(const TSharedPtr<FJsonObject>& Context, const FSurrealPilotTokenizer& Tokenizer, int32 Budget, FSurrealPilotTokenBudgetReport& OutReport)
+{
+	using namespace SurrealPilotContextBudget;
+
+	OutReport = FSurrealPilotTokenBudgetReport();
+	OutReport.Tokenizer = Tokenizer.GetName();
+	OutReport.bExact = Tokenizer.IsExact();
+	OutReport.Budget = Budget;
+	if (!Context.IsValid())
+	{
+		return Context;
+	}
+
+	struct FSection
+	{
+		FString Key;
+		TSharedPtr<FJsonValue> Value;
+		int32 KeyTokens = 0;
+		int32 ValueTokens = 0;
+		int32 Priority = 0;
+	};
+
+	TSharedPtr<FJsonObject> Trimmed = MakeShared<FJsonObject>();
+	int32 Used = 2;
+	int32 Total = 2;
+	TArray<FSection> Sections;
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Context->Values)
+	{
+		FSection Section;
+		Section.Key = Field.Key;
+		Section.Value = Field.Value;
+		Section.KeyTokens = CountKey(Tokenizer, Field.Key);
+		Section.ValueTokens = CountTokens(Tokenizer, Field.Value);
+		Section.Priority = GetSectionPriority(Field.Key);
+		Total += Section.KeyTokens + Section.ValueTokens;
+
+		Sections.Add(MoveTemp(Section));
+	}
+
+	// Names, paths and types say what the context is about and cost next to nothing, so they come first, but
+	// they are charged like anything else; a long string is a section of its own and may be cut short
+	for (int32 Index = 0; Index < Sections.Num(); ++Index)
+	{
+		const FSection& Section = Sections[Index];
+		if (IsContainer(Section.Value) || Section.ValueTokens > MaxIdentifyingTokens)
+		{
+			continue;
+		}
+		if (Used + Section.KeyTokens + Section.ValueTokens <= Budget)
+		{
+			Trimmed->Values.Add(Section.Key, Section.Value);
+			Used += Section.KeyTokens + Section.ValueTokens;
+		}
+		else
+		{
+			OutReport.DroppedSections.Add(Section.Key);
+		}
+		Sections.RemoveAt(Index--);
+	}
+
+	// Once a section has been cut short, what is left over goes unused rather than to a less useful section
+	Sections.StableSort([](const FSection& A, const FSection& B) { return A.Priority < B.Priority; });
+	bool bCutShort = false;
+	for (const FSection& Section : Sections)
+	{
+		int32 FittedTokens = 0;
+		TSharedPtr<FJsonValue> Fitted;
+		if (!bCutShort)
+		{
+			Fitted = Fit(Tokenizer, Section.Value, Section.ValueTokens, Budget - Used - Section.KeyTokens, Section.Key, OutReport, FittedTokens);
+		}
+		if (Fitted.IsValid())
+		{
+			Trimmed->Values.Add(Section.Key, Fitted);
+			Used += Section.KeyTokens + FittedTokens;
+			bCutShort = FittedTokens < Section.ValueTokens;
+		}
+		else
+		{
+			OutReport.DroppedSections.Add(Section.Key);
+		}
+	}
+
+	OutReport.TokensUsed = Used;
+	OutReport.TokensDropped = FMath::Max(0, Total - Used);
+	return OutReport.TokensDropped > 0 ? Trimmed : Context;
+}
\ No newline at end of file
@@ -0,0 +1,338 @@
+#include "SurrealPilotContextDelta.h"
+
+namespace SurrealPilotContextDelta
+{
+	/** Assets remembered per endpoint; past this the map starts over rather than holding every export of the session */
+	constexpr int32 MaxTrackedAssets = 256;
+
+	/** JSON Pointer escaping (RFC 6901) of a single path segment */
+	FString EscapeToken(const FString& Token)
+	{
+		if (!Token.Contains(TEXT("~")) && !Token.Contains(TEXT("/")))
+		{
+			return Token;
+		}
+		return Token.Replace(TEXT("~"), TEXT("~0")).Replace(TEXT("/"), TEXT("~1"));
+	}
+
+	FString UnescapeToken(const FString& Token)
+	{
+		return Token.Replace(TEXT("~1"), TEXT("/")).Replace(TEXT("~0"), TEXT("~"));
+	}
+
+	/** The "guid" field of an array element, empty if it has none */
+	FString GetGuid(const TSharedPtr<FJsonValue>& Value)
+	{
+		FString Guid;
+		if (Value.IsValid() && Value->Type == EJson::Object)
+		{
+			Value->AsObject()->TryGetStringField(TEXT("guid"), Guid);
+		}
+		return Guid;
+	}
+
+	/** Whether every element of an array has a distinct GUID, filling OutIndex with the position of each */
+	bool IndexByGuid(const TArray<TSharedPtr<FJsonValue>>& Array, TMap<FString, int32>& OutIndex)
+	{
+		OutIndex.Reserve(Array.Num());
+		for (int32 Index = 0; Index < Array.Num(); ++Index)
+		{
+			const FString Guid = GetGuid(Array[Index]);
+			if (Guid.IsEmpty() || OutIndex.Contains(Guid))
+			{
+				return false;
+			}
+			OutIndex.Add(Guid, Index);
+		}
+		return true;
+	}
+
+	void AddOperation(TArray<TSharedPtr<FJsonValue>>& Operations, const TCHAR* Op, const FString& Path, const TSharedPtr<FJsonValue>& Value = nullptr)
+	{
+		TSharedPtr<FJsonObject> Operation = MakeShared<FJsonObject>();
+		Operation->SetStringField(TEXT("op"), Op);
+		Operation->SetStringField(TEXT("path"), Path);
+		if (Value.IsValid())
+		{
+			Operation->SetField(TEXT("value"), Value);
+		}
+		Operations.Add(MakeShared<FJsonValueObject>(Operation));
+	}
+
+	void DiffValue(const FString& Path, const TSharedPtr<FJsonValue>& Base, const TSharedPtr<FJsonValue>& Target, TArray<TSharedPtr<FJsonValue>>& Operations);
+
+	void DiffObject(const FString& Path, const FJsonObject& Base, const FJsonObject& Target, TArray<TSharedPtr<FJsonValue>>& Operations)
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Base.Values)
+		{
+			if (!Target.Values.Contains(Field.Key))
+			{
+				AddOperation(Operations, TEXT("remove"), Path + TEXT("/") + EscapeToken(Field.Key));
+			}
+		}
+
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Target.Values)
+		{
+			const FString FieldPath = Path + TEXT("/") + EscapeToken(Field.Key);
+			if (const TSharedPtr<FJsonValue>* BaseValue = Base.Values.Find(Field.Key))
+			{
+				DiffValue(FieldPath, *BaseValue, Field.Value, Operations);
+			}
+			else
+			{
+				AddOperation(Operations, TEXT("add"), FieldPath, Field.Value);
+			}
+		}
+	}
+
+	/**
+	 * Diff two arrays element by element using their GUIDs. Apply removes elements in place and appends new ones,
+	 * so this only works when Target is Base's surviving elements in their original order followed by the new ones;
+	 * returns false otherwise, and for arrays without GUIDs.
+	 */
+	bool DiffArrayByGuid(const FString& Path, const TArray<TSharedPtr<FJsonValue>>& Base, const TArray<TSharedPtr<FJsonValue>>& Target, TArray<TSharedPtr<FJsonValue>>& Operations)
+	{
+		TMap<FString, int32> BaseIndex;
+		TMap<FString, int32> TargetIndex;
+		if (!IndexByGuid(Base, BaseIndex) || !IndexByGuid(Target, TargetIndex) || (Base.Num() == 0 && Target.Num() == 0))
+		{
+			return false;
+		}
+
+		int32 LastBaseIndex = -1;
+		bool bSeenNewElement = false;
+		for (const TSharedPtr<FJsonValue>& Element : Target)
+		{
+			if (const int32* Index = BaseIndex.Find(GetGuid(Element)))
+			{
+				if (bSeenNewElement || *Index < LastBaseIndex)
+				{
+					return false;
+				}
+				LastBaseIndex = *Index;
+			}
+			else
+			{
+				bSeenNewElement = true;
+			}
+		}
+
+		for (const TSharedPtr<FJsonValue>& Element : Base)
+		{
+			const FString Guid = GetGuid(Element);
+			if (!TargetIndex.Contains(Guid))
+			{
+				AddOperation(Operations, TEXT("remove"), Path + TEXT("/") + EscapeToken(Guid));
+			}
+		}
+
+		for (const TSharedPtr<FJsonValue>& Element : Target)
+		{
+			const FString Guid = GetGuid(Element);
+			const FString ElementPath = Path + TEXT("/") + EscapeToken(Guid);
+			if (const int32* Index = BaseIndex.Find(Guid))
+			{
+				DiffValue(ElementPath, Base[*Index], Element, Operations);
+			}
+			else
+			{
+				AddOperation(Operations, TEXT("add"), ElementPath, Element);
+			}
+		}
+		return true;
+	}
+
+	void DiffValue(const FString& Path, const TSharedPtr<FJsonValue>& Base, const TSharedPtr<FJsonValue>& Target, TArray<TSharedPtr<FJsonValue>>& Operations)
+	{
+		if (!Base.IsValid() || !Target.IsValid() || Base->Type != Target->Type)
+		{
+			AddOperation(Operations, TEXT("replace"), Path, Target.IsValid() ? Target : MakeShared<FJsonValueNull>());
+			return;
+		}
+
+		if (Base->Type == EJson::Object)
+		{
+			DiffObject(Path, *Base->AsObject(), *Target->AsObject(), Operations);
+		}
+		else if (Base->Type == EJson::Array)
+		{
+			if (!DiffArrayByGuid(Path, Base->AsArray(), Target->AsArray(), Operations) && !FJsonValue::CompareEqual(*Base, *Target))
+			{
+				AddOperation(Operations, TEXT("replace"), Path, Target);
+			}
+		}
+		else if (!FJsonValue::CompareEqual(*Base, *Target))
+		{
+			AddOperation(Operations, TEXT("replace"), Path, Target);
+		}
+	}
+
+	/**
+	 * Apply one operation below Slot, replacing each container on the way with a shallow copy so the
+	 * original document is left untouched. Array elements are addressed by GUID, "-" appends.
+	 */
+	bool ApplyAt(TSharedPtr<FJsonValue>& Slot, const TArray<FString>& Tokens, int32 Depth, const FString& Op, const TSharedPtr<FJsonValue>& Value)
+	{
+		const FString& Token = Tokens[Depth];
+		const bool bLast = Depth == Tokens.Num() - 1;
+
+		if (Slot->Type == EJson::Object)
+		{
+			TSharedPtr<FJsonObject> Copy = MakeShared<FJsonObject>();
+			Copy->Values = Slot->AsObject()->Values;
+
+			if (!bLast)
+			{
+				TSharedPtr<FJsonValue>* Child = Copy->Values.Find(Token);
+				if (!Child || !Child->IsValid() || !ApplyAt(*Child, Tokens, Depth + 1, Op, Value))
+				{
+					return false;
+				}
+			}
+			else if (Op == TEXT("remove"))
+			{
+				if (Copy->Values.Remove(Token) == 0)
+				{
+					return false;
+				}
+			}
+			else if (Op == TEXT("add") || (Op == TEXT("replace") && Copy->Values.Contains(Token)))
+			{
+				Copy->Values.Add(Token, Value);
+			}
+			else
+			{
+				return false;
+			}
+
+			Slot = MakeShared<FJsonValueObject>(Copy);
+			return true;
+		}
+
+		if (Slot->Type == EJson::Array)
+		{
+			TArray<TSharedPtr<FJsonValue>> Items = Slot->AsArray();
+			const int32 Index = Items.IndexOfByPredicate([&Token](const TSharedPtr<FJsonValue>& Element) { return GetGuid(Element) == Token; });
+
+			if (bLast && Op == TEXT("add"))
+			{
+				if (Index != INDEX_NONE || !Value.IsValid() || (Token != TEXT("-") && GetGuid(Value) != Token))
+				{
+					return false;
+				}
+				Items.Add(Value);
+			}
+			else if (Index == INDEX_NONE)
+			{
+				return false;
+			}
+			else if (!bLast)
+			{
+				if (!ApplyAt(Items[Index], Tokens, Depth + 1, Op, Value))
+				{
+					return false;
+				}
+			}
+			else if (Op == TEXT("remove"))
+			{
+				Items.RemoveAt(Index);
+			}
+			else if (Op == TEXT("replace"))
+			{
+				Items[Index] = Value;
+			}
+			else
+			{
+				return false;
+			}
+
+			Slot = MakeShared<FJsonValueArray>(Items);
+			return true;
+		}
+
+		return false;
+	}
+}
+
+TArray<TSharedPtr<FJsonValue>> FSurrealPilotContextDelta::Diff(const TSharedPtr<FJsonObject>& Base, const TSharedPtr<FJsonObject>& Target)
+{
+	TArray<TSharedPtr<FJsonValue>> Operations;
+	if (Base.IsValid() && Target.IsValid())
+	{
+		SurrealPilotContextDelta::DiffObject(FString(), *Base, *Target, Operations);
+	}
+	return Operations;
+}
+
+TSharedPtr<FJsonObject> FSurrealPilotContextDelta::Apply(const TSharedPtr<FJsonObject>& Base, const TArray<TSharedPtr<FJsonValue>>& Operations)
+{
+	if (!Base.IsValid())
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FJsonValue> Root = MakeShared<FJsonValueObject>(Base);
+	for (const TSharedPtr<FJsonValue>& OperationValue : Operations)
+	{
+		const TSharedPtr<FJsonObject>* Operation = nullptr;
+		FString Op;
+		FString Path;
+		if (!OperationValue.IsValid() || !OperationValue->TryGetObject(Operation) ||
+			!(*Operation)->TryGetStringField(TEXT("op"), Op) ||
+			!(*Operation)->TryGetStringField(TEXT("path"), Path) ||
+			!Path.StartsWith(TEXT("/")))
+		{
+			return nullptr;
+		}
+
+		// The leading slash yields an empty first token
+		TArray<FString> Tokens;
+		Path.ParseIntoArray(Tokens, TEXT("/"), false);
+		Tokens.RemoveAt(0);
+		for (FString& Token : Tokens)
+		{
+			Token = SurrealPilotContextDelta::UnescapeToken(Token);
+		}
+
+		const TSharedPtr<FJsonValue> Value = (*Operation)->TryGetField(TEXT("value"));
+		if (Op != TEXT("remove") && !Value.IsValid())
+		{
+			return nullptr;
+		}
+
+		if (!SurrealPilotContextDelta::ApplyAt(Root, Tokens, 0, Op, Value))
+		{
+			return nullptr;
+		}
+	}
+	return Root->AsObject();
+}
+
+const TCHAR* FSurrealPilotContextVersions::VersionHeader = TEXT("X-SurrealPilot-Context-Version");
+
+const FSurrealPilotContextVersions::FVersion* FSurrealPilotContextVersions::Find(const FString& BaseUrl, const FString& AssetPath) const
+{
+	const TMap<FString, FVersion>* Assets = Versions.Find(BaseUrl);
+	return Assets ? Assets->Find(AssetPath) : nullptr;
+}
+
+void FSurrealPilotContextVersions::Acknowledge(const FString& BaseUrl, const FString& AssetPath, const FString& Hash, const TSharedPtr<FJsonObject>& Context)
+{
+	TMap<FString, FVersion>& Assets = Versions.FindOrAdd(BaseUrl);
+	if (Assets.Num() >= SurrealPilotContextDelta::MaxTrackedAssets && !Assets.Contains(AssetPath))
+	{
+		Assets.Reset();
+	}
+
+	FVersion& Version = Assets.FindOrAdd(AssetPath);
+	Version.Hash = Hash;
+	Version.Context = Context;
+}
+
+void FSurrealPilotContextVersions::Forget(const FString& BaseUrl, const FString& AssetPath)
+{
+	if (TMap<FString, FVersion>* Assets = Versions.Find(BaseUrl))
+	{
+		Assets->Remove(AssetPath);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "SurrealPilotContextDelta.h"
+#include "SurrealPilotContextStore.h"
+#include "SurrealPilotJsonWriter.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SurrealPilotContextDeltaTest
+{
+    TSharedPtr<FJsonObject> CopyObject(const TSharedPtr<FJsonObject>& Source)
+    {
+        TSharedPtr<FJsonObject> Copy = MakeShareable(new FJsonObject);
+        Copy->Values = Source->Values;
+        return Copy;
+    }
+
+    FString MakeGuid(int32 A, int32 B, int32 C = 0)
+    {
+        return FGuid(A, B, C, 0x5EED).ToString();
+    }
+
+    /** A node shaped like UContextExporter::ExportNode's output, with a handful of pins */
+    TSharedPtr<FJsonObject> MakeNode(int32 GraphIndex, int32 NodeIndex)
+    {
+        TSharedPtr<FJsonObject> Node = MakeShareable(new FJsonObject);
+        Node->SetStringField(TEXT("guid"), MakeGuid(GraphIndex, NodeIndex));
+        Node->SetStringField(TEXT("name"), FString::Printf(TEXT("K2Node_CallFunction_%d"), NodeIndex));
+        Node->SetStringField(TEXT("class"), TEXT("K2Node_CallFunction"));
+        Node->SetStringField(TEXT("title"), TEXT("Print String"));
+        Node->SetStringField(TEXT("tooltip"), TEXT("Prints a string to the log, and optionally, to the screen"));
+        Node->SetNumberField(TEXT("posX"), (NodeIndex % 40) * 320);
+        Node->SetNumberField(TEXT("posY"), (NodeIndex / 40) * 200);
+        Node->SetStringField(TEXT("functionName"), TEXT("PrintString"));
+
+        static const TCHAR* PinNames[] = { TEXT("execute"), TEXT("then"), TEXT("self"), TEXT("InString"), TEXT("bPrintToScreen") };
+        TArray<TSharedPtr<FJsonValue>> Pins;
+        for (int32 PinIndex = 0; PinIndex < UE_ARRAY_COUNT(PinNames); ++PinIndex)
+        {
+            TSharedPtr<FJsonObject> Pin = MakeShareable(new FJsonObject);
+            Pin->SetStringField(TEXT("guid"), MakeGuid(GraphIndex, NodeIndex, PinIndex + 1));
+            Pin->SetStringField(TEXT("name"), PinNames[PinIndex]);
+            Pin->SetStringField(TEXT("type"), PinIndex < 2 ? TEXT("exec") : TEXT("string"));
+            Pin->SetStringField(TEXT("direction"), PinIndex == 1 ? TEXT("Output") : TEXT("Input"));
+            Pin->SetStringField(TEXT("defaultValue"), PinIndex == 3 ? TEXT("Hello") : TEXT(""));
+            Pin->SetBoolField(TEXT("isConnected"), PinIndex < 2);
+            Pin->SetNumberField(TEXT("connectionCount"), PinIndex < 2 ? 1 : 0);
+            Pins.Add(MakeShareable(new FJsonValueObject(Pin)));
+        }
+        Node->SetArrayField(TEXT("pins"), Pins);
+        return Node;
+    }
+
+    /** A Blueprint export with NodeCount nodes spread over a few graphs, and some variables */
+    TSharedPtr<FJsonObject> MakeBlueprint(int32 NodeCount)
+    {
+        TSharedPtr<FJsonObject> Blueprint = MakeShareable(new FJsonObject);
+        Blueprint->SetStringField(TEXT("name"), TEXT("BP_Synthetic"));
+        Blueprint->SetStringField(TEXT("path"), TEXT("/Game/BP_Synthetic.BP_Synthetic"));
+        Blueprint->SetStringField(TEXT("type"), TEXT("Blueprint"));
+        Blueprint->SetStringField(TEXT("parentClass"), TEXT("Actor"));
+
+        TArray<TSharedPtr<FJsonValue>> Variables;
+        for (int32 Index = 0; Index < 20; ++Index)
+        {
+            TSharedPtr<FJsonObject> Variable = MakeShareable(new FJsonObject);
+            Variable->SetStringField(TEXT("guid"), MakeGuid(1000, Index));
+            Variable->SetStringField(TEXT("name"), FString::Printf(TEXT("Variable%d"), Index));
+            Variable->SetStringField(TEXT("type"), TEXT("float"));
+            Variable->SetStringField(TEXT("defaultValue"), TEXT("0.0"));
+            Variables.Add(MakeShareable(new FJsonValueObject(Variable)));
+        }
+        Blueprint->SetArrayField(TEXT("variables"), Variables);
+
+        const int32 GraphCount = 3;
+        TArray<TSharedPtr<FJsonValue>> Graphs;
+        for (int32 GraphIndex = 0; GraphIndex < GraphCount; ++GraphIndex)
+        {
+            TSharedPtr<FJsonObject> Graph = MakeShareable(new FJsonObject);
+            Graph->SetStringField(TEXT("guid"), MakeGuid(2000, GraphIndex));
+            Graph->SetStringField(TEXT("name"), GraphIndex == 0 ? TEXT("EventGraph") : FString::Printf(TEXT("EventGraph%d"), GraphIndex));
+            Graph->SetStringField(TEXT("schema"), TEXT("EdGraphSchema_K2"));
+
+            TArray<TSharedPtr<FJsonValue>> Nodes;
+            for (int32 NodeIndex = GraphIndex; NodeIndex < NodeCount; NodeIndex += GraphCount)
+            {
+                Nodes.Add(MakeShareable(new FJsonValueObject(MakeNode(GraphIndex, NodeIndex))));
+            }
+            Graph->SetNumberField(TEXT("nodeCount"), Nodes.Num());
+            Graph->SetArrayField(TEXT("nodes"), Nodes);
+            Graphs.Add(MakeShareable(new FJsonValueObject(Graph)));
+        }
+        Blueprint->SetArrayField(TEXT("graphs"), Graphs);
+        return Blueprint;
+    }
+
+    /** Shallow copies down to one node, so Base is left untouched while Edit changes the copy */
+    TSharedPtr<FJsonObject> EditNode(const TSharedPtr<FJsonObject>& Base, int32 GraphIndex, int32 NodeIndex, TFunctionRef<void(FJsonObject&)> Edit)
+    {
+        TSharedPtr<FJsonObject> Target = CopyObject(Base);
+        TArray<TSharedPtr<FJsonValue>> Graphs = Target->GetArrayField(TEXT("graphs"));
+        TSharedPtr<FJsonObject> Graph = CopyObject(Graphs[GraphIndex]->AsObject());
+        TArray<TSharedPtr<FJsonValue>> Nodes = Graph->GetArrayField(TEXT("nodes"));
+
+        const FString NodeGuid = MakeGuid(GraphIndex, NodeIndex);
+        for (TSharedPtr<FJsonValue>& NodeValue : Nodes)
+        {
+            if (NodeValue->AsObject()->GetStringField(TEXT("guid")) == NodeGuid)
+            {
+                TSharedPtr<FJsonObject> Node = CopyObject(NodeValue->AsObject());
+                Edit(*Node);
+                NodeValue = MakeShareable(new FJsonValueObject(Node));
+            }
+        }
+
+        Graph->SetArrayField(TEXT("nodes"), Nodes);
+        Graphs[GraphIndex] = MakeShareable(new FJsonValueObject(Graph));
+        Target->SetArrayField(TEXT("graphs"), Graphs);
+        return Target;
+    }
+
+    FString HashOf(const TSharedPtr<FJsonObject>& Object)
+    {
+        return Object.IsValid() ? FSurrealPilotContextBlob::Encode(Object, true)->Hash : FString();
+    }
+
+    TArray<uint8> EncodeOperations(const TArray<TSharedPtr<FJsonValue>>& Operations)
+    {
+        FSurrealPilotJsonWriter Writer;
+        Writer.BeginArray();
+        for (const TSharedPtr<FJsonValue>& Operation : Operations)
+        {
+            Writer.WriteJsonValue(Operation);
+        }
+        Writer.EndArray();
+        return Writer.MoveBuffer();
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotContextDeltaTest, "SurrealPilot.ContextDelta.DiffAndApply",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotContextDeltaTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotContextDeltaTest;
+
+    TSharedPtr<FJsonObject> Base = MakeBlueprint(30);
+    const FString BaseHash = HashOf(Base);
+
+    TestEqual("Equal exports should produce no operations", FSurrealPilotContextDelta::Diff(Base, MakeBlueprint(30)).Num(), 0);
+
+    // Moving a node replaces its position and nothing else
+    TSharedPtr<FJsonObject> Moved = EditNode(Base, 1, 4, [](FJsonObject& Node)
+    {
+        Node.SetNumberField(TEXT("posX"), 9000);
+        Node.SetNumberField(TEXT("posY"), -120);
+    });
+    TArray<TSharedPtr<FJsonValue>> Operations = FSurrealPilotContextDelta::Diff(Base, Moved);
+    TestEqual("A moved node should take two operations", Operations.Num(), 2);
+    if (Operations.Num() > 0)
+    {
+        const FString ExpectedPrefix = FString::Printf(TEXT("/graphs/%s/nodes/%s/pos"), *MakeGuid(2000, 1), *MakeGuid(1, 4));
+        TestTrue("Operations should address the node by GUID", Operations[0]->AsObject()->GetStringField(TEXT("path")).StartsWith(ExpectedPrefix));
+        TestEqual("Operations should replace", Operations[0]->AsObject()->GetStringField(TEXT("op")), FString(TEXT("replace")));
+    }
+    TestEqual("Applying the delta should rebuild the edited export", HashOf(FSurrealPilotContextDelta::Apply(Base, Operations)), HashOf(Moved));
+    TestEqual("Applying should not modify the base", HashOf(Base), BaseHash);
+
+    // Pin edits, a new field, a removed node, a new node and a removed variable in one delta
+    TSharedPtr<FJsonObject> Edited = EditNode(Moved, 0, 9, [](FJsonObject& Node)
+    {
+        TArray<TSharedPtr<FJsonValue>> Pins = Node.GetArrayField(TEXT("pins"));
+        TSharedPtr<FJsonObject> Pin = CopyObject(Pins[3]->AsObject());
+        Pin->SetStringField(TEXT("defaultValue"), TEXT("Goodbye/~world"));
+        Pins[3] = MakeShareable(new FJsonValueObject(Pin));
+        Node.SetArrayField(TEXT("pins"), Pins);
+        Node.SetStringField(TEXT("comment"), TEXT("Changed greeting"));
+    });
+    {
+        TArray<TSharedPtr<FJsonValue>> Graphs = Edited->GetArrayField(TEXT("graphs"));
+        TSharedPtr<FJsonObject> Graph = CopyObject(Graphs[2]->AsObject());
+        TArray<TSharedPtr<FJsonValue>> Nodes = Graph->GetArrayField(TEXT("nodes"));
+        Nodes.RemoveAt(1);
+        Nodes.Add(MakeShareable(new FJsonValueObject(MakeNode(2, 500))));
+        Graph->SetArrayField(TEXT("nodes"), Nodes);
+        Graphs[2] = MakeShareable(new FJsonValueObject(Graph));
+        Edited->SetArrayField(TEXT("graphs"), Graphs);
+
+        TArray<TSharedPtr<FJsonValue>> Variables = Edited->GetArrayField(TEXT("variables"));
+        Variables.RemoveAt(7);
+        Edited->SetArrayField(TEXT("variables"), Variables);
+    }
+    Operations = FSurrealPilotContextDelta::Diff(Moved, Edited);
+    TestEqual("Each change should take one operation", Operations.Num(), 5);
+    TestEqual("A combined delta should rebuild the edited export", HashOf(FSurrealPilotContextDelta::Apply(Moved, Operations)), HashOf(Edited));
+
+    // Reordered elements cannot be expressed as removes and appends, so the array is replaced and still rebuilds
+    TSharedPtr<FJsonObject> Reordered = CopyObject(Base);
+    TArray<TSharedPtr<FJsonValue>> Variables = Reordered->GetArrayField(TEXT("variables"));
+    Variables.Swap(0, 1);
+    Reordered->SetArrayField(TEXT("variables"), Variables);
+    Operations = FSurrealPilotContextDelta::Diff(Base, Reordered);
+    TestEqual("A reordered array should be replaced whole", Operations.Num(), 1);
+    TestEqual("A reordered array should still rebuild", HashOf(FSurrealPilotContextDelta::Apply(Base, Operations)), HashOf(Reordered));
+
+    // Operations that do not fit the base are rejected
+    TSharedPtr<FJsonObject> Missing = MakeShareable(new FJsonObject);
+    Missing->SetStringField(TEXT("op"), TEXT("replace"));
+    Missing->SetStringField(TEXT("path"), FString::Printf(TEXT("/graphs/%s/nodes/%s/posX"), *MakeGuid(2000, 0), *MakeGuid(7, 7)));
+    Missing->SetNumberField(TEXT("value"), 1);
+    TArray<TSharedPtr<FJsonValue>> BadOperations;
+    BadOperations.Add(MakeShareable(new FJsonValueObject(Missing)));
+    TestFalse("A delta against a missing node should not apply", FSurrealPilotContextDelta::Apply(Base, BadOperations).IsValid());
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotContextDeltaBenchmarkTest, "SurrealPilot.ContextDelta.Benchmark",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotContextDeltaBenchmarkTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotContextDeltaTest;
+
+    // Override with -SurrealPilotDeltaNodes=N to measure other graph sizes
+    int32 LargestNodeCount = 3000;
+    FParse::Value(FCommandLine::Get(), TEXT("SurrealPilotDeltaNodes="), LargestNodeCount);
+    const int32 Iterations = 5;
+
+    for (const int32 NodeCount : { 300, LargestNodeCount })
+    {
+        TSharedPtr<FJsonObject> Base = MakeBlueprint(NodeCount);
+        TSharedPtr<FJsonObject> Target = EditNode(Base, 0, 0, [](FJsonObject& Node)
+        {
+            Node.SetNumberField(TEXT("posX"), 4242);
+        });
+
+        // Full upload: the canonical export, which is also encoded for its hash on every send
+        double FullSeconds = 0.0;
+        int32 FullBytes = 0;
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            const double Start = FPlatformTime::Seconds();
+            FullBytes = FSurrealPilotContextBlob::Encode(Target, true)->Json.Num();
+            FullSeconds += FPlatformTime::Seconds() - Start;
+        }
+
+        // Delta: diff against the acknowledged export and encode the operations
+        double DeltaSeconds = 0.0;
+        TArray<TSharedPtr<FJsonValue>> Operations;
+        int32 DeltaBytes = 0;
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            const double Start = FPlatformTime::Seconds();
+            Operations = FSurrealPilotContextDelta::Diff(Base, Target);
+            DeltaBytes = EncodeOperations(Operations).Num();
+            DeltaSeconds += FPlatformTime::Seconds() - Start;
+        }
+
+        const double ApplyStart = FPlatformTime::Seconds();
+        const FString RebuiltHash = HashOf(FSurrealPilotContextDelta::Apply(Base, Operations));
+        const double ApplySeconds = FPlatformTime::Seconds() - ApplyStart;
+
+        TestEqual(FString::Printf(TEXT("%d nodes: one edit should take one operation"), NodeCount), Operations.Num(), 1);
+        TestEqual(FString::Printf(TEXT("%d nodes: the delta should rebuild the export"), NodeCount), RebuiltHash, HashOf(Target));
+        TestTrue(FString::Printf(TEXT("%d nodes: the delta should be under 1%% of the export"), NodeCount), DeltaBytes * 100 < FullBytes);
+
+        AddInfo(FString::Printf(TEXT("%d nodes: full %d bytes in %.2f ms, delta %d bytes in %.2f ms (%.3f%% of full), apply + hash %.2f ms"),
+            NodeCount, FullBytes, FullSeconds * 1000.0 / Iterations, DeltaBytes, DeltaSeconds * 1000.0 / Iterations,
+            100.0 * DeltaBytes / FMath::Max(FullBytes, 1), ApplySeconds * 1000.0));
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
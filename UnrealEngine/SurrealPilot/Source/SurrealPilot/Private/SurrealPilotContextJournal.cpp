@@ -0,0 +1,383 @@
+#include "SurrealPilotContextJournal.h"
+#include "SurrealPilotJsonWriter.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/Archive.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace SurrealPilotContextJournal
+{
+	/** Buffered appends are written at once when they reach this size, without waiting for the delay */
+	constexpr int32 MaxBufferedBytes = 64 * 1024;
+
+	/** Below this many dead records the file is not worth rewriting */
+	constexpr int32 MinDeadRecordsToCompact = 64;
+}
+
+FSurrealPilotContextJournal::~FSurrealPilotContextJournal()
+{
+	Close();
+}
+
+FString FSurrealPilotContextJournal::GetDefaultPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("SurrealPilot") / TEXT("ContextJournal.jsonl");
+}
+
+void FSurrealPilotContextJournal::Open(const FString& InFilePath)
+{
+	Close();
+	FilePath = InFilePath;
+	Stats = FSurrealPilotJournalStats();
+
+	FString Contents;
+	if (!FFileHelper::LoadFileToString(Contents, *FilePath))
+	{
+		return;
+	}
+
+	TArray<FString> Lines;
+	Contents.ParseIntoArrayLines(Lines);
+	for (const FString& Line : Lines)
+	{
+		Load(Line);
+	}
+	DeadRecords = FileRecords - Entries.Num();
+
+	// A line cut short by a crash would run into the next append, so start the file over without it
+	if (!Contents.IsEmpty() && !Contents.EndsWith(TEXT("\n")))
+	{
+		Compact();
+	}
+	else
+	{
+		CompactIfWasteful();
+	}
+
+	if (Entries.Num() > 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("SurrealPilot: %d context messages waiting in %s"), Entries.Num(), *FilePath);
+	}
+}
+
+void FSurrealPilotContextJournal::Close()
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	Flush();
+	FilePath.Reset();
+	Entries.Reset();
+	SequenceByKey.Reset();
+	LastSequence = 0;
+	FileRecords = 0;
+	DeadRecords = 0;
+}
+
+void FSurrealPilotContextJournal::Load(const FString& Line)
+{
+	++FileRecords;
+
+	TSharedPtr<FJsonObject> Record;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Line), Record) || !Record.IsValid())
+	{
+		return;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Done = nullptr;
+	if (Record->TryGetArrayField(TEXT("done"), Done))
+	{
+		for (const TSharedPtr<FJsonValue>& Sequence : *Done)
+		{
+			RemoveEntry(static_cast<int64>(Sequence->AsNumber()));
+		}
+		return;
+	}
+
+	FSurrealPilotJournalEntry Entry;
+	int32 Priority = 0;
+	const TSharedPtr<FJsonObject>* Data = nullptr;
+	if (!Record->TryGetNumberField(TEXT("seq"), Entry.Sequence) || !Record->TryGetStringField(TEXT("type"), Entry.Type) || !Record->TryGetObjectField(TEXT("data"), Data))
+	{
+		return;
+	}
+	Record->TryGetStringField(TEXT("key"), Entry.SupersedeKey);
+	Record->TryGetNumberField(TEXT("priority"), Priority);
+	Entry.Priority = static_cast<uint8>(Priority);
+	Entry.Data = *Data;
+
+	LastSequence = FMath::Max(LastSequence, Entry.Sequence);
+	AddEntry(MoveTemp(Entry));
+}
+
+void FSurrealPilotContextJournal::Append(const FString& Type, const TSharedPtr<FJsonObject>& Data, const FString& SupersedeKey, uint8 Priority)
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	FSurrealPilotJournalEntry Entry;
+	Entry.Sequence = ++LastSequence;
+	Entry.Type = Type;
+	Entry.Data = Data.IsValid() ? Data : MakeShared<FJsonObject>();
+	Entry.SupersedeKey = SupersedeKey;
+	Entry.Priority = Priority;
+
+	BufferRecord(EncodeEntry(Entry));
+	++FileRecords;
+	++Stats.Appended;
+	if (AddEntry(MoveTemp(Entry)))
+	{
+		++Stats.Superseded;
+		++DeadRecords;
+	}
+
+	// Hold on to the newest messages; the oldest are the least likely to still matter
+	if (Entries.Num() > MaxEntries)
+	{
+		TArray<int64> Dropped;
+		for (int32 Index = 0; Index < Entries.Num() - MaxEntries; ++Index)
+		{
+			Dropped.Add(Entries[Index].Sequence);
+		}
+		for (const int64 Sequence : Dropped)
+		{
+			RemoveEntry(Sequence);
+		}
+		Stats.Dropped += Dropped.Num();
+		BufferDoneRecord(Dropped);
+	}
+
+	CompactIfWasteful();
+}
+
+TArray<FSurrealPilotJournalEntry> FSurrealPilotContextJournal::Peek(int32 InMaxEntries) const
+{
+	TArray<FSurrealPilotJournalEntry> Oldest;
+	const int32 Count = FMath::Min(InMaxEntries, Entries.Num());
+	Oldest.Reserve(Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Oldest.Add(Entries[Index]);
+	}
+	return Oldest;
+}
+
+void FSurrealPilotContextJournal::Remove(const TArray<int64>& Sequences)
+{
+	TArray<int64> Removed;
+	for (const int64 Sequence : Sequences)
+	{
+		if (RemoveEntry(Sequence))
+		{
+			Removed.Add(Sequence);
+		}
+	}
+	if (Removed.Num() == 0)
+	{
+		return;
+	}
+
+	Stats.Delivered += Removed.Num();
+
+	// Nothing left to deliver: the whole file is dead
+	if (Entries.Num() == 0)
+	{
+		Compact();
+		return;
+	}
+
+	BufferDoneRecord(Removed);
+	CompactIfWasteful();
+}
+
+bool FSurrealPilotContextJournal::AddEntry(FSurrealPilotJournalEntry&& Entry)
+{
+	bool bReplaced = false;
+	if (!Entry.SupersedeKey.IsEmpty())
+	{
+		if (const int64* Existing = SequenceByKey.Find(Entry.SupersedeKey))
+		{
+			bReplaced = RemoveEntry(*Existing);
+		}
+		SequenceByKey.Add(Entry.SupersedeKey, Entry.Sequence);
+	}
+	Entries.Add(MoveTemp(Entry));
+	return bReplaced;
+}
+
+bool FSurrealPilotContextJournal::RemoveEntry(int64 Sequence)
+{
+	const int32 Index = Algo::BinarySearchBy(Entries, Sequence, &FSurrealPilotJournalEntry::Sequence);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FString& Key = Entries[Index].SupersedeKey;
+	if (!Key.IsEmpty())
+	{
+		const int64* KeySequence = SequenceByKey.Find(Key);
+		if (KeySequence && *KeySequence == Sequence)
+		{
+			SequenceByKey.Remove(Key);
+		}
+	}
+	Entries.RemoveAt(Index, 1, EAllowShrinking::No);
+	return true;
+}
+
+void FSurrealPilotContextJournal::BufferDoneRecord(const TArray<int64>& Sequences)
+{
+	FSurrealPilotJsonWriter Writer(Sequences.Num() * 8 + 16);
+	Writer.BeginObject();
+	Writer.BeginArray(TEXT("done"));
+	for (const int64 Sequence : Sequences)
+	{
+		Writer.WriteInteger(Sequence);
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+
+	TArray<uint8> Record = Writer.GetBuffer();
+	Record.Add('\n');
+	BufferRecord(Record);
+
+	// The record describes nothing live, and neither do the messages it names
+	++FileRecords;
+	DeadRecords += Sequences.Num() + 1;
+}
+
+TArray<uint8> FSurrealPilotContextJournal::EncodeEntry(const FSurrealPilotJournalEntry& Entry)
+{
+	FSurrealPilotJsonWriter Writer;
+	Writer.BeginObject();
+	Writer.WriteInteger(TEXT("seq"), Entry.Sequence);
+	Writer.WriteString(TEXT("type"), Entry.Type);
+	if (!Entry.SupersedeKey.IsEmpty())
+	{
+		Writer.WriteString(TEXT("key"), Entry.SupersedeKey);
+	}
+	Writer.WriteInteger(TEXT("priority"), Entry.Priority);
+	Writer.WriteJsonObject(TEXT("data"), Entry.Data);
+	Writer.EndObject();
+
+	TArray<uint8> Record = Writer.GetBuffer();
+	Record.Add('\n');
+	return Record;
+}
+
+void FSurrealPilotContextJournal::BufferRecord(const TArray<uint8>& Record)
+{
+	WriteBuffer.Append(Record);
+	if (WriteBuffer.Num() >= SurrealPilotContextJournal::MaxBufferedBytes || FlushDelaySeconds <= 0.0f)
+	{
+		Flush();
+		return;
+	}
+
+	// Edits come in bursts; one write per burst keeps the journal off the editor's frame time
+	if (!FlushHandle.IsValid())
+	{
+		FlushHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([this](float DeltaTime)
+		{
+			// The ticker removes this delegate when it returns false
+			FlushHandle.Reset();
+			Flush();
+			return false;
+		}), FlushDelaySeconds);
+	}
+}
+
+void FSurrealPilotContextJournal::Flush()
+{
+	if (FlushHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(FlushHandle);
+		FlushHandle.Reset();
+	}
+	if (WriteBuffer.Num() == 0 || !IsOpen())
+	{
+		return;
+	}
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath, FILEWRITE_Append | FILEWRITE_AllowRead));
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: could not write context journal %s"), *FilePath);
+		return;
+	}
+
+	Writer->Serialize(WriteBuffer.GetData(), WriteBuffer.Num());
+	Writer->Close();
+	++Stats.DiskWrites;
+	Stats.BytesWritten += WriteBuffer.Num();
+	WriteBuffer.Reset();
+}
+
+void FSurrealPilotContextJournal::CompactIfWasteful()
+{
+	if (DeadRecords >= SurrealPilotContextJournal::MinDeadRecordsToCompact && DeadRecords > FileRecords - DeadRecords)
+	{
+		Compact();
+	}
+}
+
+void FSurrealPilotContextJournal::Compact()
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	if (Entries.Num() == 0)
+	{
+		if (!IFileManager::Get().Delete(*FilePath, false, false, true))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: could not compact context journal %s"), *FilePath);
+			return;
+		}
+		DiscardRewrittenRecords();
+		return;
+	}
+
+	TArray<uint8> Contents;
+	for (const FSurrealPilotJournalEntry& Entry : Entries)
+	{
+		Contents.Append(EncodeEntry(Entry));
+	}
+
+	// Written beside the journal and moved over it, so a crash mid-rewrite leaves the old file intact.
+	// Until the move succeeds the old file is the journal, and the buffered records still belong at its end.
+	const FString TempPath = FilePath + TEXT(".tmp");
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+	if (!FFileHelper::SaveArrayToFile(Contents, *TempPath) || !IFileManager::Get().Move(*FilePath, *TempPath, true, true))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: could not compact context journal %s"), *FilePath);
+		return;
+	}
+	DiscardRewrittenRecords();
+	++Stats.DiskWrites;
+	Stats.BytesWritten += Contents.Num();
+}
+
+void FSurrealPilotContextJournal::DiscardRewrittenRecords()
+{
+	// Everything buffered is about messages the rewrite covers
+	if (FlushHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(FlushHandle);
+		FlushHandle.Reset();
+	}
+	WriteBuffer.Reset();
+	FileRecords = Entries.Num();
+	DeadRecords = 0;
+	++Stats.Compactions;
+}
\ No newline at end of file
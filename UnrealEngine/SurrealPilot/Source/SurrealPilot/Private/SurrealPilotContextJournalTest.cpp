@@ -0,0 +1,160 @@
+#include "SurrealPilotContextJournal.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SurrealPilotContextJournalTest
+{
+    /** A journal file of its own under Saved/Automation, removed before the test uses it */
+    FString MakeJournalPath(const TCHAR* Name)
+    {
+        const FString FilePath = FPaths::ProjectSavedDir() / TEXT("Automation") / TEXT("SurrealPilot") / Name;
+        IFileManager::Get().Delete(*FilePath, false, false, true);
+        return FilePath;
+    }
+
+    TSharedPtr<FJsonObject> MakeNotification(const FString& PropertyPath, int32 Value)
+    {
+        TSharedPtr<FJsonObject> Notification = MakeShareable(new FJsonObject);
+        Notification->SetStringField(TEXT("type"), TEXT("property_changed"));
+        Notification->SetStringField(TEXT("property_path"), PropertyPath);
+        Notification->SetNumberField(TEXT("new_value"), Value);
+        return Notification;
+    }
+
+    /** Values of the waiting messages, oldest first */
+    FString DescribeEntries(const FSurrealPilotContextJournal& Journal)
+    {
+        TArray<FString> Values;
+        for (const FSurrealPilotJournalEntry& Entry : Journal.Peek(Journal.Num()))
+        {
+            Values.Add(FString::FromInt(static_cast<int32>(Entry.Data->GetNumberField(TEXT("new_value")))));
+        }
+        return FString::Join(Values, TEXT("|"));
+    }
+
+    int32 CountLines(const FString& FilePath)
+    {
+        TArray<FString> Lines;
+        FFileHelper::LoadFileToStringArray(Lines, *FilePath);
+        return Lines.Num();
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotContextJournalTest, "SurrealPilot.ContextJournal.AppendSupersedeAndReload",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotContextJournalTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotContextJournalTest;
+    const FString FilePath = MakeJournalPath(TEXT("AppendSupersedeAndReload.jsonl"));
+
+    {
+        FSurrealPilotContextJournal Journal;
+        Journal.Open(FilePath);
+        TestTrue("A missing file should open as an empty journal", Journal.IsOpen() && Journal.IsEmpty());
+
+        Journal.Append(TEXT("notification"), MakeNotification(TEXT("Light.Intensity"), 1), TEXT("Light.Intensity"), 3);
+        Journal.Append(TEXT("notification"), MakeNotification(TEXT("Door.Open"), 2), FString(), 1);
+        Journal.Append(TEXT("notification"), MakeNotification(TEXT("Light.Intensity"), 3), TEXT("Light.Intensity"), 3);
+        Journal.Append(TEXT("notification"), MakeNotification(TEXT("Door.Open"), 4), FString(), 1);
+
+        TestEqual("A newer message with the same key should replace the older one", DescribeEntries(Journal), FString(TEXT("2|3|4")));
+        TestEqual("Superseded count", Journal.GetStats().Superseded, 1);
+        TestEqual("Appends should wait for the batched write", Journal.GetStats().DiskWrites, 0);
+
+        // The door's first message is delivered; the rest survive a restart
+        Journal.Remove({ Journal.Peek(1)[0].Sequence });
+        Journal.Flush();
+        TestEqual("Every append and the delivery should go to disk in one write", Journal.GetStats().DiskWrites, 1);
+        TestEqual("Delivered count", Journal.GetStats().Delivered, 1);
+    }
+
+    {
+        FSurrealPilotContextJournal Journal;
+        Journal.Open(FilePath);
+        TestEqual("Reloading should leave the undelivered messages in order", DescribeEntries(Journal), FString(TEXT("3|4")));
+
+        const TArray<FSurrealPilotJournalEntry> Entries = Journal.Peek(2);
+        if (TestEqual("Two messages should be waiting", Entries.Num(), 2))
+        {
+            TestEqual("Type should survive reloading", Entries[0].Type, FString(TEXT("notification")));
+            TestEqual("Key should survive reloading", Entries[0].SupersedeKey, FString(TEXT("Light.Intensity")));
+            TestEqual("Priority should survive reloading", static_cast<int32>(Entries[0].Priority), 3);
+        }
+
+        // Keys still supersede across a restart, and new messages go after the reloaded ones
+        Journal.Append(TEXT("notification"), MakeNotification(TEXT("Light.Intensity"), 5), TEXT("Light.Intensity"), 3);
+        TestEqual("A reloaded message should be superseded by a new one with its key", DescribeEntries(Journal), FString(TEXT("4|5")));
+        TestTrue("New messages should be numbered after the reloaded ones", Journal.Peek(2)[1].Sequence > Journal.Peek(1)[0].Sequence);
+
+        TArray<int64> Sequences;
+        for (const FSurrealPilotJournalEntry& Entry : Journal.Peek(Journal.Num()))
+        {
+            Sequences.Add(Entry.Sequence);
+        }
+        Journal.Remove(Sequences);
+        TestTrue("The journal should be empty once everything is delivered", Journal.IsEmpty());
+        TestFalse("An empty journal should leave no file behind", IFileManager::Get().FileExists(*FilePath));
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotContextJournalCompactionTest, "SurrealPilot.ContextJournal.Compaction",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotContextJournalCompactionTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotContextJournalTest;
+    const FString FilePath = MakeJournalPath(TEXT("Compaction.jsonl"));
+
+    FSurrealPilotContextJournal Journal;
+    Journal.SetFlushDelay(0.0f);
+    Journal.Open(FilePath);
+
+    // Dragging a slider on 4 lights while offline: 1000 messages, of which 4 are still worth sending
+    const int32 MessageCount = 1000;
+    for (int32 Index = 0; Index < MessageCount; ++Index)
+    {
+        const FString PropertyPath = FString::Printf(TEXT("PointLight_%d.Intensity"), Index % 4);
+        Journal.Append(TEXT("notification"), MakeNotification(PropertyPath, Index), PropertyPath, 3);
+    }
+
+    TestEqual("Only the latest message per light should be waiting", DescribeEntries(Journal), FString(TEXT("996|997|998|999")));
+    TestTrue("Superseded messages should have been compacted away", Journal.GetStats().Compactions > 0);
+    TestTrue("The file should stay near the live messages rather than grow with every append", CountLines(FilePath) < 4 * 40);
+    AddInfo(FString::Printf(TEXT("%d offline messages on 4 keys: %d disk writes, %d compactions, %d lines on disk"),
+        MessageCount, Journal.GetStats().DiskWrites, Journal.GetStats().Compactions, CountLines(FilePath)));
+
+    // A line cut short by a crash is ignored, and the next append does not run into it
+    Journal.Close();
+    FString Contents;
+    FFileHelper::LoadFileToString(Contents, *FilePath);
+    FFileHelper::SaveStringToFile(Contents + TEXT("{\"seq\":5000,\"type\":\"notif"), *FilePath);
+
+    Journal.Open(FilePath);
+    TestEqual("A torn trailing line should be skipped", DescribeEntries(Journal), FString(TEXT("996|997|998|999")));
+    Journal.Append(TEXT("notification"), MakeNotification(TEXT("Door.Open"), 1000), FString(), 1);
+    Journal.Close();
+    Journal.Open(FilePath);
+    TestEqual("An append after a torn line should load", DescribeEntries(Journal), FString(TEXT("996|997|998|999|1000")));
+
+    // Beyond the limit the oldest messages go
+    Journal.SetMaxEntries(3);
+    Journal.Append(TEXT("notification"), MakeNotification(TEXT("Door.Open"), 1001), FString(), 1);
+    TestEqual("Only the newest messages should be kept", DescribeEntries(Journal), FString(TEXT("999|1000|1001")));
+    TestEqual("Dropped count", Journal.GetStats().Dropped, 3);
+    Journal.Close();
+    Journal.Open(FilePath);
+    TestEqual("Dropped messages should stay dropped after reloading", DescribeEntries(Journal), FString(TEXT("999|1000|1001")));
+
+    Journal.Close();
+    IFileManager::Get().Delete(*FilePath, false, false, true);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "SurrealPilotContextStore.h"
+#include "SurrealPilotJsonWriter.h"
+#include "Misc/SecureHash.h"
+
+namespace SurrealPilotContextStore
+{
+	/** Hashes remembered per endpoint; past this the set starts over rather than growing for the whole session */
+	constexpr int32 MaxStoredHashes = 4096;
+
+	/** Top-level fields the exporters stamp on every export, left out of the hash */
+	const TCHAR* const VolatileFields[] = { TEXT("timestamp") };
+
+	/** Object without its volatile fields; Object itself when it has none */
+	TSharedPtr<FJsonObject> WithoutVolatileFields(const TSharedPtr<FJsonObject>& Object)
+	{
+		TSharedPtr<FJsonObject> Stable = Object;
+		for (const TCHAR* Field : VolatileFields)
+		{
+			if (Stable.IsValid() && Stable->HasField(Field))
+			{
+				// Shallow: only the top level changes, so the values are shared rather than copied
+				if (Stable == Object)
+				{
+					Stable = MakeShared<FJsonObject>(*Object);
+				}
+				Stable->RemoveField(Field);
+			}
+		}
+		return Stable;
+	}
+}
+
+const TCHAR* FSurrealPilotContextStore::StoredHeader = TEXT("X-SurrealPilot-Context-Stored");
+
+TSharedRef<const FSurrealPilotContextBlob> FSurrealPilotContextBlob::Encode(const TSharedPtr<FJsonObject>& Object, bool bHash)
+{
+	FSurrealPilotJsonWriter Writer;
+	Writer.SetSortKeys(bHash);
+	Writer.WriteJsonObject(Object);
+
+	TSharedRef<FSurrealPilotContextBlob> Blob = MakeShared<FSurrealPilotContextBlob>();
+	Blob->Json = Writer.MoveBuffer();
+
+	if (bHash)
+	{
+		// Usually there is a timestamp, and the stable part is encoded again on its own to hash it
+		const TSharedPtr<FJsonObject> Stable = SurrealPilotContextStore::WithoutVolatileFields(Object);
+		TArray<uint8> StableJson;
+		if (Stable != Object)
+		{
+			FSurrealPilotJsonWriter StableWriter(Blob->Json.Num());
+			StableWriter.SetSortKeys(true);
+			StableWriter.WriteJsonObject(Stable);
+			StableJson = StableWriter.MoveBuffer();
+		}
+		const TArray<uint8>& Hashed = Stable != Object ? StableJson : Blob->Json;
+
+		uint8 Digest[FSHA1::DigestSize];
+		FSHA1::HashBuffer(Hashed.GetData(), Hashed.Num(), Digest);
+		Blob->Hash = TEXT("sha1:") + BytesToHex(Digest, FSHA1::DigestSize).ToLower();
+	}
+
+	return Blob;
+}
+
+bool FSurrealPilotContextStore::IsStored(const FString& BaseUrl, const FString& Hash) const
+{
+	const TSet<FString>* Hashes = StoredHashes.Find(BaseUrl);
+	return Hashes && Hashes->Contains(Hash);
+}
+
+void FSurrealPilotContextStore::MarkStored(const FString& BaseUrl, const FString& HeaderValue)
+{
+	if (HeaderValue.IsEmpty())
+	{
+		return;
+	}
+
+	TSet<FString>& Hashes = StoredHashes.FindOrAdd(BaseUrl);
+	if (Hashes.Num() >= SurrealPilotContextStore::MaxStoredHashes)
+	{
+		Hashes.Reset();
+	}
+
+	TArray<FString> Listed;
+	HeaderValue.ParseIntoArray(Listed, TEXT(","));
+	for (const FString& Hash : Listed)
+	{
+		Hashes.Add(Hash.TrimStartAndEnd());
+	}
+}
+
+void FSurrealPilotContextStore::Forget(const FString& BaseUrl)
+{
+	StoredHashes.Remove(BaseUrl);
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "SurrealPilotEndpointManager.h"
+
+namespace SurrealPilotEndpointManager
+{
+	/** Weight of a new probe in the smoothed round-trip time */
+	constexpr double RoundTripSmoothing = 0.3;
+
+	/** A healthy active endpoint is only replaced by one at least this much faster, so near-equal endpoints don't flap */
+	constexpr double SwitchRatio = 0.75;
+}
+
+void FSurrealPilotEndpointManager::SetEndpoints(const TArray<FString>& BaseUrls)
+{
+	bool bUnchanged = BaseUrls.Num() == Endpoints.Num();
+	for (int32 Index = 0; bUnchanged && Index < BaseUrls.Num(); ++Index)
+	{
+		bUnchanged = Endpoints[Index].BaseUrl == BaseUrls[Index];
+	}
+	if (bUnchanged)
+	{
+		return;
+	}
+
+	const FString PreviousActive = GetActiveEndpoint();
+
+	TArray<FSurrealPilotEndpointStatus> NewEndpoints;
+	NewEndpoints.Reserve(BaseUrls.Num());
+	for (const FString& BaseUrl : BaseUrls)
+	{
+		if (const FSurrealPilotEndpointStatus* Existing = FindEndpoint(BaseUrl))
+		{
+			NewEndpoints.Add(*Existing);
+		}
+		else
+		{
+			FSurrealPilotEndpointStatus& Added = NewEndpoints.AddDefaulted_GetRef();
+			Added.BaseUrl = BaseUrl;
+		}
+	}
+
+	Endpoints = MoveTemp(NewEndpoints);
+	ActiveIndex = Endpoints.IndexOfByPredicate([&PreviousActive](const FSurrealPilotEndpointStatus& Endpoint) { return Endpoint.BaseUrl == PreviousActive; });
+	Reevaluate();
+}
+
+FString FSurrealPilotEndpointManager::GetActiveEndpoint() const
+{
+	return Endpoints.IsValidIndex(ActiveIndex) ? Endpoints[ActiveIndex].BaseUrl : FString();
+}
+
+void FSurrealPilotEndpointManager::RecordProbe(const FString& BaseUrl, bool bSucceeded, double RoundTripSeconds)
+{
+	FSurrealPilotEndpointStatus* Endpoint = FindEndpoint(BaseUrl);
+	if (!Endpoint)
+	{
+		return;
+	}
+
+	++Endpoint->Probes;
+	if (!bSucceeded)
+	{
+		RecordFailure(BaseUrl);
+		return;
+	}
+
+	Endpoint->RoundTripSeconds = Endpoint->bMeasured
+		? FMath::Lerp(Endpoint->RoundTripSeconds, RoundTripSeconds, SurrealPilotEndpointManager::RoundTripSmoothing)
+		: RoundTripSeconds;
+	Endpoint->bMeasured = true;
+	RecordSuccess(BaseUrl);
+}
+
+void FSurrealPilotEndpointManager::RecordSuccess(const FString& BaseUrl)
+{
+	FSurrealPilotEndpointStatus* Endpoint = FindEndpoint(BaseUrl);
+	if (!Endpoint)
+	{
+		return;
+	}
+
+	if (!Endpoint->bHealthy)
+	{
+		UE_LOG(LogTemp, Log, TEXT("SurrealPilot: endpoint %s is healthy again"), *BaseUrl);
+	}
+	Endpoint->bHealthy = true;
+	Endpoint->ConsecutiveFailures = 0;
+	Reevaluate();
+}
+
+void FSurrealPilotEndpointManager::RecordFailure(const FString& BaseUrl)
+{
+	FSurrealPilotEndpointStatus* Endpoint = FindEndpoint(BaseUrl);
+	if (!Endpoint)
+	{
+		return;
+	}
+
+	++Endpoint->ConsecutiveFailures;
+	Endpoint->bHealthy = false;
+	Reevaluate();
+}
+
+FSurrealPilotEndpointStatus* FSurrealPilotEndpointManager::FindEndpoint(const FString& BaseUrl)
+{
+	return Endpoints.FindByPredicate([&BaseUrl](const FSurrealPilotEndpointStatus& Endpoint) { return Endpoint.BaseUrl == BaseUrl; });
+}
+
+void FSurrealPilotEndpointManager::Reevaluate()
+{
+	if (Endpoints.Num() == 0)
+	{
+		ActiveIndex = INDEX_NONE;
+		return;
+	}
+
+	// Fastest measured healthy endpoint, else the most preferred healthy one
+	int32 BestIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < Endpoints.Num(); ++Index)
+	{
+		const FSurrealPilotEndpointStatus& Candidate = Endpoints[Index];
+		if (!Candidate.bHealthy)
+		{
+			continue;
+		}
+
+		if (BestIndex == INDEX_NONE)
+		{
+			BestIndex = Index;
+			continue;
+		}
+
+		const FSurrealPilotEndpointStatus& Best = Endpoints[BestIndex];
+		if (Candidate.bMeasured && (!Best.bMeasured || Candidate.RoundTripSeconds < Best.RoundTripSeconds))
+		{
+			BestIndex = Index;
+		}
+	}
+
+	// Nothing healthy: stay where we are (or on the preferred endpoint) until something recovers
+	if (BestIndex == INDEX_NONE)
+	{
+		if (!Endpoints.IsValidIndex(ActiveIndex))
+		{
+			ActiveIndex = 0;
+		}
+		return;
+	}
+
+	if (Endpoints.IsValidIndex(ActiveIndex) && ActiveIndex != BestIndex)
+	{
+		const FSurrealPilotEndpointStatus& Active = Endpoints[ActiveIndex];
+		const FSurrealPilotEndpointStatus& Best = Endpoints[BestIndex];
+		const bool bActiveGoodEnough = Active.bHealthy &&
+			(!Best.bMeasured || (Active.bMeasured && Best.RoundTripSeconds > Active.RoundTripSeconds * SurrealPilotEndpointManager::SwitchRatio));
+		if (bActiveGoodEnough)
+		{
+			return;
+		}
+	}
+
+	if (ActiveIndex != BestIndex)
+	{
+		if (Endpoints.IsValidIndex(ActiveIndex))
+		{
+			++SwitchCount;
+			UE_LOG(LogTemp, Log, TEXT("SurrealPilot: switching API endpoint from %s to %s"), *Endpoints[ActiveIndex].BaseUrl, *Endpoints[BestIndex].BaseUrl);
+		}
+		ActiveIndex = BestIndex;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "SurrealPilotGraphContextCache.h"
+#include "Dom/JsonValue.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+#include "Engine/Blueprint.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_Event.h"
+#include "K2Node_Variable.h"
+#include "Misc/Crc.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace SurrealPilotGraphContextCache
+{
+	/** Bookkeeping FJsonValue and FJsonObject allocations carry beyond their contents */
+	constexpr int64 ValueOverheadBytes = 48;
+
+	int64 EstimateValueBytes(const TSharedPtr<FJsonValue>& Value)
+	{
+		if (!Value.IsValid())
+		{
+			return 0;
+		}
+
+		int64 ValueBytes = ValueOverheadBytes;
+		switch (Value->Type)
+		{
+		case EJson::String:
+			ValueBytes += Value->AsString().Len() * sizeof(TCHAR);
+			break;
+		case EJson::Array:
+			for (const TSharedPtr<FJsonValue>& Element : Value->AsArray())
+			{
+				ValueBytes += EstimateValueBytes(Element);
+			}
+			break;
+		case EJson::Object:
+			ValueBytes += FSurrealPilotGraphContextCache::EstimateBytes(Value->AsObject());
+			break;
+		default:
+			break;
+		}
+		return ValueBytes;
+	}
+
+	uint32 HashString(const FString& String, uint32 Crc)
+	{
+		return FCrc::MemCrc32(*String, String.Len() * sizeof(TCHAR), Crc);
+	}
+
+	template <typename T>
+	uint32 HashValue(const T& Value, uint32 Crc)
+	{
+		return FCrc::MemCrc32(&Value, sizeof(T), Crc);
+	}
+}
+
+FSurrealPilotGraphContextCache::~FSurrealPilotGraphContextCache()
+{
+	Clear();
+}
+
+TSharedPtr<FJsonObject> FSurrealPilotGraphContextCache::Find(const UEdGraph* Graph)
+{
+	const FObjectKey GraphKey(Graph);
+	if (FEntry* Entry = Entries.Find(GraphKey))
+	{
+		bool bFresh = true;
+		if (Entry->bSuspect)
+		{
+			// Walking the pins is far cheaper than building node titles and JSON again
+			bFresh = Entry->Fingerprint == ComputeFingerprint(Graph);
+			Entry->bSuspect = false;
+			if (bFresh)
+			{
+				++Stats.Revalidated;
+			}
+		}
+
+		if (bFresh)
+		{
+			LruOrder.RemoveNode(Entry->Node, false);
+			LruOrder.AddHead(Entry->Node);
+			++Stats.Hits;
+			return Entry->Fragment;
+		}
+
+		++Stats.Invalidations;
+		Remove(GraphKey);
+	}
+
+	++Stats.Misses;
+	return nullptr;
+}
+
+TSharedPtr<FJsonObject> FSurrealPilotGraphContextCache::FindOrExport(UBlueprint* Owner, UEdGraph* Graph, TFunctionRef<TSharedPtr<FJsonObject>()> Export)
+{
+	if (TSharedPtr<FJsonObject> Fragment = Find(Graph))
+	{
+		return Fragment;
+	}
+
+	TSharedPtr<FJsonObject> Fragment = Export();
+	if (Fragment.IsValid())
+	{
+		Add(Owner, Graph, Fragment, ComputeFingerprint(Graph));
+	}
+	return Fragment;
+}
+
+void FSurrealPilotGraphContextCache::Add(UBlueprint* Owner, UEdGraph* Graph, const TSharedPtr<FJsonObject>& Fragment, uint32 Fingerprint)
+{
+	// A fragment bigger than the whole cache would only evict everything else and then itself
+	const int64 FragmentBytes = EstimateBytes(Fragment);
+	if (FragmentBytes > MaxBytes)
+	{
+		return;
+	}
+
+	const FObjectKey GraphKey(Graph);
+	LruOrder.AddHead(GraphKey);
+	FEntry& Entry = Entries.Add(GraphKey);
+	Entry.Fragment = Fragment;
+	Entry.Bytes = FragmentBytes;
+	Entry.Fingerprint = Fingerprint;
+	Entry.Graph = Graph;
+	Entry.Owner = FObjectKey(Owner);
+	Entry.Node = LruOrder.GetHead();
+	Entry.GraphChangedHandle = Graph->AddOnGraphChangedHandler(
+		FOnGraphChanged::FDelegate::CreateRaw(this, &FSurrealPilotGraphContextCache::OnGraphChanged, GraphKey));
+	Bytes += FragmentBytes;
+
+	FOwnerWatch& Watch = Owners.FindOrAdd(Entry.Owner);
+	if (Watch.Graphs++ == 0 && Owner)
+	{
+		Watch.Blueprint = Owner;
+		Watch.ChangedHandle = Owner->OnChanged().AddRaw(this, &FSurrealPilotGraphContextCache::OnBlueprintChanged);
+		Watch.CompiledHandle = Owner->OnCompiled().AddRaw(this, &FSurrealPilotGraphContextCache::OnBlueprintChanged);
+	}
+
+	// Edits to a node's properties call Modify without notifying the graph
+	if (!ObjectModifiedHandle.IsValid())
+	{
+		ObjectModifiedHandle = FCoreUObjectDelegates::OnObjectModified.AddRaw(this, &FSurrealPilotGraphContextCache::OnObjectModified);
+	}
+
+	while (Bytes > MaxBytes && LruOrder.GetTail())
+	{
+		Remove(FObjectKey(LruOrder.GetTail()->GetValue()));
+		++Stats.Evictions;
+	}
+}
+
+void FSurrealPilotGraphContextCache::Invalidate(const UEdGraph* Graph)
+{
+	const FObjectKey GraphKey(Graph);
+	if (Entries.Contains(GraphKey))
+	{
+		++Stats.Invalidations;
+		Remove(GraphKey);
+	}
+}
+
+void FSurrealPilotGraphContextCache::Remove(const FObjectKey& GraphKey)
+{
+	FEntry Entry;
+	if (!Entries.RemoveAndCopyValue(GraphKey, Entry))
+	{
+		return;
+	}
+
+	Bytes -= Entry.Bytes;
+	LruOrder.RemoveNode(Entry.Node);
+	if (UEdGraph* Graph = Entry.Graph.Get())
+	{
+		Graph->RemoveOnGraphChangedHandler(Entry.GraphChangedHandle);
+	}
+
+	FOwnerWatch* Watch = Owners.Find(Entry.Owner);
+	if (Watch && --Watch->Graphs == 0)
+	{
+		if (UBlueprint* Blueprint = Watch->Blueprint.Get())
+		{
+			Blueprint->OnChanged().Remove(Watch->ChangedHandle);
+			Blueprint->OnCompiled().Remove(Watch->CompiledHandle);
+		}
+		Owners.Remove(Entry.Owner);
+	}
+
+	if (Entries.Num() == 0 && ObjectModifiedHandle.IsValid())
+	{
+		FCoreUObjectDelegates::OnObjectModified.Remove(ObjectModifiedHandle);
+		ObjectModifiedHandle.Reset();
+	}
+}
+
+void FSurrealPilotGraphContextCache::Clear()
+{
+	TArray<FObjectKey> GraphKeys;
+	Entries.GetKeys(GraphKeys);
+	for (const FObjectKey& GraphKey : GraphKeys)
+	{
+		Remove(GraphKey);
+	}
+}
+
+void FSurrealPilotGraphContextCache::SetMaxBytes(int64 InMaxBytes)
+{
+	MaxBytes = FMath::Max<int64>(0, InMaxBytes);
+	while (Bytes > MaxBytes && LruOrder.GetTail())
+	{
+		Remove(FObjectKey(LruOrder.GetTail()->GetValue()));
+		++Stats.Evictions;
+	}
+}
+
+void FSurrealPilotGraphContextCache::OnGraphChanged(const FEdGraphEditAction& Action, FObjectKey GraphKey)
+{
+	if (Entries.Contains(GraphKey))
+	{
+		++Stats.Invalidations;
+		Remove(GraphKey);
+	}
+}
+
+void FSurrealPilotGraphContextCache::OnBlueprintChanged(UBlueprint* Blueprint)
+{
+	const FObjectKey OwnerKey(Blueprint);
+	for (TPair<FObjectKey, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.Owner == OwnerKey)
+		{
+			Pair.Value.bSuspect = true;
+		}
+	}
+}
+
+void FSurrealPilotGraphContextCache::OnObjectModified(UObject* Object)
+{
+	const UEdGraph* Graph = Cast<UEdGraph>(Object);
+	if (!Graph)
+	{
+		const UEdGraphNode* Node = Cast<UEdGraphNode>(Object);
+		Graph = Node ? Node->GetGraph() : nullptr;
+	}
+	if (Graph)
+	{
+		Invalidate(Graph);
+	}
+}
+
+uint32 FSurrealPilotGraphContextCache::ComputeFingerprint(const UEdGraph* Graph)
+{
+	using namespace SurrealPilotGraphContextCache;
+	if (!Graph)
+	{
+		return 0;
+	}
+
+	// Everything the exported fragment is made of, so no edit that changes the fragment keeps the fingerprint
+	uint32 Crc = HashValue(Graph->GetFName(), 0);
+	Crc = HashValue(Graph->Nodes.Num(), Crc);
+	for (const UEdGraphNode* Node : Graph->Nodes)
+	{
+		if (!Node)
+		{
+			continue;
+		}
+
+		Crc = HashValue(Node->NodeGuid, Crc);
+		Crc = HashValue(Node->NodePosX, Crc);
+		Crc = HashValue(Node->NodePosY, Crc);
+		Crc = HashString(Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString(), Crc);
+		Crc = HashString(Node->GetTooltipText().ToString(), Crc);
+		if (const UK2Node_CallFunction* FunctionNode = Cast<UK2Node_CallFunction>(Node))
+		{
+			Crc = HashValue(FunctionNode->FunctionReference.GetMemberName(), Crc);
+		}
+		else if (const UK2Node_Variable* VariableNode = Cast<UK2Node_Variable>(Node))
+		{
+			Crc = HashValue(VariableNode->GetVarName(), Crc);
+		}
+		else if (const UK2Node_Event* EventNode = Cast<UK2Node_Event>(Node))
+		{
+			Crc = HashValue(EventNode->GetFunctionName(), Crc);
+		}
+
+		Crc = HashValue(Node->Pins.Num(), Crc);
+		for (const UEdGraphPin* Pin : Node->Pins)
+		{
+			if (!Pin)
+			{
+				continue;
+			}
+			Crc = HashValue(Pin->PinId, Crc);
+			Crc = HashValue(Pin->PinName, Crc);
+			Crc = HashValue(Pin->Direction, Crc);
+			Crc = HashValue(Pin->PinType.PinCategory, Crc);
+			Crc = HashValue(Pin->PinType.PinSubCategory, Crc);
+			const UObject* SubCategoryObject = Pin->PinType.PinSubCategoryObject.Get();
+			Crc = HashString(SubCategoryObject ? SubCategoryObject->GetPathName() : FString(), Crc);
+			Crc = HashValue(Pin->LinkedTo.Num(), Crc);
+			Crc = HashString(Pin->DefaultValue, Crc);
+		}
+	}
+	return Crc;
+}
+
+int64 FSurrealPilotGraphContextCache::EstimateBytes(const TSharedPtr<FJsonObject>& Object)
+{
+	using namespace SurrealPilotGraphContextCache;
+	if (!Object.IsValid())
+	{
+		return 0;
+	}
+
+	int64 ObjectBytes = ValueOverheadBytes;
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Object->Values)
+	{
+		ObjectBytes += Field.Key.Len() * sizeof(TCHAR) + EstimateValueBytes(Field.Value);
+	}
+	return ObjectBytes;
+}
\ No newline at end of file
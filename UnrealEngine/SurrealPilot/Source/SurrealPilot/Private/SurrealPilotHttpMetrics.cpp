@@ -0,0 +1,271 @@
+#include "SurrealPilotHttpMetrics.h"
+#include "SurrealPilotStats.h"
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Time to First Byte (ms)"), STAT_SurrealPilot_TimeToFirstByteMs, STATGROUP_SurrealPilot);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Time to First Event (ms)"), STAT_SurrealPilot_TimeToFirstEventMs, STATGROUP_SurrealPilot);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Request Duration (ms)"), STAT_SurrealPilot_RequestDurationMs, STATGROUP_SurrealPilot);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Streamed Events per Second"), STAT_SurrealPilot_EventsPerSecond, STATGROUP_SurrealPilot);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Completed Requests"), STAT_SurrealPilot_CompletedRequests, STATGROUP_SurrealPilot);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes Sent"), STAT_SurrealPilot_BytesSent, STATGROUP_SurrealPilot);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes Received"), STAT_SurrealPilot_BytesReceived, STATGROUP_SurrealPilot);
+
+namespace SurrealPilotHttpMetrics
+{
+	/** Smallest value with its own bucket; anything below shares bucket 0 */
+	constexpr double MinBucketValue = 0.01;
+
+	constexpr int32 BucketsPerOctave = 4;
+
+	/** Covers 0.01 to about 10^10 (ms, bytes or events per second) */
+	constexpr int32 BucketCount = 1 + 40 * BucketsPerOctave;
+}
+
+FSurrealPilotHistogram::FSurrealPilotHistogram()
+	: Count(0)
+	, Sum(0.0)
+	, Min(0.0)
+	, Max(0.0)
+{
+	Buckets.SetNumZeroed(SurrealPilotHttpMetrics::BucketCount);
+}
+
+void FSurrealPilotHistogram::Add(double Value)
+{
+	Value = FMath::Max(0.0, Value);
+	++Buckets[GetBucketIndex(Value)];
+
+	Min = Count > 0 ? FMath::Min(Min, Value) : Value;
+	Max = Count > 0 ? FMath::Max(Max, Value) : Value;
+	Sum += Value;
+	++Count;
+}
+
+double FSurrealPilotHistogram::GetPercentile(double Percentile) const
+{
+	if (Count == 0)
+	{
+		return 0.0;
+	}
+
+	const int64 Rank = FMath::Max<int64>(1, FMath::CeilToInt64(FMath::Clamp(Percentile, 0.0, 100.0) / 100.0 * Count));
+	int64 Seen = 0;
+	for (int32 BucketIndex = 0; BucketIndex < Buckets.Num(); ++BucketIndex)
+	{
+		Seen += Buckets[BucketIndex];
+		if (Seen >= Rank)
+		{
+			// The bucket midpoint can fall outside what was actually observed
+			return FMath::Clamp(GetBucketValue(BucketIndex), Min, Max);
+		}
+	}
+	return Max;
+}
+
+void FSurrealPilotHistogram::Reset()
+{
+	FMemory::Memzero(Buckets.GetData(), Buckets.Num() * sizeof(uint32));
+	Count = 0;
+	Sum = 0.0;
+	Min = 0.0;
+	Max = 0.0;
+}
+
+TSharedRef<FJsonObject> FSurrealPilotHistogram::ToJson() const
+{
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetNumberField(TEXT("count"), static_cast<double>(Count));
+	Json->SetNumberField(TEXT("min"), GetMin());
+	Json->SetNumberField(TEXT("mean"), GetMean());
+	Json->SetNumberField(TEXT("p50"), GetPercentile(50.0));
+	Json->SetNumberField(TEXT("p95"), GetPercentile(95.0));
+	Json->SetNumberField(TEXT("p99"), GetPercentile(99.0));
+	Json->SetNumberField(TEXT("max"), GetMax());
+	return Json;
+}
+
+int32 FSurrealPilotHistogram::GetBucketIndex(double Value)
+{
+	if (Value <= SurrealPilotHttpMetrics::MinBucketValue)
+	{
+		return 0;
+	}
+
+	const int32 Index = 1 + FMath::FloorToInt32(FMath::Log2(Value / SurrealPilotHttpMetrics::MinBucketValue) * SurrealPilotHttpMetrics::BucketsPerOctave);
+	return FMath::Min(Index, SurrealPilotHttpMetrics::BucketCount - 1);
+}
+
+double FSurrealPilotHistogram::GetBucketValue(int32 BucketIndex)
+{
+	if (BucketIndex == 0)
+	{
+		return SurrealPilotHttpMetrics::MinBucketValue;
+	}
+
+	// Geometric middle of [Min * 2^((i-1)/n), Min * 2^(i/n))
+	return SurrealPilotHttpMetrics::MinBucketValue * FMath::Pow(2.0, (BucketIndex - 0.5) / SurrealPilotHttpMetrics::BucketsPerOctave);
+}
+
+FString FSurrealPilotRequestSample::ToString() const
+{
+	FString Line = FString::Printf(TEXT("%s %s%s"), *Verb, *BaseUrl, *Route);
+	if (!Provider.IsEmpty())
+	{
+		Line += FString::Printf(TEXT(" provider=%s"), *Provider);
+	}
+	Line += FString::Printf(TEXT(" status=%d total=%.1fms"), ResponseCode, TotalSeconds * 1000.0);
+	if (FirstByteSeconds >= 0.0)
+	{
+		Line += FString::Printf(TEXT(" ttfb=%.1fms"), FirstByteSeconds * 1000.0);
+	}
+	if (FirstEventSeconds >= 0.0)
+	{
+		Line += FString::Printf(TEXT(" first_event=%.1fms events=%d"), FirstEventSeconds * 1000.0, EventCount);
+	}
+	Line += FString::Printf(TEXT(" sent=%lld received=%lld"), RequestBytes, ResponseBytes);
+	return Line;
+}
+
+TSharedRef<FJsonObject> FSurrealPilotEndpointMetrics::ToJson() const
+{
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetStringField(TEXT("base_url"), BaseUrl);
+	Json->SetStringField(TEXT("route"), Route);
+	Json->SetStringField(TEXT("provider"), Provider);
+	Json->SetNumberField(TEXT("requests"), Requests);
+	Json->SetNumberField(TEXT("failures"), Failures);
+	Json->SetObjectField(TEXT("first_byte_ms"), FirstByteMs.ToJson());
+	Json->SetObjectField(TEXT("first_event_ms"), FirstEventMs.ToJson());
+	Json->SetObjectField(TEXT("total_ms"), TotalMs.ToJson());
+	Json->SetObjectField(TEXT("request_bytes"), RequestBytes.ToJson());
+	Json->SetObjectField(TEXT("response_bytes"), ResponseBytes.ToJson());
+	Json->SetObjectField(TEXT("events_per_second"), EventsPerSecond.ToJson());
+	return Json;
+}
+
+void FSurrealPilotHttpMetrics::Record(const FSurrealPilotRequestSample& Sample)
+{
+	const FString Key = MakeKey(Sample.BaseUrl, Sample.Route, Sample.Provider);
+	FSurrealPilotEndpointMetrics* Metrics = Series.Find(Key);
+	if (!Metrics)
+	{
+		Metrics = &Series.Add(Key);
+		Metrics->BaseUrl = Sample.BaseUrl;
+		Metrics->Route = Sample.Route;
+		Metrics->Provider = Sample.Provider;
+	}
+
+	++Metrics->Requests;
+	if (Sample.ResponseCode < 200 || Sample.ResponseCode >= 300)
+	{
+		++Metrics->Failures;
+	}
+
+	Metrics->TotalMs.Add(Sample.TotalSeconds * 1000.0);
+	Metrics->RequestBytes.Add(static_cast<double>(Sample.RequestBytes));
+	Metrics->ResponseBytes.Add(static_cast<double>(Sample.ResponseBytes));
+	SET_FLOAT_STAT(STAT_SurrealPilot_RequestDurationMs, Sample.TotalSeconds * 1000.0);
+	INC_DWORD_STAT(STAT_SurrealPilot_CompletedRequests);
+	INC_DWORD_STAT_BY(STAT_SurrealPilot_BytesSent, Sample.RequestBytes);
+	INC_DWORD_STAT_BY(STAT_SurrealPilot_BytesReceived, Sample.ResponseBytes);
+
+	if (Sample.FirstByteSeconds >= 0.0)
+	{
+		Metrics->FirstByteMs.Add(Sample.FirstByteSeconds * 1000.0);
+		SET_FLOAT_STAT(STAT_SurrealPilot_TimeToFirstByteMs, Sample.FirstByteSeconds * 1000.0);
+	}
+
+	if (Sample.FirstEventSeconds >= 0.0)
+	{
+		Metrics->FirstEventMs.Add(Sample.FirstEventSeconds * 1000.0);
+		SET_FLOAT_STAT(STAT_SurrealPilot_TimeToFirstEventMs, Sample.FirstEventSeconds * 1000.0);
+
+		// Rate over the streaming part of the response, after the first event arrived
+		const double StreamSeconds = Sample.TotalSeconds - Sample.FirstEventSeconds;
+		if (Sample.EventCount > 1 && StreamSeconds > 0.0)
+		{
+			const double EventsPerSecond = (Sample.EventCount - 1) / StreamSeconds;
+			Metrics->EventsPerSecond.Add(EventsPerSecond);
+			SET_FLOAT_STAT(STAT_SurrealPilot_EventsPerSecond, EventsPerSecond);
+		}
+	}
+}
+
+void FSurrealPilotHttpMetrics::RecordProbe(const FString& BaseUrl, double RoundTripSeconds)
+{
+	ProbeRoundTripMs.FindOrAdd(BaseUrl).Add(RoundTripSeconds * 1000.0);
+}
+
+const FSurrealPilotEndpointMetrics* FSurrealPilotHttpMetrics::Find(const FString& BaseUrl, const FString& Route, const FString& Provider) const
+{
+	return Series.Find(MakeKey(BaseUrl, Route, Provider));
+}
+
+TSharedRef<FJsonObject> FSurrealPilotHttpMetrics::ToJson() const
+{
+	TArray<TSharedPtr<FJsonValue>> SeriesJson;
+	for (const TPair<FString, FSurrealPilotEndpointMetrics>& Entry : Series)
+	{
+		SeriesJson.Add(MakeShared<FJsonValueObject>(Entry.Value.ToJson()));
+	}
+
+	TSharedRef<FJsonObject> ProbesJson = MakeShared<FJsonObject>();
+	for (const TPair<FString, FSurrealPilotHistogram>& Entry : ProbeRoundTripMs)
+	{
+		ProbesJson->SetObjectField(Entry.Key, Entry.Value.ToJson());
+	}
+
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetArrayField(TEXT("series"), SeriesJson);
+	Json->SetObjectField(TEXT("probe_round_trip_ms"), ProbesJson);
+	return Json;
+}
+
+FString FSurrealPilotHttpMetrics::ToReport() const
+{
+	if (Series.Num() == 0 && ProbeRoundTripMs.Num() == 0)
+	{
+		return TEXT("No SurrealPilot HTTP requests recorded");
+	}
+
+	auto FormatLatency = [](const TCHAR* Label, const FSurrealPilotHistogram& Histogram)
+	{
+		return Histogram.GetCount() == 0
+			? FString()
+			: FString::Printf(TEXT("    %-16s p50 %8.1f  p95 %8.1f  p99 %8.1f  max %8.1f  (n=%lld)\n"),
+				Label, Histogram.GetPercentile(50.0), Histogram.GetPercentile(95.0), Histogram.GetPercentile(99.0), Histogram.GetMax(), Histogram.GetCount());
+	};
+
+	FString Report;
+	for (const TPair<FString, FSurrealPilotEndpointMetrics>& Entry : Series)
+	{
+		const FSurrealPilotEndpointMetrics& Metrics = Entry.Value;
+		Report += FString::Printf(TEXT("%s%s%s: %d requests, %d failed\n"),
+			*Metrics.BaseUrl, *Metrics.Route, Metrics.Provider.IsEmpty() ? TEXT("") : *FString::Printf(TEXT(" [%s]"), *Metrics.Provider),
+			Metrics.Requests, Metrics.Failures);
+		Report += FormatLatency(TEXT("first byte ms"), Metrics.FirstByteMs);
+		Report += FormatLatency(TEXT("first event ms"), Metrics.FirstEventMs);
+		Report += FormatLatency(TEXT("total ms"), Metrics.TotalMs);
+		Report += FormatLatency(TEXT("events/s"), Metrics.EventsPerSecond);
+		Report += FString::Printf(TEXT("    bytes            sent mean %.0f  received mean %.0f  received max %.0f\n"),
+			Metrics.RequestBytes.GetMean(), Metrics.ResponseBytes.GetMean(), Metrics.ResponseBytes.GetMax());
+	}
+
+	for (const TPair<FString, FSurrealPilotHistogram>& Entry : ProbeRoundTripMs)
+	{
+		Report += FString::Printf(TEXT("%s health probe\n"), *Entry.Key);
+		Report += FormatLatency(TEXT("round trip ms"), Entry.Value);
+	}
+
+	return Report;
+}
+
+void FSurrealPilotHttpMetrics::Reset()
+{
+	Series.Reset();
+	ProbeRoundTripMs.Reset();
+}
+
+FString FSurrealPilotHttpMetrics::MakeKey(const FString& BaseUrl, const FString& Route, const FString& Provider)
+{
+	return BaseUrl + TEXT("|") + Route + TEXT("|") + Provider;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "SurrealPilotHttpMetrics.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotHistogramTest, "SurrealPilot.Metrics.Histogram",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotHistogramTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotHistogram Histogram;
+    TestEqual("An empty histogram has no percentiles", Histogram.GetPercentile(50.0), 0.0);
+
+    // 1..1000 ms: exact percentiles are 500, 950 and 990
+    for (int32 Value = 1; Value <= 1000; ++Value)
+    {
+        Histogram.Add(Value);
+    }
+
+    TestEqual("Count", Histogram.GetCount(), static_cast<int64>(1000));
+    TestEqual("Min", Histogram.GetMin(), 1.0);
+    TestEqual("Max", Histogram.GetMax(), 1000.0);
+    TestEqual("Mean", Histogram.GetMean(), 500.5);
+
+    // Buckets are a quarter octave wide, so a percentile is within about 10% of the true value either way
+    const TPair<double, double> Expected[] = { { 50.0, 500.0 }, { 95.0, 950.0 }, { 99.0, 990.0 } };
+    for (const TPair<double, double>& Percentile : Expected)
+    {
+        const double Value = Histogram.GetPercentile(Percentile.Key);
+        TestTrue(FString::Printf(TEXT("p%.0f = %.1f should be near %.0f"), Percentile.Key, Value, Percentile.Value),
+            FMath::Abs(Value - Percentile.Value) <= Percentile.Value * 0.1);
+    }
+    TestTrue("p100 should not exceed the maximum", Histogram.GetPercentile(100.0) <= Histogram.GetMax());
+    TestTrue("p0 should not fall below the minimum", Histogram.GetPercentile(0.0) >= Histogram.GetMin());
+
+    // Values outside the bucket range land in the end buckets without losing min and max
+    FSurrealPilotHistogram Extremes;
+    Extremes.Add(0.0);
+    Extremes.Add(1e15);
+    TestEqual("Tiny values keep their minimum", Extremes.GetMin(), 0.0);
+    TestEqual("Huge values keep their maximum", Extremes.GetMax(), 1e15);
+
+    Histogram.Reset();
+    TestEqual("Reset clears the count", Histogram.GetCount(), static_cast<int64>(0));
+    TestEqual("Reset clears the percentiles", Histogram.GetPercentile(99.0), 0.0);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotHttpMetricsTest, "SurrealPilot.Metrics.HttpMetrics",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotHttpMetricsTest::RunTest(const FString& Parameters)
+{
+    FSurrealPilotHttpMetrics Metrics;
+
+    FSurrealPilotRequestSample Chat;
+    Chat.Verb = TEXT("POST");
+    Chat.BaseUrl = TEXT("http://127.0.0.1:8000");
+    Chat.Route = TEXT("/api/chat");
+    Chat.Provider = TEXT("openai");
+    Chat.ResponseCode = 200;
+    Chat.FirstByteSeconds = 0.1;
+    Chat.FirstEventSeconds = 0.2;
+    Chat.TotalSeconds = 1.2;
+    Chat.EventCount = 11;
+    Metrics.Record(Chat);
+
+    FSurrealPilotRequestSample OtherProvider = Chat;
+    OtherProvider.Provider = TEXT("anthropic");
+    OtherProvider.ResponseCode = 503;
+    OtherProvider.FirstEventSeconds = -1.0;
+    OtherProvider.EventCount = 0;
+    Metrics.Record(OtherProvider);
+
+    const FSurrealPilotEndpointMetrics* OpenAI = Metrics.Find(Chat.BaseUrl, Chat.Route, Chat.Provider);
+    const FSurrealPilotEndpointMetrics* Anthropic = Metrics.Find(Chat.BaseUrl, Chat.Route, OtherProvider.Provider);
+    if (!TestNotNull("Each provider should get its own series", OpenAI) || !TestNotNull("Second provider series", Anthropic))
+    {
+        return false;
+    }
+
+    TestEqual("First byte is recorded in milliseconds", OpenAI->FirstByteMs.GetMax(), 100.0);
+    TestEqual("First event is recorded in milliseconds", OpenAI->FirstEventMs.GetMax(), 200.0);
+    TestEqual("Events per second covers the stream after the first event", OpenAI->EventsPerSecond.GetMax(), 10.0);
+    TestEqual("A successful request is not a failure", OpenAI->Failures, 0);
+    TestEqual("A 503 counts as a failure", Anthropic->Failures, 1);
+    TestEqual("A request without events has no first-event samples", Anthropic->FirstEventMs.GetCount(), static_cast<int64>(0));
+    TestNull("Unknown routes have no series", Metrics.Find(Chat.BaseUrl, TEXT("/api/context")));
+
+    Metrics.RecordProbe(Chat.BaseUrl, 0.005);
+    TSharedRef<FJsonObject> Json = Metrics.ToJson();
+    TestEqual("JSON lists every series", Json->GetArrayField(TEXT("series")).Num(), 2);
+    TestTrue("JSON includes probe round trips", Json->GetObjectField(TEXT("probe_round_trip_ms"))->HasField(Chat.BaseUrl));
+
+    Metrics.Reset();
+    TestNull("Reset removes every series", Metrics.Find(Chat.BaseUrl, Chat.Route, Chat.Provider));
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
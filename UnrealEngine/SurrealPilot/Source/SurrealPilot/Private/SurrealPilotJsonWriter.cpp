@@ -0,0 +1,423 @@
+#include "SurrealPilotJsonWriter.h"
+
+namespace SurrealPilotJson
+{
+	/** Smallest allocation the writer makes, to avoid several tiny growth steps for small bodies */
+	constexpr int32 MinimumCapacity = 256;
+
+	/** Doubles with an integral value below this magnitude are written without a fraction */
+	constexpr double MaxExactInteger = 9007199254740992.0; // 2^53
+
+	FORCEINLINE uint8 HexDigit(uint32 Value)
+	{
+		return static_cast<uint8>(Value < 10 ? '0' + Value : 'a' + (Value - 10));
+	}
+}
+
+FSurrealPilotJsonWriter::FSurrealPilotJsonWriter(int32 InitialCapacity)
+	: bSortKeys(false)
+	, BytesWritten(0)
+	, BytesMovedByGrowth(0)
+	, GrowthCount(0)
+	, PeakAllocatedSize(0)
+{
+	if (InitialCapacity > 0)
+	{
+		Buffer.Reserve(InitialCapacity);
+		PeakAllocatedSize = Buffer.GetAllocatedSize();
+	}
+}
+
+void FSurrealPilotJsonWriter::BeginObject()
+{
+	BeginValue();
+	AppendByte('{');
+	ContainerHasValue.Push(false);
+}
+
+void FSurrealPilotJsonWriter::BeginObject(FStringView Key)
+{
+	WriteKey(Key);
+	AppendByte('{');
+	ContainerHasValue.Push(false);
+}
+
+void FSurrealPilotJsonWriter::EndObject()
+{
+	check(ContainerHasValue.Num() > 0);
+	ContainerHasValue.Pop(EAllowShrinking::No);
+	AppendByte('}');
+}
+
+void FSurrealPilotJsonWriter::BeginArray()
+{
+	BeginValue();
+	AppendByte('[');
+	ContainerHasValue.Push(false);
+}
+
+void FSurrealPilotJsonWriter::BeginArray(FStringView Key)
+{
+	WriteKey(Key);
+	AppendByte('[');
+	ContainerHasValue.Push(false);
+}
+
+void FSurrealPilotJsonWriter::EndArray()
+{
+	check(ContainerHasValue.Num() > 0);
+	ContainerHasValue.Pop(EAllowShrinking::No);
+	AppendByte(']');
+}
+
+void FSurrealPilotJsonWriter::WriteString(FStringView Key, FStringView Value)
+{
+	WriteKey(Key);
+	WriteEscapedString(Value);
+}
+
+void FSurrealPilotJsonWriter::WriteString(FStringView Value)
+{
+	BeginValue();
+	WriteEscapedString(Value);
+}
+
+void FSurrealPilotJsonWriter::WriteInteger(FStringView Key, int64 Value)
+{
+	WriteKey(Key);
+	ANSICHAR Digits[32];
+	const int32 Length = FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%lld", static_cast<long long>(Value));
+	Append(Digits, Length);
+}
+
+void FSurrealPilotJsonWriter::WriteInteger(int64 Value)
+{
+	BeginValue();
+	ANSICHAR Digits[32];
+	const int32 Length = FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%lld", static_cast<long long>(Value));
+	Append(Digits, Length);
+}
+
+void FSurrealPilotJsonWriter::WriteNumber(FStringView Key, double Value)
+{
+	WriteKey(Key);
+	WriteNumberOnly(Value);
+}
+
+void FSurrealPilotJsonWriter::WriteNumber(double Value)
+{
+	BeginValue();
+	WriteNumberOnly(Value);
+}
+
+void FSurrealPilotJsonWriter::WriteBool(FStringView Key, bool bValue)
+{
+	WriteKey(Key);
+	bValue ? Append("true", 4) : Append("false", 5);
+}
+
+void FSurrealPilotJsonWriter::WriteBool(bool bValue)
+{
+	BeginValue();
+	bValue ? Append("true", 4) : Append("false", 5);
+}
+
+void FSurrealPilotJsonWriter::WriteNull(FStringView Key)
+{
+	WriteKey(Key);
+	Append("null", 4);
+}
+
+void FSurrealPilotJsonWriter::WriteNull()
+{
+	BeginValue();
+	Append("null", 4);
+}
+
+void FSurrealPilotJsonWriter::WriteJsonValue(FStringView Key, const TSharedPtr<FJsonValue>& Value)
+{
+	WriteKey(Key);
+	WriteJsonValueOnly(Value);
+}
+
+void FSurrealPilotJsonWriter::WriteJsonValue(const TSharedPtr<FJsonValue>& Value)
+{
+	BeginValue();
+	WriteJsonValueOnly(Value);
+}
+
+void FSurrealPilotJsonWriter::WriteJsonObject(FStringView Key, const TSharedPtr<FJsonObject>& Object)
+{
+	WriteKey(Key);
+	Object.IsValid() ? WriteJsonObjectOnly(*Object) : Append("null", 4);
+}
+
+void FSurrealPilotJsonWriter::WriteJsonObject(const TSharedPtr<FJsonObject>& Object)
+{
+	BeginValue();
+	Object.IsValid() ? WriteJsonObjectOnly(*Object) : Append("null", 4);
+}
+
+void FSurrealPilotJsonWriter::WriteRawValue(FStringView Key, TArrayView<const uint8> Utf8Json)
+{
+	WriteKey(Key);
+	Append(Utf8Json.GetData(), Utf8Json.Num());
+}
+
+void FSurrealPilotJsonWriter::WriteRawValue(TArrayView<const uint8> Utf8Json)
+{
+	BeginValue();
+	Append(Utf8Json.GetData(), Utf8Json.Num());
+}
+
+TArray<uint8> FSurrealPilotJsonWriter::MoveBuffer()
+{
+	TArray<uint8> Result = MoveTemp(Buffer);
+	Buffer.Reset();
+	ContainerHasValue.Reset();
+	return Result;
+}
+
+void FSurrealPilotJsonWriter::BeginValue()
+{
+	if (ContainerHasValue.Num() > 0)
+	{
+		if (ContainerHasValue.Last())
+		{
+			AppendByte(',');
+		}
+		ContainerHasValue.Last() = true;
+	}
+}
+
+void FSurrealPilotJsonWriter::WriteKey(FStringView Key)
+{
+	check(ContainerHasValue.Num() > 0);
+	BeginValue();
+	WriteEscapedString(Key);
+	AppendByte(':');
+}
+
+void FSurrealPilotJsonWriter::WriteEscapedString(FStringView Value)
+{
+	// Most context strings are ASCII, so this usually covers the whole string in one reservation
+	Reserve(Value.Len() + 2);
+	AppendByte('"');
+
+	const TCHAR* Chars = Value.GetData();
+	const int32 Length = Value.Len();
+	for (int32 Index = 0; Index < Length; ++Index)
+	{
+		uint32 CodePoint = static_cast<uint32>(Chars[Index]);
+
+		if (CodePoint < 0x80)
+		{
+			switch (CodePoint)
+			{
+			case '"':  Append("\\\"", 2); break;
+			case '\\': Append("\\\\", 2); break;
+			case '\n': Append("\\n", 2); break;
+			case '\t': Append("\\t", 2); break;
+			case '\b': Append("\\b", 2); break;
+			case '\f': Append("\\f", 2); break;
+			case '\r': Append("\\r", 2); break;
+			default:
+				if (CodePoint < 0x20)
+				{
+					const uint8 Escape[6] = { '\\', 'u', '0', '0', SurrealPilotJson::HexDigit(CodePoint >> 4), SurrealPilotJson::HexDigit(CodePoint & 0xF) };
+					Append(Escape, 6);
+				}
+				else
+				{
+					AppendByte(static_cast<uint8>(CodePoint));
+				}
+				break;
+			}
+			continue;
+		}
+
+		// Combine UTF-16 surrogate pairs; unpaired surrogates become U+FFFD
+		if (CodePoint >= 0xD800 && CodePoint <= 0xDBFF && Index + 1 < Length)
+		{
+			const uint32 Low = static_cast<uint32>(Chars[Index + 1]);
+			if (Low >= 0xDC00 && Low <= 0xDFFF)
+			{
+				CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+				++Index;
+			}
+		}
+		if ((CodePoint >= 0xD800 && CodePoint <= 0xDFFF) || CodePoint > 0x10FFFF)
+		{
+			CodePoint = 0xFFFD;
+		}
+
+		uint8 Encoded[4];
+		int32 EncodedLength;
+		if (CodePoint < 0x800)
+		{
+			Encoded[0] = static_cast<uint8>(0xC0 | (CodePoint >> 6));
+			Encoded[1] = static_cast<uint8>(0x80 | (CodePoint & 0x3F));
+			EncodedLength = 2;
+		}
+		else if (CodePoint < 0x10000)
+		{
+			Encoded[0] = static_cast<uint8>(0xE0 | (CodePoint >> 12));
+			Encoded[1] = static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F));
+			Encoded[2] = static_cast<uint8>(0x80 | (CodePoint & 0x3F));
+			EncodedLength = 3;
+		}
+		else
+		{
+			Encoded[0] = static_cast<uint8>(0xF0 | (CodePoint >> 18));
+			Encoded[1] = static_cast<uint8>(0x80 | ((CodePoint >> 12) & 0x3F));
+			Encoded[2] = static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F));
+			Encoded[3] = static_cast<uint8>(0x80 | (CodePoint & 0x3F));
+			EncodedLength = 4;
+		}
+		Append(Encoded, EncodedLength);
+	}
+
+	AppendByte('"');
+}
+
+void FSurrealPilotJsonWriter::WriteNumberOnly(double Value)
+{
+	// JSON has no representation for NaN or infinity
+	if (!FMath::IsFinite(Value))
+	{
+		Append("null", 4);
+		return;
+	}
+
+	ANSICHAR Digits[40];
+	int32 Length;
+	if (FMath::Abs(Value) < SurrealPilotJson::MaxExactInteger && FMath::FloorToDouble(Value) == Value)
+	{
+		Length = FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%lld", static_cast<long long>(Value));
+	}
+	else
+	{
+		Length = FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%.17g", Value);
+	}
+	Append(Digits, Length);
+}
+
+void FSurrealPilotJsonWriter::WriteJsonValueOnly(const TSharedPtr<FJsonValue>& Value)
+{
+	if (!Value.IsValid())
+	{
+		Append("null", 4);
+		return;
+	}
+
+	switch (Value->Type)
+	{
+	case EJson::String:
+		WriteEscapedString(Value->AsString());
+		break;
+
+	case EJson::Number:
+		WriteNumberOnly(Value->AsNumber());
+		break;
+
+	case EJson::Boolean:
+		Value->AsBool() ? Append("true", 4) : Append("false", 5);
+		break;
+
+	case EJson::Array:
+		AppendByte('[');
+		ContainerHasValue.Push(false);
+		for (const TSharedPtr<FJsonValue>& Element : Value->AsArray())
+		{
+			BeginValue();
+			WriteJsonValueOnly(Element);
+		}
+		ContainerHasValue.Pop(EAllowShrinking::No);
+		AppendByte(']');
+		break;
+
+	case EJson::Object:
+	{
+		const TSharedPtr<FJsonObject> Object = Value->AsObject();
+		Object.IsValid() ? WriteJsonObjectOnly(*Object) : Append("null", 4);
+		break;
+	}
+
+	case EJson::Null:
+	case EJson::None:
+	default:
+		Append("null", 4);
+		break;
+	}
+}
+
+void FSurrealPilotJsonWriter::WriteJsonObjectOnly(const FJsonObject& Object)
+{
+	AppendByte('{');
+	ContainerHasValue.Push(false);
+	if (bSortKeys)
+	{
+		TArray<const TPair<FString, TSharedPtr<FJsonValue>>*, TInlineAllocator<16>> Fields;
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Object.Values)
+		{
+			Fields.Add(&Field);
+		}
+		Fields.Sort([](const TPair<FString, TSharedPtr<FJsonValue>>& A, const TPair<FString, TSharedPtr<FJsonValue>>& B)
+		{
+			return A.Key.Compare(B.Key, ESearchCase::CaseSensitive) < 0;
+		});
+		for (const TPair<FString, TSharedPtr<FJsonValue>>* Field : Fields)
+		{
+			WriteKey(Field->Key);
+			WriteJsonValueOnly(Field->Value);
+		}
+	}
+	else
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Object.Values)
+		{
+			WriteKey(Field.Key);
+			WriteJsonValueOnly(Field.Value);
+		}
+	}
+	ContainerHasValue.Pop(EAllowShrinking::No);
+	AppendByte('}');
+}
+
+void FSurrealPilotJsonWriter::Append(const void* Data, int32 Num)
+{
+	if (Num <= 0)
+	{
+		return;
+	}
+
+	Reserve(Num);
+	const int32 Offset = Buffer.AddUninitialized(Num);
+	FMemory::Memcpy(Buffer.GetData() + Offset, Data, Num);
+	BytesWritten += Num;
+}
+
+void FSurrealPilotJsonWriter::AppendByte(uint8 Byte)
+{
+	Reserve(1);
+	Buffer.Add(Byte);
+	++BytesWritten;
+}
+
+void FSurrealPilotJsonWriter::Reserve(int32 AdditionalBytes)
+{
+	const int64 Required = static_cast<int64>(Buffer.Num()) + AdditionalBytes;
+	if (Required <= Buffer.Max())
+	{
+		return;
+	}
+
+	// Grow geometrically ourselves so growth copies can be accounted for
+	const int64 Doubled = FMath::Max<int64>(static_cast<int64>(Buffer.Max()) * 2, SurrealPilotJson::MinimumCapacity);
+	const int32 NewCapacity = static_cast<int32>(FMath::Min<int64>(FMath::Max(Required, Doubled), MAX_int32));
+
+	BytesMovedByGrowth += Buffer.Num();
+	++GrowthCount;
+	Buffer.Reserve(NewCapacity);
+	PeakAllocatedSize = FMath::Max(PeakAllocatedSize, Buffer.GetAllocatedSize());
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "SurrealPilotJsonWriter.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SurrealPilotJsonWriterTest
+{
+    /** Decode a UTF-8 body and parse it back into a DOM */
+    TSharedPtr<FJsonObject> ParseUtf8(const TArray<uint8>& Utf8)
+    {
+        FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Utf8.GetData()), Utf8.Num());
+        const FString Json(Converted.Length(), Converted.Get());
+
+        TSharedPtr<FJsonObject> Object;
+        TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Json);
+        FJsonSerializer::Deserialize(Reader, Object);
+        return Object;
+    }
+
+    /** A Blueprint-shaped context of roughly TargetBytes once serialized */
+    TSharedPtr<FJsonObject> MakeSyntheticContext(int32 TargetBytes)
+    {
+        TSharedPtr<FJsonObject> Context = MakeShareable(new FJsonObject);
+        Context->SetStringField(TEXT("blueprint_name"), TEXT("BP_ThirdPersonCharacter"));
+
+        TArray<TSharedPtr<FJsonValue>> Nodes;
+        int32 ApproximateBytes = 0;
+        for (int32 NodeIndex = 0; ApproximateBytes < TargetBytes; ++NodeIndex)
+        {
+            TSharedPtr<FJsonObject> Node = MakeShareable(new FJsonObject);
+            Node->SetStringField(TEXT("name"), FString::Printf(TEXT("K2Node_CallFunction_%d"), NodeIndex));
+            Node->SetStringField(TEXT("title"), TEXT("Set Actor Location \"Target\" — with sweep"));
+            Node->SetStringField(TEXT("comment"), TEXT("Moves the pawn to the spawn point.\nRuns every respawn."));
+            Node->SetNumberField(TEXT("pos_x"), NodeIndex * 16);
+            Node->SetNumberField(TEXT("pos_y"), -NodeIndex * 0.5);
+            Node->SetBoolField(TEXT("enabled"), (NodeIndex % 3) != 0);
+
+            TArray<TSharedPtr<FJsonValue>> Pins;
+            for (int32 PinIndex = 0; PinIndex < 4; ++PinIndex)
+            {
+                TSharedPtr<FJsonObject> Pin = MakeShareable(new FJsonObject);
+                Pin->SetStringField(TEXT("name"), FString::Printf(TEXT("Pin_%d"), PinIndex));
+                Pin->SetStringField(TEXT("type"), TEXT("struct"));
+                Pin->SetStringField(TEXT("default"), TEXT("(X=0.000000,Y=0.000000,Z=100.000000)"));
+                Pins.Add(MakeShareable(new FJsonValueObject(Pin)));
+            }
+            Node->SetArrayField(TEXT("pins"), Pins);
+
+            Nodes.Add(MakeShareable(new FJsonValueObject(Node)));
+            ApproximateBytes += 560;
+        }
+        Context->SetArrayField(TEXT("nodes"), Nodes);
+
+        return Context;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotJsonWriterTest, "SurrealPilot.JsonWriter.RoundTrip",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotJsonWriterTest::RunTest(const FString& Parameters)
+{
+    TSharedPtr<FJsonObject> Nested = MakeShareable(new FJsonObject);
+    Nested->SetStringField(TEXT("escapes"), TEXT("quote \" backslash \\ slash / tab \t newline \n cr \r bell \x07"));
+    Nested->SetStringField(TEXT("unicode"), TEXT("café ✓ \xD83D\xDE80"));
+    Nested->SetNumberField(TEXT("integer"), 42);
+    Nested->SetNumberField(TEXT("negative"), -7);
+    Nested->SetNumberField(TEXT("fraction"), 0.1);
+    Nested->SetNumberField(TEXT("large"), 1.0e300);
+    Nested->SetBoolField(TEXT("flag"), true);
+    Nested->SetField(TEXT("nothing"), MakeShareable(new FJsonValueNull()));
+
+    TArray<TSharedPtr<FJsonValue>> Mixed;
+    Mixed.Add(MakeShareable(new FJsonValueString(TEXT("a"))));
+    Mixed.Add(MakeShareable(new FJsonValueNumber(3)));
+    Mixed.Add(MakeShareable(new FJsonValueArray(TArray<TSharedPtr<FJsonValue>>())));
+    Mixed.Add(MakeShareable(new FJsonValueObject(MakeShareable(new FJsonObject))));
+    Nested->SetArrayField(TEXT("mixed"), Mixed);
+
+    TSharedPtr<FJsonObject> Expected = MakeShareable(new FJsonObject);
+    Expected->SetStringField(TEXT("type"), TEXT("blueprint"));
+    Expected->SetObjectField(TEXT("data"), Nested);
+
+    // Start with no capacity so the growth path is exercised as well
+    FSurrealPilotJsonWriter Writer;
+    Writer.BeginObject();
+    Writer.WriteString(TEXT("type"), TEXT("blueprint"));
+    Writer.WriteJsonObject(TEXT("data"), Nested);
+    Writer.EndObject();
+
+    const TArray<uint8> Body = Writer.MoveBuffer();
+    TSharedPtr<FJsonObject> Parsed = SurrealPilotJsonWriterTest::ParseUtf8(Body);
+    if (!TestTrue("Writer output should parse as JSON", Parsed.IsValid()))
+    {
+        return false;
+    }
+
+    TestTrue("Round trip should match the source DOM",
+        FJsonValue::CompareEqual(FJsonValueObject(Expected), FJsonValueObject(Parsed)));
+
+    // The condensed TJsonWriter output must describe the same document
+    FString Condensed;
+    TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> CondensedWriter = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Condensed);
+    FJsonSerializer::Serialize(Expected.ToSharedRef(), CondensedWriter);
+
+    TSharedPtr<FJsonObject> CondensedParsed;
+    TSharedRef<TJsonReader<>> CondensedReader = TJsonReaderFactory<>::Create(Condensed);
+    FJsonSerializer::Deserialize(CondensedReader, CondensedParsed);
+    TestTrue("Writer and TJsonWriter should agree",
+        CondensedParsed.IsValid() && FJsonValue::CompareEqual(FJsonValueObject(CondensedParsed), FJsonValueObject(Parsed)));
+
+    FString Unicode;
+    Parsed->GetObjectField(TEXT("data"))->TryGetStringField(TEXT("unicode"), Unicode);
+    TestEqual("Surrogate pairs should survive as one code point", Unicode, FString(TEXT("café ✓ \xD83D\xDE80")));
+
+    TestTrue("Moving the buffer should leave the writer empty", Writer.GetBuffer().Num() == 0);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotJsonWriterBenchmark, "SurrealPilot.JsonWriter.Benchmark",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSurrealPilotJsonWriterBenchmark::RunTest(const FString& Parameters)
+{
+    TSharedPtr<FJsonObject> Context = SurrealPilotJsonWriterTest::MakeSyntheticContext(5 * 1024 * 1024);
+    const int32 Iterations = 5;
+
+    // Legacy path: FJsonObject -> FString -> FTCHARToUTF8 -> request payload copy (what SetContentAsString did)
+    int32 LegacyBodyBytes = 0;
+    int64 LegacyBytesCopied = 0;
+    SIZE_T LegacyPeakBytes = 0;
+    const double LegacyStart = FPlatformTime::Seconds();
+    for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+    {
+        TSharedPtr<FJsonObject> RequestBody = MakeShareable(new FJsonObject);
+        RequestBody->SetStringField(TEXT("type"), TEXT("blueprint"));
+        RequestBody->SetObjectField(TEXT("data"), Context);
+
+        FString RequestBodyString;
+        TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&RequestBodyString);
+        FJsonSerializer::Serialize(RequestBody.ToSharedRef(), JsonWriter);
+
+        FTCHARToUTF8 Converter(*RequestBodyString, RequestBodyString.Len());
+        TArray<uint8> Payload;
+        Payload.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+
+        LegacyBodyBytes = Payload.Num();
+        // Lower bound: ignores copies made while the FString itself grew
+        LegacyBytesCopied = RequestBodyString.Len() * sizeof(TCHAR) + 2 * static_cast<int64>(Converter.Length());
+        LegacyPeakBytes = RequestBodyString.GetAllocatedSize() + Converter.Length() + Payload.GetAllocatedSize();
+    }
+    const double LegacySeconds = (FPlatformTime::Seconds() - LegacyStart) / Iterations;
+
+    // Direct path, sized from the previous payload as FHttpClient does after its first request
+    int32 DirectBodyBytes = 0;
+    int64 DirectBytesCopied = 0;
+    SIZE_T DirectPeakBytes = 0;
+    int32 DirectGrowths = 0;
+    int32 PreviousSize = 0;
+    const double DirectStart = FPlatformTime::Seconds();
+    for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+    {
+        FSurrealPilotJsonWriter Writer(PreviousSize + PreviousSize / 8);
+        Writer.BeginObject();
+        Writer.WriteString(TEXT("type"), TEXT("blueprint"));
+        Writer.WriteJsonObject(TEXT("data"), Context);
+        Writer.EndObject();
+
+        DirectBytesCopied = Writer.GetBytesCopied();
+        DirectPeakBytes = Writer.GetPeakAllocatedSize();
+        DirectGrowths = Writer.GetGrowthCount();
+
+        TArray<uint8> Payload = Writer.MoveBuffer();
+        DirectBodyBytes = Payload.Num();
+        PreviousSize = DirectBodyBytes;
+    }
+    const double DirectSeconds = (FPlatformTime::Seconds() - DirectStart) / Iterations;
+
+    TestTrue("Both paths should produce a body of similar size", FMath::Abs(DirectBodyBytes - LegacyBodyBytes) < LegacyBodyBytes / 10);
+
+    const double Megabytes = DirectBodyBytes / (1024.0 * 1024.0);
+    AddInfo(FString::Printf(TEXT("Context body: %.2f MB"), Megabytes));
+    AddInfo(FString::Printf(TEXT("Legacy FString path: %.2f ms, >= %.2f MB copied, %.2f MB peak"),
+        LegacySeconds * 1000.0, LegacyBytesCopied / (1024.0 * 1024.0), LegacyPeakBytes / (1024.0 * 1024.0)));
+    AddInfo(FString::Printf(TEXT("FSurrealPilotJsonWriter: %.2f ms, %.2f MB copied, %.2f MB peak, %d growths (pre-sized)"),
+        DirectSeconds * 1000.0, DirectBytesCopied / (1024.0 * 1024.0), DirectPeakBytes / (1024.0 * 1024.0), DirectGrowths));
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
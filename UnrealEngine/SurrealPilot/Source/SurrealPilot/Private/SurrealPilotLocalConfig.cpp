@@ -0,0 +1,245 @@
+#include "SurrealPilotLocalConfig.h"
+#include "DirectoryWatcherModule.h"
+#include "IDirectoryWatcher.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+TUniquePtr<FSurrealPilotLocalConfig> FSurrealPilotLocalConfig::Instance = nullptr;
+
+namespace SurrealPilotLocalConfig
+{
+	/** How often the file timestamp is polled when no directory watcher is available */
+	constexpr double TimestampPollIntervalSeconds = 2.0;
+}
+
+void FSurrealPilotLocalConfig::Initialize()
+{
+	Get().RegisterDirectoryWatcher();
+}
+
+void FSurrealPilotLocalConfig::Shutdown()
+{
+	if (Instance.IsValid())
+	{
+		Instance->UnregisterDirectoryWatcher();
+		Instance.Reset();
+	}
+}
+
+FSurrealPilotLocalConfig& FSurrealPilotLocalConfig::Get()
+{
+	if (!Instance.IsValid())
+	{
+		Instance = TUniquePtr<FSurrealPilotLocalConfig>(new FSurrealPilotLocalConfig());
+	}
+	return *Instance;
+}
+
+FSurrealPilotLocalConfig::FSurrealPilotLocalConfig()
+	: ConfigPath(ResolveConfigPath())
+	, Snapshot(MakeShared<FSurrealPilotLocalConfigSnapshot>())
+	, bDirty(true)
+	, LoadedTimestamp(FDateTime::MinValue())
+	, LastTimestampCheckTime(0.0)
+{
+}
+
+FSurrealPilotLocalConfig::~FSurrealPilotLocalConfig()
+{
+	UnregisterDirectoryWatcher();
+}
+
+TSharedRef<const FSurrealPilotLocalConfigSnapshot> FSurrealPilotLocalConfig::GetSnapshot()
+{
+	FScopeLock Lock(&SnapshotLock);
+
+	if (NeedsReload())
+	{
+		Reload();
+	}
+
+	return Snapshot;
+}
+
+bool FSurrealPilotLocalConfig::Save(const TSharedRef<FJsonObject>& ConfigJson)
+{
+	// Ensure directory exists
+	const FString ConfigDir = FPaths::GetPath(ConfigPath);
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.DirectoryExists(*ConfigDir))
+	{
+		PlatformFile.CreateDirectoryTree(*ConfigDir);
+	}
+
+	FString ConfigContent;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ConfigContent);
+	FJsonSerializer::Serialize(ConfigJson, Writer);
+
+	const bool bSaved = FFileHelper::SaveStringToFile(ConfigContent, *ConfigPath);
+
+	Invalidate();
+
+	// The directory may have just been created, in which case it can be watched now
+	if (bSaved && !WatcherHandle.IsValid() && IsInGameThread())
+	{
+		RegisterDirectoryWatcher();
+	}
+
+	return bSaved;
+}
+
+void FSurrealPilotLocalConfig::Invalidate()
+{
+	FScopeLock Lock(&SnapshotLock);
+	bDirty = true;
+}
+
+bool FSurrealPilotLocalConfig::NeedsReload()
+{
+	if (bDirty)
+	{
+		return true;
+	}
+
+	// The watcher reports every change, so there is nothing to poll
+	if (WatcherHandle.IsValid())
+	{
+		return false;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now - LastTimestampCheckTime < SurrealPilotLocalConfig::TimestampPollIntervalSeconds)
+	{
+		return false;
+	}
+	LastTimestampCheckTime = Now;
+
+	return IFileManager::Get().GetTimeStamp(*ConfigPath) != LoadedTimestamp;
+}
+
+void FSurrealPilotLocalConfig::Reload()
+{
+	TSharedRef<FSurrealPilotLocalConfigSnapshot> NewSnapshot = MakeShared<FSurrealPilotLocalConfigSnapshot>();
+
+	bDirty = false;
+	LastTimestampCheckTime = FPlatformTime::Seconds();
+	LoadedTimestamp = IFileManager::Get().GetTimeStamp(*ConfigPath);
+
+	FString ConfigContent;
+	FileReadCount.Increment();
+	if (FFileHelper::LoadFileToString(ConfigContent, *ConfigPath))
+	{
+		TSharedPtr<FJsonObject> ConfigJson;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ConfigContent);
+
+		if (FJsonSerializer::Deserialize(Reader, ConfigJson) && ConfigJson.IsValid())
+		{
+			NewSnapshot->bLoaded = true;
+			NewSnapshot->Json = ConfigJson;
+
+			if (ConfigJson->TryGetStringField(TEXT("api_key"), NewSnapshot->ApiKey) && !NewSnapshot->ApiKey.IsEmpty())
+			{
+				NewSnapshot->AuthorizationHeader = FString::Printf(TEXT("Bearer %s"), *NewSnapshot->ApiKey);
+			}
+
+			ConfigJson->TryGetStringField(TEXT("preferred_provider"), NewSnapshot->PreferredProvider);
+
+			int32 Port = 0;
+			if (ConfigJson->TryGetNumberField(TEXT("port"), Port) && Port > 0 && Port <= 65535)
+			{
+				NewSnapshot->Port = Port;
+			}
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: Failed to parse local config %s"), *ConfigPath);
+		}
+	}
+
+	Snapshot = NewSnapshot;
+}
+
+void FSurrealPilotLocalConfig::RegisterDirectoryWatcher()
+{
+	if (WatcherHandle.IsValid())
+	{
+		return;
+	}
+
+	// Directories can only be watched once they exist; until then the timestamp poll covers changes
+	const FString ConfigDir = FPaths::GetPath(ConfigPath);
+	if (!IFileManager::Get().DirectoryExists(*ConfigDir))
+	{
+		return;
+	}
+
+	FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::LoadModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+	IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule ? DirectoryWatcherModule->Get() : nullptr;
+	if (!DirectoryWatcher)
+	{
+		return;
+	}
+
+	FDelegateHandle NewHandle;
+	if (DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(
+		ConfigDir,
+		IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FSurrealPilotLocalConfig::OnConfigDirectoryChanged),
+		NewHandle))
+	{
+		WatchedDirectory = ConfigDir;
+
+		// Changes made before the watcher existed are picked up by one final reload
+		FScopeLock Lock(&SnapshotLock);
+		WatcherHandle = NewHandle;
+		bDirty = true;
+	}
+}
+
+void FSurrealPilotLocalConfig::UnregisterDirectoryWatcher()
+{
+	if (!WatcherHandle.IsValid())
+	{
+		return;
+	}
+
+	if (FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")))
+	{
+		if (IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule->Get())
+		{
+			DirectoryWatcher->UnregisterDirectoryChangedCallback_Handle(WatchedDirectory, WatcherHandle);
+		}
+	}
+
+	WatcherHandle.Reset();
+	WatchedDirectory.Empty();
+}
+
+void FSurrealPilotLocalConfig::OnConfigDirectoryChanged(const TArray<FFileChangeData>& FileChanges)
+{
+	const FString ConfigFilename = FPaths::GetCleanFilename(ConfigPath);
+	for (const FFileChangeData& Change : FileChanges)
+	{
+		if (FPaths::GetCleanFilename(Change.Filename) == ConfigFilename)
+		{
+			Invalidate();
+			return;
+		}
+	}
+}
+
+FString FSurrealPilotLocalConfig::ResolveConfigPath()
+{
+	FString UserProfile = FPlatformMisc::GetEnvironmentVariable(TEXT("USERPROFILE"));
+	if (UserProfile.IsEmpty())
+	{
+		UserProfile = FPlatformMisc::GetEnvironmentVariable(TEXT("HOME"));
+	}
+
+	return FPaths::Combine(UserProfile, TEXT(".surrealpilot"), TEXT("config.json"));
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "SurrealPilotStyle.h"
 #include "SurrealPilotSettings.h"
 #include "HttpClient.h"
+#include "SurrealPilotLocalConfig.h"
 #include "ContextExporter.h"
 #include "BuildErrorCapture.h"
 #include "PatchApplier.h"
@@ -14,6 +15,7 @@
 #include "Engine/Blueprint.h"
 #include "Editor.h"
 #include "HAL/PlatformApplicationMisc.h"
+#include "Serialization/JsonSerializer.h"
 
 static const FName SurrealPilotTabName("SurrealPilot");
 
@@ -31,6 +33,9 @@ void FSurrealPilotModule::StartupModule()
 	// Register menus
 	RegisterMenus();
 
+	// Watch the local config file so settings and requests share one cached copy
+	FSurrealPilotLocalConfig::Initialize();
+
 	// Initialize HTTP client
 	FHttpClient::Initialize();
 
@@ -51,6 +56,9 @@ void FSurrealPilotModule::ShutdownModule()
 	// Shutdown HTTP client
 	FHttpClient::Shutdown();
 
+	// Stop watching the local config file
+	FSurrealPilotLocalConfig::Shutdown();
+
 	UE_LOG(LogTemp, Log, TEXT("SurrealPilot plugin shutdown"));
 }
 
@@ -156,11 +164,27 @@ void FSurrealPilotModule::OnExportBlueprintContext()
 		return;
 	}
 
-	FString ContextJson = ContextExporter->ExportBlueprintContext(SelectedBlueprint);
+	TSharedPtr<FJsonObject> ContextObject = ContextExporter->ExportBlueprintContextObject(SelectedBlueprint);
+	if (!ContextObject.IsValid())
+	{
+		return;
+	}
 	
-	// Copy to clipboard for now - in future tasks this will be sent to API
+	FString ContextJson;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ContextJson);
+	FJsonSerializer::Serialize(ContextObject.ToSharedRef(), Writer);
 	FPlatformApplicationMisc::ClipboardCopy(*ContextJson);
 	
+	// Re-exporting after an edit sends only what changed since the server's copy
+	if (FHttpClient::IsAvailable())
+	{
+		FHttpClient::Get().SendAssetContext(SelectedBlueprint->GetPathName(), TEXT("blueprint"), ContextObject, FOnHttpResponse(),
+			FOnHttpError::CreateLambda([](const FString& Error)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: Failed to send blueprint context: %s"), *Error);
+			}));
+	}
+	
 	UE_LOG(LogTemp, Log, TEXT("Blueprint context exported to clipboard: %s"), *SelectedBlueprint->GetName());
 }
 
@@ -0,0 +1,571 @@
+#include "SurrealPilotProjectContext.h"
+#include "SurrealPilotJsonWriter.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphPin.h"
+#include "EdGraphSchema_K2.h"
+#include "Editor.h"
+#include "Engine/Blueprint.h"
+#include "HAL/FileManager.h"
+#include "K2Node_FunctionEntry.h"
+#include "K2Node_FunctionResult.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace SurrealPilotProjectContext
+{
+	/** Bumped when the member cache's layout changes, so an older file is ignored */
+	constexpr int32 MemberCacheVersion = 1;
+
+	IAssetRegistry& GetAssetRegistry()
+	{
+		return FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	}
+
+	/** Name of a class from the path a tag stores it as, e.g. /Script/CoreUObject.Class'/Script/Engine.Actor' */
+	FString ClassNameFromTag(const FString& TagValue)
+	{
+		const FString ObjectPath = FPackageName::ExportTextPathToObjectPath(TagValue);
+		return ObjectPath.Contains(TEXT(".")) ? FPackageName::ObjectPathToObjectName(ObjectPath) : ObjectPath;
+	}
+
+	/** Interface names from the ImplementedInterfaces tag, a comma-separated list of interface paths */
+	TArray<FString> ParseInterfaces(const FString& TagValue)
+	{
+		TArray<FString> Items;
+		TagValue.ParseIntoArray(Items, TEXT(","), true);
+
+		TArray<FString> Interfaces;
+		for (FString& Item : Items)
+		{
+			Item.TrimStartAndEndInline();
+			Item.RemoveFromStart(TEXT("(Interface="));
+			Item.RemoveFromEnd(TEXT(")"));
+			Item.TrimQuotesInline();
+			if (!Item.IsEmpty())
+			{
+				Interfaces.Add(ClassNameFromTag(Item));
+			}
+		}
+		return Interfaces;
+	}
+
+	void WritePinType(FSurrealPilotJsonWriter& Writer, const FEdGraphPinType& PinType)
+	{
+		Writer.WriteString(TEXT("type"), PinType.PinCategory.ToString());
+		Writer.WriteBool(TEXT("isArray"), PinType.IsArray());
+		if (PinType.PinSubCategoryObject.IsValid())
+		{
+			Writer.WriteString(TEXT("subType"), PinType.PinSubCategoryObject->GetName());
+		}
+	}
+
+	/** A function's parameters or returns: the node's pins other than its exec pin */
+	void WriteSignaturePins(FSurrealPilotJsonWriter& Writer, const TCHAR* Field, const UEdGraphNode* Node)
+	{
+		Writer.BeginArray(Field);
+		for (const UEdGraphPin* Pin : Node->Pins)
+		{
+			if (Pin && Pin->PinType.PinCategory != UEdGraphSchema_K2::PC_Exec)
+			{
+				Writer.BeginObject();
+				Writer.WriteString(TEXT("name"), Pin->PinName.ToString());
+				WritePinType(Writer, Pin->PinType);
+				Writer.EndObject();
+			}
+		}
+		Writer.EndArray();
+	}
+
+	/** Re-encode a value read from the member cache file */
+	TArray<uint8> EncodeValue(const TSharedPtr<FJsonValue>& Value)
+	{
+		FSurrealPilotJsonWriter Writer;
+		Writer.WriteJsonValue(Value);
+		return Writer.MoveBuffer();
+	}
+}
+
+FSurrealPilotProjectContext::FSurrealPilotProjectContext()
+	: MemberCachePath(GetDefaultMemberCachePath())
+{
+}
+
+FSurrealPilotProjectContext::~FSurrealPilotProjectContext()
+{
+	StopListening();
+}
+
+FString FSurrealPilotProjectContext::GetDefaultMemberCachePath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("SurrealPilot") / TEXT("ProjectContextMembers.json");
+}
+
+void FSurrealPilotProjectContext::SetMemberCachePath(const FString& InMemberCachePath)
+{
+	if (MemberCachePath != InMemberCachePath)
+	{
+		MemberCachePath = InMemberCachePath;
+		Members.Reset();
+		bMemberCacheLoaded = false;
+		bMemberCacheDirty = false;
+	}
+}
+
+TArray<uint8> FSurrealPilotProjectContext::Export(const FString& InRootPath)
+{
+	LoadMemberCache();
+	FString NewRootPath = InRootPath;
+	NewRootPath.RemoveFromEnd(TEXT("/"));
+	if (!bScanned || RootPath != NewRootPath)
+	{
+		RootPath = NewRootPath;
+		Scan();
+	}
+	else
+	{
+		RefreshDirty();
+	}
+
+	// Sorted, so the same project exports the same bytes whatever order the registry found it in
+	TArray<FString> Paths;
+	Entries.GetKeys(Paths);
+	Paths.Sort();
+
+	Stats.MembersFromLoaded = 0;
+	Stats.MembersFromCache = 0;
+	Stats.MembersUnknown = 0;
+
+	FSurrealPilotJsonWriter Writer(LastExportBytes + LastExportBytes / 8);
+	Writer.BeginObject();
+	Writer.WriteString(TEXT("type"), TEXT("Project"));
+	Writer.WriteString(TEXT("root"), RootPath);
+	Writer.WriteBool(TEXT("complete"), !SurrealPilotProjectContext::GetAssetRegistry().IsLoadingAssets());
+	Writer.WriteInteger(TEXT("blueprintCount"), Paths.Num());
+	Writer.BeginArray(TEXT("blueprints"));
+	for (const FString& Path : Paths)
+	{
+		const FEntry& Entry = Entries[Path];
+		Writer.WriteRawValue(Entry.Json);
+		switch (Entry.MembersSource)
+		{
+		case EMembersSource::Loaded: ++Stats.MembersFromLoaded; break;
+		case EMembersSource::Cache: ++Stats.MembersFromCache; break;
+		case EMembersSource::Unknown: ++Stats.MembersUnknown; break;
+		}
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+
+	LastExportBytes = Writer.GetBuffer().Num();
+	return Writer.MoveBuffer();
+}
+
+void FSurrealPilotProjectContext::Scan()
+{
+	IAssetRegistry& AssetRegistry = SurrealPilotProjectContext::GetAssetRegistry();
+
+	// Subclasses too, so Animation and Widget Blueprints are included
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UBlueprint::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+	Filter.PackagePaths.Add(FName(*RootPath));
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	Entries.Reset();
+	Entries.Reserve(Assets.Num());
+	Dirty.Reset();
+	for (const FAssetData& AssetData : Assets)
+	{
+		Summarize(AssetData);
+	}
+
+	bScanned = true;
+	++Stats.Scans;
+	StartListening();
+}
+
+void FSurrealPilotProjectContext::RefreshDirty()
+{
+	if (Dirty.Num() == 0)
+	{
+		return;
+	}
+
+	IAssetRegistry& AssetRegistry = SurrealPilotProjectContext::GetAssetRegistry();
+	for (const FString& Path : Dirty)
+	{
+		const FAssetData AssetData = AssetRegistry.GetAssetByObjectPath(FSoftObjectPath(Path));
+		if (AssetData.IsValid() && AssetData.IsInstanceOf(UBlueprint::StaticClass()) && IsUnderRoot(AssetData))
+		{
+			Summarize(AssetData);
+			++Stats.Refreshed;
+		}
+		else
+		{
+			Entries.Remove(Path);
+		}
+	}
+	Dirty.Reset();
+}
+
+bool FSurrealPilotProjectContext::IsUnderRoot(const FAssetData& AssetData) const
+{
+	const FString PackagePath = AssetData.PackagePath.ToString();
+	return PackagePath == RootPath || PackagePath.StartsWith(RootPath + TEXT("/"));
+}
+
+void FSurrealPilotProjectContext::Summarize(const FAssetData& AssetData)
+{
+	using namespace SurrealPilotProjectContext;
+	const FString ObjectPath = AssetData.GetObjectPathString();
+	FEntry& Entry = Entries.FindOrAdd(ObjectPath);
+
+	FSurrealPilotJsonWriter Writer(512);
+	Writer.BeginObject();
+	Writer.WriteString(TEXT("name"), AssetData.AssetName.ToString());
+	Writer.WriteString(TEXT("path"), ObjectPath);
+	Writer.WriteString(TEXT("class"), AssetData.AssetClassPath.GetAssetName().ToString());
+
+	FString TagValue;
+	if (AssetData.GetTagValue(FBlueprintTags::ParentClassPath, TagValue) && !TagValue.IsEmpty())
+	{
+		Writer.WriteString(TEXT("parentClass"), ClassNameFromTag(TagValue));
+	}
+	if (AssetData.GetTagValue(FBlueprintTags::NativeParentClassPath, TagValue) && !TagValue.IsEmpty())
+	{
+		Writer.WriteString(TEXT("nativeParentClass"), ClassNameFromTag(TagValue));
+	}
+	if (AssetData.GetTagValue(FBlueprintTags::BlueprintType, TagValue) && !TagValue.IsEmpty())
+	{
+		Writer.WriteString(TEXT("blueprintType"), TagValue);
+	}
+	if (AssetData.GetTagValue(FBlueprintTags::BlueprintDescription, TagValue) && !TagValue.IsEmpty())
+	{
+		Writer.WriteString(TEXT("description"), TagValue);
+	}
+	if (AssetData.GetTagValue(FBlueprintTags::BlueprintCategory, TagValue) && !TagValue.IsEmpty())
+	{
+		Writer.WriteString(TEXT("category"), TagValue);
+	}
+	if (AssetData.GetTagValue(FBlueprintTags::IsDataOnly, TagValue))
+	{
+		Writer.WriteBool(TEXT("dataOnly"), TagValue.ToBool());
+	}
+
+	Writer.BeginArray(TEXT("interfaces"));
+	if (AssetData.GetTagValue(FBlueprintTags::ImplementedInterfaces, TagValue))
+	{
+		for (const FString& Interface : ParseInterfaces(TagValue))
+		{
+			Writer.WriteString(Interface);
+		}
+	}
+	Writer.EndArray();
+
+	// A loaded Blueprint is read as it is now; an unloaded one only gets members read while its tags were the same
+	const uint32 TagHash = HashMemberTags(AssetData);
+	const FMembers* KnownMembers = nullptr;
+	if (UBlueprint* Blueprint = Cast<UBlueprint>(AssetData.FastGetAsset(false)))
+	{
+		FMembers& LoadedMembers = Members.FindOrAdd(ObjectPath);
+		ReadMembers(Blueprint, LoadedMembers);
+		LoadedMembers.TagHash = TagHash;
+		bMemberCacheDirty = true;
+		KnownMembers = &LoadedMembers;
+		Entry.MembersSource = EMembersSource::Loaded;
+	}
+	else
+	{
+		const FMembers* CachedMembers = Members.Find(ObjectPath);
+		const bool bCacheValid = CachedMembers && TagHash != 0 && CachedMembers->TagHash == TagHash;
+		KnownMembers = bCacheValid ? CachedMembers : nullptr;
+		Entry.MembersSource = bCacheValid ? EMembersSource::Cache : EMembersSource::Unknown;
+	}
+
+	Writer.WriteBool(TEXT("membersKnown"), KnownMembers != nullptr);
+	if (KnownMembers)
+	{
+		Writer.WriteRawValue(TEXT("variables"), KnownMembers->Variables);
+		Writer.WriteRawValue(TEXT("functions"), KnownMembers->Functions);
+	}
+	Writer.EndObject();
+
+	Entry.Json = Writer.MoveBuffer();
+}
+
+uint32 FSurrealPilotProjectContext::HashMemberTags(const FAssetData& AssetData)
+{
+	// The Find in Blueprints data indexes every variable, function and pin, so it changes whenever they do
+	FString SearchData;
+	if (!AssetData.GetTagValue(FBlueprintTags::FindInBlueprintsData, SearchData) || SearchData.IsEmpty())
+	{
+		return 0;
+	}
+
+	FString ParentClass;
+	AssetData.GetTagValue(FBlueprintTags::ParentClassPath, ParentClass);
+	uint32 Crc = FCrc::MemCrc32(*ParentClass, ParentClass.Len() * sizeof(TCHAR));
+	Crc = FCrc::MemCrc32(*SearchData, SearchData.Len() * sizeof(TCHAR), Crc);
+	return Crc != 0 ? Crc : 1;
+}
+
+void FSurrealPilotProjectContext::ReadMembers(UBlueprint* Blueprint, FMembers& OutMembers)
+{
+	using namespace SurrealPilotProjectContext;
+
+	FSurrealPilotJsonWriter VariablesWriter;
+	VariablesWriter.BeginArray();
+	for (const FBPVariableDescription& Variable : Blueprint->NewVariables)
+	{
+		VariablesWriter.BeginObject();
+		VariablesWriter.WriteString(TEXT("name"), Variable.VarName.ToString());
+		WritePinType(VariablesWriter, Variable.VarType);
+		if (!Variable.Category.IsEmpty())
+		{
+			VariablesWriter.WriteString(TEXT("category"), Variable.Category.ToString());
+		}
+		VariablesWriter.EndObject();
+	}
+	VariablesWriter.EndArray();
+
+	FSurrealPilotJsonWriter FunctionsWriter;
+	FunctionsWriter.BeginArray();
+	for (const UEdGraph* FunctionGraph : Blueprint->FunctionGraphs)
+	{
+		if (!FunctionGraph)
+		{
+			continue;
+		}
+
+		FunctionsWriter.BeginObject();
+		FunctionsWriter.WriteString(TEXT("name"), FunctionGraph->GetName());
+		for (const UEdGraphNode* GraphNode : FunctionGraph->Nodes)
+		{
+			if (Cast<UK2Node_FunctionEntry>(GraphNode))
+			{
+				WriteSignaturePins(FunctionsWriter, TEXT("parameters"), GraphNode);
+			}
+		}
+		for (const UEdGraphNode* GraphNode : FunctionGraph->Nodes)
+		{
+			// A function can have several return nodes, all with the same pins
+			if (Cast<UK2Node_FunctionResult>(GraphNode))
+			{
+				WriteSignaturePins(FunctionsWriter, TEXT("returns"), GraphNode);
+				break;
+			}
+		}
+		FunctionsWriter.EndObject();
+	}
+	FunctionsWriter.EndArray();
+
+	OutMembers.Variables = VariablesWriter.MoveBuffer();
+	OutMembers.Functions = FunctionsWriter.MoveBuffer();
+}
+
+void FSurrealPilotProjectContext::LoadMemberCache()
+{
+	if (bMemberCacheLoaded)
+	{
+		return;
+	}
+	bMemberCacheLoaded = true;
+
+	FString Contents;
+	if (MemberCachePath.IsEmpty() || !FFileHelper::LoadFileToString(Contents, *MemberCachePath))
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	int32 Version = 0;
+	const TArray<TSharedPtr<FJsonValue>>* Blueprints = nullptr;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Contents), Root) || !Root.IsValid() ||
+		!Root->TryGetNumberField(TEXT("version"), Version) || Version != SurrealPilotProjectContext::MemberCacheVersion ||
+		!Root->TryGetArrayField(TEXT("blueprints"), Blueprints))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: ignoring unreadable project context cache %s"), *MemberCachePath);
+		return;
+	}
+
+	for (const TSharedPtr<FJsonValue>& Value : *Blueprints)
+	{
+		const TSharedPtr<FJsonObject>* Blueprint = nullptr;
+		FString Path;
+		int64 TagHash = 0;
+		if (!Value->TryGetObject(Blueprint) || !(*Blueprint)->TryGetStringField(TEXT("path"), Path) ||
+			!(*Blueprint)->TryGetNumberField(TEXT("tags"), TagHash) ||
+			!(*Blueprint)->HasTypedField<EJson::Array>(TEXT("variables")) || !(*Blueprint)->HasTypedField<EJson::Array>(TEXT("functions")))
+		{
+			continue;
+		}
+
+		// Members read this session are newer than the file
+		if (Members.Contains(Path))
+		{
+			continue;
+		}
+
+		FMembers& Entry = Members.Add(Path);
+		Entry.TagHash = static_cast<uint32>(TagHash);
+		Entry.Variables = SurrealPilotProjectContext::EncodeValue((*Blueprint)->Values.FindRef(TEXT("variables")));
+		Entry.Functions = SurrealPilotProjectContext::EncodeValue((*Blueprint)->Values.FindRef(TEXT("functions")));
+	}
+}
+
+void FSurrealPilotProjectContext::SaveMemberCache()
+{
+	if (!bMemberCacheDirty || MemberCachePath.IsEmpty())
+	{
+		return;
+	}
+
+	FSurrealPilotJsonWriter Writer;
+	Writer.BeginObject();
+	Writer.WriteInteger(TEXT("version"), SurrealPilotProjectContext::MemberCacheVersion);
+	Writer.BeginArray(TEXT("blueprints"));
+	for (const TPair<FString, FMembers>& Pair : Members)
+	{
+		if (Pair.Value.TagHash == 0)
+		{
+			continue;
+		}
+		Writer.BeginObject();
+		Writer.WriteString(TEXT("path"), Pair.Key);
+		Writer.WriteInteger(TEXT("tags"), Pair.Value.TagHash);
+		Writer.WriteRawValue(TEXT("variables"), Pair.Value.Variables);
+		Writer.WriteRawValue(TEXT("functions"), Pair.Value.Functions);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(MemberCachePath), true);
+	if (!FFileHelper::SaveArrayToFile(Writer.GetBuffer(), *MemberCachePath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: could not write project context cache %s"), *MemberCachePath);
+		return;
+	}
+	bMemberCacheDirty = false;
+}
+
+void FSurrealPilotProjectContext::Reset()
+{
+	StopListening();
+	Entries.Reset();
+	Dirty.Reset();
+	bScanned = false;
+	LastExportBytes = 0;
+}
+
+void FSurrealPilotProjectContext::StartListening()
+{
+	if (AssetAddedHandle.IsValid())
+	{
+		return;
+	}
+
+	IAssetRegistry& AssetRegistry = SurrealPilotProjectContext::GetAssetRegistry();
+	AssetAddedHandle = AssetRegistry.OnAssetAdded().AddRaw(this, &FSurrealPilotProjectContext::MarkDirty);
+	AssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddRaw(this, &FSurrealPilotProjectContext::OnAssetRemoved);
+	AssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddRaw(this, &FSurrealPilotProjectContext::OnAssetRenamed);
+	AssetUpdatedHandle = AssetRegistry.OnAssetUpdated().AddRaw(this, &FSurrealPilotProjectContext::MarkDirty);
+	FilesLoadedHandle = AssetRegistry.OnFilesLoaded().AddRaw(this, &FSurrealPilotProjectContext::OnFilesLoaded);
+	if (GEditor)
+	{
+		PreCompileHandle = GEditor->OnBlueprintPreCompile().AddRaw(this, &FSurrealPilotProjectContext::OnBlueprintPreCompile);
+	}
+}
+
+void FSurrealPilotProjectContext::StopListening()
+{
+	if (!AssetAddedHandle.IsValid())
+	{
+		return;
+	}
+
+	// The registry may already be gone at shutdown
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>("AssetRegistry"))
+	{
+		IAssetRegistry& AssetRegistry = AssetRegistryModule->Get();
+		AssetRegistry.OnAssetAdded().Remove(AssetAddedHandle);
+		AssetRegistry.OnAssetRemoved().Remove(AssetRemovedHandle);
+		AssetRegistry.OnAssetRenamed().Remove(AssetRenamedHandle);
+		AssetRegistry.OnAssetUpdated().Remove(AssetUpdatedHandle);
+		AssetRegistry.OnFilesLoaded().Remove(FilesLoadedHandle);
+	}
+	if (GEditor)
+	{
+		GEditor->OnBlueprintPreCompile().Remove(PreCompileHandle);
+	}
+
+	AssetAddedHandle.Reset();
+	AssetRemovedHandle.Reset();
+	AssetRenamedHandle.Reset();
+	AssetUpdatedHandle.Reset();
+	FilesLoadedHandle.Reset();
+	PreCompileHandle.Reset();
+}
+
+void FSurrealPilotProjectContext::MarkDirty(const FAssetData& AssetData)
+{
+	// Assets found during discovery are picked up by the scan that follows it
+	if (!bScanned || SurrealPilotProjectContext::GetAssetRegistry().IsLoadingAssets() || !AssetData.IsInstanceOf(UBlueprint::StaticClass()))
+	{
+		return;
+	}
+	Dirty.Add(AssetData.GetObjectPathString());
+}
+
+void FSurrealPilotProjectContext::OnAssetRemoved(const FAssetData& AssetData)
+{
+	const FString ObjectPath = AssetData.GetObjectPathString();
+	Entries.Remove(ObjectPath);
+	Dirty.Remove(ObjectPath);
+	if (Members.Remove(ObjectPath) > 0)
+	{
+		bMemberCacheDirty = true;
+	}
+}
+
+void FSurrealPilotProjectContext::OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	Entries.Remove(OldObjectPath);
+	Dirty.Remove(OldObjectPath);
+
+	// The members went with the asset; its tags, and so their hash, are unchanged
+	FMembers OldMembers;
+	if (Members.RemoveAndCopyValue(OldObjectPath, OldMembers))
+	{
+		Members.Add(AssetData.GetObjectPathString(), MoveTemp(OldMembers));
+		bMemberCacheDirty = true;
+	}
+	MarkDirty(AssetData);
+}
+
+void FSurrealPilotProjectContext::OnBlueprintPreCompile(UBlueprint* Blueprint)
+{
+	// Read again after the compile, on the next export
+	if (Blueprint)
+	{
+		Dirty.Add(Blueprint->GetPathName());
+	}
+}
+
+void FSurrealPilotProjectContext::OnFilesLoaded()
+{
+	// Discovery has finished; one pass over everything is cheaper than each discovered asset on its own
+	bScanned = false;
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "SurrealPilotProjectContext.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Blueprint.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SurrealPilotProjectContextTest
+{
+    /** Engine content always has Blueprints, whatever project the tests run in */
+    const TCHAR* const RootPath = TEXT("/Engine");
+
+    TArray<FAssetData> GetBlueprints()
+    {
+        FARFilter Filter;
+        Filter.ClassPaths.Add(UBlueprint::StaticClass()->GetClassPathName());
+        Filter.bRecursiveClasses = true;
+        Filter.PackagePaths.Add(RootPath);
+        Filter.bRecursivePaths = true;
+
+        TArray<FAssetData> Assets;
+        FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get().GetAssets(Filter, Assets);
+        return Assets;
+    }
+
+    TSharedPtr<FJsonObject> Parse(const TArray<uint8>& Utf8Json)
+    {
+        FUTF8ToTCHAR Json(reinterpret_cast<const ANSICHAR*>(Utf8Json.GetData()), Utf8Json.Num());
+        TSharedPtr<FJsonObject> Object;
+        FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(Json.Length(), Json.Get())), Object);
+        return Object;
+    }
+
+    /** The summary of the Blueprint at Path in an export, or null */
+    TSharedPtr<FJsonObject> FindBlueprint(const TSharedPtr<FJsonObject>& Export, const FString& Path)
+    {
+        for (const TSharedPtr<FJsonValue>& Value : Export->GetArrayField(TEXT("blueprints")))
+        {
+            if (Value->AsObject()->GetStringField(TEXT("path")) == Path)
+            {
+                return Value->AsObject();
+            }
+        }
+        return nullptr;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotProjectContextExportTest, "SurrealPilot.ProjectContext.ExportWithoutLoading",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotProjectContextExportTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotProjectContextTest;
+
+    const FString CachePath = FPaths::AutomationTransientDir() / TEXT("SurrealPilotProjectContext.json");
+    IFileManager::Get().Delete(*CachePath, false, false, true);
+
+    // Which Blueprints were loaded before the export, to check it loaded no others
+    TArray<FAssetData> Blueprints = GetBlueprints();
+    TSet<FString> LoadedBefore;
+    for (const FAssetData& AssetData : Blueprints)
+    {
+        if (AssetData.FastGetAsset(false))
+        {
+            LoadedBefore.Add(AssetData.GetObjectPathString());
+        }
+    }
+
+    FSurrealPilotProjectContext ProjectContext;
+    ProjectContext.SetMemberCachePath(CachePath);
+
+    const double ColdStart = FPlatformTime::Seconds();
+    const TArray<uint8> ColdExport = ProjectContext.Export(RootPath);
+    const double ColdSeconds = FPlatformTime::Seconds() - ColdStart;
+
+    TSharedPtr<FJsonObject> Export = Parse(ColdExport);
+    if (!TestTrue("Export should be valid JSON", Export.IsValid()))
+    {
+        return false;
+    }
+    TestEqual("Export should be a project summary", Export->GetStringField(TEXT("type")), FString(TEXT("Project")));
+    TestEqual("Every Blueprint should be summarized", static_cast<int32>(Export->GetNumberField(TEXT("blueprintCount"))), Blueprints.Num());
+    TestEqual("The count should match the list", Export->GetArrayField(TEXT("blueprints")).Num(), Blueprints.Num());
+
+    int32 NewlyLoaded = 0;
+    for (const FAssetData& AssetData : Blueprints)
+    {
+        NewlyLoaded += !LoadedBefore.Contains(AssetData.GetObjectPathString()) && AssetData.FastGetAsset(false) ? 1 : 0;
+    }
+    TestEqual("Export should load no Blueprint", NewlyLoaded, 0);
+
+    const FSurrealPilotProjectContextStats& Stats = ProjectContext.GetStats();
+    TestEqual("Loaded Blueprints should have their members read", Stats.MembersFromLoaded, LoadedBefore.Num());
+    for (const FString& Path : LoadedBefore)
+    {
+        TSharedPtr<FJsonObject> Summary = FindBlueprint(Export, Path);
+        TestTrue(FString::Printf(TEXT("%s should list its members"), *Path), Summary.IsValid() && Summary->GetBoolField(TEXT("membersKnown")));
+    }
+
+    // Nothing changed, so nothing is summarized again
+    const double WarmStart = FPlatformTime::Seconds();
+    const TArray<uint8> WarmExport = ProjectContext.Export(RootPath);
+    const double WarmSeconds = FPlatformTime::Seconds() - WarmStart;
+    TestEqual("A second export should not scan again", Stats.Scans, 1);
+    TestEqual("A second export should summarize nothing again", Stats.Refreshed, 0);
+    TestTrue("A second export should match the first", WarmExport == ColdExport);
+
+    AddInfo(FString::Printf(TEXT("%d Blueprints under %s (%d loaded): first export %.1f ms, next %.2f ms, %d KB"),
+        Blueprints.Num(), RootPath, LoadedBefore.Num(), ColdSeconds * 1000.0, WarmSeconds * 1000.0, ColdExport.Num() / 1024));
+
+    IFileManager::Get().Delete(*CachePath, false, false, true);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotProjectContextMemberCacheTest, "SurrealPilot.ProjectContext.MemberCache",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotProjectContextMemberCacheTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotProjectContextTest;
+
+    // An unloaded Blueprint with search data its members can be checked against
+    const FAssetData* Unloaded = nullptr;
+    TArray<FAssetData> Blueprints = GetBlueprints();
+    for (const FAssetData& AssetData : Blueprints)
+    {
+        if (!AssetData.FastGetAsset(false) && FSurrealPilotProjectContext::HashMemberTags(AssetData) != 0)
+        {
+            Unloaded = &AssetData;
+            break;
+        }
+    }
+    if (!Unloaded)
+    {
+        AddWarning(TEXT("No unloaded Blueprint with search data to test the member cache with"));
+        return true;
+    }
+
+    const FString Path = Unloaded->GetObjectPathString();
+    const FString CachePath = FPaths::AutomationTransientDir() / TEXT("SurrealPilotProjectContextMembers.json");
+    auto WriteCache = [&CachePath, &Path](uint32 TagHash)
+    {
+        FFileHelper::SaveStringToFile(FString::Printf(
+            TEXT("{\"version\":1,\"blueprints\":[{\"path\":\"%s\",\"tags\":%u,\"variables\":[{\"name\":\"Health\",\"type\":\"real\",\"isArray\":false}],\"functions\":[]}]}"),
+            *Path, TagHash), *CachePath);
+    };
+
+    // Members remembered while the Blueprint's tags were what they are now
+    WriteCache(FSurrealPilotProjectContext::HashMemberTags(*Unloaded));
+    {
+        FSurrealPilotProjectContext ProjectContext;
+        ProjectContext.SetMemberCachePath(CachePath);
+        TSharedPtr<FJsonObject> Summary = FindBlueprint(Parse(ProjectContext.Export(RootPath)), Path);
+        if (TestTrue("Blueprint should be summarized", Summary.IsValid()))
+        {
+            TestTrue("Matching members should be used", Summary->GetBoolField(TEXT("membersKnown")));
+            TestEqual("Members should come from the cache", Summary->GetArrayField(TEXT("variables")).Num(), 1);
+        }
+        TestTrue("Members should be counted as cached", ProjectContext.GetStats().MembersFromCache >= 1);
+    }
+
+    // Members remembered before the Blueprint changed
+    WriteCache(FSurrealPilotProjectContext::HashMemberTags(*Unloaded) + 1);
+    {
+        FSurrealPilotProjectContext ProjectContext;
+        ProjectContext.SetMemberCachePath(CachePath);
+        TSharedPtr<FJsonObject> Summary = FindBlueprint(Parse(ProjectContext.Export(RootPath)), Path);
+        if (TestTrue("Blueprint should be summarized", Summary.IsValid()))
+        {
+            TestFalse("Stale members should not be used", Summary->GetBoolField(TEXT("membersKnown")));
+            TestFalse("Stale members should not be exported", Summary->HasField(TEXT("variables")));
+        }
+    }
+
+    TestFalse("The Blueprint should still not be loaded", Unloaded->FastGetAsset(false) != nullptr);
+
+    IFileManager::Get().Delete(*CachePath, false, false, true);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "SurrealPilotRequestHandle.h"
+
+ESurrealPilotRequestStatus FSurrealPilotRequestHandle::GetStatus() const
+{
+	if (!State.IsValid())
+	{
+		return ESurrealPilotRequestStatus::Failed;
+	}
+
+	if (State->Status == ESurrealPilotRequestStatus::Queued && State->CurrentRequest.IsValid() &&
+		State->CurrentRequest->GetStatus() == EHttpRequestStatus::Processing)
+	{
+		return ESurrealPilotRequestStatus::InFlight;
+	}
+	return State->Status;
+}
+
+bool FSurrealPilotRequestHandle::IsFinished() const
+{
+	return !State.IsValid() || State->IsFinished();
+}
+
+void FSurrealPilotRequestHandle::Cancel()
+{
+	if (State.IsValid() && !State->IsFinished())
+	{
+		Stop(State.ToSharedRef(), ESurrealPilotRequestStatus::Cancelled);
+	}
+}
+
+void FSurrealPilotRequestHandle::SetDeadline(double SecondsFromNow)
+{
+	if (!State.IsValid() || State->IsFinished())
+	{
+		return;
+	}
+
+	FTSTicker::GetCoreTicker().RemoveTicker(State->DeadlineHandle);
+
+	TWeakPtr<FSurrealPilotRequestState> WeakState = State;
+	State->DeadlineHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakState](float DeltaTime)
+	{
+		if (TSharedPtr<FSurrealPilotRequestState> PinnedState = WeakState.Pin())
+		{
+			PinnedState->DeadlineHandle.Reset();
+			if (!PinnedState->IsFinished())
+			{
+				UE_LOG(LogTemp, Log, TEXT("SurrealPilot: request deadline passed, aborting"));
+				Stop(PinnedState.ToSharedRef(), ESurrealPilotRequestStatus::TimedOut);
+			}
+		}
+		return false;
+	}), static_cast<float>(FMath::Max(0.0, SecondsFromNow)));
+}
+
+void FSurrealPilotRequestHandle::Finish(FSurrealPilotRequestState& InState, ESurrealPilotRequestStatus FinalStatus)
+{
+	InState.Status = FinalStatus;
+	InState.CurrentRequest.Reset();
+	InState.Abort.Reset();
+	if (InState.DeadlineHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(InState.DeadlineHandle);
+		InState.DeadlineHandle.Reset();
+	}
+}
+
+void FSurrealPilotRequestHandle::Stop(const TSharedRef<FSurrealPilotRequestState>& InState, ESurrealPilotRequestStatus FinalStatus)
+{
+	// Finish first so callbacks triggered by the abort see the final status
+	TFunction<void(FHttpRequestPtr, ESurrealPilotRequestStatus)> Abort = MoveTemp(InState->Abort);
+	FHttpRequestPtr Request = InState->CurrentRequest;
+	Finish(*InState, FinalStatus);
+
+	if (Abort)
+	{
+		Abort(Request, FinalStatus);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "SurrealPilotRequestScheduler.h"
+#include "SurrealPilotStats.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queued Requests"), STAT_SurrealPilot_QueuedRequests, STATGROUP_SurrealPilot);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("In-Flight Requests"), STAT_SurrealPilot_InFlightRequests, STATGROUP_SurrealPilot);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Chat Queue Wait (ms)"), STAT_SurrealPilot_ChatQueueWaitMs, STATGROUP_SurrealPilot);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Background Queue Wait (ms)"), STAT_SurrealPilot_BackgroundQueueWaitMs, STATGROUP_SurrealPilot);
+
+FSurrealPilotRequestScheduler::FSurrealPilotRequestScheduler()
+	: MaxTotalInFlight(6)
+	, TotalInFlight(0)
+{
+	// Chat may use every slot; the other classes leave room for it
+	MaxInFlight[static_cast<int32>(ESurrealPilotRequestPriority::InteractiveChat)] = MAX_int32;
+	MaxInFlight[static_cast<int32>(ESurrealPilotRequestPriority::PatchFeedback)] = 2;
+	MaxInFlight[static_cast<int32>(ESurrealPilotRequestPriority::BackgroundContext)] = 2;
+	MaxInFlight[static_cast<int32>(ESurrealPilotRequestPriority::HealthCheck)] = 1;
+}
+
+void FSurrealPilotRequestScheduler::Submit(ESurrealPilotRequestPriority Priority, FHttpRequestPtr Request)
+{
+	check(IsInGameThread());
+	check(Priority != ESurrealPilotRequestPriority::Count);
+
+	const int32 ClassIndex = static_cast<int32>(Priority);
+
+	FQueuedRequest Queued;
+	Queued.Request = Request;
+	Queued.EnqueueTime = FPlatformTime::Seconds();
+
+	// Never overtake requests of the same class that are already waiting
+	if (Queues[ClassIndex].Num() == 0 && HasFreeSlot(ClassIndex))
+	{
+		Dispatch(ClassIndex, MoveTemp(Queued));
+	}
+	else
+	{
+		Queues[ClassIndex].Add(MoveTemp(Queued));
+		FSurrealPilotSchedulerClassStats& ClassStats = Stats[ClassIndex];
+		ClassStats.Queued = Queues[ClassIndex].Num();
+		ClassStats.PeakQueued = FMath::Max(ClassStats.PeakQueued, ClassStats.Queued);
+	}
+
+	UpdateStatCounters();
+}
+
+bool FSurrealPilotRequestScheduler::Cancel(FHttpRequestPtr Request)
+{
+	for (int32 ClassIndex = 0; ClassIndex < ClassCount; ++ClassIndex)
+	{
+		TArray<FQueuedRequest>& Queue = Queues[ClassIndex];
+		const int32 QueueIndex = Queue.IndexOfByPredicate([&Request](const FQueuedRequest& Queued) { return Queued.Request == Request; });
+		if (QueueIndex != INDEX_NONE)
+		{
+			Queue.RemoveAt(QueueIndex);
+			Stats[ClassIndex].Queued = Queue.Num();
+			UpdateStatCounters();
+			return true;
+		}
+	}
+	return false;
+}
+
+void FSurrealPilotRequestScheduler::SetMaxInFlight(ESurrealPilotRequestPriority Priority, int32 InMaxInFlight)
+{
+	MaxInFlight[static_cast<int32>(Priority)] = FMath::Max(1, InMaxInFlight);
+	PumpQueues();
+}
+
+void FSurrealPilotRequestScheduler::SetMaxTotalInFlight(int32 InMaxInFlight)
+{
+	MaxTotalInFlight = FMath::Max(1, InMaxInFlight);
+	PumpQueues();
+}
+
+int32 FSurrealPilotRequestScheduler::GetTotalQueued() const
+{
+	int32 Total = 0;
+	for (const TArray<FQueuedRequest>& Queue : Queues)
+	{
+		Total += Queue.Num();
+	}
+	return Total;
+}
+
+void FSurrealPilotRequestScheduler::ResetStats()
+{
+	for (int32 ClassIndex = 0; ClassIndex < ClassCount; ++ClassIndex)
+	{
+		FSurrealPilotSchedulerClassStats& ClassStats = Stats[ClassIndex];
+		ClassStats.PeakQueued = ClassStats.Queued;
+		ClassStats.Dispatched = 0;
+		ClassStats.TotalWaitSeconds = 0.0;
+		ClassStats.MaxWaitSeconds = 0.0;
+	}
+}
+
+bool FSurrealPilotRequestScheduler::HasFreeSlot(int32 ClassIndex) const
+{
+	return TotalInFlight < MaxTotalInFlight && Stats[ClassIndex].InFlight < MaxInFlight[ClassIndex];
+}
+
+void FSurrealPilotRequestScheduler::PumpQueues()
+{
+	for (int32 ClassIndex = 0; ClassIndex < ClassCount && TotalInFlight < MaxTotalInFlight; ++ClassIndex)
+	{
+		TArray<FQueuedRequest>& Queue = Queues[ClassIndex];
+		while (Queue.Num() > 0 && HasFreeSlot(ClassIndex))
+		{
+			FQueuedRequest Queued = MoveTemp(Queue[0]);
+			Queue.RemoveAt(0, 1, EAllowShrinking::No);
+			Stats[ClassIndex].Queued = Queue.Num();
+			Dispatch(ClassIndex, MoveTemp(Queued));
+		}
+	}
+
+	UpdateStatCounters();
+}
+
+void FSurrealPilotRequestScheduler::Dispatch(int32 ClassIndex, FQueuedRequest&& Queued)
+{
+	FSurrealPilotSchedulerClassStats& ClassStats = Stats[ClassIndex];
+
+	const double WaitSeconds = FPlatformTime::Seconds() - Queued.EnqueueTime;
+	++ClassStats.Dispatched;
+	++ClassStats.InFlight;
+	++TotalInFlight;
+	ClassStats.TotalWaitSeconds += WaitSeconds;
+	ClassStats.MaxWaitSeconds = FMath::Max(ClassStats.MaxWaitSeconds, WaitSeconds);
+
+	if (ClassIndex == static_cast<int32>(ESurrealPilotRequestPriority::InteractiveChat))
+	{
+		SET_FLOAT_STAT(STAT_SurrealPilot_ChatQueueWaitMs, WaitSeconds * 1000.0);
+	}
+	else if (ClassIndex == static_cast<int32>(ESurrealPilotRequestPriority::BackgroundContext))
+	{
+		SET_FLOAT_STAT(STAT_SurrealPilot_BackgroundQueueWaitMs, WaitSeconds * 1000.0);
+	}
+
+	// Release the slot before the caller's handler runs, so a handler that resends gets it straight back.
+	// The flag guards against a request that fails to start and still reports completion later.
+	TSharedRef<bool> bFinished = MakeShared<bool>(false);
+	FHttpRequestCompleteDelegate OnComplete = Queued.Request->OnProcessRequestComplete();
+	Queued.Request->OnProcessRequestComplete().BindLambda([this, ClassIndex, bFinished, OnComplete](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+	{
+		if (!*bFinished)
+		{
+			*bFinished = true;
+			OnRequestFinished(ClassIndex);
+		}
+		OnComplete.ExecuteIfBound(Request, Response, bWasSuccessful);
+	});
+
+	if (!Queued.Request->ProcessRequest() && !*bFinished)
+	{
+		*bFinished = true;
+		OnRequestFinished(ClassIndex);
+	}
+}
+
+void FSurrealPilotRequestScheduler::OnRequestFinished(int32 ClassIndex)
+{
+	--Stats[ClassIndex].InFlight;
+	--TotalInFlight;
+	PumpQueues();
+}
+
+void FSurrealPilotRequestScheduler::UpdateStatCounters() const
+{
+	SET_DWORD_STAT(STAT_SurrealPilot_QueuedRequests, GetTotalQueued());
+	SET_DWORD_STAT(STAT_SurrealPilot_InFlightRequests, TotalInFlight);
+}
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "SurrealPilotResponseCache.h"
+#include "SurrealPilotContextStore.h"
+#include "SurrealPilotJsonWriter.h"
+#include "Dom/JsonValue.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace SurrealPilotResponseCache
+{
+	/** Extension of the file each disk entry is kept in */
+	const TCHAR* const EntryExtension = TEXT(".json");
+
+	/** Keys are "sha1:<hex>"; files are named by the hex part */
+	const TCHAR* const KeyPrefix = TEXT("sha1:");
+
+	double ToWallClockSeconds(const FDateTime& Time)
+	{
+		return (Time - FDateTime(1970, 1, 1)).GetTotalSeconds();
+	}
+}
+
+FString FSurrealPilotResponseCache::GetDefaultDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("SurrealPilot") / TEXT("ResponseCache");
+}
+
+double FSurrealPilotResponseCache::GetWallClockSeconds()
+{
+	return SurrealPilotResponseCache::ToWallClockSeconds(FDateTime::UtcNow());
+}
+
+FString FSurrealPilotResponseCache::MakeKey(const FString& Provider, const TArray<TSharedPtr<FJsonObject>>& Messages, const FString& ContextHash)
+{
+	// Hashed through the canonical encoding, so the order fields were set in does not change the key
+	TArray<TSharedPtr<FJsonValue>> MessageValues;
+	MessageValues.Reserve(Messages.Num());
+	for (const TSharedPtr<FJsonObject>& Message : Messages)
+	{
+		MessageValues.Add(MakeShared<FJsonValueObject>(Message));
+	}
+
+	TSharedPtr<FJsonObject> Request = MakeShared<FJsonObject>();
+	Request->SetStringField(TEXT("provider"), Provider);
+	Request->SetArrayField(TEXT("messages"), MessageValues);
+	Request->SetStringField(TEXT("context"), ContextHash);
+	return FSurrealPilotContextBlob::Encode(Request, true)->Hash;
+}
+
+void FSurrealPilotResponseCache::Configure(int64 InMaxMemoryBytes, int64 InMaxDiskBytes, double InTtlSeconds, const FString& InDiskDirectory)
+{
+	MaxMemoryBytes = FMath::Max<int64>(0, InMaxMemoryBytes);
+	MaxDiskBytes = FMath::Max<int64>(0, InMaxDiskBytes);
+	TtlSeconds = InTtlSeconds;
+
+	if (DiskDirectory != InDiskDirectory)
+	{
+		DiskDirectory = InDiskDirectory;
+		DiskEntries.Reset();
+		DiskBytes = 0;
+		bDiskIndexLoaded = false;
+	}
+
+	while (MemoryBytes > MaxMemoryBytes && LruOrder.GetTail())
+	{
+		RemoveFromMemory(FString(LruOrder.GetTail()->GetValue()));
+		++Stats.Evictions;
+	}
+	if (bDiskIndexLoaded)
+	{
+		TrimDisk();
+	}
+}
+
+bool FSurrealPilotResponseCache::Find(const FString& Key, double Now, FSurrealPilotCachedResponse& OutResponse)
+{
+	++Stats.Lookups;
+	auto IsExpired = [this, Now](const FSurrealPilotCachedResponse& Response)
+	{
+		return TtlSeconds > 0.0 && Now - Response.CreatedSeconds > TtlSeconds;
+	};
+
+	if (FMemoryEntry* Entry = MemoryEntries.Find(Key))
+	{
+		if (IsExpired(Entry->Response))
+		{
+			++Stats.Expired;
+			RemoveFromMemory(Key);
+			RemoveFromDisk(Key);
+			return false;
+		}
+
+		LruOrder.RemoveNode(Entry->Node, false);
+		LruOrder.AddHead(Entry->Node);
+		if (FDiskEntry* DiskEntry = DiskEntries.Find(Key))
+		{
+			DiskEntry->LastUsedSeconds = Now;
+		}
+		OutResponse = Entry->Response;
+		++Stats.MemoryHits;
+		return true;
+	}
+
+	if (MaxDiskBytes <= 0 || DiskDirectory.IsEmpty())
+	{
+		return false;
+	}
+
+	LoadDiskIndex();
+	if (!DiskEntries.Contains(Key))
+	{
+		return false;
+	}
+
+	FSurrealPilotCachedResponse Response;
+	if (!LoadFromDisk(Key, Response))
+	{
+		RemoveFromDisk(Key);
+		return false;
+	}
+	if (IsExpired(Response))
+	{
+		++Stats.Expired;
+		RemoveFromDisk(Key);
+		return false;
+	}
+
+	DiskEntries[Key].LastUsedSeconds = Now;
+	AddToMemory(Key, Response);
+	OutResponse = MoveTemp(Response);
+	++Stats.DiskHits;
+	return true;
+}
+
+void FSurrealPilotResponseCache::Add(const FString& Key, const FSurrealPilotCachedResponse& Response)
+{
+	++Stats.Stores;
+	AddToMemory(Key, Response);
+
+	if (MaxDiskBytes <= 0 || DiskDirectory.IsEmpty())
+	{
+		return;
+	}
+	LoadDiskIndex();
+
+	FSurrealPilotJsonWriter Writer;
+	Writer.BeginObject();
+	Writer.WriteString(TEXT("key"), Key);
+	Writer.WriteNumber(TEXT("created"), Response.CreatedSeconds);
+	Writer.WriteNumber(TEXT("latency"), Response.LatencySeconds);
+	Writer.BeginArray(TEXT("chunks"));
+	for (const FString& Chunk : Response.Chunks)
+	{
+		Writer.WriteString(Chunk);
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+
+	IFileManager::Get().MakeDirectory(*DiskDirectory, true);
+	if (!FFileHelper::SaveArrayToFile(Writer.GetBuffer(), *GetEntryPath(Key)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: could not write response cache entry %s"), *GetEntryPath(Key));
+		return;
+	}
+
+	FDiskEntry& DiskEntry = DiskEntries.FindOrAdd(Key);
+	DiskBytes += Writer.GetBuffer().Num() - DiskEntry.Bytes;
+	DiskEntry.Bytes = Writer.GetBuffer().Num();
+	DiskEntry.LastUsedSeconds = Response.CreatedSeconds;
+	TrimDisk();
+}
+
+void FSurrealPilotResponseCache::Clear()
+{
+	MemoryEntries.Reset();
+	LruOrder.Empty();
+	MemoryBytes = 0;
+
+	if (!DiskDirectory.IsEmpty())
+	{
+		LoadDiskIndex();
+		for (const TPair<FString, FDiskEntry>& DiskEntry : DiskEntries)
+		{
+			IFileManager::Get().Delete(*GetEntryPath(DiskEntry.Key), false, false, true);
+		}
+	}
+	DiskEntries.Reset();
+	DiskBytes = 0;
+}
+
+void FSurrealPilotResponseCache::AddToMemory(const FString& Key, const FSurrealPilotCachedResponse& Response)
+{
+	RemoveFromMemory(Key);
+
+	// An answer bigger than the whole tier would only evict everything else and then itself
+	const int64 Bytes = GetResponseBytes(Response);
+	if (Bytes > MaxMemoryBytes)
+	{
+		return;
+	}
+
+	LruOrder.AddHead(Key);
+	FMemoryEntry& Entry = MemoryEntries.Add(Key);
+	Entry.Response = Response;
+	Entry.Bytes = Bytes;
+	Entry.Node = LruOrder.GetHead();
+	MemoryBytes += Bytes;
+
+	while (MemoryBytes > MaxMemoryBytes && LruOrder.GetTail())
+	{
+		RemoveFromMemory(FString(LruOrder.GetTail()->GetValue()));
+		++Stats.Evictions;
+	}
+}
+
+void FSurrealPilotResponseCache::RemoveFromMemory(const FString& Key)
+{
+	FMemoryEntry Entry;
+	if (MemoryEntries.RemoveAndCopyValue(Key, Entry))
+	{
+		MemoryBytes -= Entry.Bytes;
+		LruOrder.RemoveNode(Entry.Node);
+	}
+}
+
+bool FSurrealPilotResponseCache::LoadFromDisk(const FString& Key, FSurrealPilotCachedResponse& OutResponse)
+{
+	FString Contents;
+	TSharedPtr<FJsonObject> Root;
+	if (!FFileHelper::LoadFileToString(Contents, *GetEntryPath(Key)) ||
+		!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Contents), Root) || !Root.IsValid())
+	{
+		return false;
+	}
+
+	FString StoredKey;
+	const TArray<TSharedPtr<FJsonValue>>* Chunks = nullptr;
+	if (!Root->TryGetStringField(TEXT("key"), StoredKey) || StoredKey != Key || !Root->TryGetArrayField(TEXT("chunks"), Chunks))
+	{
+		return false;
+	}
+
+	Root->TryGetNumberField(TEXT("created"), OutResponse.CreatedSeconds);
+	Root->TryGetNumberField(TEXT("latency"), OutResponse.LatencySeconds);
+	OutResponse.Chunks.Reserve(Chunks->Num());
+	for (const TSharedPtr<FJsonValue>& Chunk : *Chunks)
+	{
+		OutResponse.Chunks.Add(Chunk->AsString());
+	}
+	return true;
+}
+
+void FSurrealPilotResponseCache::RemoveFromDisk(const FString& Key)
+{
+	FDiskEntry Entry;
+	if (DiskEntries.RemoveAndCopyValue(Key, Entry))
+	{
+		DiskBytes -= Entry.Bytes;
+		IFileManager::Get().Delete(*GetEntryPath(Key), false, false, true);
+	}
+}
+
+void FSurrealPilotResponseCache::TrimDisk()
+{
+	while (DiskBytes > MaxDiskBytes && DiskEntries.Num() > 0)
+	{
+		// Evictions are rare next to lookups, so a scan is cheaper than keeping the disk tier ordered
+		const FString* Oldest = nullptr;
+		double OldestUse = TNumericLimits<double>::Max();
+		for (const TPair<FString, FDiskEntry>& DiskEntry : DiskEntries)
+		{
+			if (DiskEntry.Value.LastUsedSeconds < OldestUse)
+			{
+				Oldest = &DiskEntry.Key;
+				OldestUse = DiskEntry.Value.LastUsedSeconds;
+			}
+		}
+		RemoveFromDisk(FString(*Oldest));
+		++Stats.Evictions;
+	}
+}
+
+void FSurrealPilotResponseCache::LoadDiskIndex()
+{
+	if (bDiskIndexLoaded)
+	{
+		return;
+	}
+	bDiskIndexLoaded = true;
+
+	// A file's modification time stands in for its last use until this session uses it
+	IFileManager::Get().IterateDirectoryStat(*DiskDirectory, [this](const TCHAR* Path, const FFileStatData& StatData)
+	{
+		const FString FilePath(Path);
+		if (!StatData.bIsDirectory && FilePath.EndsWith(SurrealPilotResponseCache::EntryExtension))
+		{
+			FDiskEntry& DiskEntry = DiskEntries.Add(SurrealPilotResponseCache::KeyPrefix + FPaths::GetBaseFilename(FilePath));
+			DiskEntry.Bytes = StatData.FileSize;
+			DiskEntry.LastUsedSeconds = SurrealPilotResponseCache::ToWallClockSeconds(StatData.ModificationTime);
+			DiskBytes += StatData.FileSize;
+		}
+		return true;
+	});
+	TrimDisk();
+}
+
+FString FSurrealPilotResponseCache::GetEntryPath(const FString& Key) const
+{
+	FString FileName = Key;
+	FileName.RemoveFromStart(SurrealPilotResponseCache::KeyPrefix);
+	return DiskDirectory / FileName + SurrealPilotResponseCache::EntryExtension;
+}
+
+int64 FSurrealPilotResponseCache::GetResponseBytes(const FSurrealPilotCachedResponse& Response)
+{
+	int64 Bytes = sizeof(FSurrealPilotCachedResponse);
+	for (const FString& Chunk : Response.Chunks)
+	{
+		Bytes += sizeof(FString) + Chunk.GetAllocatedSize();
+	}
+	return Bytes;
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "SurrealPilotResponseCache.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SurrealPilotResponseCacheTest
+{
+    TArray<TSharedPtr<FJsonObject>> MakeMessages(const FString& Question)
+    {
+        TSharedPtr<FJsonObject> Message = MakeShareable(new FJsonObject);
+        Message->SetStringField(TEXT("role"), TEXT("user"));
+        Message->SetStringField(TEXT("content"), Question);
+        return { Message };
+    }
+
+    /** An answer of a few chunks, recorded at CreatedSeconds */
+    FSurrealPilotCachedResponse MakeResponse(const FString& Text, double CreatedSeconds)
+    {
+        FSurrealPilotCachedResponse Response;
+        for (int32 Index = 0; Index < 4; ++Index)
+        {
+            Response.Chunks.Add(FString::Printf(TEXT("{\"content\":\"%s %d\"}"), *Text, Index));
+        }
+        Response.LatencySeconds = 2.5;
+        Response.CreatedSeconds = CreatedSeconds;
+        return Response;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotResponseCacheKeyTest, "SurrealPilot.ResponseCache.Key",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotResponseCacheKeyTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotResponseCacheTest;
+
+    // The same message built with its fields in another order
+    TSharedPtr<FJsonObject> Reordered = MakeShareable(new FJsonObject);
+    Reordered->SetStringField(TEXT("content"), TEXT("Explain this compile error"));
+    Reordered->SetStringField(TEXT("role"), TEXT("user"));
+
+    const FString Key = FSurrealPilotResponseCache::MakeKey(TEXT("openai"), MakeMessages(TEXT("Explain this compile error")), TEXT("sha1:abc"));
+    TestTrue("Key should be a content hash", Key.StartsWith(TEXT("sha1:")));
+    TestEqual("Field order should not change the key", FSurrealPilotResponseCache::MakeKey(TEXT("openai"), { Reordered }, TEXT("sha1:abc")), Key);
+    TestNotEqual("Another provider should change the key", FSurrealPilotResponseCache::MakeKey(TEXT("anthropic"), MakeMessages(TEXT("Explain this compile error")), TEXT("sha1:abc")), Key);
+    TestNotEqual("Another question should change the key", FSurrealPilotResponseCache::MakeKey(TEXT("openai"), MakeMessages(TEXT("Explain this warning")), TEXT("sha1:abc")), Key);
+    TestNotEqual("Another context should change the key", FSurrealPilotResponseCache::MakeKey(TEXT("openai"), MakeMessages(TEXT("Explain this compile error")), TEXT("sha1:def")), Key);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotResponseCacheMemoryTest, "SurrealPilot.ResponseCache.MemoryLruAndTtl",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotResponseCacheMemoryTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotResponseCacheTest;
+
+    // Measure one entry, then leave room for two
+    FSurrealPilotResponseCache Cache;
+    Cache.Configure(1024 * 1024, 0, 60.0, FString());
+    Cache.Add(TEXT("sha1:a"), MakeResponse(TEXT("A"), 1000.0));
+    const int64 EntryBytes = Cache.GetMemoryBytes();
+    Cache.Configure(EntryBytes * 2 + EntryBytes / 2, 0, 60.0, FString());
+
+    Cache.Add(TEXT("sha1:b"), MakeResponse(TEXT("B"), 1000.0));
+    FSurrealPilotCachedResponse Found;
+    TestTrue("A should be found", Cache.Find(TEXT("sha1:a"), 1010.0, Found));
+    TestEqual("A should replay its chunks", FString::Join(Found.Chunks, TEXT("|")), FString::Join(MakeResponse(TEXT("A"), 0.0).Chunks, TEXT("|")));
+
+    // A was used more recently than B, so B makes way for C
+    Cache.Add(TEXT("sha1:c"), MakeResponse(TEXT("C"), 1000.0));
+    TestEqual("The memory tier should hold two entries", Cache.GetMemoryEntryCount(), 2);
+    TestFalse("The least recently used entry should be evicted", Cache.Find(TEXT("sha1:b"), 1010.0, Found));
+    TestTrue("A recently used entry should survive", Cache.Find(TEXT("sha1:a"), 1010.0, Found));
+    TestEqual("Evictions", Cache.GetStats().Evictions, 1);
+
+    // Past the time to live an entry is a miss and is dropped
+    TestTrue("C should be fresh within its time to live", Cache.Find(TEXT("sha1:c"), 1059.0, Found));
+    TestFalse("C should expire after its time to live", Cache.Find(TEXT("sha1:c"), 1061.0, Found));
+    TestEqual("Expired", Cache.GetStats().Expired, 1);
+    TestEqual("Expired entries should be dropped", Cache.GetMemoryEntryCount(), 1);
+
+    const FSurrealPilotResponseCacheStats& Stats = Cache.GetStats();
+    TestEqual("Memory hits", Stats.MemoryHits, 3);
+    TestEqual("Lookups", Stats.Lookups, 5);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotResponseCacheDiskTest, "SurrealPilot.ResponseCache.DiskTier",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotResponseCacheDiskTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotResponseCacheTest;
+    const FString Directory = FPaths::ProjectSavedDir() / TEXT("Automation") / TEXT("SurrealPilot") / TEXT("ResponseCache");
+    IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+    const double Now = FSurrealPilotResponseCache::GetWallClockSeconds();
+    const FString KeyA = FSurrealPilotResponseCache::MakeKey(TEXT("openai"), MakeMessages(TEXT("A")), FString());
+    const FString KeyB = FSurrealPilotResponseCache::MakeKey(TEXT("openai"), MakeMessages(TEXT("B")), FString());
+    const FString KeyC = FSurrealPilotResponseCache::MakeKey(TEXT("openai"), MakeMessages(TEXT("C")), FString());
+
+    int64 EntryBytes = 0;
+    {
+        FSurrealPilotResponseCache Cache;
+        Cache.Configure(1024 * 1024, 1024 * 1024, 3600.0, Directory);
+        Cache.Add(KeyA, MakeResponse(TEXT("A"), Now));
+        EntryBytes = Cache.GetDiskBytes();
+        TestTrue("The answer should be written to disk", EntryBytes > 0 && Cache.GetDiskEntryCount() == 1);
+    }
+
+    // A new session starts with an empty memory tier and finds the answer on disk
+    {
+        FSurrealPilotResponseCache Cache;
+        Cache.Configure(1024 * 1024, 1024 * 1024, 3600.0, Directory);
+        FSurrealPilotCachedResponse Found;
+        if (TestTrue("The answer should survive a restart", Cache.Find(KeyA, Now + 1.0, Found)))
+        {
+            TestEqual("Chunks should come back in order", FString::Join(Found.Chunks, TEXT("|")), FString::Join(MakeResponse(TEXT("A"), Now).Chunks, TEXT("|")));
+            TestEqual("Latency should come back", Found.LatencySeconds, 2.5);
+        }
+        TestEqual("Disk hits", Cache.GetStats().DiskHits, 1);
+        TestTrue("A disk hit should be promoted to memory", Cache.Find(KeyA, Now + 2.0, Found) && Cache.GetStats().MemoryHits == 1);
+
+        // Room for two files: B goes when C arrives, since A was used since
+        Cache.Configure(1024 * 1024, EntryBytes * 2 + EntryBytes / 2, 3600.0, Directory);
+        Cache.Add(KeyB, MakeResponse(TEXT("B"), Now + 3.0));
+        Cache.Find(KeyA, Now + 4.0, Found);
+        Cache.Add(KeyC, MakeResponse(TEXT("C"), Now + 5.0));
+        TestEqual("The disk tier should hold two files", Cache.GetDiskEntryCount(), 2);
+        TestTrue("The disk tier should stay under its cap", Cache.GetDiskBytes() <= EntryBytes * 2 + EntryBytes / 2);
+    }
+
+    {
+        FSurrealPilotResponseCache Cache;
+        Cache.Configure(1024 * 1024, 1024 * 1024, 3600.0, Directory);
+        FSurrealPilotCachedResponse Found;
+        TestFalse("The evicted file should be gone", Cache.Find(KeyB, Now + 6.0, Found));
+        TestTrue("C should be on disk", Cache.Find(KeyC, Now + 6.0, Found));
+        TestFalse("Past the time to live a file is a miss", Cache.Find(KeyA, Now + 7200.0, Found));
+
+        Cache.Clear();
+        TestEqual("Clear should empty the disk tier", Cache.GetDiskEntryCount(), 0);
+    }
+
+    IFileManager::Get().DeleteDirectory(*Directory, false, true);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "SurrealPilotRetryPolicy.h"
+
+bool FSurrealPilotRetryPolicy::IsRetryable(const FHttpResponsePtr& Response, bool bWasSuccessful)
+{
+	// No status line at all: connection refused, reset or timed out
+	const int32 ResponseCode = Response.IsValid() ? Response->GetResponseCode() : 0;
+	if (ResponseCode == 0)
+	{
+		return true;
+	}
+
+	// A successful response that broke off mid-body may already have streamed chunks to the caller, so only error statuses qualify
+	return IsRetryableStatus(ResponseCode);
+}
+
+bool FSurrealPilotRetryPolicy::IsRetryableStatus(int32 ResponseCode)
+{
+	switch (ResponseCode)
+	{
+	case EHttpResponseCodes::RequestTimeout:
+	case EHttpResponseCodes::TooManyRequests:
+	case EHttpResponseCodes::BadGateway:
+	case EHttpResponseCodes::ServiceUnavail:
+	case EHttpResponseCodes::GatewayTimeout:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool FSurrealPilotRetryPolicy::GetRetryDelay(int32 RetryNumber, const FHttpResponsePtr& Response, FRandomStream& Random, double& OutDelaySeconds) const
+{
+	if (Response.IsValid())
+	{
+		const FString RetryAfter = Response->GetHeader(TEXT("Retry-After"));
+		double RetryAfterSeconds = 0.0;
+		if (!RetryAfter.IsEmpty() && ParseRetryAfter(RetryAfter, FDateTime::UtcNow(), RetryAfterSeconds))
+		{
+			// The server knows better than our backoff, but waiting minutes inside the editor helps nobody
+			if (RetryAfterSeconds > MaxDelaySeconds)
+			{
+				return false;
+			}
+			OutDelaySeconds = RetryAfterSeconds;
+			return true;
+		}
+	}
+
+	// Full jitter: uniform in [0, min(Max, Base * 2^(n-1))], which spreads out clients that failed together
+	const double Ceiling = FMath::Min(MaxDelaySeconds, BaseDelaySeconds * FMath::Pow(2.0, static_cast<double>(FMath::Max(RetryNumber - 1, 0))));
+	OutDelaySeconds = Random.GetFraction() * Ceiling;
+	return true;
+}
+
+bool FSurrealPilotRetryPolicy::ParseRetryAfter(const FString& HeaderValue, const FDateTime& UtcNow, double& OutSeconds)
+{
+	const FString Trimmed = HeaderValue.TrimStartAndEnd();
+
+	if (Trimmed.IsNumeric())
+	{
+		OutSeconds = FMath::Max(0.0, FCString::Atod(*Trimmed));
+		return true;
+	}
+
+	FDateTime RetryAt;
+	if (FDateTime::ParseHttpDate(Trimmed, RetryAt))
+	{
+		OutSeconds = FMath::Max(0.0, (RetryAt - UtcNow).GetTotalSeconds());
+		return true;
+	}
+
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "SurrealPilotRetryPolicy.h"
+#include "SurrealPilotCircuitBreaker.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotRetryPolicyTest, "SurrealPilot.Resilience.RetryPolicy",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotRetryPolicyTest::RunTest(const FString& Parameters)
+{
+    TestTrue("A request that got no response should be retryable", FSurrealPilotRetryPolicy::IsRetryable(nullptr, false));
+
+    const FDateTime Now(2024, 1, 1, 12, 0, 0);
+    double Seconds = -1.0;
+    TestTrue("Delay-seconds should parse", FSurrealPilotRetryPolicy::ParseRetryAfter(TEXT(" 7 "), Now, Seconds));
+    TestEqual("Delay-seconds value", Seconds, 7.0);
+    TestTrue("HTTP-date should parse", FSurrealPilotRetryPolicy::ParseRetryAfter(TEXT("Mon, 01 Jan 2024 12:00:30 GMT"), Now, Seconds));
+    TestEqual("HTTP-date should be relative to now", Seconds, 30.0);
+    TestTrue("A date in the past should parse", FSurrealPilotRetryPolicy::ParseRetryAfter(TEXT("Mon, 01 Jan 2024 11:00:00 GMT"), Now, Seconds));
+    TestEqual("A date in the past means retry now", Seconds, 0.0);
+    TestFalse("Garbage should not parse", FSurrealPilotRetryPolicy::ParseRetryAfter(TEXT("soon"), Now, Seconds));
+
+    // Full jitter: every delay falls within the doubling ceiling, capped at the maximum
+    FSurrealPilotRetryPolicy Policy;
+    Policy.BaseDelaySeconds = 0.5;
+    Policy.MaxDelaySeconds = 3.0;
+    FRandomStream Random(1234);
+    for (int32 RetryNumber = 1; RetryNumber <= 6; ++RetryNumber)
+    {
+        const double Ceiling = FMath::Min(Policy.MaxDelaySeconds, Policy.BaseDelaySeconds * FMath::Pow(2.0, RetryNumber - 1.0));
+        double Largest = 0.0;
+        for (int32 Sample = 0; Sample < 200; ++Sample)
+        {
+            double Delay = -1.0;
+            TestTrue("Backoff delay should always be available", Policy.GetRetryDelay(RetryNumber, nullptr, Random, Delay));
+            TestTrue(FString::Printf(TEXT("Retry %d delay should be within [0, %.2f]"), RetryNumber, Ceiling), Delay >= 0.0 && Delay <= Ceiling);
+            Largest = FMath::Max(Largest, Delay);
+        }
+        TestTrue(FString::Printf(TEXT("Retry %d delays should spread across the range"), RetryNumber), Largest > Ceiling * 0.5);
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotCircuitBreakerTest, "SurrealPilot.Resilience.CircuitBreaker",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotCircuitBreakerTest::RunTest(const FString& Parameters)
+{
+    const FString Desktop = TEXT("http://127.0.0.1:8000");
+    const FString Cloud = TEXT("https://api.surrealpilot.com");
+
+    FSurrealPilotCircuitBreaker Breaker(3, 10.0);
+    TestTrue("Unknown endpoints should be allowed", Breaker.AllowRequest(Desktop, 0.0));
+
+    Breaker.RecordFailure(Desktop, 1.0);
+    Breaker.RecordFailure(Desktop, 2.0);
+    TestEqual("Below the threshold the circuit stays closed", Breaker.GetState(Desktop), ESurrealPilotCircuitState::Closed);
+
+    // A success in between resets the count
+    Breaker.RecordSuccess(Desktop);
+    Breaker.RecordFailure(Desktop, 3.0);
+    Breaker.RecordFailure(Desktop, 4.0);
+    TestEqual("Failures must be consecutive to open the circuit", Breaker.GetState(Desktop), ESurrealPilotCircuitState::Closed);
+
+    Breaker.RecordFailure(Desktop, 5.0);
+    TestEqual("The threshold should open the circuit", Breaker.GetState(Desktop), ESurrealPilotCircuitState::Open);
+    TestFalse("An open circuit should fail fast", Breaker.AllowRequest(Desktop, 6.0));
+    TestTrue("Other endpoints are unaffected", Breaker.AllowRequest(Cloud, 6.0));
+
+    TestTrue("After the cooldown one probe should be allowed", Breaker.AllowRequest(Desktop, 15.0));
+    TestEqual("The probe should leave the circuit half-open", Breaker.GetState(Desktop), ESurrealPilotCircuitState::HalfOpen);
+    TestFalse("Only one probe at a time", Breaker.AllowRequest(Desktop, 15.0));
+
+    Breaker.RecordFailure(Desktop, 16.0);
+    TestEqual("A failed probe should re-open the circuit", Breaker.GetState(Desktop), ESurrealPilotCircuitState::Open);
+    TestFalse("The cooldown restarts from the failed probe", Breaker.AllowRequest(Desktop, 25.0));
+
+    TestTrue("The next probe should be allowed", Breaker.AllowRequest(Desktop, 26.0));
+    Breaker.RecordSuccess(Desktop);
+    TestEqual("A successful probe should close the circuit", Breaker.GetState(Desktop), ESurrealPilotCircuitState::Closed);
+    TestTrue("Requests should flow again", Breaker.AllowRequest(Desktop, 26.0));
+
+    // A probe that never gets an answer must not leave the circuit half-open for good
+    for (double Now = 30.0; Now < 33.0; Now += 1.0)
+    {
+        Breaker.RecordFailure(Desktop, Now);
+    }
+    TestTrue("A probe should be allowed after the cooldown", Breaker.AllowRequest(Desktop, 42.0));
+    Breaker.RecordAbandonedProbe(Desktop, 43.0);
+    TestEqual("An abandoned probe should re-open the circuit", Breaker.GetState(Desktop), ESurrealPilotCircuitState::Open);
+    TestFalse("The cooldown restarts from the abandoned probe", Breaker.AllowRequest(Desktop, 52.0));
+    TestTrue("Another probe should be allowed after it", Breaker.AllowRequest(Desktop, 53.0));
+    Breaker.RecordSuccess(Desktop);
+    Breaker.RecordAbandonedProbe(Desktop, 54.0);
+    TestEqual("An abandoned request leaves a closed circuit closed", Breaker.GetState(Desktop), ESurrealPilotCircuitState::Closed);
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
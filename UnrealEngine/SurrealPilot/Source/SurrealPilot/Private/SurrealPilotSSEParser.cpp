@@ -0,0 +1,240 @@
+#include "SurrealPilotSSEParser.h"
+
+namespace SurrealPilotSSE
+{
+	/** Compare a field name span against an ASCII literal */
+	template <int32 N>
+	FORCEINLINE bool FieldEquals(const uint8* Field, int32 FieldLength, const ANSICHAR (&Name)[N])
+	{
+		return FieldLength == N - 1 && FMemory::Memcmp(Field, Name, N - 1) == 0;
+	}
+
+	/** Index of the first occurrence of Byte in the span, or INDEX_NONE */
+	FORCEINLINE int32 FindByte(const uint8* Data, int32 Num, uint8 Byte)
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			if (Data[Index] == Byte)
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+}
+
+FSurrealPilotSSEParser::FSurrealPilotSSEParser()
+	: PendingRetryMilliseconds(INDEX_NONE)
+	, bHasData(false)
+	, bSkipLeadingLineFeed(false)
+	, bAtStreamStart(true)
+{
+}
+
+void FSurrealPilotSSEParser::Feed(const uint8* Data, int32 Num, TFunctionRef<void(const FSurrealPilotSSEEvent&)> OnEvent)
+{
+	int32 Cursor = 0;
+
+	// A CRLF pair split across two reads is still a single line terminator
+	if (bSkipLeadingLineFeed && Num > 0)
+	{
+		if (Data[0] == '\n')
+		{
+			Cursor = 1;
+		}
+		bSkipLeadingLineFeed = false;
+	}
+
+	int32 LineStart = Cursor;
+	while (Cursor < Num)
+	{
+		const uint8 Byte = Data[Cursor];
+		if (Byte != '\r' && Byte != '\n')
+		{
+			++Cursor;
+			continue;
+		}
+
+		// Lines that arrived in one piece are parsed in place; only lines spanning reads are copied
+		if (LineBuffer.Num() > 0)
+		{
+			LineBuffer.Append(Data + LineStart, Cursor - LineStart);
+			ProcessLine(LineBuffer.GetData(), LineBuffer.Num(), OnEvent);
+			LineBuffer.Reset();
+		}
+		else
+		{
+			ProcessLine(Data + LineStart, Cursor - LineStart, OnEvent);
+		}
+
+		++Cursor;
+		if (Byte == '\r')
+		{
+			if (Cursor < Num)
+			{
+				if (Data[Cursor] == '\n')
+				{
+					++Cursor;
+				}
+			}
+			else
+			{
+				bSkipLeadingLineFeed = true;
+			}
+		}
+		LineStart = Cursor;
+	}
+
+	if (LineStart < Num)
+	{
+		LineBuffer.Append(Data + LineStart, Num - LineStart);
+	}
+}
+
+void FSurrealPilotSSEParser::Finish(TFunctionRef<void(const FSurrealPilotSSEEvent&)> OnEvent)
+{
+	if (LineBuffer.Num() > 0)
+	{
+		ProcessLine(LineBuffer.GetData(), LineBuffer.Num(), OnEvent);
+		LineBuffer.Reset();
+	}
+
+	DispatchEvent(OnEvent);
+	bSkipLeadingLineFeed = false;
+}
+
+void FSurrealPilotSSEParser::Reset()
+{
+	LineBuffer.Reset();
+	DataBuffer.Reset();
+	EventTypeBuffer.Reset();
+	LastEventIdBuffer.Reset();
+	PendingRetryMilliseconds = INDEX_NONE;
+	bHasData = false;
+	bSkipLeadingLineFeed = false;
+	bAtStreamStart = true;
+}
+
+void FSurrealPilotSSEParser::ProcessLine(const uint8* Line, int32 Num, TFunctionRef<void(const FSurrealPilotSSEEvent&)> OnEvent)
+{
+	if (bAtStreamStart)
+	{
+		bAtStreamStart = false;
+		if (Num >= 3 && Line[0] == 0xEF && Line[1] == 0xBB && Line[2] == 0xBF)
+		{
+			Line += 3;
+			Num -= 3;
+		}
+	}
+
+	// A blank line terminates the current event
+	if (Num == 0)
+	{
+		DispatchEvent(OnEvent);
+		return;
+	}
+
+	// Comment lines (often used as keep-alives)
+	if (Line[0] == ':')
+	{
+		return;
+	}
+
+	int32 FieldLength = Num;
+	const uint8* Value = nullptr;
+	int32 ValueLength = 0;
+
+	const int32 ColonIndex = SurrealPilotSSE::FindByte(Line, Num, ':');
+	if (ColonIndex != INDEX_NONE)
+	{
+		FieldLength = ColonIndex;
+		Value = Line + ColonIndex + 1;
+		ValueLength = Num - FieldLength - 1;
+
+		// A single space after the colon is not part of the value
+		if (ValueLength > 0 && Value[0] == ' ')
+		{
+			++Value;
+			--ValueLength;
+		}
+	}
+
+	if (SurrealPilotSSE::FieldEquals(Line, FieldLength, "data"))
+	{
+		DataBuffer.Append(Value, ValueLength);
+		DataBuffer.Add('\n');
+		bHasData = true;
+	}
+	else if (SurrealPilotSSE::FieldEquals(Line, FieldLength, "event"))
+	{
+		EventTypeBuffer.Reset();
+		EventTypeBuffer.Append(Value, ValueLength);
+	}
+	else if (SurrealPilotSSE::FieldEquals(Line, FieldLength, "id"))
+	{
+		// IDs containing NUL are ignored by spec
+		if (SurrealPilotSSE::FindByte(Value, ValueLength, 0) == INDEX_NONE)
+		{
+			LastEventIdBuffer.Reset();
+			LastEventIdBuffer.Append(Value, ValueLength);
+		}
+	}
+	else if (SurrealPilotSSE::FieldEquals(Line, FieldLength, "retry"))
+	{
+		int64 Retry = 0;
+		bool bValid = ValueLength > 0 && ValueLength <= 9;
+		for (int32 Index = 0; bValid && Index < ValueLength; ++Index)
+		{
+			bValid = Value[Index] >= '0' && Value[Index] <= '9';
+			Retry = Retry * 10 + (Value[Index] - '0');
+		}
+		if (bValid)
+		{
+			PendingRetryMilliseconds = static_cast<int32>(Retry);
+		}
+	}
+	// Unknown fields are ignored
+}
+
+void FSurrealPilotSSEParser::DispatchEvent(TFunctionRef<void(const FSurrealPilotSSEEvent&)> OnEvent)
+{
+	if (!bHasData)
+	{
+		EventTypeBuffer.Reset();
+		return;
+	}
+
+	FSurrealPilotSSEEvent Event;
+	Event.Event = EventTypeBuffer.Num() > 0 ? Utf8ToString(EventTypeBuffer.GetData(), EventTypeBuffer.Num()) : FString(TEXT("message"));
+	Event.Id = Utf8ToString(LastEventIdBuffer.GetData(), LastEventIdBuffer.Num());
+	// Drop the line feed appended after the last data line
+	Event.Data = Utf8ToString(DataBuffer.GetData(), DataBuffer.Num() - 1);
+	Event.RetryMilliseconds = PendingRetryMilliseconds;
+
+	// Buffers keep their capacity so steady-state parsing does not reallocate
+	DataBuffer.Reset();
+	EventTypeBuffer.Reset();
+	PendingRetryMilliseconds = INDEX_NONE;
+	bHasData = false;
+
+	OnEvent(Event);
+}
+
+FString FSurrealPilotSSEParser::Utf8ToString(const uint8* Data, int32 Num)
+{
+	if (Num <= 0)
+	{
+		return FString();
+	}
+
+	const UTF8CHAR* Source = reinterpret_cast<const UTF8CHAR*>(Data);
+	const int32 Length = FPlatformString::ConvertedLength<TCHAR>(Source, Num);
+
+	FString Result;
+	TArray<TCHAR>& Chars = Result.GetCharArray();
+	Chars.SetNumUninitialized(Length + 1);
+	FPlatformString::Convert(Chars.GetData(), Length, Source, Num);
+	Chars[Length] = TEXT('\0');
+
+	return Result;
+}
\ No newline at end of file
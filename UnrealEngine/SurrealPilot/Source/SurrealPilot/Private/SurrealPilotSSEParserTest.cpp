@@ -0,0 +1,164 @@
+#include "SurrealPilotSSEParser.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SurrealPilotSSETest
+{
+    /** Feed the whole transcript in fixed-size reads and collect every event */
+    TArray<FSurrealPilotSSEEvent> ParseInSpans(const FString& Transcript, int32 SpanSize)
+    {
+        FTCHARToUTF8 Utf8(*Transcript);
+        const uint8* Bytes = reinterpret_cast<const uint8*>(Utf8.Get());
+
+        TArray<FSurrealPilotSSEEvent> Events;
+        FSurrealPilotSSEParser Parser;
+        for (int32 Offset = 0; Offset < Utf8.Length(); Offset += SpanSize)
+        {
+            Parser.Feed(Bytes + Offset, FMath::Min(SpanSize, Utf8.Length() - Offset), [&Events](const FSurrealPilotSSEEvent& Event)
+            {
+                Events.Add(Event);
+            });
+        }
+        Parser.Finish([&Events](const FSurrealPilotSSEEvent& Event)
+        {
+            Events.Add(Event);
+        });
+        return Events;
+    }
+
+    /** The line-splitting parser FHttpClient used before the incremental parser, kept for comparison */
+    TArray<FString> LegacyParseSSEData(const FString& ResponseData)
+    {
+        TArray<FString> Chunks;
+        TArray<FString> Lines;
+        ResponseData.ParseIntoArrayLines(Lines);
+
+        for (const FString& Line : Lines)
+        {
+            if (Line.StartsWith(TEXT("data: ")))
+            {
+                FString Data = Line.Mid(6);
+                if (!Data.IsEmpty() && Data != TEXT("[DONE]"))
+                {
+                    Chunks.Add(Data);
+                }
+            }
+        }
+
+        return Chunks;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotSSEParserTest, "SurrealPilot.SSEParser.Fields",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotSSEParserTest::RunTest(const FString& Parameters)
+{
+    const FString Transcript = TEXT(
+        ": keep-alive comment\r\n"
+        "retry: 1500\r\n"
+        "data: first\r\n"
+        "\r\n"
+        "event: delta\n"
+        "id: 42\n"
+        "data: line one\n"
+        "data:line two\n"
+        "\n"
+        "data: {\"content\":\"café\"}\r"
+        "\r"
+        "data: unterminated");
+
+    // Every split point must produce the same events, including a CRLF split across reads
+    for (int32 SpanSize = 1; SpanSize <= 16; ++SpanSize)
+    {
+        TArray<FSurrealPilotSSEEvent> Events = SurrealPilotSSETest::ParseInSpans(Transcript, SpanSize);
+        if (!TestEqual(FString::Printf(TEXT("Event count with %d-byte reads"), SpanSize), Events.Num(), 4))
+        {
+            continue;
+        }
+
+        TestEqual("First event data", Events[0].Data, TEXT("first"));
+        TestEqual("First event type defaults to message", Events[0].Event, TEXT("message"));
+        TestEqual("First event carries retry", Events[0].RetryMilliseconds, 1500);
+
+        TestEqual("Multi-line data is joined with a line feed", Events[1].Data, TEXT("line one\nline two"));
+        TestEqual("Event field is applied", Events[1].Event, TEXT("delta"));
+        TestEqual("Id field is applied", Events[1].Id, TEXT("42"));
+        TestEqual("Retry only applies to its own event", Events[1].RetryMilliseconds, (int32)INDEX_NONE);
+
+        TestEqual("UTF-8 payload is decoded", Events[2].Data, TEXT("{\"content\":\"café\"}"));
+        TestEqual("Last event id persists", Events[2].Id, TEXT("42"));
+        TestEqual("Event type resets after dispatch", Events[2].Event, TEXT("message"));
+
+        TestEqual("Trailing data is flushed on finish", Events[3].Data, TEXT("unterminated"));
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotSSEParserBenchmark, "SurrealPilot.SSEParser.Benchmark",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSurrealPilotSSEParserBenchmark::RunTest(const FString& Parameters)
+{
+    // Build a transcript shaped like a long streamed completion (~4 MB)
+    FString Transcript;
+    Transcript.Reserve(4 * 1024 * 1024);
+    int32 EventCount = 0;
+    while (Transcript.Len() < 4 * 1024 * 1024)
+    {
+        Transcript += FString::Printf(TEXT("data: {\"id\":\"chatcmpl-%d\",\"choices\":[{\"delta\":{\"content\":\"token %d of the Blueprint explanation\"}}]}\n\n"), EventCount, EventCount);
+        ++EventCount;
+    }
+    Transcript += TEXT("data: [DONE]\n\n");
+
+    FTCHARToUTF8 Utf8(*Transcript);
+    const uint8* Bytes = reinterpret_cast<const uint8*>(Utf8.Get());
+    const int32 NumBytes = Utf8.Length();
+    const int32 Iterations = 5;
+
+    // Legacy path: convert the whole body, split into lines, substring each data line
+    int32 LegacyChunks = 0;
+    const double LegacyStart = FPlatformTime::Seconds();
+    for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+    {
+        const FString Body(UTF8_TO_TCHAR(reinterpret_cast<const ANSICHAR*>(Bytes)));
+        LegacyChunks = SurrealPilotSSETest::LegacyParseSSEData(Body).Num();
+    }
+    const double LegacySeconds = (FPlatformTime::Seconds() - LegacyStart) / Iterations;
+
+    // Incremental path: feed 16 KB network-sized reads
+    int32 IncrementalChunks = 0;
+    const int32 SpanSize = 16 * 1024;
+    const double IncrementalStart = FPlatformTime::Seconds();
+    for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+    {
+        IncrementalChunks = 0;
+        FSurrealPilotSSEParser Parser;
+        auto CountEvent = [&IncrementalChunks](const FSurrealPilotSSEEvent& Event)
+        {
+            if (Event.Data != TEXT("[DONE]"))
+            {
+                ++IncrementalChunks;
+            }
+        };
+        for (int32 Offset = 0; Offset < NumBytes; Offset += SpanSize)
+        {
+            Parser.Feed(Bytes + Offset, FMath::Min(SpanSize, NumBytes - Offset), CountEvent);
+        }
+        Parser.Finish(CountEvent);
+    }
+    const double IncrementalSeconds = (FPlatformTime::Seconds() - IncrementalStart) / Iterations;
+
+    TestEqual("Both parsers should find the same number of events", IncrementalChunks, LegacyChunks);
+
+    const double Megabytes = NumBytes / (1024.0 * 1024.0);
+    AddInfo(FString::Printf(TEXT("SSE transcript: %.2f MB, %d events"), Megabytes, EventCount));
+    AddInfo(FString::Printf(TEXT("Legacy ParseSSEData: %.2f ms (%.1f MB/s)"), LegacySeconds * 1000.0, Megabytes / LegacySeconds));
+    AddInfo(FString::Printf(TEXT("FSurrealPilotSSEParser: %.2f ms (%.1f MB/s)"), IncrementalSeconds * 1000.0, Megabytes / IncrementalSeconds));
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -1,11 +1,7 @@
 #include "SurrealPilotSettings.h"
 #include "HttpClient.h"
-#include "Misc/FileHelper.h"
-#include "Misc/Paths.h"
+#include "SurrealPilotLocalConfig.h"
 #include "Dom/JsonObject.h"
-#include "Serialization/JsonSerializer.h"
-#include "Serialization/JsonWriter.h"
-#include "HAL/PlatformFilemanager.h"
 
 USurrealPilotSettings::USurrealPilotSettings()
 {
@@ -24,7 +20,10 @@ FText USurrealPilotSettings::GetSectionText() const
 
 FString USurrealPilotSettings::GetApiKey() const
 {
-	return ApiKey;
+	// The snapshot follows edits made to the config file while the editor is running; a config file without a key
+	// leaves the one in the settings in force
+	TSharedRef<const FSurrealPilotLocalConfigSnapshot> Config = FSurrealPilotLocalConfig::Get().GetSnapshot();
+	return Config->bLoaded && !Config->ApiKey.IsEmpty() ? Config->ApiKey : ApiKey;
 }
 
 void USurrealPilotSettings::SetApiKey(const FString& NewApiKey)
@@ -35,19 +34,30 @@ void USurrealPilotSettings::SetApiKey(const FString& NewApiKey)
 
 FString USurrealPilotSettings::GetEffectiveApiUrl() const
 {
-	// Try desktop first
-	FString DesktopUrl = FString::Printf(TEXT("http://127.0.0.1:%d"), DesktopApiPort);
+	// The HTTP client probes both endpoints and knows which one is healthy and fastest
+	if (FHttpClient::IsAvailable())
+	{
+		return FHttpClient::Get().GetApiBaseUrl();
+	}
 	
-	// TODO: Add actual connectivity test here
-	// For now, return desktop URL if port is valid, otherwise SaaS
+	// Before the module starts the client or after it shuts down, assume the desktop app when its port is valid
 	if (DesktopApiPort > 0 && DesktopApiPort <= 65535)
 	{
-		return DesktopUrl;
+		return FString::Printf(TEXT("http://127.0.0.1:%d"), DesktopApiPort);
 	}
-	
 	return SaaSApiUrl;
 }
 
+int32 USurrealPilotSettings::GetContextTokenBudget(const FString& Provider) const
+{
+	if (const int32* Budget = ContextTokenBudgets.Find(Provider.ToLower()))
+	{
+		return *Budget;
+	}
+	const int32* Default = ContextTokenBudgets.Find(TEXT("default"));
+	return Default ? *Default : 32000;
+}
+
 void USurrealPilotSettings::TestApiConnection()
 {
 	FHttpClient::Get().TestConnection(
@@ -64,69 +74,49 @@ void USurrealPilotSettings::TestApiConnection()
 
 void USurrealPilotSettings::LoadLocalConfig()
 {
-	FString ConfigPath = GetLocalConfigPath();
-	FString ConfigContent;
+	// Shares the cached snapshot the HTTP client uses, so this does not touch disk unless the file changed
+	TSharedRef<const FSurrealPilotLocalConfigSnapshot> Config = FSurrealPilotLocalConfig::Get().GetSnapshot();
+	if (!Config->bLoaded)
+	{
+		return;
+	}
 	
-	if (FFileHelper::LoadFileToString(ConfigContent, *ConfigPath))
+	// Load API key
+	if (Config->Json->HasField(TEXT("api_key")))
 	{
-		TSharedPtr<FJsonObject> ConfigJson;
-		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ConfigContent);
-		
-		if (FJsonSerializer::Deserialize(Reader, ConfigJson) && ConfigJson.IsValid())
-		{
-			// Load API key
-			FString LoadedApiKey;
-			if (ConfigJson->TryGetStringField(TEXT("api_key"), LoadedApiKey))
-			{
-				ApiKey = LoadedApiKey;
-			}
-			
-			// Load preferred provider
-			FString ProviderString;
-			if (ConfigJson->TryGetStringField(TEXT("preferred_provider"), ProviderString))
-			{
-				if (ProviderString == TEXT("openai"))
-				{
-					PreferredProvider = EAIProvider::OpenAI;
-				}
-				else if (ProviderString == TEXT("anthropic"))
-				{
-					PreferredProvider = EAIProvider::Anthropic;
-				}
-				else if (ProviderString == TEXT("gemini"))
-				{
-					PreferredProvider = EAIProvider::Gemini;
-				}
-				else if (ProviderString == TEXT("ollama"))
-				{
-					PreferredProvider = EAIProvider::Ollama;
-				}
-			}
-			
-			// Load port
-			int32 LoadedPort;
-			if (ConfigJson->TryGetNumberField(TEXT("port"), LoadedPort))
-			{
-				DesktopApiPort = LoadedPort;
-			}
-		}
+		ApiKey = Config->ApiKey;
 	}
-}
-
-void USurrealPilotSettings::SaveLocalConfig() const
-{
-	FString ConfigPath = GetLocalConfigPath();
 	
-	// Ensure directory exists
-	FString ConfigDir = FPaths::GetPath(ConfigPath);
-	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-	if (!PlatformFile.DirectoryExists(*ConfigDir))
+	// Load preferred provider
+	const FString& ProviderString = Config->PreferredProvider;
+	if (ProviderString == TEXT("openai"))
 	{
-		PlatformFile.CreateDirectoryTree(*ConfigDir);
+		PreferredProvider = EAIProvider::OpenAI;
+	}
+	else if (ProviderString == TEXT("anthropic"))
+	{
+		PreferredProvider = EAIProvider::Anthropic;
+	}
+	else if (ProviderString == TEXT("gemini"))
+	{
+		PreferredProvider = EAIProvider::Gemini;
+	}
+	else if (ProviderString == TEXT("ollama"))
+	{
+		PreferredProvider = EAIProvider::Ollama;
 	}
 	
+	// Load port
+	if (Config->Port > 0)
+	{
+		DesktopApiPort = Config->Port;
+	}
+}
+
+void USurrealPilotSettings::SaveLocalConfig() const
+{
 	// Create JSON object
-	TSharedPtr<FJsonObject> ConfigJson = MakeShareable(new FJsonObject);
+	TSharedRef<FJsonObject> ConfigJson = MakeShared<FJsonObject>();
 	ConfigJson->SetStringField(TEXT("api_key"), ApiKey);
 	ConfigJson->SetNumberField(TEXT("port"), DesktopApiPort);
 	
@@ -149,22 +139,11 @@ void USurrealPilotSettings::SaveLocalConfig() const
 	}
 	ConfigJson->SetStringField(TEXT("preferred_provider"), ProviderString);
 	
-	// Serialize to string
-	FString ConfigContent;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ConfigContent);
-	FJsonSerializer::Serialize(ConfigJson.ToSharedRef(), Writer);
-	
-	// Save to file
-	FFileHelper::SaveStringToFile(ConfigContent, *ConfigPath);
+	// Save to file and refresh the shared snapshot
+	FSurrealPilotLocalConfig::Get().Save(ConfigJson);
 }
 
 FString USurrealPilotSettings::GetLocalConfigPath() const
 {
-	FString UserProfile = FPlatformMisc::GetEnvironmentVariable(TEXT("USERPROFILE"));
-	if (UserProfile.IsEmpty())
-	{
-		UserProfile = FPlatformMisc::GetEnvironmentVariable(TEXT("HOME"));
-	}
-	
-	return FPaths::Combine(UserProfile, TEXT(".surrealpilot"), TEXT("config.json"));
+	return FSurrealPilotLocalConfig::Get().GetConfigPath();
 }
\ No newline at end of file
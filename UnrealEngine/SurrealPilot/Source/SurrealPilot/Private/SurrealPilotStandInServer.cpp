@@ -0,0 +1,1101 @@
+#include "SurrealPilotStandInServer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "SurrealPilotCompression.h"
+#include "SurrealPilotCompactBinary.h"
+#include "SurrealPilotContextStore.h"
+#include "SurrealPilotContextDelta.h"
+#include "Async/Async.h"
+#include "Common/TcpListener.h"
+#include "Common/TcpSocketBuilder.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Base64.h"
+#include "Misc/SecureHash.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace SurrealPilotStandInServer
+{
+	/** Appended to Sec-WebSocket-Key before hashing it into Sec-WebSocket-Accept (RFC 6455) */
+	const TCHAR* const WebSocketGuid = TEXT("258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+
+	/** Frame opcodes */
+	constexpr uint8 OpContinuation = 0x0;
+	constexpr uint8 OpText = 0x1;
+	constexpr uint8 OpClose = 0x8;
+	constexpr uint8 OpPing = 0x9;
+	constexpr uint8 OpPong = 0xA;
+
+	/** Larger client frames are treated as a broken connection */
+	constexpr uint64 MaxFrameBytes = 64 * 1024 * 1024;
+
+	bool RecvAll(FSocket* Socket, uint8* Data, int32 Num)
+	{
+		int32 Received = 0;
+		while (Received < Num)
+		{
+			if (!Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(5)))
+			{
+				return false;
+			}
+
+			int32 BytesRead = 0;
+			if (!Socket->Recv(Data + Received, Num - Received, BytesRead) || BytesRead <= 0)
+			{
+				return false;
+			}
+			Received += BytesRead;
+		}
+		return true;
+	}
+
+	TSharedPtr<FJsonObject> ParseObject(const FString& Json)
+	{
+		TSharedPtr<FJsonObject> Object;
+		return FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Object) ? Object : nullptr;
+	}
+
+	/** "Name: value\r\n" lines as a JSON object */
+	TSharedRef<FJsonObject> HeadersToJson(const FString& Headers)
+	{
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		TArray<FString> Lines;
+		Headers.ParseIntoArrayLines(Lines);
+		for (const FString& Line : Lines)
+		{
+			FString Name;
+			FString Value;
+			if (Line.Split(TEXT(":"), &Name, &Value))
+			{
+				Object->SetStringField(Name.TrimStartAndEnd(), Value.TrimStartAndEnd());
+			}
+		}
+		return Object;
+	}
+}
+
+FSurrealPilotStandInServer::FSurrealPilotStandInServer()
+	: BoundPort(0)
+	, ChatEventDelaySeconds(0.0f)
+	, ChatFirstEventDelaySeconds(0.0f)
+	, ChatChunkBytes(0)
+	, ContextResponseDelaySeconds(0.0f)
+	, HealthResponseDelaySeconds(0.0f)
+	, PeakContextRequests(0)
+	, ErrorRandom(0x5EED)
+	, bAcceptsCompressedBodies(true)
+	, bAcceptsCompactBinary(true)
+	, bStoresContextBlobs(true)
+	, bKeepsAssetVersions(true)
+	, bAcceptsWebSockets(true)
+{
+}
+
+FSurrealPilotStandInServer::~FSurrealPilotStandInServer()
+{
+	Stop();
+}
+
+bool FSurrealPilotStandInServer::Start(int32 Port)
+{
+	if (Listener.IsValid())
+	{
+		return true;
+	}
+
+	bStopping = false;
+
+	FSocket* ListenSocket = FTcpSocketBuilder(TEXT("SurrealPilotStandInServer"))
+		.AsReusable()
+		.BoundToEndpoint(FIPv4Endpoint(FIPv4Address::InternalLoopback, Port))
+		.Listening(64);
+
+	if (!ListenSocket)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SurrealPilot stand-in server failed to bind port %d"), Port);
+		return false;
+	}
+
+	BoundPort = ListenSocket->GetPortNo();
+
+	// The listener takes ownership of the socket and destroys it on shutdown
+	Listener = MakeUnique<FTcpListener>(*ListenSocket, FTimespan::FromMilliseconds(1));
+	Listener->OnConnectionAccepted().BindRaw(this, &FSurrealPilotStandInServer::HandleConnectionAccepted);
+
+	UE_LOG(LogTemp, Log, TEXT("SurrealPilot stand-in server listening on %s"), *GetBaseUrl());
+	return true;
+}
+
+void FSurrealPilotStandInServer::Stop()
+{
+	if (!Listener.IsValid())
+	{
+		return;
+	}
+
+	bStopping = true;
+	Listener.Reset();
+
+	// Connection threads reference this object, so wait for them to drain
+	while (ActiveConnections.GetValue() > 0)
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("SurrealPilot stand-in server stopped"));
+}
+
+FString FSurrealPilotStandInServer::GetBaseUrl() const
+{
+	return FString::Printf(TEXT("http://127.0.0.1:%d"), BoundPort);
+}
+
+void FSurrealPilotStandInServer::SetChatEvents(const TArray<FString>& Events, float DelayBetweenEventsSeconds)
+{
+	FScopeLock Lock(&ScriptLock);
+	ChatEvents = Events;
+	ChatEventDelaySeconds = DelayBetweenEventsSeconds;
+}
+
+void FSurrealPilotStandInServer::SetChatFirstEventDelay(float DelaySeconds)
+{
+	FScopeLock Lock(&ScriptLock);
+	ChatFirstEventDelaySeconds = DelaySeconds;
+}
+
+void FSurrealPilotStandInServer::SetChatChunkBytes(int32 ChunkBytes)
+{
+	FScopeLock Lock(&ScriptLock);
+	ChatChunkBytes = FMath::Max(0, ChunkBytes);
+}
+
+TArray<uint8> FSurrealPilotStandInServer::GetLastRequestBody() const
+{
+	FScopeLock Lock(&LastRequestLock);
+	return LastRequestBody;
+}
+
+FString FSurrealPilotStandInServer::GetLastContentEncoding() const
+{
+	FScopeLock Lock(&LastRequestLock);
+	return LastContentEncoding;
+}
+
+FString FSurrealPilotStandInServer::GetLastContentType() const
+{
+	FScopeLock Lock(&LastRequestLock);
+	return LastContentType;
+}
+
+void FSurrealPilotStandInServer::SetContextResponseDelay(float DelaySeconds)
+{
+	FScopeLock Lock(&ScriptLock);
+	ContextResponseDelaySeconds = DelaySeconds;
+}
+
+void FSurrealPilotStandInServer::SetContextResponseBody(const FString& Body)
+{
+	FScopeLock Lock(&ScriptLock);
+	ContextResponseBody = Body;
+}
+
+void FSurrealPilotStandInServer::SetHealthResponseDelay(float DelaySeconds)
+{
+	FScopeLock Lock(&ScriptLock);
+	HealthResponseDelaySeconds = DelaySeconds;
+}
+
+void FSurrealPilotStandInServer::SetScriptedFailures(const FString& Path, const TArray<int32>& StatusCodes, const FString& RetryAfter)
+{
+	FScopeLock Lock(&ScriptLock);
+	FFailureScript& Script = FailureScripts.FindOrAdd(Path);
+	Script.StatusCodes = StatusCodes;
+	Script.RetryAfter = RetryAfter;
+}
+
+void FSurrealPilotStandInServer::SetErrorRate(const FString& Path, float Probability, int32 StatusCode)
+{
+	FScopeLock Lock(&ScriptLock);
+	FErrorRate& Rate = ErrorRates.FindOrAdd(Path);
+	Rate.Probability = FMath::Clamp(Probability, 0.0f, 1.0f);
+	Rate.StatusCode = StatusCode;
+}
+
+bool FSurrealPilotStandInServer::TakeScriptedFailure(const FString& Path, int32& OutStatusCode, FString& OutRetryAfter)
+{
+	FScopeLock Lock(&ScriptLock);
+	FFailureScript* Script = FailureScripts.Find(Path);
+	if (Script && Script->StatusCodes.Num() > 0)
+	{
+		OutStatusCode = Script->StatusCodes[0];
+		OutRetryAfter = Script->RetryAfter;
+		Script->StatusCodes.RemoveAt(0);
+		return true;
+	}
+
+	const FErrorRate* Rate = ErrorRates.Find(Path);
+	if (Rate && Rate->Probability > 0.0f && ErrorRandom.GetFraction() < Rate->Probability)
+	{
+		OutStatusCode = Rate->StatusCode;
+		OutRetryAfter.Reset();
+		return true;
+	}
+
+	return false;
+}
+
+void FSurrealPilotStandInServer::ForgetContextBlobs()
+{
+	FScopeLock Lock(&BlobLock);
+	StoredContextBlobs.Reset();
+}
+
+void FSurrealPilotStandInServer::ForgetAssetVersions()
+{
+	FScopeLock Lock(&BlobLock);
+	AssetVersions.Reset();
+}
+
+TSharedPtr<FJsonObject> FSurrealPilotStandInServer::GetAssetContext(const FString& AssetPath) const
+{
+	FScopeLock Lock(&BlobLock);
+	const FAssetVersion* Version = AssetVersions.Find(AssetPath);
+	return Version ? Version->Context : nullptr;
+}
+
+bool FSurrealPilotStandInServer::ResolveContextBlobs(const TSharedPtr<FJsonObject>& Root, FString& OutStoredHeader)
+{
+	// Context fields live at the top level, or in each item of a batch
+	TArray<TSharedPtr<FJsonObject>> Containers;
+	Containers.Add(Root);
+	const TArray<TSharedPtr<FJsonValue>>* Items = nullptr;
+	if (Root->TryGetArrayField(TEXT("items"), Items))
+	{
+		for (const TSharedPtr<FJsonValue>& Item : *Items)
+		{
+			if (Item.IsValid() && Item->Type == EJson::Object)
+			{
+				Containers.Add(Item->AsObject());
+			}
+		}
+	}
+
+	TArray<FString> Stored;
+	FScopeLock Lock(&BlobLock);
+	for (const TSharedPtr<FJsonObject>& Container : Containers)
+	{
+		for (const TCHAR* Field : { TEXT("context"), TEXT("data") })
+		{
+			FString Hash;
+			if (Container->TryGetStringField(FString(Field) + TEXT("_ref"), Hash) && !StoredContextBlobs.Contains(Hash))
+			{
+				return false;
+			}
+			if (bStoresContextBlobs && Container->TryGetStringField(FString(Field) + TEXT("_hash"), Hash))
+			{
+				const TSharedPtr<FJsonObject>* Object = nullptr;
+				Container->TryGetObjectField(Field, Object);
+				StoredContextBlobs.Add(Hash, Object ? *Object : nullptr);
+				Stored.AddUnique(Hash);
+			}
+		}
+	}
+
+	OutStoredHeader = FString::Join(Stored, TEXT(", "));
+	return true;
+}
+
+bool FSurrealPilotStandInServer::ResolveRequestContext(const FString& Path, const TSharedPtr<FJsonObject>& Root, FString& OutHeaders, FString& OutErrorBody)
+{
+	FString StoredHashes;
+	if (!ResolveContextBlobs(Root, StoredHashes))
+	{
+		OutErrorBody = TEXT("{\"error\":\"unknown_context_ref\"}");
+		return false;
+	}
+	if (!StoredHashes.IsEmpty())
+	{
+		OutHeaders += FString::Printf(TEXT("X-SurrealPilot-Context-Stored: %s\r\n"), *StoredHashes);
+	}
+
+	if (Path == TEXT("/api/context") && !ResolveAssetVersion(Root, OutHeaders))
+	{
+		OutErrorBody = TEXT("{\"error\":\"context_version_mismatch\"}");
+		return false;
+	}
+	return true;
+}
+
+FString FSurrealPilotStandInServer::BeginContextResponse()
+{
+	const int32 Active = ActiveContextRequests.Increment();
+	float Delay = 0.0f;
+	FString ResponseBody;
+	{
+		FScopeLock Lock(&ScriptLock);
+		PeakContextRequests = FMath::Max(PeakContextRequests, Active);
+		Delay = ContextResponseDelaySeconds;
+		ResponseBody = ContextResponseBody.IsEmpty() ? TEXT("{\"status\":\"received\"}") : ContextResponseBody;
+	}
+	if (Delay > 0.0f)
+	{
+		FPlatformProcess::Sleep(Delay);
+	}
+	return ResponseBody;
+}
+
+bool FSurrealPilotStandInServer::ResolveAssetVersion(const TSharedPtr<FJsonObject>& Root, FString& OutVersionHeader)
+{
+	FString AssetPath;
+	FString Version;
+	if (!bKeepsAssetVersions || !Root->TryGetStringField(TEXT("asset"), AssetPath) || !Root->TryGetStringField(TEXT("version"), Version))
+	{
+		return true;
+	}
+
+	FScopeLock Lock(&BlobLock);
+	TSharedPtr<FJsonObject> Context;
+	const TArray<TSharedPtr<FJsonValue>>* Patch = nullptr;
+	FString ContextRef;
+	if (Root->TryGetArrayField(TEXT("patch"), Patch))
+	{
+		FString BaseVersion;
+		Root->TryGetStringField(TEXT("base_version"), BaseVersion);
+		const FAssetVersion* Base = AssetVersions.Find(AssetPath);
+		if (!Base || Base->Hash != BaseVersion)
+		{
+			return false;
+		}
+		Context = FSurrealPilotContextDelta::Apply(Base->Context, *Patch);
+
+		// A real server would trust the client; checking the hash here catches deltas that do not rebuild the export
+		if (!Context.IsValid() || FSurrealPilotContextBlob::Encode(Context, true)->Hash != Version)
+		{
+			AssetVersions.Remove(AssetPath);
+			return false;
+		}
+	}
+	else if (Root->TryGetStringField(TEXT("data_ref"), ContextRef))
+	{
+		const TSharedPtr<FJsonObject>* Stored = StoredContextBlobs.Find(ContextRef);
+		Context = Stored ? *Stored : nullptr;
+	}
+	else
+	{
+		const TSharedPtr<FJsonObject>* Data = nullptr;
+		Context = Root->TryGetObjectField(TEXT("data"), Data) ? *Data : nullptr;
+	}
+
+	if (!Context.IsValid())
+	{
+		AssetVersions.Remove(AssetPath);
+		return false;
+	}
+
+	FAssetVersion& Kept = AssetVersions.FindOrAdd(AssetPath);
+	Kept.Hash = Version;
+	Kept.Context = Context;
+	OutVersionHeader += FString::Printf(TEXT("X-SurrealPilot-Context-Version: %s\r\n"), *Version);
+	return true;
+}
+
+int32 FSurrealPilotStandInServer::GetPeakConcurrentContextRequests() const
+{
+	FScopeLock Lock(&ScriptLock);
+	return PeakContextRequests;
+}
+
+bool FSurrealPilotStandInServer::HandleConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint)
+{
+	if (bStopping)
+	{
+		return false;
+	}
+
+	ActiveConnections.Increment();
+	Async(EAsyncExecution::Thread, [this, Socket]()
+	{
+		ServeConnection(Socket);
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		ActiveConnections.Decrement();
+	});
+
+	return true;
+}
+
+void FSurrealPilotStandInServer::ServeConnection(FSocket* Socket)
+{
+	Socket->SetNonBlocking(false);
+
+	FString Verb;
+	FString Path;
+	TMap<FString, FString> Headers;
+	TArray<uint8> Body;
+
+	if (!ReadRequest(Socket, Verb, Path, Headers, Body))
+	{
+		return;
+	}
+
+	// The handshake is not a request of its own; the requests sent over the channel are counted as they arrive
+	const FString* Upgrade = Headers.Find(TEXT("upgrade"));
+	if (bAcceptsWebSockets && Verb == TEXT("GET") && Path == TEXT("/api/ws") && Upgrade && Upgrade->Equals(TEXT("websocket"), ESearchCase::IgnoreCase))
+	{
+		ServeWebSocket(Socket, Headers);
+		Socket->Close();
+		return;
+	}
+
+	RequestCount.Increment();
+
+	int32 ScriptedStatus = 0;
+	FString RetryAfter;
+	if (TakeScriptedFailure(Path, ScriptedStatus, RetryAfter))
+	{
+		const FString ExtraHeaders = RetryAfter.IsEmpty() ? FString() : FString::Printf(TEXT("Retry-After: %s\r\n"), *RetryAfter);
+		SendResponse(Socket, ScriptedStatus, TEXT("application/json"), TEXT("{\"error\":\"scripted_failure\"}"), ExtraHeaders);
+		Socket->Close();
+		return;
+	}
+
+	const FString* ContentEncoding = Headers.Find(TEXT("content-encoding"));
+	if (ContentEncoding && !ContentEncoding->Equals(TEXT("identity"), ESearchCase::IgnoreCase))
+	{
+		TArray<uint8> Decoded;
+		if (!bAcceptsCompressedBodies || !FSurrealPilotCompression::Decompress(Body, *ContentEncoding, Decoded))
+		{
+			SendResponse(Socket, 415, TEXT("application/json"), TEXT("{\"error\":\"unsupported_content_encoding\"}"));
+			Socket->Close();
+			return;
+		}
+		Body = MoveTemp(Decoded);
+	}
+
+	const FString* ContentType = Headers.Find(TEXT("content-type"));
+	{
+		FScopeLock Lock(&LastRequestLock);
+		LastRequestBody = Body;
+		LastContentEncoding = ContentEncoding ? *ContentEncoding : FString();
+		LastContentType = ContentType ? *ContentType : FString();
+	}
+
+	// Served as the JSON it decodes to, like a server that reads both
+	if (ContentType && ContentType->StartsWith(FSurrealPilotCompactBinary::GetContentType(), ESearchCase::IgnoreCase))
+	{
+		FString DecodedJson;
+		if (!bAcceptsCompactBinary || !FSurrealPilotCompactBinary::ToJsonString(Body, DecodedJson, false))
+		{
+			SendResponse(Socket, 415, TEXT("application/json"), TEXT("{\"error\":\"unsupported_media_type\"}"));
+			Socket->Close();
+			return;
+		}
+		FTCHARToUTF8 Utf8(*DecodedJson);
+		Body = TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	FString ContextHeaders;
+	TSharedPtr<FJsonObject> Root;
+	const FString Json(Body.Num(), reinterpret_cast<const UTF8CHAR*>(Body.GetData()));
+	if (Verb == TEXT("POST") && (Path == TEXT("/api/chat") || Path == TEXT("/api/context")) &&
+		FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root) && Root.IsValid())
+	{
+		FString ErrorBody;
+		if (!ResolveRequestContext(Path, Root, ContextHeaders, ErrorBody))
+		{
+			SendResponse(Socket, 409, TEXT("application/json"), ErrorBody);
+			Socket->Close();
+			return;
+		}
+	}
+
+	if (Verb == TEXT("GET") && Path == TEXT("/api/health"))
+	{
+		float Delay = 0.0f;
+		{
+			FScopeLock Lock(&ScriptLock);
+			Delay = HealthResponseDelaySeconds;
+		}
+		if (Delay > 0.0f)
+		{
+			FPlatformProcess::Sleep(Delay);
+		}
+
+		SendResponse(Socket, 200, TEXT("application/json"), TEXT("{\"status\":\"ok\"}"));
+	}
+	else if (Verb == TEXT("POST") && Path == TEXT("/api/chat"))
+	{
+		SendChatStream(Socket, ContextHeaders);
+	}
+	else if (Verb == TEXT("POST") && Path == TEXT("/api/context"))
+	{
+		const FString ResponseBody = BeginContextResponse();
+		SendResponse(Socket, 200, TEXT("application/json"), ResponseBody, ContextHeaders);
+		ActiveContextRequests.Decrement();
+	}
+	else
+	{
+		SendResponse(Socket, 404, TEXT("application/json"), TEXT("{\"error\":\"not_found\"}"));
+	}
+
+	Socket->Close();
+}
+
+bool FSurrealPilotStandInServer::ReadRequest(FSocket* Socket, FString& OutVerb, FString& OutPath, TMap<FString, FString>& OutHeaders, TArray<uint8>& OutBody)
+{
+	TArray<uint8> Buffer;
+	int32 HeaderEnd = INDEX_NONE;
+	uint8 Chunk[4096];
+
+	// Read until the blank line that terminates the header block
+	while (HeaderEnd == INDEX_NONE)
+	{
+		if (!Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(5)))
+		{
+			return false;
+		}
+
+		int32 BytesRead = 0;
+		if (!Socket->Recv(Chunk, sizeof(Chunk), BytesRead) || BytesRead <= 0)
+		{
+			return false;
+		}
+		Buffer.Append(Chunk, BytesRead);
+
+		for (int32 Index = 3; Index < Buffer.Num(); ++Index)
+		{
+			if (Buffer[Index - 3] == '\r' && Buffer[Index - 2] == '\n' && Buffer[Index - 1] == '\r' && Buffer[Index] == '\n')
+			{
+				HeaderEnd = Index + 1;
+				break;
+			}
+		}
+	}
+
+	const FString HeaderBlock(HeaderEnd, reinterpret_cast<const ANSICHAR*>(Buffer.GetData()));
+	TArray<FString> Lines;
+	HeaderBlock.ParseIntoArrayLines(Lines);
+	if (Lines.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray<FString> RequestLine;
+	Lines[0].ParseIntoArrayWS(RequestLine);
+	if (RequestLine.Num() < 2)
+	{
+		return false;
+	}
+	OutVerb = RequestLine[0];
+	OutPath = RequestLine[1];
+
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		FString Key;
+		FString Value;
+		if (Lines[LineIndex].Split(TEXT(":"), &Key, &Value))
+		{
+			OutHeaders.Add(Key.TrimStartAndEnd().ToLower(), Value.TrimStartAndEnd());
+		}
+	}
+
+	const FString* ContentLengthHeader = OutHeaders.Find(TEXT("content-length"));
+	const int32 ContentLength = ContentLengthHeader ? FCString::Atoi(**ContentLengthHeader) : 0;
+
+	OutBody.Append(Buffer.GetData() + HeaderEnd, Buffer.Num() - HeaderEnd);
+	while (OutBody.Num() < ContentLength)
+	{
+		if (!Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(5)))
+		{
+			return false;
+		}
+
+		int32 BytesRead = 0;
+		if (!Socket->Recv(Chunk, sizeof(Chunk), BytesRead) || BytesRead <= 0)
+		{
+			return false;
+		}
+		OutBody.Append(Chunk, BytesRead);
+	}
+
+	return true;
+}
+
+bool FSurrealPilotStandInServer::SendAll(FSocket* Socket, const ANSICHAR* Data, int32 Num)
+{
+	int32 TotalSent = 0;
+	while (TotalSent < Num)
+	{
+		int32 BytesSent = 0;
+		if (!Socket->Send(reinterpret_cast<const uint8*>(Data) + TotalSent, Num - TotalSent, BytesSent))
+		{
+			return false;
+		}
+		TotalSent += BytesSent;
+	}
+	return true;
+}
+
+bool FSurrealPilotStandInServer::SendString(FSocket* Socket, const FString& Data)
+{
+	FTCHARToUTF8 Utf8(*Data);
+	return SendAll(Socket, Utf8.Get(), Utf8.Length());
+}
+
+void FSurrealPilotStandInServer::SendResponse(FSocket* Socket, int32 StatusCode, const FString& ContentType, const FString& Body, const FString& ExtraHeaders)
+{
+	FTCHARToUTF8 Utf8Body(*Body);
+	const FString Header = FString::Printf(
+		TEXT("HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %d\r\n%sConnection: close\r\n\r\n"),
+		StatusCode,
+		StatusCode == 200 ? TEXT("OK") : TEXT("Error"),
+		*ContentType,
+		Utf8Body.Length(),
+		*ExtraHeaders);
+
+	if (SendString(Socket, Header))
+	{
+		SendAll(Socket, Utf8Body.Get(), Utf8Body.Length());
+	}
+}
+
+void FSurrealPilotStandInServer::SendChatStream(FSocket* Socket, const FString& ExtraHeaders)
+{
+	TArray<FString> Events;
+	float Delay = 0.0f;
+	float FirstEventDelay = 0.0f;
+	int32 ChunkBytes = 0;
+	{
+		FScopeLock Lock(&ScriptLock);
+		Events = ChatEvents;
+		Delay = ChatEventDelaySeconds;
+		FirstEventDelay = ChatFirstEventDelaySeconds;
+		ChunkBytes = ChatChunkBytes;
+	}
+
+	// No Content-Length: the body runs until the connection closes, like a real SSE endpoint
+	if (!SendString(Socket, FString::Printf(TEXT("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n%sConnection: close\r\n\r\n"), *ExtraHeaders)))
+	{
+		return;
+	}
+
+	if (FirstEventDelay > 0.0f)
+	{
+		FPlatformProcess::Sleep(FirstEventDelay);
+	}
+
+	for (const FString& Event : Events)
+	{
+		FTCHARToUTF8 Utf8Event(*FString::Printf(TEXT("data: %s\n\n"), *Event));
+		const int32 PieceBytes = ChunkBytes > 0 ? ChunkBytes : Utf8Event.Length();
+		for (int32 Offset = 0; Offset < Utf8Event.Length(); Offset += PieceBytes)
+		{
+			if (bStopping || !SendAll(Socket, Utf8Event.Get() + Offset, FMath::Min(PieceBytes, Utf8Event.Length() - Offset)))
+			{
+				return;
+			}
+		}
+		EventsSent.Increment();
+
+		if (Delay > 0.0f)
+		{
+			FPlatformProcess::Sleep(Delay);
+		}
+	}
+
+	SendString(Socket, TEXT("data: [DONE]\n\n"));
+}
+
+int32 FSurrealPilotStandInServer::PushToChannels(const FString& Type, const TSharedRef<FJsonObject>& Body)
+{
+	TSharedRef<FJsonObject> Message = MakeShared<FJsonObject>();
+	Message->SetStringField(TEXT("op"), TEXT("push"));
+	Message->SetStringField(TEXT("type"), Type);
+	Message->SetObjectField(TEXT("body"), Body);
+
+	TArray<TSharedRef<FChannelConnection>> OpenChannels;
+	{
+		FScopeLock Lock(&ChannelLock);
+		OpenChannels = Channels;
+	}
+
+	int32 Sent = 0;
+	for (const TSharedRef<FChannelConnection>& Connection : OpenChannels)
+	{
+		Sent += SendChannelMessage(*Connection, Message) ? 1 : 0;
+	}
+	return Sent;
+}
+
+void FSurrealPilotStandInServer::CloseChannels()
+{
+	TArray<TSharedRef<FChannelConnection>> OpenChannels;
+	{
+		FScopeLock Lock(&ChannelLock);
+		OpenChannels = Channels;
+	}
+
+	// 1001 Going Away; the connection thread sees bOpen drop and closes the socket
+	const uint8 GoingAway[] = { 0x03, 0xE9 };
+	for (const TSharedRef<FChannelConnection>& Connection : OpenChannels)
+	{
+		SendFrame(*Connection, SurrealPilotStandInServer::OpClose, GoingAway, sizeof(GoingAway));
+		FScopeLock Lock(&Connection->Lock);
+		Connection->bOpen = false;
+	}
+}
+
+int32 FSurrealPilotStandInServer::GetOpenChannelCount() const
+{
+	FScopeLock Lock(&ChannelLock);
+	return Channels.Num();
+}
+
+void FSurrealPilotStandInServer::ServeWebSocket(FSocket* Socket, const TMap<FString, FString>& Headers)
+{
+	using namespace SurrealPilotStandInServer;
+
+	const FString* Key = Headers.Find(TEXT("sec-websocket-key"));
+	if (!Key)
+	{
+		SendResponse(Socket, 400, TEXT("application/json"), TEXT("{\"error\":\"missing_websocket_key\"}"));
+		return;
+	}
+
+	FTCHARToUTF8 KeyUtf8(*(*Key + WebSocketGuid));
+	uint8 Digest[FSHA1::DigestSize];
+	FSHA1::HashBuffer(KeyUtf8.Get(), KeyUtf8.Length(), Digest);
+
+	// Agree to the first subprotocol offered
+	FString ProtocolHeader;
+	if (const FString* Protocols = Headers.Find(TEXT("sec-websocket-protocol")))
+	{
+		FString Protocol;
+		if (!Protocols->Split(TEXT(","), &Protocol, nullptr))
+		{
+			Protocol = *Protocols;
+		}
+		ProtocolHeader = FString::Printf(TEXT("Sec-WebSocket-Protocol: %s\r\n"), *Protocol.TrimStartAndEnd());
+	}
+
+	if (!SendString(Socket, FString::Printf(TEXT("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n%s\r\n"),
+		*FBase64::Encode(Digest, FSHA1::DigestSize), *ProtocolHeader)))
+	{
+		return;
+	}
+
+	TSharedRef<FChannelConnection> Connection = MakeShared<FChannelConnection>();
+	Connection->Socket = Socket;
+	{
+		FScopeLock Lock(&ChannelLock);
+		Channels.Add(Connection);
+	}
+
+	TArray<uint8> Message;
+	while (!bStopping)
+	{
+		{
+			FScopeLock Lock(&Connection->Lock);
+			if (!Connection->bOpen)
+			{
+				break;
+			}
+		}
+
+		// Poll so that Stop and CloseChannels are noticed between frames
+		if (!Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromMilliseconds(20)))
+		{
+			continue;
+		}
+
+		uint8 Opcode = 0;
+		bool bFinal = false;
+		TArray<uint8> Payload;
+		if (!ReadFrame(Socket, Opcode, bFinal, Payload))
+		{
+			break;
+		}
+
+		if (Opcode == OpClose)
+		{
+			SendFrame(*Connection, OpClose, Payload.GetData(), FMath::Min(Payload.Num(), 2));
+			break;
+		}
+		if (Opcode == OpPing)
+		{
+			SendFrame(*Connection, OpPong, Payload.GetData(), Payload.Num());
+			continue;
+		}
+		if (Opcode != OpText && Opcode != OpContinuation)
+		{
+			continue;
+		}
+
+		Message.Append(Payload);
+		if (bFinal)
+		{
+			HandleChannelMessage(Connection, FString(Message.Num(), reinterpret_cast<const UTF8CHAR*>(Message.GetData())));
+			Message.Reset();
+		}
+	}
+
+	{
+		FScopeLock Lock(&Connection->Lock);
+		Connection->bOpen = false;
+	}
+	{
+		FScopeLock Lock(&ChannelLock);
+		Channels.Remove(Connection);
+	}
+
+	// Requests still being served write to this socket, which is destroyed once this returns
+	while (Connection->ActiveRequests.GetValue() > 0)
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+}
+
+bool FSurrealPilotStandInServer::ReadFrame(FSocket* Socket, uint8& OutOpcode, bool& bOutFinal, TArray<uint8>& OutPayload)
+{
+	using namespace SurrealPilotStandInServer;
+
+	uint8 Header[2];
+	if (!RecvAll(Socket, Header, 2))
+	{
+		return false;
+	}
+	bOutFinal = (Header[0] & 0x80) != 0;
+	OutOpcode = Header[0] & 0x0F;
+	const bool bMasked = (Header[1] & 0x80) != 0;
+
+	uint64 Length = Header[1] & 0x7F;
+	if (Length >= 126)
+	{
+		const int32 ExtendedBytes = Length == 126 ? 2 : 8;
+		uint8 Extended[8];
+		if (!RecvAll(Socket, Extended, ExtendedBytes))
+		{
+			return false;
+		}
+		Length = 0;
+		for (int32 Index = 0; Index < ExtendedBytes; ++Index)
+		{
+			Length = (Length << 8) | Extended[Index];
+		}
+	}
+	if (Length > MaxFrameBytes)
+	{
+		return false;
+	}
+
+	uint8 Mask[4] = { 0, 0, 0, 0 };
+	if (bMasked && !RecvAll(Socket, Mask, 4))
+	{
+		return false;
+	}
+
+	OutPayload.SetNumUninitialized(static_cast<int32>(Length));
+	if (Length > 0 && !RecvAll(Socket, OutPayload.GetData(), OutPayload.Num()))
+	{
+		return false;
+	}
+	for (int32 Index = 0; Index < OutPayload.Num(); ++Index)
+	{
+		OutPayload[Index] ^= Mask[Index % 4];
+	}
+	return true;
+}
+
+bool FSurrealPilotStandInServer::SendFrame(FChannelConnection& Connection, uint8 Opcode, const uint8* Data, int32 Num)
+{
+	TArray<uint8> Frame;
+	Frame.Reserve(Num + 10);
+	Frame.Add(0x80 | Opcode);
+	if (Num < 126)
+	{
+		Frame.Add(static_cast<uint8>(Num));
+	}
+	else if (Num < 65536)
+	{
+		Frame.Add(126);
+		Frame.Add(static_cast<uint8>(Num >> 8));
+		Frame.Add(static_cast<uint8>(Num));
+	}
+	else
+	{
+		Frame.Add(127);
+		for (int32 Shift = 56; Shift >= 0; Shift -= 8)
+		{
+			Frame.Add(static_cast<uint8>(static_cast<uint64>(Num) >> Shift));
+		}
+	}
+	Frame.Append(Data, Num);
+
+	FScopeLock Lock(&Connection.Lock);
+	return Connection.bOpen && SendAll(Connection.Socket, reinterpret_cast<const ANSICHAR*>(Frame.GetData()), Frame.Num());
+}
+
+bool FSurrealPilotStandInServer::SendChannelMessage(FChannelConnection& Connection, const TSharedRef<FJsonObject>& Message)
+{
+	FString Json;
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
+	FJsonSerializer::Serialize(Message, Writer);
+
+	FTCHARToUTF8 Utf8(*Json);
+	return SendFrame(Connection, SurrealPilotStandInServer::OpText, reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+}
+
+void FSurrealPilotStandInServer::HandleChannelMessage(const TSharedRef<FChannelConnection>& Connection, const FString& Message)
+{
+	TSharedPtr<FJsonObject> Root = SurrealPilotStandInServer::ParseObject(Message);
+	int32 RequestId = INDEX_NONE;
+	FString Op;
+	if (!Root.IsValid() || !Root->TryGetNumberField(TEXT("id"), RequestId) || !Root->TryGetStringField(TEXT("op"), Op))
+	{
+		return;
+	}
+
+	if (Op == TEXT("cancel"))
+	{
+		FScopeLock Lock(&Connection->Lock);
+		Connection->Cancelled.Add(RequestId);
+		return;
+	}
+
+	FString Path;
+	Root->TryGetStringField(TEXT("path"), Path);
+	const TSharedPtr<FJsonObject>* Body = nullptr;
+	TSharedPtr<FJsonObject> RequestBody = Root->TryGetObjectField(TEXT("body"), Body) ? *Body : nullptr;
+
+	RequestCount.Increment();
+	ChannelRequestCount.Increment();
+
+	// Served on their own threads so a slow chat does not hold up the requests multiplexed behind it
+	Connection->ActiveRequests.Increment();
+	ActiveConnections.Increment();
+	Async(EAsyncExecution::Thread, [this, Connection, RequestId, Path, RequestBody]()
+	{
+		ServeChannelRequest(Connection, RequestId, Path, RequestBody);
+		Connection->ActiveRequests.Decrement();
+		ActiveConnections.Decrement();
+	});
+}
+
+void FSurrealPilotStandInServer::ServeChannelRequest(const TSharedRef<FChannelConnection>& Connection, int32 RequestId, const FString& Path, const TSharedPtr<FJsonObject>& Body)
+{
+	using namespace SurrealPilotStandInServer;
+
+	auto Respond = [this, &Connection, RequestId](int32 Status, const FString& ResponseBody, const FString& ResponseHeaders)
+	{
+		TSharedRef<FJsonObject> Message = MakeShared<FJsonObject>();
+		Message->SetNumberField(TEXT("id"), RequestId);
+		Message->SetStringField(TEXT("op"), TEXT("response"));
+		Message->SetNumberField(TEXT("status"), Status);
+		Message->SetObjectField(TEXT("headers"), HeadersToJson(ResponseHeaders));
+		if (TSharedPtr<FJsonObject> ResponseObject = ParseObject(ResponseBody))
+		{
+			Message->SetObjectField(TEXT("body"), ResponseObject);
+		}
+		SendChannelMessage(*Connection, Message);
+	};
+
+	int32 ScriptedStatus = 0;
+	FString RetryAfter;
+	if (TakeScriptedFailure(Path, ScriptedStatus, RetryAfter))
+	{
+		Respond(ScriptedStatus, TEXT("{\"error\":\"scripted_failure\"}"), RetryAfter.IsEmpty() ? FString() : FString::Printf(TEXT("Retry-After: %s\r\n"), *RetryAfter));
+		return;
+	}
+
+	if (!Body.IsValid())
+	{
+		Respond(400, TEXT("{\"error\":\"missing_body\"}"), FString());
+		return;
+	}
+
+	{
+		FString Json;
+		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
+		FJsonSerializer::Serialize(Body.ToSharedRef(), Writer);
+		FTCHARToUTF8 Utf8(*Json);
+
+		FScopeLock Lock(&LastRequestLock);
+		LastRequestBody = TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+		LastContentEncoding.Reset();
+		LastContentType = TEXT("application/json");
+	}
+
+	FString ContextHeaders;
+	if (Path == TEXT("/api/chat") || Path == TEXT("/api/context"))
+	{
+		FString ErrorBody;
+		if (!ResolveRequestContext(Path, Body, ContextHeaders, ErrorBody))
+		{
+			Respond(409, ErrorBody, FString());
+			return;
+		}
+	}
+
+	if (Path == TEXT("/api/chat"))
+	{
+		TArray<FString> Events;
+		float Delay = 0.0f;
+		float FirstEventDelay = 0.0f;
+		{
+			FScopeLock Lock(&ScriptLock);
+			Events = ChatEvents;
+			Delay = ChatEventDelaySeconds;
+			FirstEventDelay = ChatFirstEventDelaySeconds;
+		}
+
+		if (FirstEventDelay > 0.0f)
+		{
+			FPlatformProcess::Sleep(FirstEventDelay);
+		}
+
+		for (const FString& Event : Events)
+		{
+			{
+				FScopeLock Lock(&Connection->Lock);
+				if (bStopping || !Connection->bOpen || Connection->Cancelled.Contains(RequestId))
+				{
+					return;
+				}
+			}
+
+			TSharedRef<FJsonObject> Message = MakeShared<FJsonObject>();
+			Message->SetNumberField(TEXT("id"), RequestId);
+			Message->SetStringField(TEXT("op"), TEXT("event"));
+			Message->SetStringField(TEXT("data"), Event);
+			if (!SendChannelMessage(*Connection, Message))
+			{
+				return;
+			}
+			EventsSent.Increment();
+
+			if (Delay > 0.0f)
+			{
+				FPlatformProcess::Sleep(Delay);
+			}
+		}
+
+		Respond(200, TEXT("{\"status\":\"complete\"}"), ContextHeaders);
+	}
+	else if (Path == TEXT("/api/context"))
+	{
+		const FString ResponseBody = BeginContextResponse();
+		Respond(200, ResponseBody, ContextHeaders);
+		ActiveContextRequests.Decrement();
+	}
+	else
+	{
+		Respond(404, TEXT("{\"error\":\"not_found\"}"), FString());
+	}
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -0,0 +1,259 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+
+class FSocket;
+class FTcpListener;
+struct FIPv4Endpoint;
+
+/**
+ * Minimal in-process stand-in for the SurrealPilot desktop API, used by automation tests.
+ * Serves each connection on its own thread so SSE events can be written with real delays
+ * between them, which lets tests observe whether the client consumes a stream incrementally.
+ */
+class FSurrealPilotStandInServer
+{
+public:
+	FSurrealPilotStandInServer();
+	~FSurrealPilotStandInServer();
+
+	/** Start listening on the loopback interface (0 picks a free port) */
+	bool Start(int32 Port = 0);
+
+	/** Stop listening and wait for in-flight connections to finish */
+	void Stop();
+
+	/** Base URL the client should target, e.g. http://127.0.0.1:54012 */
+	FString GetBaseUrl() const;
+
+	/** Port bound by the last Start, so the server can be restarted on the same address */
+	int32 GetPort() const { return BoundPort; }
+
+	/** Script the SSE events returned by POST /api/chat */
+	void SetChatEvents(const TArray<FString>& Events, float DelayBetweenEventsSeconds);
+
+	/** Delay between the chat response headers and the first event, to simulate the model thinking */
+	void SetChatFirstEventDelay(float DelaySeconds);
+
+	/** Write chat events in pieces of at most this many bytes, so events straddle reads (0 writes each event whole) */
+	void SetChatChunkBytes(int32 ChunkBytes);
+
+	/** Delay before answering POST /api/context, to simulate a slow upload link */
+	void SetContextResponseDelay(float DelaySeconds);
+
+	/** Body returned by POST /api/context instead of the default acknowledgement */
+	void SetContextResponseBody(const FString& Body);
+
+	/** Delay before answering GET /api/health, to simulate a distant server */
+	void SetHealthResponseDelay(float DelaySeconds);
+
+	/**
+	 * Answer the next requests to Path with these status codes, one per request, before serving normally.
+	 * RetryAfter, when set, is sent as the Retry-After header with each scripted failure.
+	 */
+	void SetScriptedFailures(const FString& Path, const TArray<int32>& StatusCodes, const FString& RetryAfter = FString());
+
+	/** Answer this fraction (0-1) of requests to Path with StatusCode, chosen at random from a fixed seed */
+	void SetErrorRate(const FString& Path, float Probability, int32 StatusCode = 503);
+
+	/**
+	 * Whether context sent with a *_hash field is kept and confirmed in X-SurrealPilot-Context-Stored (true),
+	 * like a server with content-addressed storage, or ignored (false), like one without.
+	 * A *_ref to a context the server does not have is answered with 409.
+	 */
+	void SetStoresContextBlobs(bool bStore) { bStoresContextBlobs = bStore; }
+
+	/** Drop every stored context blob, as a restarted server would */
+	void ForgetContextBlobs();
+
+	/**
+	 * Whether asset context is kept by version and confirmed in X-SurrealPilot-Context-Version (true), so that
+	 * deltas against it can be applied, or ignored (false). A delta against any other version is answered with 409.
+	 */
+	void SetKeepsAssetVersions(bool bKeep) { bKeepsAssetVersions = bKeep; }
+
+	/** Drop every kept asset version, as a restarted server would */
+	void ForgetAssetVersions();
+
+	/** The server's copy of an asset's context, rebuilt from the deltas it received; null if it has none */
+	TSharedPtr<FJsonObject> GetAssetContext(const FString& AssetPath) const;
+
+	/** Number of SSE events written to the socket so far */
+	int32 GetEventsSent() const { return EventsSent.GetValue(); }
+
+	/** Most POST /api/context requests the server has been handling at the same time */
+	int32 GetPeakConcurrentContextRequests() const;
+
+	/** Number of requests received so far */
+	int32 GetRequestCount() const { return RequestCount.GetValue(); }
+
+	/** Whether gzip/deflate request bodies are decoded (true) or answered with 415 (false) */
+	void SetAcceptsCompressedBodies(bool bAccept) { bAcceptsCompressedBodies = bAccept; }
+
+	/** Body of the most recent request, after decoding any Content-Encoding */
+	TArray<uint8> GetLastRequestBody() const;
+
+	/** Content-Encoding of the most recent request, empty when the body was sent as-is */
+	FString GetLastContentEncoding() const;
+
+	/**
+	 * Whether Compact Binary bodies are decoded to JSON and served like JSON ones (true) or answered with 415 (false).
+	 * GetLastRequestBody returns such a body as it was sent.
+	 */
+	void SetAcceptsCompactBinary(bool bAccept) { bAcceptsCompactBinary = bAccept; }
+
+	/** Content-Type of the most recent request */
+	FString GetLastContentType() const;
+
+	/**
+	 * Whether GET /api/ws is upgraded to a WebSocket channel (true) or answered with 404, like a server without one (false).
+	 * Requests on a channel are served like their HTTP counterparts, scripted failures and context storage included.
+	 */
+	void SetAcceptsWebSockets(bool bAccept) { bAcceptsWebSockets = bAccept; }
+
+	/** Send {"op":"push","type":Type,"body":Body} on every open channel; returns how many it was sent on */
+	int32 PushToChannels(const FString& Type, const TSharedRef<FJsonObject>& Body);
+
+	/** Close every open channel, as a restarting desktop app would */
+	void CloseChannels();
+
+	/** Channels currently open */
+	int32 GetOpenChannelCount() const;
+
+	/** Requests received over channels so far; GetRequestCount includes them */
+	int32 GetChannelRequestCount() const { return ChannelRequestCount.GetValue(); }
+
+private:
+	/** One WebSocket connection to /api/ws */
+	struct FChannelConnection
+	{
+		FSocket* Socket = nullptr;
+
+		/** Guards sends on the socket, bOpen and Cancelled */
+		FCriticalSection Lock;
+		bool bOpen = true;
+		TSet<int32> Cancelled;
+
+		/** Requests still being served on their own threads */
+		FThreadSafeCounter ActiveRequests;
+	};
+
+private:
+	bool HandleConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint);
+	void ServeConnection(FSocket* Socket);
+
+	bool ReadRequest(FSocket* Socket, FString& OutVerb, FString& OutPath, TMap<FString, FString>& OutHeaders, TArray<uint8>& OutBody);
+	bool SendAll(FSocket* Socket, const ANSICHAR* Data, int32 Num);
+	bool SendString(FSocket* Socket, const FString& Data);
+	void SendResponse(FSocket* Socket, int32 StatusCode, const FString& ContentType, const FString& Body, const FString& ExtraHeaders = FString());
+	void SendChatStream(FSocket* Socket, const FString& ExtraHeaders);
+
+	/** Complete the WebSocket handshake and serve frames until either side closes the connection */
+	void ServeWebSocket(FSocket* Socket, const TMap<FString, FString>& Headers);
+
+	/** Read one client frame and unmask its payload */
+	bool ReadFrame(FSocket* Socket, uint8& OutOpcode, bool& bOutFinal, TArray<uint8>& OutPayload);
+
+	/** Send one unmasked server frame; false once the connection is closed */
+	bool SendFrame(FChannelConnection& Connection, uint8 Opcode, const uint8* Data, int32 Num);
+	bool SendChannelMessage(FChannelConnection& Connection, const TSharedRef<FJsonObject>& Message);
+
+	/** Handle a text message from a channel: start serving a request on its own thread, or cancel one */
+	void HandleChannelMessage(const TSharedRef<FChannelConnection>& Connection, const FString& Message);
+
+	/** Serve one request received on a channel, answering with event frames and a response frame */
+	void ServeChannelRequest(const TSharedRef<FChannelConnection>& Connection, int32 RequestId, const FString& Path, const TSharedPtr<FJsonObject>& Body);
+
+	/**
+	 * Store the contexts a chat or context body sends with a hash and check the ones it refers to.
+	 * Returns false if a reference is unknown; OutStoredHeader is the confirmation header to send otherwise.
+	 */
+	bool ResolveContextBlobs(const TSharedPtr<FJsonObject>& Root, FString& OutStoredHeader);
+
+	/**
+	 * Keep the asset version a context body carries, applying its delta to the kept base version.
+	 * Returns false if the base version is not the kept one or the result does not hash to the new version;
+	 * otherwise the confirmation header is appended to OutVersionHeader.
+	 */
+	bool ResolveAssetVersion(const TSharedPtr<FJsonObject>& Root, FString& OutVersionHeader);
+
+	/**
+	 * Resolve the context references and asset version of a chat or context body.
+	 * Returns false with the 409 body to answer with if the server does not have what it refers to;
+	 * otherwise appends the confirmation headers to OutHeaders.
+	 */
+	bool ResolveRequestContext(const FString& Path, const TSharedPtr<FJsonObject>& Root, FString& OutHeaders, FString& OutErrorBody);
+
+	/** Count a context request as active, wait out the scripted delay and return the body to answer with; pair with ActiveContextRequests.Decrement */
+	FString BeginContextResponse();
+
+	/** Pop the next scripted failure for a path, or roll for an injected one */
+	bool TakeScriptedFailure(const FString& Path, int32& OutStatusCode, FString& OutRetryAfter);
+
+private:
+	TUniquePtr<FTcpListener> Listener;
+	int32 BoundPort;
+
+	mutable FCriticalSection ScriptLock;
+	TArray<FString> ChatEvents;
+	float ChatEventDelaySeconds;
+	float ChatFirstEventDelaySeconds;
+	int32 ChatChunkBytes;
+	float ContextResponseDelaySeconds;
+	float HealthResponseDelaySeconds;
+	FString ContextResponseBody;
+	int32 PeakContextRequests;
+
+	struct FFailureScript
+	{
+		TArray<int32> StatusCodes;
+		FString RetryAfter;
+	};
+	TMap<FString, FFailureScript> FailureScripts;
+
+	struct FErrorRate
+	{
+		float Probability = 0.0f;
+		int32 StatusCode = 503;
+	};
+	TMap<FString, FErrorRate> ErrorRates;
+	FRandomStream ErrorRandom;
+
+	mutable FCriticalSection BlobLock;
+	TMap<FString, TSharedPtr<FJsonObject>> StoredContextBlobs;
+
+	struct FAssetVersion
+	{
+		FString Hash;
+		TSharedPtr<FJsonObject> Context;
+	};
+	TMap<FString, FAssetVersion> AssetVersions;
+
+	mutable FCriticalSection ChannelLock;
+	TArray<TSharedRef<FChannelConnection>> Channels;
+
+	mutable FCriticalSection LastRequestLock;
+	TArray<uint8> LastRequestBody;
+	FString LastContentEncoding;
+	FString LastContentType;
+
+	FThreadSafeCounter EventsSent;
+	FThreadSafeCounter RequestCount;
+	FThreadSafeCounter ActiveConnections;
+	FThreadSafeCounter ActiveContextRequests;
+	FThreadSafeCounter ChannelRequestCount;
+	FThreadSafeBool bStopping;
+	FThreadSafeBool bAcceptsCompressedBodies;
+	FThreadSafeBool bAcceptsCompactBinary;
+	FThreadSafeBool bStoresContextBlobs;
+	FThreadSafeBool bKeepsAssetVersions;
+	FThreadSafeBool bAcceptsWebSockets;
+};
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/** Stat group for the plugin's network traffic (stat SurrealPilot) */
+DECLARE_STATS_GROUP(TEXT("SurrealPilot"), STATGROUP_SurrealPilot, STATCAT_Advanced);
\ No newline at end of file
@@ -0,0 +1,428 @@
+#include "SurrealPilotTokenizer.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Base64.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+namespace SurrealPilotTokenizer
+{
+	/** Pieces longer than this are merged in chunks, so a huge run of whitespace cannot make BPE quadratic */
+	constexpr int32 MaxMergeBytes = 256;
+
+	/** Vocabulary and estimate calibration for each provider */
+	struct FProviderVocabulary
+	{
+		const TCHAR* Provider;
+		const TCHAR* Vocabulary;
+		double TokensPerWordPiece;
+	};
+
+	// Rough token ratios of each provider's vocabulary to o200k_base, used only when estimating
+	constexpr FProviderVocabulary ProviderVocabularies[] =
+	{
+		{ TEXT("openai"), TEXT("o200k_base"), 1.0 },
+		{ TEXT("anthropic"), TEXT("claude"), 1.15 },
+		{ TEXT("gemini"), TEXT("gemini"), 1.0 },
+		{ TEXT("ollama"), TEXT("llama3"), 1.05 },
+	};
+
+	bool IsLetter(uint8 Byte)
+	{
+		// Any byte of a multi-byte UTF-8 sequence counts as a letter, so non-Latin words stay whole
+		return (Byte >= 'a' && Byte <= 'z') || (Byte >= 'A' && Byte <= 'Z') || Byte >= 0x80;
+	}
+
+	bool IsDigit(uint8 Byte)
+	{
+		return Byte >= '0' && Byte <= '9';
+	}
+
+	bool IsNewline(uint8 Byte)
+	{
+		return Byte == '\r' || Byte == '\n';
+	}
+
+	bool IsSpace(uint8 Byte)
+	{
+		return Byte == ' ' || Byte == '\t' || Byte == '\v' || Byte == '\f' || IsNewline(Byte);
+	}
+
+	bool IsPunctuation(uint8 Byte)
+	{
+		return !IsLetter(Byte) && !IsDigit(Byte) && !IsSpace(Byte);
+	}
+
+	/** Length of an English contraction ('s 't 're 've 'm 'll 'd) starting at an apostrophe, 0 if there is none */
+	int32 MatchContraction(const uint8* Text, int32 Remaining)
+	{
+		if (Remaining < 2 || Text[0] != '\'')
+		{
+			return 0;
+		}
+
+		const uint8 First = FChar::ToLower(Text[1]);
+		const uint8 Second = Remaining > 2 ? FChar::ToLower(Text[2]) : 0;
+		if (First == 's' || First == 't' || First == 'm' || First == 'd')
+		{
+			return 2;
+		}
+		if ((First == 'r' && Second == 'e') || (First == 'v' && Second == 'e') || (First == 'l' && Second == 'l'))
+		{
+			return 3;
+		}
+		return 0;
+	}
+
+	TSharedRef<const FSurrealPilotTokenizer> CreateForProvider(const FString& Provider)
+	{
+		FString Vocabulary = TEXT("cl100k_base");
+		double TokensPerWordPiece = 1.0;
+		for (const FProviderVocabulary& Entry : ProviderVocabularies)
+		{
+			if (Provider.Equals(Entry.Provider, ESearchCase::IgnoreCase))
+			{
+				Vocabulary = Entry.Vocabulary;
+				TokensPerWordPiece = Entry.TokensPerWordPiece;
+				break;
+			}
+		}
+
+		TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("SurrealPilot"));
+		if (Plugin.IsValid())
+		{
+			const FString FilePath = Plugin->GetBaseDir() / TEXT("Resources") / TEXT("Tokenizers") / (Vocabulary + TEXT(".tiktoken"));
+			if (FPaths::FileExists(FilePath))
+			{
+				if (TSharedPtr<FSurrealPilotTokenizer> Loaded = FSurrealPilotTokenizer::LoadVocabulary(Vocabulary, FilePath))
+				{
+					UE_LOG(LogTemp, Log, TEXT("SurrealPilot: counting %s tokens with the %s vocabulary"), *Provider, *Vocabulary);
+					return Loaded.ToSharedRef();
+				}
+				UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: could not load tokenizer vocabulary %s, estimating tokens instead"), *FilePath);
+			}
+		}
+
+		return FSurrealPilotTokenizer::MakeEstimator(Vocabulary + TEXT(" (estimate)"), TokensPerWordPiece);
+	}
+}
+
+TSharedRef<const FSurrealPilotTokenizer> FSurrealPilotTokenizer::ForProvider(const FString& Provider)
+{
+	static FCriticalSection Lock;
+	static TMap<FString, TSharedRef<const FSurrealPilotTokenizer>> Tokenizers;
+
+	const FString Key = Provider.ToLower();
+	FScopeLock ScopeLock(&Lock);
+	if (const TSharedRef<const FSurrealPilotTokenizer>* Existing = Tokenizers.Find(Key))
+	{
+		return *Existing;
+	}
+	return Tokenizers.Add(Key, SurrealPilotTokenizer::CreateForProvider(Key));
+}
+
+TSharedPtr<FSurrealPilotTokenizer> FSurrealPilotTokenizer::LoadVocabulary(const FString& Name, const FString& FilePath)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+	{
+		return nullptr;
+	}
+
+	TArray<TPair<TArray<uint8>, int32>> Ranks;
+	Ranks.Reserve(Lines.Num());
+	for (const FString& Line : Lines)
+	{
+		FString Token;
+		FString Rank;
+		if (Line.IsEmpty())
+		{
+			continue;
+		}
+		if (!Line.Split(TEXT(" "), &Token, &Rank))
+		{
+			return nullptr;
+		}
+
+		TPair<TArray<uint8>, int32>& Entry = Ranks.AddDefaulted_GetRef();
+		if (!FBase64::Decode(Token, Entry.Key) || !Rank.IsNumeric())
+		{
+			return nullptr;
+		}
+		Entry.Value = FCString::Atoi(*Rank);
+	}
+
+	if (Ranks.Num() == 0)
+	{
+		return nullptr;
+	}
+	return FromRanks(Name, Ranks);
+}
+
+TSharedRef<FSurrealPilotTokenizer> FSurrealPilotTokenizer::FromRanks(const FString& Name, const TArray<TPair<TArray<uint8>, int32>>& Ranks)
+{
+	TSharedRef<FSurrealPilotTokenizer> Tokenizer = MakeShareable(new FSurrealPilotTokenizer());
+	Tokenizer->Name = Name;
+
+	// Copy every token into one buffer first; the keys point into it, so it must not grow afterwards
+	int32 TotalBytes = 0;
+	for (const TPair<TArray<uint8>, int32>& Entry : Ranks)
+	{
+		TotalBytes += Entry.Key.Num();
+	}
+	Tokenizer->TokenBytes.Reserve(TotalBytes);
+	Tokenizer->Ranks.Reserve(Ranks.Num());
+	for (const TPair<TArray<uint8>, int32>& Entry : Ranks)
+	{
+		const int32 Offset = Tokenizer->TokenBytes.Num();
+		Tokenizer->TokenBytes.Append(Entry.Key);
+		Tokenizer->Ranks.Add(FTokenKey{ Tokenizer->TokenBytes.GetData() + Offset, Entry.Key.Num() }, Entry.Value);
+	}
+	return Tokenizer;
+}
+
+TSharedRef<FSurrealPilotTokenizer> FSurrealPilotTokenizer::MakeEstimator(const FString& Name, double TokensPerWordPiece)
+{
+	TSharedRef<FSurrealPilotTokenizer> Tokenizer = MakeShareable(new FSurrealPilotTokenizer());
+	Tokenizer->Name = Name;
+	Tokenizer->TokensPerWordPiece = TokensPerWordPiece;
+	return Tokenizer;
+}
+
+int32 FSurrealPilotTokenizer::CountTokens(TArrayView<const uint8> Utf8) const
+{
+	if (IsExact())
+	{
+		int32 Tokens = 0;
+		SplitPieces(Utf8, [this, &Utf8, &Tokens](int32 Offset, int32 Num)
+		{
+			Tokens += EncodePiece(Utf8.GetData() + Offset, Num, nullptr);
+		});
+		return Tokens;
+	}
+
+	int32 Estimate = 0;
+	SplitPieces(Utf8, [this, &Utf8, &Estimate](int32 Offset, int32 Num)
+	{
+		Estimate += EstimatePiece(Utf8.GetData() + Offset, Num);
+	});
+	return FMath::CeilToInt(Estimate * TokensPerWordPiece);
+}
+
+int32 FSurrealPilotTokenizer::CountTokens(FStringView Text) const
+{
+	FTCHARToUTF8 Utf8(Text.GetData(), Text.Len());
+	return CountTokens(TArrayView<const uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length()));
+}
+
+TArray<int32> FSurrealPilotTokenizer::Encode(TArrayView<const uint8> Utf8) const
+{
+	TArray<int32> Tokens;
+	if (IsExact())
+	{
+		SplitPieces(Utf8, [this, &Utf8, &Tokens](int32 Offset, int32 Num)
+		{
+			EncodePiece(Utf8.GetData() + Offset, Num, &Tokens);
+		});
+	}
+	return Tokens;
+}
+
+void FSurrealPilotTokenizer::SplitPieces(TArrayView<const uint8> Utf8, TFunctionRef<void(int32, int32)> Visit)
+{
+	using namespace SurrealPilotTokenizer;
+
+	const uint8* Text = Utf8.GetData();
+	const int32 Num = Utf8.Num();
+	int32 Index = 0;
+	while (Index < Num)
+	{
+		const int32 Start = Index;
+		const uint8 Byte = Text[Index];
+		const uint8 Next = Index + 1 < Num ? Text[Index + 1] : 0;
+
+		if (const int32 Contraction = MatchContraction(Text + Index, Num - Index))
+		{
+			Index += Contraction;
+		}
+		else if (IsLetter(Byte) || (!IsNewline(Byte) && !IsDigit(Byte) && Index + 1 < Num && IsLetter(Next)))
+		{
+			// A word, taking one leading space or punctuation character with it
+			++Index;
+			while (Index < Num && IsLetter(Text[Index]))
+			{
+				++Index;
+			}
+		}
+		else if (IsDigit(Byte))
+		{
+			while (Index < Num && Index - Start < 3 && IsDigit(Text[Index]))
+			{
+				++Index;
+			}
+		}
+		else if (IsPunctuation(Byte) || (Byte == ' ' && Index + 1 < Num && IsPunctuation(Next)))
+		{
+			// Punctuation with an optional leading space, and the line breaks that follow it
+			++Index;
+			while (Index < Num && IsPunctuation(Text[Index]))
+			{
+				++Index;
+			}
+			while (Index < Num && IsNewline(Text[Index]))
+			{
+				++Index;
+			}
+		}
+		else
+		{
+			int32 End = Index;
+			int32 LastNewline = INDEX_NONE;
+			while (End < Num && IsSpace(Text[End]))
+			{
+				if (IsNewline(Text[End]))
+				{
+					LastNewline = End;
+				}
+				++End;
+			}
+
+			if (LastNewline != INDEX_NONE)
+			{
+				// Whitespace up to and including the last line break; indentation after it starts the next piece
+				Index = LastNewline + 1;
+			}
+			else if (End < Num && End - Index > 1)
+			{
+				// Leave the last space for the word or punctuation that follows
+				Index = End - 1;
+			}
+			else
+			{
+				Index = End;
+			}
+		}
+
+		Visit(Start, Index - Start);
+	}
+}
+
+int32 FSurrealPilotTokenizer::FindRank(const uint8* Bytes, int32 Num) const
+{
+	const int32* Rank = Ranks.Find(FTokenKey{ Bytes, Num });
+	return Rank ? *Rank : INDEX_NONE;
+}
+
+int32 FSurrealPilotTokenizer::EncodePiece(const uint8* Piece, int32 Num, TArray<int32>* OutTokens) const
+{
+	// Most pieces of an export are common words and field names that are tokens on their own
+	const int32 WholeRank = FindRank(Piece, Num);
+	if (WholeRank != INDEX_NONE)
+	{
+		if (OutTokens)
+		{
+			OutTokens->Add(WholeRank);
+		}
+		return 1;
+	}
+
+	if (Num > SurrealPilotTokenizer::MaxMergeBytes)
+	{
+		const int32 Half = SurrealPilotTokenizer::MaxMergeBytes;
+		return EncodePiece(Piece, Half, OutTokens) + EncodePiece(Piece + Half, Num - Half, OutTokens);
+	}
+
+	// Byte-pair merging: start from single bytes and repeatedly merge the adjacent pair with the lowest rank
+	TArray<int32, TInlineAllocator<64>> Boundaries;
+	for (int32 Offset = 0; Offset <= Num; ++Offset)
+	{
+		Boundaries.Add(Offset);
+	}
+
+	TArray<int32, TInlineAllocator<64>> PairRanks;
+	PairRanks.SetNumUninitialized(FMath::Max(Num - 1, 0));
+	for (int32 Part = 0; Part < PairRanks.Num(); ++Part)
+	{
+		PairRanks[Part] = FindRank(Piece + Boundaries[Part], Boundaries[Part + 2] - Boundaries[Part]);
+	}
+
+	while (PairRanks.Num() > 0)
+	{
+		int32 BestPart = INDEX_NONE;
+		int32 BestRank = MAX_int32;
+		for (int32 Part = 0; Part < PairRanks.Num(); ++Part)
+		{
+			if (PairRanks[Part] != INDEX_NONE && PairRanks[Part] < BestRank)
+			{
+				BestRank = PairRanks[Part];
+				BestPart = Part;
+			}
+		}
+		if (BestPart == INDEX_NONE)
+		{
+			break;
+		}
+
+		// Merge parts BestPart and BestPart + 1, then re-rank the pairs on either side of the merged part
+		Boundaries.RemoveAt(BestPart + 1, 1, EAllowShrinking::No);
+		PairRanks.RemoveAt(BestPart, 1, EAllowShrinking::No);
+		if (BestPart < PairRanks.Num())
+		{
+			PairRanks[BestPart] = FindRank(Piece + Boundaries[BestPart], Boundaries[BestPart + 2] - Boundaries[BestPart]);
+		}
+		if (BestPart > 0)
+		{
+			PairRanks[BestPart - 1] = FindRank(Piece + Boundaries[BestPart - 1], Boundaries[BestPart + 1] - Boundaries[BestPart - 1]);
+		}
+	}
+
+	if (OutTokens)
+	{
+		for (int32 Part = 0; Part + 1 < Boundaries.Num(); ++Part)
+		{
+			OutTokens->Add(FindRank(Piece + Boundaries[Part], Boundaries[Part + 1] - Boundaries[Part]));
+		}
+	}
+	return Boundaries.Num() - 1;
+}
+
+int32 FSurrealPilotTokenizer::EstimatePiece(const uint8* Piece, int32 Num) const
+{
+	using namespace SurrealPilotTokenizer;
+
+	int32 Letters = 0;
+	int32 NonLatinCharacters = 0;
+	int32 Punctuation = 0;
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		const uint8 Byte = Piece[Index];
+		if (Byte >= 0xC0)
+		{
+			// Lead byte of a multi-byte character: these mostly cost a token each
+			++NonLatinCharacters;
+		}
+		else if (IsLetter(Byte) && Byte < 0x80)
+		{
+			++Letters;
+		}
+		else if (IsPunctuation(Byte))
+		{
+			++Punctuation;
+		}
+	}
+
+	if (NonLatinCharacters > 0)
+	{
+		return NonLatinCharacters + (Letters + 5) / 6;
+	}
+	if (Letters > 0)
+	{
+		// Words up to eight letters are usually one token; longer identifiers split every six letters or so
+		return Letters <= 8 ? 1 : (Letters + 5) / 6;
+	}
+	if (Punctuation > 0)
+	{
+		return (Punctuation + 1) / 2;
+	}
+	return 1;
+}
\ No newline at end of file
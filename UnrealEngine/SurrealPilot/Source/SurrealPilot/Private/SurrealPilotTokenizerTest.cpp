@@ -0,0 +1,318 @@
+#include "SurrealPilotTokenizer.h"
+#include "SurrealPilotContextBudget.h"
+#include "SurrealPilotJsonWriter.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SurrealPilotTokenizerTest
+{
+    TArray<uint8> ToUtf8(const FString& Text)
+    {
+        FTCHARToUTF8 Utf8(*Text);
+        return TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+    }
+
+    /** Every single byte, then merges that build "hello" and " world" the way a trained vocabulary would */
+    TSharedRef<FSurrealPilotTokenizer> MakeTinyVocabulary()
+    {
+        TArray<TPair<TArray<uint8>, int32>> Ranks;
+        for (int32 Byte = 0; Byte < 256; ++Byte)
+        {
+            TArray<uint8> Token;
+            Token.Add(static_cast<uint8>(Byte));
+            Ranks.Emplace(MoveTemp(Token), Byte);
+        }
+
+        static const TCHAR* Merges[] = { TEXT("he"), TEXT("ll"), TEXT("hell"), TEXT("hello"), TEXT(" w"), TEXT("or"), TEXT(" wor"), TEXT("ld"), TEXT(" world") };
+        for (int32 Index = 0; Index < UE_ARRAY_COUNT(Merges); ++Index)
+        {
+            Ranks.Emplace(ToUtf8(Merges[Index]), 256 + Index);
+        }
+        return FSurrealPilotTokenizer::FromRanks(TEXT("tiny"), Ranks);
+    }
+
+    TArray<FString> Split(const FString& Text)
+    {
+        const TArray<uint8> Utf8 = ToUtf8(Text);
+        TArray<FString> Pieces;
+        FSurrealPilotTokenizer::SplitPieces(Utf8, [&Utf8, &Pieces](int32 Offset, int32 Num)
+        {
+            FUTF8ToTCHAR Piece(reinterpret_cast<const ANSICHAR*>(Utf8.GetData() + Offset), Num);
+            Pieces.Add(FString(Piece.Length(), Piece.Get()));
+        });
+        return Pieces;
+    }
+
+    TSharedPtr<FJsonValue> MakeStringArray(const FString& Prefix, int32 Count)
+    {
+        TArray<TSharedPtr<FJsonValue>> Values;
+        for (int32 Index = 0; Index < Count; ++Index)
+        {
+            Values.Add(MakeShareable(new FJsonValueString(FString::Printf(TEXT("%s %d: %s"), *Prefix, Index,
+                TEXT("Accessed None trying to read property CachedTarget in EventGraph")))));
+        }
+        return MakeShareable(new FJsonValueArray(Values));
+    }
+
+    /** A Blueprint-shaped context with every section the budgeter knows about */
+    TSharedPtr<FJsonObject> MakeContext(int32 NodeCount)
+    {
+        TSharedPtr<FJsonObject> Context = MakeShareable(new FJsonObject);
+        Context->SetStringField(TEXT("name"), TEXT("BP_Turret"));
+        Context->SetStringField(TEXT("path"), TEXT("/Game/BP_Turret.BP_Turret"));
+        Context->SetField(TEXT("scene"), MakeStringArray(TEXT("Actor"), NodeCount));
+
+        TArray<TSharedPtr<FJsonValue>> Nodes;
+        for (int32 Index = 0; Index < NodeCount; ++Index)
+        {
+            TSharedPtr<FJsonObject> Node = MakeShareable(new FJsonObject);
+            Node->SetStringField(TEXT("name"), FString::Printf(TEXT("K2Node_CallFunction_%d"), Index));
+            Node->SetStringField(TEXT("title"), TEXT("Print String"));
+            Node->SetStringField(TEXT("tooltip"), TEXT("Prints a string to the log, and optionally, to the screen"));
+            Node->SetNumberField(TEXT("posX"), (Index % 40) * 320);
+            Node->SetNumberField(TEXT("posY"), (Index / 40) * 200);
+            Nodes.Add(MakeShareable(new FJsonValueObject(Node)));
+        }
+        TSharedPtr<FJsonObject> Graph = MakeShareable(new FJsonObject);
+        Graph->SetStringField(TEXT("name"), TEXT("EventGraph"));
+        Graph->SetArrayField(TEXT("nodes"), Nodes);
+        TArray<TSharedPtr<FJsonValue>> Graphs;
+        Graphs.Add(MakeShareable(new FJsonValueObject(Graph)));
+        Context->SetArrayField(TEXT("graphs"), Graphs);
+
+        Context->SetField(TEXT("build_errors"), MakeStringArray(TEXT("Error"), 3));
+        TSharedPtr<FJsonObject> Selection = MakeShareable(new FJsonObject);
+        Selection->SetStringField(TEXT("node"), TEXT("K2Node_CallFunction_0"));
+        Context->SetObjectField(TEXT("selection"), Selection);
+        return Context;
+    }
+
+    int32 CountObject(const FSurrealPilotTokenizer& Tokenizer, const TSharedPtr<FJsonObject>& Object)
+    {
+        return FSurrealPilotContextBudget::CountTokens(Tokenizer, MakeShareable(new FJsonValueObject(Object)));
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotTokenizerBpeTest, "SurrealPilot.Tokenizer.Bpe",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotTokenizerBpeTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotTokenizerTest;
+
+    TSharedRef<FSurrealPilotTokenizer> Tokenizer = MakeTinyVocabulary();
+    TestTrue(TEXT("A tokenizer with ranks should count exactly"), Tokenizer->IsExact());
+
+    // Whole pieces that are tokens
+    TArray<int32> Tokens = Tokenizer->Encode(ToUtf8(TEXT("hello world")));
+    TestEqual(TEXT("hello world should be two tokens"), Tokens.Num(), 2);
+    if (Tokens.Num() == 2)
+    {
+        TestEqual(TEXT("hello should be its merged token"), Tokens[0], 259);
+        TestEqual(TEXT(" world should be its merged token"), Tokens[1], 264);
+    }
+
+    // Merges applied by rank: he + ll -> hell, and nothing merges with the trailing x
+    Tokens = Tokenizer->Encode(ToUtf8(TEXT("hellx")));
+    TestEqual(TEXT("hellx should be two tokens"), Tokens.Num(), 2);
+    if (Tokens.Num() == 2)
+    {
+        TestEqual(TEXT("hell should merge"), Tokens[0], 258);
+        TestEqual(TEXT("x should stay a byte"), Tokens[1], static_cast<int32>('x'));
+    }
+
+    // Only ll merges in yellow
+    TestEqual(TEXT("yellow should be y, e, ll, o, w"), Tokenizer->CountTokens(TEXT("yellow")), 5);
+    TestEqual(TEXT("Counting should agree with encoding"), Tokenizer->CountTokens(TEXT("hello world hellx")), Tokenizer->Encode(ToUtf8(TEXT("hello world hellx"))).Num());
+    TestEqual(TEXT("Empty text should have no tokens"), Tokenizer->CountTokens(TEXT("")), 0);
+
+    // Pieces longer than the merge window are split rather than merged in one quadratic pass
+    const FString LongRun = FString::ChrN(1000, TEXT('l'));
+    TestEqual(TEXT("A long run should merge pairwise"), Tokenizer->CountTokens(LongRun), 500);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotTokenizerSplitTest, "SurrealPilot.Tokenizer.SplitPieces",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotTokenizerSplitTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotTokenizerTest;
+
+    const TArray<FString> Pieces = Split(TEXT("Hello, world's 12345\n\n  x"));
+    static const TCHAR* Expected[] = { TEXT("Hello"), TEXT(","), TEXT(" world"), TEXT("'s"), TEXT(" "), TEXT("123"), TEXT("45"), TEXT("\n\n"), TEXT(" "), TEXT(" x") };
+    TestEqual(TEXT("Piece count"), Pieces.Num(), static_cast<int32>(UE_ARRAY_COUNT(Expected)));
+    for (int32 Index = 0; Index < FMath::Min<int32>(Pieces.Num(), UE_ARRAY_COUNT(Expected)); ++Index)
+    {
+        TestEqual(FString::Printf(TEXT("Piece %d"), Index), Pieces[Index], FString(Expected[Index]));
+    }
+
+    // Runs of JSON punctuation stay together between the words
+    const TArray<FString> JsonPieces = Split(TEXT("{\"name\":\"BP\"}"));
+    TestEqual(TEXT("JSON should split into punctuation and words"), JsonPieces.Num(), 5);
+
+    // Multi-byte characters are part of words, not split into bytes
+    TestEqual(TEXT("A non-Latin word should be one piece"), Split(TEXT("\u00FCber")).Num(), 1);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotTokenizerEstimateTest, "SurrealPilot.Tokenizer.Estimate",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotTokenizerEstimateTest::RunTest(const FString& Parameters)
+{
+    TSharedRef<FSurrealPilotTokenizer> Estimator = FSurrealPilotTokenizer::MakeEstimator(TEXT("test"));
+    TestFalse(TEXT("An estimator should not claim exact counts"), Estimator->IsExact());
+    TestEqual(TEXT("Short words should be a token each"), Estimator->CountTokens(TEXT("hello world")), 2);
+    TestEqual(TEXT("Long identifiers should split"), Estimator->CountTokens(TEXT("SurrealPilotContextBudget")), 5);
+    TestEqual(TEXT("An estimator has no token ids"), Estimator->Encode(TArrayView<const uint8>()).Num(), 0);
+
+    TSharedRef<FSurrealPilotTokenizer> Scaled = FSurrealPilotTokenizer::MakeEstimator(TEXT("scaled"), 1.5);
+    TestEqual(TEXT("Calibration should scale the estimate"), Scaled->CountTokens(TEXT("hello world")), 3);
+
+    // Every provider gets a tokenizer, exact or not, without touching the network
+    for (const TCHAR* Provider : { TEXT("openai"), TEXT("anthropic"), TEXT("gemini"), TEXT("ollama"), TEXT("unknown") })
+    {
+        TSharedRef<const FSurrealPilotTokenizer> Tokenizer = FSurrealPilotTokenizer::ForProvider(Provider);
+        TestTrue(FString::Printf(TEXT("%s should count tokens"), Provider), Tokenizer->CountTokens(TEXT("Print String")) > 0);
+        TestTrue(FString::Printf(TEXT("%s should be cached"), Provider), &Tokenizer.Get() == &FSurrealPilotTokenizer::ForProvider(Provider).Get());
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotContextBudgetTrimTest, "SurrealPilot.ContextBudget.Trim",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotContextBudgetTrimTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotTokenizerTest;
+
+    TSharedRef<FSurrealPilotTokenizer> Tokenizer = FSurrealPilotTokenizer::MakeEstimator(TEXT("test"));
+    TSharedPtr<FJsonObject> Context = MakeContext(200);
+    const int32 FullTokens = CountObject(*Tokenizer, Context);
+
+    // Within budget: sent untouched
+    FSurrealPilotTokenBudgetReport Report;
+    TSharedPtr<FJsonObject> Untouched = FSurrealPilotContextBudget::Trim(Context, *Tokenizer, FullTokens * 2, Report);
+    TestTrue(TEXT("Context within budget should be returned as is"), Untouched == Context);
+    TestEqual(TEXT("Nothing should be dropped within budget"), Report.TokensDropped, 0);
+
+    // Room for the selection, the errors and some of the graph, but not the scene
+    const int32 GraphTokens = FSurrealPilotContextBudget::CountTokens(*Tokenizer, Context->Values.FindChecked(TEXT("graphs")));
+    const int32 Budget = FullTokens - GraphTokens / 2 - FSurrealPilotContextBudget::CountTokens(*Tokenizer, Context->Values.FindChecked(TEXT("scene")));
+    TSharedPtr<FJsonObject> Trimmed = FSurrealPilotContextBudget::Trim(Context, *Tokenizer, Budget, Report);
+
+    TestTrue(TEXT("Scalars should be kept"), Trimmed->HasField(TEXT("name")) && Trimmed->HasField(TEXT("path")));
+    TestTrue(TEXT("Selection should be kept"), Trimmed->HasField(TEXT("selection")));
+    TestEqual(TEXT("Build errors should be kept whole"), Trimmed->GetArrayField(TEXT("build_errors")).Num(), 3);
+    TestFalse(TEXT("The scene should be dropped first"), Trimmed->HasField(TEXT("scene")));
+    TestTrue(TEXT("The scene should be reported as dropped"), Report.DroppedSections.Contains(TEXT("scene")));
+
+    const TArray<TSharedPtr<FJsonValue>>* Graphs = nullptr;
+    TestTrue(TEXT("Graphs should be cut short, not dropped"), Trimmed->TryGetArrayField(TEXT("graphs"), Graphs) && Graphs->Num() == 1);
+    if (Graphs && Graphs->Num() == 1)
+    {
+        const TSharedPtr<FJsonObject> Graph = (*Graphs)[0]->AsObject();
+        const int32 KeptNodes = Graph->GetArrayField(TEXT("nodes")).Num();
+        TestEqual(TEXT("The graph's name should be kept"), Graph->GetStringField(TEXT("name")), FString(TEXT("EventGraph")));
+        TestTrue(TEXT("Some but not all nodes should be kept"), KeptNodes > 0 && KeptNodes < 200);
+    }
+    TestTrue(TEXT("The cut should be reported"), Report.TruncatedSections.ContainsByPredicate([](const FString& Section) { return Section.StartsWith(TEXT("graphs[0].nodes")); }));
+
+    TestTrue(TEXT("Tokens used should fit the budget"), Report.TokensUsed <= Budget);
+    TestTrue(TEXT("The trimmed context should fit the budget when counted as sent"), CountObject(*Tokenizer, Trimmed) <= Budget);
+    TestTrue(TEXT("Dropped tokens should be reported"), Report.TokensDropped > 0);
+    TestTrue(TEXT("The original context should not be modified"), Context->HasField(TEXT("scene")) && Context->GetArrayField(TEXT("graphs"))[0]->AsObject()->GetArrayField(TEXT("nodes")).Num() == 200);
+
+    // No room for anything but the scalars
+    TSharedPtr<FJsonObject> ScalarsOnly = MakeShareable(new FJsonObject);
+    ScalarsOnly->SetStringField(TEXT("name"), Context->GetStringField(TEXT("name")));
+    ScalarsOnly->SetStringField(TEXT("path"), Context->GetStringField(TEXT("path")));
+    FSurrealPilotContextBudget::Trim(ScalarsOnly, *Tokenizer, MAX_int32, Report);
+    const int32 ScalarTokens = Report.TokensUsed;
+    Trimmed = FSurrealPilotContextBudget::Trim(Context, *Tokenizer, ScalarTokens, Report);
+    TestTrue(TEXT("Scalars should be kept first"), Trimmed->HasField(TEXT("name")) && Trimmed->HasField(TEXT("path")));
+    TestEqual(TEXT("Every section should be dropped"), Report.DroppedSections.Num(), 4);
+    if (Report.DroppedSections.Num() == 4)
+    {
+        TestEqual(TEXT("Sections should be dropped in priority order"), Report.DroppedSections[0], FString(TEXT("selection")));
+        TestEqual(TEXT("The scene should be last"), Report.DroppedSections[3], FString(TEXT("scene")));
+    }
+
+    // Scalars are charged too
+    Trimmed = FSurrealPilotContextBudget::Trim(Context, *Tokenizer, 0, Report);
+    TestEqual(TEXT("Nothing should fit in no budget"), Trimmed->Values.Num(), 0);
+    TestTrue(TEXT("The scalars should be reported as dropped"), Report.DroppedSections.Contains(TEXT("name")) && Report.DroppedSections.Contains(TEXT("path")));
+
+    // A long string is a section of its own: it comes after the known sections and is cut short rather than sent whole
+    TSharedPtr<FJsonObject> WithNotes = MakeShareable(new FJsonObject);
+    WithNotes->Values = Context->Values;
+    FString Notes;
+    for (int32 Index = 0; Index < 500; ++Index)
+    {
+        Notes += FString::Printf(TEXT("Note %d: the turret keeps its target between rounds. "), Index);
+    }
+    WithNotes->SetStringField(TEXT("notes"), Notes);
+    const int32 NotesTokens = FSurrealPilotContextBudget::CountTokens(*Tokenizer, WithNotes->Values.FindChecked(TEXT("notes")));
+    const int32 NotesBudget = FullTokens + NotesTokens / 2;
+    Trimmed = FSurrealPilotContextBudget::Trim(WithNotes, *Tokenizer, NotesBudget, Report);
+    TestTrue(TEXT("Every known section should be kept before the long string"), Trimmed->HasField(TEXT("scene")) && Trimmed->GetArrayField(TEXT("graphs")).Num() == 1);
+    const FString KeptNotes = Trimmed->HasField(TEXT("notes")) ? Trimmed->GetStringField(TEXT("notes")) : FString();
+    TestTrue(TEXT("The long string should be cut short, not dropped"), KeptNotes.Len() > 0 && KeptNotes.Len() < Notes.Len() && KeptNotes.EndsWith(TEXT("...")));
+    TestTrue(TEXT("The cut should be reported"), Report.TruncatedSections.ContainsByPredicate([](const FString& Section) { return Section.StartsWith(TEXT("notes (")); }));
+    TestTrue(TEXT("The context with the cut string should fit the budget"), Report.TokensUsed <= NotesBudget);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSurrealPilotContextBudgetBenchmarkTest, "SurrealPilot.ContextBudget.Benchmark",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSurrealPilotContextBudgetBenchmarkTest::RunTest(const FString& Parameters)
+{
+    using namespace SurrealPilotTokenizerTest;
+
+    // Override with -SurrealPilotTokenizerNodes=N to measure other export sizes
+    int32 NodeCount = 3000;
+    FParse::Value(FCommandLine::Get(), TEXT("SurrealPilotTokenizerNodes="), NodeCount);
+    const int32 Iterations = 5;
+
+    TSharedPtr<FJsonObject> Context = MakeContext(NodeCount);
+    FSurrealPilotJsonWriter Writer;
+    Writer.WriteJsonObject(Context);
+    const int32 Bytes = Writer.GetBuffer().Num();
+
+    for (const TSharedRef<const FSurrealPilotTokenizer>& Tokenizer : { FSurrealPilotTokenizer::ForProvider(TEXT("openai")),
+        TSharedRef<const FSurrealPilotTokenizer>(MakeTinyVocabulary()) })
+    {
+        double CountSeconds = 0.0;
+        int32 Tokens = 0;
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            const double Start = FPlatformTime::Seconds();
+            Tokens = Tokenizer->CountTokens(Writer.GetBuffer());
+            CountSeconds += FPlatformTime::Seconds() - Start;
+        }
+
+        FSurrealPilotTokenBudgetReport Report;
+        const double TrimStart = FPlatformTime::Seconds();
+        FSurrealPilotContextBudget::Trim(Context, *Tokenizer, Tokens / 4, Report);
+        const double TrimSeconds = FPlatformTime::Seconds() - TrimStart;
+
+        TestTrue(FString::Printf(TEXT("%s: trimming to a quarter should drop tokens"), *Tokenizer->GetName()), Report.TokensDropped > 0);
+        AddInfo(FString::Printf(TEXT("%s (%s): %d bytes -> %d tokens in %.2f ms (%.1f MB/s), trim to %d tokens in %.2f ms"),
+            *Tokenizer->GetName(), Tokenizer->IsExact() ? TEXT("exact") : TEXT("estimate"), Bytes, Tokens,
+            CountSeconds * 1000.0 / Iterations, Bytes * Iterations / FMath::Max(CountSeconds, 1e-9) / (1024.0 * 1024.0),
+            Tokens / 4, TrimSeconds * 1000.0));
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
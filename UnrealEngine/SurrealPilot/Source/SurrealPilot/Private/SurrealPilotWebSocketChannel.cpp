@@ -0,0 +1,269 @@
+#include "SurrealPilotWebSocketChannel.h"
+#include "SurrealPilotJsonWriter.h"
+#include "WebSocketsModule.h"
+#include "IWebSocket.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+const TCHAR* const FSurrealPilotWebSocketChannel::ChannelPath = TEXT("/api/ws");
+const TCHAR* const FSurrealPilotWebSocketChannel::Protocol = TEXT("surrealpilot");
+
+namespace SurrealPilotWebSocketChannel
+{
+	/** Backoff between reconnection attempts */
+	constexpr double ReconnectBaseDelaySeconds = 0.5;
+	constexpr double ReconnectMaxDelaySeconds = 30.0;
+}
+
+FSurrealPilotWebSocketChannel::~FSurrealPilotWebSocketChannel()
+{
+	Close();
+}
+
+FString FSurrealPilotWebSocketChannel::MakeChannelUrl(const FString& ApiBaseUrl)
+{
+	FString Url = ApiBaseUrl;
+	if (Url.StartsWith(TEXT("https://"), ESearchCase::IgnoreCase))
+	{
+		Url = TEXT("wss://") + Url.RightChop(8);
+	}
+	else if (Url.StartsWith(TEXT("http://"), ESearchCase::IgnoreCase))
+	{
+		Url = TEXT("ws://") + Url.RightChop(7);
+	}
+	Url.RemoveFromEnd(TEXT("/"));
+	return Url + ChannelPath;
+}
+
+void FSurrealPilotWebSocketChannel::Open(const FString& InBaseUrl, const TMap<FString, FString>& InHeaders)
+{
+	if (State != ESurrealPilotChannelState::Closed && BaseUrl == InBaseUrl)
+	{
+		return;
+	}
+
+	// Requests on a connection to another endpoint start over elsewhere rather than being dropped
+	TMap<int32, FPendingRequest> Lost = MoveTemp(Pending);
+	Pending.Reset();
+
+	Close();
+	BaseUrl = InBaseUrl;
+	Headers = InHeaders;
+	ReconnectAttempts = 0;
+	ReconnectPolicy.BaseDelaySeconds = SurrealPilotWebSocketChannel::ReconnectBaseDelaySeconds;
+	ReconnectPolicy.MaxDelaySeconds = SurrealPilotWebSocketChannel::ReconnectMaxDelaySeconds;
+	ReconnectRandom.Initialize(static_cast<int32>(FPlatformTime::Cycles()));
+	Connect();
+	ReportLost(MoveTemp(Lost));
+}
+
+void FSurrealPilotWebSocketChannel::Close()
+{
+	if (ReconnectHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(ReconnectHandle);
+		ReconnectHandle.Reset();
+	}
+
+	Disconnect();
+	Pending.Reset();
+	State = ESurrealPilotChannelState::Closed;
+	BaseUrl.Reset();
+}
+
+void FSurrealPilotWebSocketChannel::Connect()
+{
+	State = ESurrealPilotChannelState::Connecting;
+
+	Socket = FWebSocketsModule::Get().CreateWebSocket(MakeChannelUrl(BaseUrl), Protocol, Headers);
+	Socket->OnConnected().AddRaw(this, &FSurrealPilotWebSocketChannel::HandleConnected);
+	Socket->OnConnectionError().AddRaw(this, &FSurrealPilotWebSocketChannel::HandleConnectionError);
+	Socket->OnClosed().AddRaw(this, &FSurrealPilotWebSocketChannel::HandleClosed);
+	Socket->OnMessage().AddRaw(this, &FSurrealPilotWebSocketChannel::HandleMessage);
+	Socket->Connect();
+}
+
+void FSurrealPilotWebSocketChannel::Disconnect()
+{
+	if (!Socket.IsValid())
+	{
+		return;
+	}
+
+	// Unbind first: closing reports OnClosed, which would schedule a reconnect
+	TSharedPtr<IWebSocket> ClosingSocket = MoveTemp(Socket);
+	ClosingSocket->OnConnected().RemoveAll(this);
+	ClosingSocket->OnConnectionError().RemoveAll(this);
+	ClosingSocket->OnClosed().RemoveAll(this);
+	ClosingSocket->OnMessage().RemoveAll(this);
+	if (ClosingSocket->IsConnected())
+	{
+		ClosingSocket->Close();
+	}
+
+	// This may run inside one of the socket's own callbacks, so keep it alive until the next tick
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([ClosingSocket](float DeltaTime)
+	{
+		return false;
+	}));
+}
+
+void FSurrealPilotWebSocketChannel::ScheduleReconnect()
+{
+	double DelaySeconds = ReconnectPolicy.MaxDelaySeconds;
+	ReconnectPolicy.GetRetryDelay(++ReconnectAttempts, nullptr, ReconnectRandom, DelaySeconds);
+
+	ReconnectHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([this](float DeltaTime)
+	{
+		// The ticker removes this delegate when it returns false
+		ReconnectHandle.Reset();
+		Connect();
+		return false;
+	}), static_cast<float>(DelaySeconds));
+}
+
+int32 FSurrealPilotWebSocketChannel::Send(const FString& Path, TArrayView<const uint8> JsonBody, FOnFrame OnFrame, FOnLost OnLost)
+{
+	if (!IsConnected())
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 RequestId = ++LastRequestId;
+	FSurrealPilotJsonWriter Writer(JsonBody.Num() + 64);
+	Writer.BeginObject();
+	Writer.WriteInteger(TEXT("id"), RequestId);
+	Writer.WriteString(TEXT("op"), TEXT("request"));
+	Writer.WriteString(TEXT("path"), Path);
+	Writer.WriteRawValue(TEXT("body"), JsonBody);
+	Writer.EndObject();
+
+	FPendingRequest& Request = Pending.Add(RequestId);
+	Request.OnFrame = MoveTemp(OnFrame);
+	Request.OnLost = MoveTemp(OnLost);
+	++Stats.Requests;
+
+	// Sent as a text frame straight from the UTF-8 buffer
+	Socket->Send(Writer.GetBuffer().GetData(), Writer.GetBuffer().Num(), false);
+	return RequestId;
+}
+
+void FSurrealPilotWebSocketChannel::Cancel(int32 RequestId)
+{
+	if (Pending.Remove(RequestId) > 0 && IsConnected())
+	{
+		Socket->Send(FString::Printf(TEXT("{\"id\":%d,\"op\":\"cancel\"}"), RequestId));
+	}
+}
+
+void FSurrealPilotWebSocketChannel::HandleConnected()
+{
+	State = ESurrealPilotChannelState::Connected;
+	ReconnectAttempts = 0;
+	++Stats.Connects;
+	UE_LOG(LogTemp, Log, TEXT("SurrealPilot: channel to %s connected"), *BaseUrl);
+}
+
+void FSurrealPilotWebSocketChannel::HandleConnectionError(const FString& Error)
+{
+	++Stats.FailedConnects;
+
+	// A desktop app without channel support fails every attempt; say so once rather than on every retry
+	UE_CLOG(ReconnectAttempts == 0, LogTemp, Log, TEXT("SurrealPilot: channel to %s unavailable (%s), using HTTP"), *BaseUrl, *Error);
+	HandleDisconnect();
+}
+
+void FSurrealPilotWebSocketChannel::HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean)
+{
+	++Stats.Disconnects;
+	UE_LOG(LogTemp, Log, TEXT("SurrealPilot: channel to %s closed (%d %s), using HTTP until it reconnects"), *BaseUrl, StatusCode, *Reason);
+	HandleDisconnect();
+}
+
+void FSurrealPilotWebSocketChannel::HandleDisconnect()
+{
+	Disconnect();
+	State = ESurrealPilotChannelState::Connecting;
+
+	TMap<int32, FPendingRequest> Lost = MoveTemp(Pending);
+	Pending.Reset();
+	if (!ReconnectHandle.IsValid() && !BaseUrl.IsEmpty())
+	{
+		ScheduleReconnect();
+	}
+	ReportLost(MoveTemp(Lost));
+}
+
+void FSurrealPilotWebSocketChannel::ReportLost(TMap<int32, FPendingRequest>&& Lost)
+{
+	// Callbacks may send again; they see a channel that is not connected and go over HTTP
+	Stats.RequestsLost += Lost.Num();
+	for (TPair<int32, FPendingRequest>& Request : Lost)
+	{
+		if (Request.Value.OnLost)
+		{
+			Request.Value.OnLost();
+		}
+	}
+}
+
+void FSurrealPilotWebSocketChannel::HandleMessage(const FString& Message)
+{
+	TSharedPtr<FJsonObject> Root;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Message), Root) || !Root.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SurrealPilot: ignoring malformed channel frame"));
+		return;
+	}
+
+	FSurrealPilotChannelFrame Frame;
+	Root->TryGetStringField(TEXT("op"), Frame.Op);
+	const TSharedPtr<FJsonObject>* Body = nullptr;
+	if (Root->TryGetObjectField(TEXT("body"), Body))
+	{
+		Frame.Body = *Body;
+	}
+
+	if (Frame.Op == TEXT("push"))
+	{
+		FString Type;
+		Root->TryGetStringField(TEXT("type"), Type);
+		++Stats.Pushes;
+		PushDelegate.Broadcast(Type, Frame.Body);
+		return;
+	}
+
+	int32 RequestId = INDEX_NONE;
+	FPendingRequest* Request = Root->TryGetNumberField(TEXT("id"), RequestId) ? Pending.Find(RequestId) : nullptr;
+	if (!Request)
+	{
+		// Cancelled on this side while the server was still answering
+		return;
+	}
+
+	Frame.FrameBytes = FTCHARToUTF8(*Message).Length();
+	if (Frame.Op == TEXT("event"))
+	{
+		Root->TryGetStringField(TEXT("data"), Frame.Data);
+
+		// The callback may cancel this request or send another, either of which can free or move the entry
+		FOnFrame OnFrame = Request->OnFrame;
+		OnFrame(Frame);
+		return;
+	}
+
+	Root->TryGetNumberField(TEXT("status"), Frame.Status);
+	const TSharedPtr<FJsonObject>* ResponseHeaders = nullptr;
+	if (Root->TryGetObjectField(TEXT("headers"), ResponseHeaders))
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Header : (*ResponseHeaders)->Values)
+		{
+			Frame.Headers.Add(Header.Key, Header.Value.IsValid() ? Header.Value->AsString() : FString());
+		}
+	}
+
+	// The response ends the request; remove it first so the callback can send the next one
+	FOnFrame OnFrame = MoveTemp(Request->OnFrame);
+	Pending.Remove(RequestId);
+	OnFrame(Frame);
+}
\ No newline at end of file
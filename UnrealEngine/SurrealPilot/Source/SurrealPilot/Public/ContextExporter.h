@@ -5,6 +5,8 @@
 #include "BlueprintGraph/Classes/K2Node.h"
 #include "EditorSubsystem.h"
 #include "Dom/JsonObject.h"
+#include "SurrealPilotGraphContextCache.h"
+#include "SurrealPilotProjectContext.h"
 
 /**
  * Interface for context export functionality
@@ -53,13 +55,85 @@ public:
     virtual FString ExportErrorContext(const TArray<FString>& Errors) override;
     virtual FString ExportSelectionContext() override;
 
+    /**
+     * Export Blueprint context as a JSON object, for callers that send it rather than display it.
+     * Graphs, nodes, pins and variables carry a "guid" field so successive exports can be diffed.
+     * Graphs that have not changed since the last export are taken from the graph context cache; the objects they
+     * share with earlier exports must not be modified.
+     * @param Blueprint The blueprint to export context from
+     * @return JSON object containing blueprint context, or null if Blueprint is null
+     */
+    TSharedPtr<FJsonObject> ExportBlueprintContextObject(UBlueprint* Blueprint);
+
+    /**
+     * Export Blueprint context as Compact Binary, with the same fields as the JSON export.
+     * Decode it with FSurrealPilotCompactBinary::Decode, or turn it into JSON text with ToJsonString.
+     * @param Blueprint The blueprint to export context from
+     * @return Versioned Compact Binary envelope containing blueprint context, with an empty payload if Blueprint is null
+     */
+    TArray<uint8> ExportBlueprintContextBinary(UBlueprint* Blueprint);
+
+    /**
+     * Export a summary of every Blueprint under a content path - parent class, interfaces, variables and function
+     * signatures - from the Asset Registry, without loading any package.
+     * Exports after the first only summarize again the Blueprints that changed.
+     * @param RootPath Content path to summarize
+     * @return JSON string containing the project's Blueprints
+     */
+    FString ExportProjectContext(const FString& RootPath = TEXT("/Game"));
+
+    /**
+     * Project-wide Blueprint summary kept between exports, with its counters
+     */
+    const FSurrealPilotProjectContext& GetProjectContext() const { return ProjectContext; }
+
     /**
      * Get the singleton instance of the context exporter
      */
     UFUNCTION(BlueprintCallable, Category = "SurrealPilot")
     static UContextExporter* Get();
 
+    /**
+     * Exported graphs kept for the next export of their Blueprint, with their hit rate
+     */
+    const FSurrealPilotGraphContextCache& GetGraphContextCache() const { return GraphContextCache; }
+
+    /**
+     * Forget every cached graph, so the next export walks each graph again
+     */
+    void ClearGraphContextCache() { GraphContextCache.Clear(); }
+
 private:
+    /** Exported graphs by graph, dropped as the graphs change */
+    FSurrealPilotGraphContextCache GraphContextCache;
+
+    /** Every Blueprint in the project, summarized from the Asset Registry */
+    FSurrealPilotProjectContext ProjectContext;
+
+    /** Length of the last streamed Blueprint export, to size the next one's buffer */
+    int32 LastBlueprintContextLength = 0;
+
+    /**
+     * Get the graph context cache with its cap from the settings, or null when the settings turn it off
+     */
+    FSurrealPilotGraphContextCache* GetEnabledGraphContextCache();
+
+    /**
+     * Export a graph through the graph context cache when it is enabled
+     * @param Blueprint The blueprint that owns the graph
+     * @param Graph The graph to export
+     * @param Export Walks the graph when the cache has no fresh copy
+     * @return JSON object for the graph
+     */
+    TSharedPtr<FJsonObject> ExportCachedGraph(UBlueprint* Blueprint, UEdGraph* Graph, TFunctionRef<TSharedPtr<FJsonObject>()> Export);
+
+    /**
+     * Export a function graph's signature to JSON
+     * @param FunctionGraph The function graph to export
+     * @return JSON object containing the function's name, parameters and return values
+     */
+    TSharedPtr<FJsonObject> ExportFunctionSignature(UEdGraph* FunctionGraph);
+
     /**
      * Export blueprint graph nodes to JSON
      * @param Graph The blueprint graph to export
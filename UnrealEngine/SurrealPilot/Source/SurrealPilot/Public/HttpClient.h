@@ -3,11 +3,60 @@
 #include "CoreMinimal.h"
 #include "Http.h"
 #include "Dom/JsonObject.h"
+#include "SurrealPilotSSEParser.h"
+#include "SurrealPilotRequestScheduler.h"
+#include "SurrealPilotRetryPolicy.h"
+#include "SurrealPilotCircuitBreaker.h"
+#include "SurrealPilotEndpointManager.h"
+#include "SurrealPilotRequestHandle.h"
+#include "SurrealPilotHttpMetrics.h"
+#include "SurrealPilotContextStore.h"
+#include "SurrealPilotContextDelta.h"
+#include "SurrealPilotContextBudget.h"
+#include "SurrealPilotWebSocketChannel.h"
+#include "SurrealPilotContextJournal.h"
+#include "SurrealPilotResponseCache.h"
+#include "Containers/Ticker.h"
+
+class FSurrealPilotJsonWriter;
 
 DECLARE_DELEGATE_OneParam(FOnHttpResponse, TSharedPtr<FJsonObject>);
 DECLARE_DELEGATE_OneParam(FOnHttpError, const FString&);
 DECLARE_DELEGATE_OneParam(FOnStreamingChunk, const FString&);
 
+/**
+ * Counters for context messages sent through FHttpClient::QueueContext
+ */
+struct SURREALPILOT_API FSurrealPilotContextBatchStats
+{
+	/** Messages passed to QueueContext */
+	int32 Queued = 0;
+	
+	/** Messages dropped because a newer message with the same key replaced them */
+	int32 Superseded = 0;
+	
+	/** Messages actually sent */
+	int32 Sent = 0;
+	
+	/** HTTP requests used to send them */
+	int32 Requests = 0;
+};
+
+/**
+ * Counters for retried and short-circuited requests
+ */
+struct SURREALPILOT_API FSurrealPilotRetryStats
+{
+	/** Attempts re-sent after a retryable failure */
+	int32 Retries = 0;
+	
+	/** Requests that still failed after using every retry */
+	int32 Exhausted = 0;
+	
+	/** Requests failed immediately because the endpoint's circuit was open */
+	int32 FailedFast = 0;
+};
+
 /**
  * HTTP client for communicating with SurrealPilot API
  * Handles both desktop (localhost:8000) and SaaS endpoints
@@ -23,51 +72,541 @@ public:
 	
 	/** Get the singleton instance */
 	static FHttpClient& Get();
+	
+	/** Whether Initialize has run and Shutdown has not */
+	static bool IsAvailable() { return Instance.IsValid(); }
 
-	/** Send a chat request to the API */
-	void SendChatRequest(
+	/**
+	 * Send a chat request to the API.
+	 * A chat still streaming for the same non-empty ConversationId is cancelled, since its answer is no longer wanted.
+	 * With the response cache on, a request identical to one already answered replays that answer's chunks instead.
+	 * OnComplete runs once every chunk of a successful answer has been delivered.
+	 */
+	FSurrealPilotRequestHandle SendChatRequest(
 		const TArray<TSharedPtr<FJsonObject>>& Messages,
 		const FString& Provider = TEXT("openai"),
 		const TSharedPtr<FJsonObject>& Context = nullptr,
 		FOnStreamingChunk OnChunk = FOnStreamingChunk(),
-		FOnHttpError OnError = FOnHttpError()
+		FOnHttpError OnError = FOnHttpError(),
+		const FString& ConversationId = FString(),
+		FSimpleDelegate OnComplete = FSimpleDelegate()
 	);
 	
-	/** Send a context export request */
-	void SendContextRequest(
+	/**
+	 * Send a context export request.
+	 * With Context Encoding set to Compact Binary the request goes over HTTP encoded as Compact Binary, with its
+	 * context inline, until the server answers 415; from then on it is sent as JSON.
+	 */
+	FSurrealPilotRequestHandle SendContextRequest(
 		const FString& ContextType,
 		const TSharedPtr<FJsonObject>& ContextData,
 		FOnHttpResponse OnResponse,
-		FOnHttpError OnError
+		FOnHttpError OnError,
+		ESurrealPilotRequestPriority Priority = ESurrealPilotRequestPriority::BackgroundContext
 	);
 	
+	/**
+	 * Send the context export of an asset such as a Blueprint. Once the endpoint has acknowledged a version of
+	 * the asset, later uploads carry only a delta against that version; if the server's copy turns out to differ,
+	 * the export is resent in full. ContextData is kept as the base of the next delta and must not be modified.
+	 */
+	FSurrealPilotRequestHandle SendAssetContext(
+		const FString& AssetPath,
+		const FString& ContextType,
+		const TSharedPtr<FJsonObject>& ContextData,
+		FOnHttpResponse OnResponse,
+		FOnHttpError OnError,
+		ESurrealPilotRequestPriority Priority = ESurrealPilotRequestPriority::BackgroundContext
+	);
+	
+	/**
+	 * Queue a context message to be sent with others in a single batch request.
+	 * A queued message is dropped when a newer one with the same non-empty SupersedeKey arrives.
+	 */
+	void QueueContext(
+		const FString& ContextType,
+		const TSharedPtr<FJsonObject>& ContextData,
+		const FString& SupersedeKey = FString(),
+		ESurrealPilotRequestPriority Priority = ESurrealPilotRequestPriority::BackgroundContext
+	);
+	
+	/** Send every queued context message now */
+	void FlushQueuedContext();
+	
+	/** Send the context messages kept in the journal while the endpoint was down, oldest first, one batch at a time */
+	void ReplayContextJournal();
+	
+	/** Context messages kept on disk until the endpoint can take them */
+	const FSurrealPilotContextJournal& GetContextJournal() const { return ContextJournal; }
+	
+	/** Keep undelivered context in the journal at FilePath instead of the default one (empty restores the default) */
+	void SetContextJournalPath(const FString& FilePath);
+	
+	/** Counters for queued context messages */
+	const FSurrealPilotContextBatchStats& GetContextBatchStats() const { return ContextBatchStats; }
+	
+	/** Queue depth and wait-time metrics for each priority class */
+	const FSurrealPilotRequestScheduler& GetScheduler() const { return Scheduler; }
+	
+	/** Counters for context sent by hash reference instead of inline */
+	const FSurrealPilotContextDedupStats& GetContextDedupStats() const { return ContextStore.GetStats(); }
+	
+	/** Counters for asset context sent as a delta instead of in full */
+	const FSurrealPilotContextDeltaStats& GetContextDeltaStats() const { return ContextVersions.GetStats(); }
+	
+	/** Tokens of chat context sent and trimmed to fit provider budgets */
+	const FSurrealPilotTokenBudgetStats& GetTokenBudgetStats() const { return TokenBudgetStats; }
+	
+	/** What the most recent chat request's context kept and dropped */
+	const FSurrealPilotTokenBudgetReport& GetLastTokenBudgetReport() const { return LastTokenBudgetReport; }
+	
+	/** Chat answers kept for identical requests, with their hit rate and the latency they saved */
+	const FSurrealPilotResponseCache& GetResponseCache() const { return ResponseCache; }
+	
+	/** Forget every cached chat answer, on disk too */
+	void ClearResponseCache() { ResponseCache.Clear(); }
+	
+	/** Counters for retries and circuit-breaker rejections */
+	const FSurrealPilotRetryStats& GetRetryStats() const { return RetryStats; }
+	
+	/** Circuit state for a base URL such as http://127.0.0.1:8000 */
+	ESurrealPilotCircuitState GetCircuitState(const FString& BaseUrl) const { return CircuitBreaker.GetState(BaseUrl); }
+	
 	/** Test API connectivity */
-	void TestConnection(FOnHttpResponse OnResponse, FOnHttpError OnError);
+	FSurrealPilotRequestHandle TestConnection(FOnHttpResponse OnResponse, FOnHttpError OnError);
+	
+	/** Target a specific API base URL instead of the configured one (empty restores the default) */
+	void SetBaseUrlOverride(const FString& BaseUrl);
+	
+	/** Choose between these base URLs, in order of preference, instead of the configured ones (empty restores the default) */
+	void SetEndpointOverrides(const TArray<FString>& BaseUrls);
+	
+	/** Get the base API URL requests go to now (desktop or SaaS, whichever is healthy and fastest) */
+	FString GetApiBaseUrl();
+	
+	/** Health and round-trip state of each endpoint */
+	const FSurrealPilotEndpointManager& GetEndpointManager() const { return EndpointManager; }
+	
+	/** Send a health probe to every endpoint that has none in flight */
+	void ProbeEndpoints();
+	
+	/** Latency and throughput histograms per endpoint, route and provider */
+	const FSurrealPilotHttpMetrics& GetMetrics() const { return Metrics; }
+	
+	/** Clear every latency and throughput histogram */
+	void ResetMetrics() { Metrics.Reset(); }
+	
+	/** Open, retarget or close the WebSocket channel to match the settings and the endpoint requests go to now */
+	void RefreshChannel();
+	
+	/** WebSocket channel to the desktop app; chat and context go over it while it is connected */
+	const FSurrealPilotWebSocketChannel& GetChannel() const { return Channel; }
+	
+	/** Messages the desktop app pushes over the channel, such as patches */
+	FOnSurrealPilotChannelPush& OnServerPush() { return Channel.OnPush(); }
+
+private:
+	/** Progress through a streaming SSE response body */
+	struct FSSEStreamState
+	{
+		/** Bytes of the response body already handed to the SSE parser */
+		int32 ConsumedBytes = 0;
+		
+		/** Resumable parser holding partial lines between reads */
+		FSurrealPilotSSEParser Parser;
+		
+		/** Events delivered on the game thread while the body was arriving */
+		int32 EventCount = 0;
+		
+		/** FPlatformTime::Seconds() when the first of them was delivered, 0 before that */
+		double FirstEventTime = 0.0;
+		
+		/** Request the stream belongs to, so events parsed after it completes are not delivered once it is cancelled */
+		TWeakPtr<FSurrealPilotRequestState> RequestState;
+	};
+	
+	/** How the context fields of a request body were sent */
+	struct FContextUpload
+	{
+		/** Rebuilds the body with every context inline and in full; set only when some context went out as a reference or a delta */
+		TFunction<TArray<uint8>()> BuildInlineBody;
+		
+		/** Rebuilds the body against what another endpoint stores, when a retry fails over to it; set along with BuildInlineBody */
+		TFunction<TArray<uint8>(const FString&, FContextUpload&)> BuildForEndpoint;
+		
+		/** Contexts sent as a reference, and the JSON bytes they stand for */
+		int32 References = 0;
+		int64 ReferencedBytes = 0;
+		
+		/** Contexts sent inline with their hash */
+		int32 Uploads = 0;
+		int64 UploadedBytes = 0;
+		
+		/** Asset whose export the body carries, the version it brings the server to, and that export */
+		FString AssetPath;
+		FString AssetVersion;
+		TSharedPtr<FJsonObject> AssetContext;
+		
+		/** Whether the export went out as a delta against the acknowledged version, and the JSON bytes of delta and export */
+		bool bAssetDelta = false;
+		int64 DeltaBytes = 0;
+		int64 AssetBytes = 0;
+	};
+	
+	/** Everything needed to issue a request again, for retries and the compression fallback */
+	struct FRequestAttempt
+	{
+		FString Verb;
+		FString Endpoint;
+		ESurrealPilotRequestPriority Priority = ESurrealPilotRequestPriority::BackgroundContext;
+		
+		/** Binds the caller's delegates to each new request */
+		TFunction<void(FHttpRequestPtr)> BindHandlers;
+		
+		/** Uncompressed body, kept while a compressed copy is in flight */
+		TSharedPtr<TArray<uint8>> PlainBody;
+		
+		/** Base URL of the current attempt, which is also its circuit breaker key */
+		FString BaseUrl;
+		
+		/** Retries made so far */
+		int32 RetryCount = 0;
+		
+		/** Whether the current attempt is the one request a half-open circuit let through */
+		bool bCircuitProbe = false;
+		
+		/** Whether retryable failures may be retried at all */
+		bool bAllowRetry = true;
+		
+		/** Shared with the handles returned to the caller */
+		TSharedRef<FSurrealPilotRequestState> State = MakeShared<FSurrealPilotRequestState>();
+		
+		/** Caller's completion delegate for the current attempt, used to report a timeout */
+		FHttpRequestCompleteDelegate OnComplete;
+		
+		/** AI provider, for chat requests, so latency can be broken down by provider */
+		FString Provider;
+		
+		/** SSE progress of a chat request, read for time to first event */
+		TSharedPtr<FSSEStreamState> StreamState;
+		
+		/** Seconds from sending the current attempt to its first response header, negative until one arrives */
+		double FirstByteSeconds = -1.0;
+		
+		/** Context references in the body, and how to send it inline if the server no longer has them */
+		FContextUpload ContextUpload;
+		
+		/** Body for the next attempt instead of the previous request's, when it has to change */
+		TSharedPtr<TArray<uint8>> ReplacementBody;
+		
+		/** Content-Type of the body when it is not JSON */
+		FString ContentType;
+		
+		/** Builds the same body as JSON, while one in another encoding is in flight, in case the server rejects it */
+		TFunction<TArray<uint8>()> BuildJsonBody;
+	};
+	
+	/** How a request sent over the channel reports back; over HTTP the handlers BindHandlers binds do this */
+	struct FChannelCallbacks
+	{
+		/** Each streamed chat event */
+		TFunction<void(const FString&)> OnEvent;
+		
+		/** JSON body of a successful response, null if it had none */
+		TFunction<void(TSharedPtr<FJsonObject>)> OnResponse;
+		
+		/** Failure with its status and body, or 0 and an empty body when there was no response */
+		TFunction<void(int32, const FString&)> OnFailure;
+	};
+	
+	/** A request on the channel, with everything needed to send it over HTTP instead */
+	struct FChannelRequest
+	{
+		FString Endpoint;
+		ESurrealPilotRequestPriority Priority = ESurrealPilotRequestPriority::BackgroundContext;
+		TArray<uint8> Body;
+		TFunction<void(FHttpRequestPtr)> BindHandlers;
+		FContextUpload ContextUpload;
+		FString Provider;
+		TSharedPtr<FSSEStreamState> StreamState;
+		TSharedPtr<const FChannelCallbacks> Callbacks;
+		
+		/** Shared with the handles returned to the caller, and with the HTTP request if it falls back */
+		TSharedRef<FSurrealPilotRequestState> State = MakeShared<FSurrealPilotRequestState>();
+		
+		/** API base URL of the channel, and the request's id on it */
+		FString BaseUrl;
+		int32 RequestId = INDEX_NONE;
+		
+		/** Events delivered so far; once there are any, the request can no longer move to HTTP */
+		int32 EventCount = 0;
+		
+		/** For the latency histograms */
+		double SentTime = 0.0;
+		double FirstFrameSeconds = -1.0;
+		double FirstEventSeconds = -1.0;
+		int64 ResponseBytes = 0;
+	};
+	
+	/** A context message waiting for the next batch */
+	struct FQueuedContext
+	{
+		FString Type;
+		TSharedPtr<FJsonObject> Data;
+		FString SupersedeKey;
+		ESurrealPilotRequestPriority Priority = ESurrealPilotRequestPriority::BackgroundContext;
+		
+		/** Replaced by a newer message with the same key; skipped when the batch is sent */
+		bool bSuperseded = false;
+	};
 
 private:
 	FHttpClient() = default;
 	~FHttpClient() = default;
 	
-	/** Get the base API URL (localhost or SaaS) */
-	FString GetApiBaseUrl() const;
+	/** Update the endpoint list from the overrides or the local config and settings */
+	void RefreshEndpoints();
+	
+	/** Open the journal at the override or default path, or close it when the journal is turned off */
+	void RefreshContextJournal();
+	
+	/** Remove the queued messages that have not been superseded from the queue, cancelling the pending flush */
+	TArray<FQueuedContext> TakeQueuedContext();
+	
+	/** Send messages now, or journal them when the endpoint is down or older messages are still waiting in the journal */
+	void DeliverContext(TArray<FQueuedContext>&& Items);
+	
+	/** Send messages in one request, a lone message in the plain format; OnComplete gets the final status, or 0 when there was no response */
+	void SendContextItems(const TArray<FQueuedContext>& Items, TFunction<void(int32)> OnComplete);
+	
+	/** Keep messages in the journal until the endpoint is back */
+	void JournalContext(const TArray<FQueuedContext>& Items);
+	
+	/** Whether a failure means the endpoint could not take the request now, rather than that it rejected it */
+	static bool IsEndpointUnavailable(int32 ResponseCode);
+	
+	/** Feed the outcome of a request into the circuit breaker and endpoint selection */
+	void RecordEndpointResult(const FString& BaseUrl, int32 ResponseCode);
+	
+	/** Add a completed attempt to the latency histograms, and log it when HTTP debug logging is on */
+	void RecordAttemptMetrics(const FRequestAttempt& Attempt, FHttpRequestPtr Request, FHttpResponsePtr Response);
 	
 	/** Get authentication headers */
 	TMap<FString, FString> GetAuthHeaders() const;
 	
-	/** Handle streaming response */
-	void HandleStreamingResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, FOnStreamingChunk OnChunk, FOnHttpError OnError);
+	/** Handle streaming response; OnStreamEnd runs once every event of a successful response has been delivered */
+	void HandleStreamingResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, TSharedRef<FSSEStreamState> StreamState, FOnStreamingChunk OnChunk, FOnHttpError OnError,
+		TFunction<void()> OnStreamEnd);
+	
+	/** Answer a chat request from the cache: its chunks are delivered on the next tick, as fast as OnChunk takes them */
+	FSurrealPilotRequestHandle ReplayCachedChat(const FSurrealPilotCachedResponse& Cached, FOnStreamingChunk OnChunk, FOnHttpError OnError, FSimpleDelegate OnComplete);
+	
+	/** Feed the bytes received since the last call to the SSE parser; bFinal also flushes a trailing partial event */
+	static void ConsumeStreamedResponse(FHttpResponsePtr Response, FSSEStreamState& StreamState, bool bFinal, const FOnStreamingChunk& OnChunk);
+	
+	/**
+	 * Parse a JSON response body and pass the object to OnResponse; large bodies are parsed on a worker thread.
+	 * A large body is then delivered only if RequestState was not cancelled or timed out meanwhile, and finishes it.
+	 */
+	static void ParseJsonResponse(FHttpResponsePtr Response, FOnHttpResponse OnResponse, FOnHttpError OnError, TWeakPtr<FSurrealPilotRequestState> RequestState);
+	
+	/**
+	 * POST a JSON body, compressing it when enabled; BindHandlers binds the delegates and is reused if the request is resent.
+	 * ContextUpload describes the context references in the body. Provider and StreamState only feed the latency metrics.
+	 * With ChannelCallbacks the request goes over the WebSocket channel instead while it is connected.
+	 * State is the request's state if BindHandlers needs it, otherwise a new one is made.
+	 */
+	FSurrealPilotRequestHandle SendJsonRequest(const FString& Endpoint, ESurrealPilotRequestPriority Priority, TArray<uint8>&& Body, TFunction<void(FHttpRequestPtr)> BindHandlers,
+		FContextUpload ContextUpload = FContextUpload(), const FString& Provider = FString(), TSharedPtr<FSSEStreamState> StreamState = nullptr,
+		TSharedPtr<const FChannelCallbacks> ChannelCallbacks = nullptr, TSharedPtr<FSurrealPilotRequestState> State = nullptr);
+	
+	/**
+	 * POST a Compact Binary body over HTTP. If the server answers 415, the body BuildJsonBody returns is sent instead
+	 * and later requests to the same URL go out as JSON. State is as for SendJsonRequest.
+	 */
+	FSurrealPilotRequestHandle SendCompactBinaryRequest(const FString& Endpoint, ESurrealPilotRequestPriority Priority, TArray<uint8>&& Body,
+		TFunction<TArray<uint8>()> BuildJsonBody, TFunction<void(FHttpRequestPtr)> BindHandlers, TSharedPtr<FSurrealPilotRequestState> State = nullptr);
+	
+	/** POST a JSON body over HTTP, reporting through State */
+	FSurrealPilotRequestHandle SendHttpRequest(const FString& Endpoint, ESurrealPilotRequestPriority Priority, TArray<uint8>&& Body, TFunction<void(FHttpRequestPtr)> BindHandlers,
+		FContextUpload ContextUpload, const FString& Provider, TSharedPtr<FSSEStreamState> StreamState, TSharedRef<FSurrealPilotRequestState> State);
+	
+	/** Send a request over the channel, or over HTTP if the channel cannot take it */
+	void SendOverChannel(TSharedRef<FChannelRequest> Request);
+	
+	/** Handle an event or the response of a request on the channel */
+	void HandleChannelFrame(TSharedRef<FChannelRequest> Request, const FSurrealPilotChannelFrame& Frame);
+	
+	/** The channel dropped before the response: resend over HTTP, or fail if events were already delivered */
+	void HandleChannelLost(TSharedRef<FChannelRequest> Request);
+	
+	/** Send a channel request over HTTP instead, with the same handle */
+	void FallBackToHttp(TSharedRef<FChannelRequest> Request);
+	
+	/** Add a finished channel request to the latency histograms */
+	void RecordChannelMetrics(const FChannelRequest& Request, int32 ResponseCode);
+	
+	/** Callbacks that report a channel request the way the HTTP handlers of a JSON request would */
+	static TSharedRef<const FChannelCallbacks> MakeJsonChannelCallbacks(FOnHttpResponse OnResponse, FOnHttpError OnError);
+	
+	/** Report a failed chat request, with its status and body or 0 when there was no response */
+	static void ReportChatError(int32 ResponseCode, const FString& Body, const FOnHttpError& OnError);
+	
+	/**
+	 * After a server answered that it lacks context a body referred to, forget what it was thought to keep and
+	 * build the body with every context inline and in full. Returns false if the response was not such an answer.
+	 */
+	bool PrepareInlineResend(const FString& BaseUrl, int32 ResponseCode, FContextUpload& Upload, TArray<uint8>& OutBody);
+	
+	/** Count what context references and deltas saved, and learn from the response headers what the server now keeps */
+	void RecordContextUploaded(const FString& BaseUrl, const FContextUpload& Upload, TFunctionRef<FString(const FString&)> GetHeader);
+	
+	/**
+	 * Set a body on a request, as JSON unless the attempt has another content type, compressing it when enabled and
+	 * keeping the plain copy for the 415 fallback
+	 */
+	void SetJsonBody(FRequestAttempt& Attempt, FHttpRequestPtr Request, TArray<uint8>&& Body);
+	
+	/**
+	 * Build a body whose contexts go out by reference where the endpoint at ReferenceBaseUrl stores them.
+	 * Build is called with the endpoint to reference against, or an empty string to write every context inline.
+	 */
+	TArray<uint8> BuildBodyWithContext(TFunction<TArray<uint8>(const FString&, FContextUpload&)> Build, const FString& ReferenceBaseUrl, FContextUpload& OutUpload);
+	
+	/** Write a context field as Field_ref when ReferenceBaseUrl stores it, otherwise inline with a Field_hash */
+	void WriteContextField(FSurrealPilotJsonWriter& Writer, const FString& Field, const FSurrealPilotContextBlob& Blob, const FString& ReferenceBaseUrl, FContextUpload& Upload) const;
+	
+	/** Remember a request until it finishes, so shutdown can cancel it */
+	void TrackRequest(const TSharedRef<FSurrealPilotRequestState>& State);
+	
+	/** Make the attempt cancellable and send its first request */
+	FSurrealPilotRequestHandle StartAttempt(TSharedRef<FRequestAttempt> Attempt, FHttpRequestPtr Request);
+	
+	/** Send one attempt of a request through the circuit breaker and scheduler, retrying it on retryable failures */
+	void SendAttempt(TSharedRef<FRequestAttempt> Attempt, FHttpRequestPtr Request);
+	
+	/** Build the next attempt from the previous request's body and send it */
+	void ResendAttempt(TSharedRef<FRequestAttempt> Attempt, FHttpRequestPtr PreviousRequest);
+	
+	/** Run a callback on the game thread after a delay, unless the client shuts down first */
+	void RunAfterDelay(float DelaySeconds, TFunction<void()> Callback);
+	
+	/** Hand a fully prepared request to the scheduler */
+	void SubmitRequest(ESurrealPilotRequestPriority Priority, FHttpRequestPtr Request);
+	
+	/** Trim chat context to what is left of the provider's token budget after the messages, and record what was kept */
+	TSharedPtr<FJsonObject> FitContextToTokenBudget(const TArray<TSharedPtr<FJsonObject>>& Messages, const FString& Provider, const TSharedPtr<FJsonObject>& Context);
+	
+	/** Encode a chat request body as UTF-8 JSON */
+	TArray<uint8> BuildChatRequestBody(const TArray<TSharedPtr<FJsonObject>>& Messages, const FString& Provider, const TSharedPtr<const FSurrealPilotContextBlob>& Context,
+		const FString& ReferenceBaseUrl, FContextUpload& Upload);
+	
+	/** Encode a context export request body as UTF-8 JSON */
+	TArray<uint8> BuildContextRequestBody(const FString& ContextType, const FSurrealPilotContextBlob& ContextData, const FString& ReferenceBaseUrl, FContextUpload& Upload);
 	
-	/** Parse Server-Sent Events data */
-	TArray<FString> ParseSSEData(const FString& ResponseData) const;
+	/**
+	 * Encode an asset context request body: a delta against the version ReferenceBaseUrl acknowledged when there is
+	 * one and it is worth it, otherwise the full export
+	 */
+	TArray<uint8> BuildAssetContextBody(const FString& AssetPath, const FString& ContextType, const TSharedPtr<FJsonObject>& ContextData, const FSurrealPilotContextBlob& ContextBlob,
+		const FString& ReferenceBaseUrl, FContextUpload& Upload);
+	
+	/** Encode a {"type":"batch","items":[...]} context request body; Blobs holds each item's encoded data */
+	TArray<uint8> BuildContextBatchBody(const TArray<FQueuedContext>& Items, const TArray<TSharedRef<const FSurrealPilotContextBlob>>& Blobs,
+		const FString& ReferenceBaseUrl, FContextUpload& Upload);
 	
 	/** Create HTTP request with common headers */
-	FHttpRequestPtr CreateRequest(const FString& Verb, const FString& Endpoint) const;
+	FHttpRequestPtr CreateRequest(const FString& Verb, const FString& Endpoint, const FString& BaseUrl) const;
 
 private:
 	static TUniquePtr<FHttpClient> Instance;
 	
-	/** Cached API base URL */
-	mutable FString CachedApiUrl;
+	/** Base URLs that replace the configured ones, empty when unset */
+	TArray<FString> EndpointOverrides;
+	
+	/** Latest chat request of each conversation */
+	TMap<FString, FSurrealPilotRequestHandle> ActiveChats;
+	
+	/** Picks the endpoint each request goes to */
+	FSurrealPilotEndpointManager EndpointManager;
+	
+	/** Requests that had not finished when last seen, whether queued, waiting to retry or on the wire */
+	TArray<TWeakPtr<FSurrealPilotRequestState>> LiveRequests;
+	
+	/** Health probes in flight, by base URL */
+	TMap<FString, FHttpRequestPtr> ActiveProbes;
+	
+	/** Periodic probe registration */
+	FTSTicker::FDelegateHandle EndpointProbeHandle;
+	
+	/** Size of the last encoded body of each kind, used to pre-size the next one */
+	int32 LastChatBodySize = 0;
+	int32 LastContextBodySize = 0;
+	
+	/** URLs that answered a compressed body with 415 Unsupported Media Type */
+	TSet<FString> UrlsWithoutCompression;
+	
+	/** URLs that answered a Compact Binary body with 415 Unsupported Media Type */
+	TSet<FString> UrlsWithoutCompactBinary;
+	
+	/** Context messages waiting for the next batch, in arrival order */
+	TArray<FQueuedContext> QueuedContexts;
+	
+	/** Index into QueuedContexts of the live message for each supersede key */
+	TMap<FString, int32> QueuedContextIndexByKey;
+	
+	/** Queued messages that have not been superseded */
+	int32 LiveQueuedContextCount = 0;
+	
+	/** Pending flush at the end of the batch window */
+	FTSTicker::FDelegateHandle ContextFlushHandle;
+	
+	FSurrealPilotContextBatchStats ContextBatchStats;
+	
+	/** Context messages the endpoint could not take, kept on disk until it is back */
+	FSurrealPilotContextJournal ContextJournal;
+	
+	/** Journal file that replaces the default one, empty when unset */
+	FString ContextJournalPathOverride;
+	
+	/** A replay batch is in flight; the next waits for it so the journal arrives in order */
+	bool bReplayingContextJournal = false;
+	
+	/** Orders and throttles outgoing requests */
+	FSurrealPilotRequestScheduler Scheduler;
+	
+	/** Backoff settings, refreshed from USurrealPilotSettings for each attempt */
+	FSurrealPilotRetryPolicy RetryPolicy;
+	
+	/** Fails requests fast while an endpoint is down */
+	FSurrealPilotCircuitBreaker CircuitBreaker;
+	
+	/** Jitter source for retry delays */
+	FRandomStream RetryRandom;
+	
+	FSurrealPilotRetryStats RetryStats;
+	
+	FSurrealPilotTokenBudgetStats TokenBudgetStats;
+	FSurrealPilotTokenBudgetReport LastTokenBudgetReport;
+	
+	/** Latency and throughput per endpoint, route and provider */
+	FSurrealPilotHttpMetrics Metrics;
+	
+	/** Context blobs each endpoint keeps, so they can be sent by hash */
+	FSurrealPilotContextStore ContextStore;
+	
+	/** Version of each asset's context each endpoint last acknowledged, the base for deltas */
+	FSurrealPilotContextVersions ContextVersions;
+	
+	/** Chat answers for identical requests, when enabled */
+	FSurrealPilotResponseCache ResponseCache;
+	
+	/** Persistent connection to the desktop app, when enabled */
+	FSurrealPilotWebSocketChannel Channel;
+	
+	/** Ticker registrations for RunAfterDelay, removed on shutdown */
+	TMap<uint32, FTSTicker::FDelegateHandle> DelayedCalls;
+	uint32 LastDelayedCallId = 0;
 	
 	/** HTTP module reference */
 	FHttpModule* HttpModule;
@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "EditorSubsystem.h"
 #include "Dom/JsonObject.h"
+#include "SurrealPilotRequestScheduler.h"
+#include "SurrealPilotChatJobs.h"
 #include "RemoteControlIntegration.generated.h"
 
 /**
@@ -30,11 +32,29 @@ public:
     void RegisterRemoteControlEndpoints();
 
     /**
-     * Handle incoming chat request from external application
+     * Start a chat job for an external application; returns {"job_id":...} at once, and the answer is read with PollChatJob
      */
     UFUNCTION(CallInEditor = true, Category = "SurrealPilot")
     FString HandleChatRequest(const FString& Message, const FString& Provider = TEXT("openai"));
 
+    /**
+     * Get a chat job's status and the chunks from FromChunk on; pass the returned "next" back to get only newer chunks
+     */
+    UFUNCTION(CallInEditor = true, Category = "SurrealPilot")
+    FString PollChatJob(const FString& JobId, int32 FromChunk = 0);
+
+    /**
+     * Cancel a running chat job
+     */
+    UFUNCTION(CallInEditor = true, Category = "SurrealPilot")
+    bool CancelChatJob(const FString& JobId);
+
+    /**
+     * List the chat jobs still kept, with their status and chunk count
+     */
+    UFUNCTION(CallInEditor = true, Category = "SurrealPilot")
+    FString ListChatJobs();
+
     /**
      * Export current context via Remote Control
      */
@@ -66,9 +86,27 @@ public:
     FString GetCppProjectInfo();
 
     /**
-     * Send context to desktop chat automatically
+     * Get a summary of every Blueprint under RootPath, read from the Asset Registry without loading them, via Remote Control
      */
-    void SendContextToDesktopChat(const FString& ContextType, const TSharedPtr<FJsonObject>& ContextData);
+    UFUNCTION(CallInEditor = true, Category = "SurrealPilot")
+    FString GetProjectContext(const FString& RootPath = TEXT("/Game"));
+
+    /**
+     * Get HTTP latency and throughput histograms per endpoint, route and provider via Remote Control
+     */
+    UFUNCTION(CallInEditor = true, Category = "SurrealPilot")
+    FString GetHttpMetrics();
+
+    /**
+     * Send context to desktop chat automatically; while the desktop app is away it is journaled and sent once it is back
+     * @param SupersedeKey Messages with the same key replace each other while waiting to be sent
+     * @param Priority Scheduling class for the request that carries the message
+     */
+    void SendContextToDesktopChat(
+        const FString& ContextType,
+        const TSharedPtr<FJsonObject>& ContextData,
+        const FString& SupersedeKey = FString(),
+        ESurrealPilotRequestPriority Priority = ESurrealPilotRequestPriority::BackgroundContext);
 
     /**
      * Check if desktop chat is available
@@ -82,6 +120,12 @@ private:
     /** Desktop chat connection status */
     bool bDesktopChatConnected;
 
+    /** Subscription to messages the desktop app pushes over the WebSocket channel */
+    FDelegateHandle ServerPushHandle;
+
+    /** Chats started through Remote Control, read back by polling */
+    FSurrealPilotChatJobs ChatJobs;
+
     /**
      * Create Remote Control preset
      */
@@ -96,4 +140,9 @@ private:
      * Handle Remote Control property change
      */
     void OnRemoteControlPropertyChange(const FString& PropertyPath, const FString& NewValue);
+
+    /**
+     * Handle a message the desktop app pushed over the WebSocket channel
+     */
+    void OnServerPush(const FString& Type, const TSharedPtr<FJsonObject>& Body);
 };
\ No newline at end of file
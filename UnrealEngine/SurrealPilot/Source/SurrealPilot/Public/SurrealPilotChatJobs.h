@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "SurrealPilotRequestHandle.h"
+
+enum class ESurrealPilotChatJobStatus : uint8
+{
+	/** Waiting for or receiving the answer */
+	Running,
+
+	/** Every chunk of the answer has arrived */
+	Succeeded,
+
+	/** The request failed; the job's error says why */
+	Failed,
+
+	/** Cancelled by a caller */
+	Cancelled
+};
+
+/**
+ * Chat requests started on behalf of callers that cannot hold a callback, such as Remote Control clients.
+ * Each job gets an ID; its chunks are kept as they stream in so the caller can poll for the ones it has not seen yet,
+ * and any number of jobs can run at once. Finished jobs are kept for a while so a repeated poll sees the same answer.
+ * Must be used from the game thread.
+ */
+class SURREALPILOT_API FSurrealPilotChatJobs
+{
+public:
+	~FSurrealPilotChatJobs();
+
+	/** Send a chat request and return the ID of its job */
+	FString Start(const TArray<TSharedPtr<FJsonObject>>& Messages, const FString& Provider, const TSharedPtr<FJsonObject>& Context);
+
+	/**
+	 * The job's status and the chunks from FromChunk on, as {"job_id","status","chunks":[...],"next":N[,"error"]};
+	 * pass "next" back as FromChunk to get only what arrived since. Null for an unknown or expired job.
+	 */
+	TSharedPtr<FJsonObject> Poll(const FString& JobId, int32 FromChunk);
+
+	/** Stop a running job; false if it is unknown or already finished */
+	bool Cancel(const FString& JobId);
+
+	/** Stop every running job and forget every job */
+	void CancelAll();
+
+	/** Every job still kept, as {"jobs":[{"job_id","status","chunks"}],"running":N} */
+	TSharedPtr<FJsonObject> List();
+
+	/** Jobs kept, and those still running */
+	int32 Num() const { return Jobs.Num(); }
+	int32 GetRunningCount() const;
+
+	/** Seconds a finished job is kept for polling */
+	void SetRetentionSeconds(double InRetentionSeconds) { RetentionSeconds = InRetentionSeconds; }
+
+	static const TCHAR* LexToString(ESurrealPilotChatJobStatus Status);
+
+private:
+	struct FJob
+	{
+		ESurrealPilotChatJobStatus Status = ESurrealPilotChatJobStatus::Running;
+		TArray<FString> Chunks;
+		FString Error;
+		FSurrealPilotRequestHandle Handle;
+
+		/** FPlatformTime::Seconds() when the job stopped running */
+		double FinishedSeconds = 0.0;
+	};
+
+	/** Record a final status, unless the job has one already */
+	static void Finish(FJob& Job, ESurrealPilotChatJobStatus Status);
+
+	/** Forget finished jobs kept longer than the retention */
+	void PruneFinished();
+
+	/** Shared with the request's callbacks, which can outlive the job's entry here */
+	TMap<FString, TSharedRef<FJob>> Jobs;
+
+	double RetentionSeconds = 300.0;
+};
\ No newline at end of file
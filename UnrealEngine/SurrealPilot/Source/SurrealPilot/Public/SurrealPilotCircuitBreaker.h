@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class ESurrealPilotCircuitState : uint8
+{
+	/** Requests flow normally */
+	Closed,
+
+	/** The endpoint is considered down; requests fail immediately */
+	Open,
+
+	/** The cooldown has elapsed; a single probe request is allowed through */
+	HalfOpen
+};
+
+/**
+ * Per-endpoint circuit breaker.
+ * After FailureThreshold consecutive failures the circuit opens and requests fail fast for
+ * CooldownSeconds, instead of each one waiting out a connection timeout. Then one probe is let
+ * through: success closes the circuit, failure re-opens it for another cooldown.
+ * Time is passed in by the caller so behaviour is deterministic under test.
+ */
+class SURREALPILOT_API FSurrealPilotCircuitBreaker
+{
+public:
+	explicit FSurrealPilotCircuitBreaker(int32 InFailureThreshold = 5, double InCooldownSeconds = 15.0);
+
+	/** Whether a request to the endpoint may be sent now; may move an open circuit to half-open */
+	bool AllowRequest(const FString& EndpointKey, double Now);
+
+	/** Record a request that reached the endpoint and got a healthy answer */
+	void RecordSuccess(const FString& EndpointKey);
+
+	/** Record a request that could not reach the endpoint or got a server-side failure */
+	void RecordFailure(const FString& EndpointKey, double Now);
+
+	/**
+	 * Record that the probe a half-open circuit let through was cancelled or timed out before any answer.
+	 * The circuit re-opens for another cooldown without counting a failure, so a later request can probe again.
+	 */
+	void RecordAbandonedProbe(const FString& EndpointKey, double Now);
+
+	/** Current state for an endpoint (Closed if it has never been seen) */
+	ESurrealPilotCircuitState GetState(const FString& EndpointKey) const;
+
+	/** Update the thresholds (existing endpoint state is kept) */
+	void Configure(int32 InFailureThreshold, double InCooldownSeconds);
+
+	/** Forget every endpoint */
+	void Reset();
+
+private:
+	struct FEndpointState
+	{
+		ESurrealPilotCircuitState State = ESurrealPilotCircuitState::Closed;
+		int32 ConsecutiveFailures = 0;
+		double OpenedAt = 0.0;
+	};
+
+	TMap<FString, FEndpointState> Endpoints;
+	int32 FailureThreshold;
+	double CooldownSeconds;
+};
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+
+class FCbObjectView;
+class FCbWriter;
+
+/**
+ * Context payloads encoded as Unreal Compact Binary instead of JSON.
+ * The logical schema is the JSON one, field for field: a Compact Binary field name stores its key once per field
+ * instead of quoted and escaped, integers are varints and strings are length-prefixed UTF-8, so nothing is escaped
+ * and a reader does not scan for quotes. JSON numbers that are whole and exactly representable are written as
+ * integers and read back as numbers, so converting to JSON and back is lossless.
+ * Every payload is wrapped in an envelope, {"version":Version,"payload":{...}}, so the format can change without
+ * breaking a reader that checks it.
+ * An object with an empty key, at any depth, has no Compact Binary form; callers send it as JSON instead.
+ */
+class SURREALPILOT_API FSurrealPilotCompactBinary
+{
+public:
+	/** Version written to and required in the envelope */
+	static constexpr int32 Version = 1;
+
+	/** Content-Type of an encoded request body */
+	static const TCHAR* GetContentType();
+
+	/** Encode a JSON object in an envelope; empty if the object has an empty key */
+	static TArray<uint8> Encode(const TSharedPtr<FJsonObject>& Object);
+
+	/** Open an envelope on Writer; the next field written is the payload object, then EndEnvelope closes it */
+	static void BeginEnvelope(FCbWriter& Writer);
+	static void EndEnvelope(FCbWriter& Writer);
+
+	/**
+	 * Write a JSON object, value or number as the next field of Writer, under the name set before it if any.
+	 * An object or value with an empty key is not written, and false returned.
+	 */
+	static bool WriteJsonObject(FCbWriter& Writer, const FJsonObject& Object);
+	static bool WriteJsonValue(FCbWriter& Writer, const TSharedPtr<FJsonValue>& Value);
+	static void WriteNumber(FCbWriter& Writer, double Value);
+
+	/** Name the next field of Writer, converting it to UTF-8 */
+	static void SetName(FCbWriter& Writer, FStringView Name);
+
+	/** Write a string as the next field of Writer, converting it to UTF-8 */
+	static void WriteString(FCbWriter& Writer, FStringView Value);
+
+	/** Everything Writer holds, as bytes */
+	static TArray<uint8> Save(const FCbWriter& Writer);
+
+	/** Decode an envelope back to the JSON object it holds; null, with the reason in OutError, if Data is not one */
+	static TSharedPtr<FJsonObject> Decode(TArrayView<const uint8> Data, FString* OutError = nullptr);
+
+	/** Read an object written by WriteJsonObject back to JSON; null if it has a field JSON cannot represent */
+	static TSharedPtr<FJsonObject> ReadJsonObject(const FCbObjectView& Object);
+
+	/** Decode an envelope to JSON text, for logs and debugging; false if Data is not one */
+	static bool ToJsonString(TArrayView<const uint8> Data, FString& OutJson, bool bPretty = true);
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SurrealPilotSettings.h"
+
+/**
+ * Running totals for compressed request bodies
+ */
+struct SURREALPILOT_API FSurrealPilotCompressionStats
+{
+	/** Bodies that were sent compressed */
+	int32 CompressedRequests = 0;
+
+	/** Compressed bodies the server rejected, which were resent as plain JSON */
+	int32 Fallbacks = 0;
+
+	/** Size of the compressed bodies before compression */
+	int64 UncompressedBytes = 0;
+
+	/** Size of the compressed bodies after compression */
+	int64 CompressedBytes = 0;
+
+	/** CPU time spent compressing */
+	double CompressSeconds = 0.0;
+
+	/** Uncompressed / compressed size, 1 when nothing has been compressed */
+	double GetRatio() const { return CompressedBytes > 0 ? static_cast<double>(UncompressedBytes) / CompressedBytes : 1.0; }
+};
+
+/**
+ * zlib-based request body compression.
+ * DeflateDictionary primes the compressor with field names and values that recur throughout
+ * SurrealPilot context exports, which helps most on the small and medium bodies gzip handles poorly.
+ */
+class SURREALPILOT_API FSurrealPilotCompression
+{
+public:
+	/** Compress a body; returns false if the mode is None or compression failed. Nothing is recorded until the body is sent */
+	static bool Compress(TArrayView<const uint8> Input, ESurrealPilotRequestCompression Mode, TArray<uint8>& OutCompressed);
+
+	/** Decompress a body sent with the given Content-Encoding ("gzip" or "deflate") */
+	static bool Decompress(TArrayView<const uint8> Input, const FString& ContentEncoding, TArray<uint8>& OutDecompressed);
+
+	/** Content-Encoding header value for a mode */
+	static const TCHAR* GetContentEncoding(ESurrealPilotRequestCompression Mode);
+
+	/** Identifier sent in X-SurrealPilot-Dictionary so the server can pick the matching dictionary */
+	static const TCHAR* GetDictionaryId();
+
+	/** The preset dictionary used by DeflateDictionary */
+	static TArrayView<const uint8> GetDictionary();
+
+	/** Record a body that was sent compressed, with the time it took to compress */
+	static void RecordCompression(int64 UncompressedSize, int64 CompressedSize, double Seconds);
+
+	/** Record that a server rejected a compressed body */
+	static void RecordFallback();
+
+	/** Snapshot of the running totals */
+	static FSurrealPilotCompressionStats GetStats();
+
+	/** Clear the running totals */
+	static void ResetStats();
+
+private:
+	static FCriticalSection StatsLock;
+	static FSurrealPilotCompressionStats Stats;
+};
\ No newline at end of file
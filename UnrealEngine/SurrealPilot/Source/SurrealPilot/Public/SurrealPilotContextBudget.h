@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+
+class FSurrealPilotTokenizer;
+
+/**
+ * What fitting one context into its token budget kept and dropped
+ */
+struct SURREALPILOT_API FSurrealPilotTokenBudgetReport
+{
+	/** Vocabulary the tokens were counted with, and whether the count is exact or an estimate */
+	FString Tokenizer;
+	bool bExact = false;
+
+	/** Tokens the context was allowed */
+	int32 Budget = 0;
+
+	/** Tokens of the context as sent */
+	int32 TokensUsed = 0;
+
+	/** Tokens of the sections and elements that were left out */
+	int32 TokensDropped = 0;
+
+	/** Sections left out entirely, and sections cut short with how much of them was kept */
+	TArray<FString> DroppedSections;
+	TArray<FString> TruncatedSections;
+
+	/** One-line summary for logs */
+	FString ToString() const;
+};
+
+/**
+ * Running totals across chat requests
+ */
+struct SURREALPILOT_API FSurrealPilotTokenBudgetStats
+{
+	/** Chat requests whose context was measured */
+	int32 Requests = 0;
+
+	/** Of those, the ones that had to be trimmed */
+	int32 TrimmedRequests = 0;
+
+	int64 TokensUsed = 0;
+	int64 TokensDropped = 0;
+};
+
+/**
+ * Trims a context object to a token budget, keeping the most useful parts.
+ * Short top-level scalar fields (names, paths, types) are kept first, as far as the budget goes. Sections are then
+ * added by priority: selection, then build errors, then Blueprint graphs, variables and functions, then the scene,
+ * then anything else, long top-level strings included. A section that does not fit is cut short element by element,
+ * or a string character by character, rather than dropped whole.
+ */
+class SURREALPILOT_API FSurrealPilotContextBudget
+{
+public:
+	/** A copy of Context that fits in Budget tokens; Context itself is not modified */
+	static TSharedPtr<FJsonObject> Trim(const TSharedPtr<FJsonObject>& Context, const FSurrealPilotTokenizer& Tokenizer, int32 Budget, FSurrealPilotTokenBudgetReport& OutReport);
+
+	/** Tokens of a JSON value as it is sent (condensed UTF-8) */
+	static int32 CountTokens(const FSurrealPilotTokenizer& Tokenizer, const TSharedPtr<FJsonValue>& Value);
+
+	/** Priority of a top-level context section; lower is kept first */
+	static int32 GetSectionPriority(const FString& Key);
+};
\ No newline at end of file
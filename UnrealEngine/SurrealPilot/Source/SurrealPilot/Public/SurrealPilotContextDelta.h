@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+
+/**
+ * RFC 6902-style patches between two exports of the same asset.
+ *
+ * Arrays whose elements are all objects with a unique "guid" field (graphs, nodes, pins, variables) are
+ * diffed by GUID rather than by index: their elements are addressed as /graphs/<guid>/nodes/<guid>, a
+ * moved node is a pair of posX/posY replaces and an added one is a single "add" appended to its array.
+ * Any other array that changed is replaced whole. Applying Diff(Base, Target) to Base gives back an
+ * object that encodes to exactly the same canonical JSON as Target, so both sides agree on its hash.
+ */
+class SURREALPILOT_API FSurrealPilotContextDelta
+{
+public:
+	/** Operations that turn Base into Target, empty when they are equal */
+	static TArray<TSharedPtr<FJsonValue>> Diff(const TSharedPtr<FJsonObject>& Base, const TSharedPtr<FJsonObject>& Target);
+
+	/** Apply operations to a copy of Base; Base itself is not modified. Returns null if an operation does not fit Base. */
+	static TSharedPtr<FJsonObject> Apply(const TSharedPtr<FJsonObject>& Base, const TArray<TSharedPtr<FJsonValue>>& Operations);
+};
+
+/**
+ * Counters for asset context sent as a delta instead of in full
+ */
+struct SURREALPILOT_API FSurrealPilotContextDeltaStats
+{
+	/** Uploads sent as a delta against the version the server acknowledged */
+	int32 Deltas = 0;
+
+	/** Uploads sent in full: the first of an asset, or one whose delta would not have been much smaller */
+	int32 FullUploads = 0;
+
+	/** Deltas the server rejected because its version of the asset differed, and which were resent in full */
+	int32 Divergences = 0;
+
+	/** JSON bytes of the deltas sent */
+	int64 DeltaBytes = 0;
+
+	/** JSON bytes of the full exports those deltas replaced */
+	int64 FullBytesReplaced = 0;
+};
+
+/**
+ * The last version of each asset's context an endpoint acknowledged, kept so the next upload can be a delta.
+ * Each entry holds the acknowledged export itself, which is the base the next delta is computed from.
+ */
+class SURREALPILOT_API FSurrealPilotContextVersions
+{
+public:
+	/**
+	 * Response header a server sends with the version hash it now holds of the uploaded asset.
+	 * Deltas only go to endpoints that have sent it, so servers that do not keep versions receive full exports.
+	 */
+	static const TCHAR* VersionHeader;
+
+	struct FVersion
+	{
+		/** Content hash of the export, as FSurrealPilotContextBlob computes it */
+		FString Hash;
+
+		/** The export itself; never modified after it is recorded */
+		TSharedPtr<FJsonObject> Context;
+	};
+
+	/** Version of AssetPath that BaseUrl last acknowledged, or null if it has none */
+	const FVersion* Find(const FString& BaseUrl, const FString& AssetPath) const;
+
+	/** Record that BaseUrl now has this version of AssetPath */
+	void Acknowledge(const FString& BaseUrl, const FString& AssetPath, const FString& Hash, const TSharedPtr<FJsonObject>& Context);
+
+	/** Forget the version BaseUrl has of AssetPath, after it rejected a delta against it */
+	void Forget(const FString& BaseUrl, const FString& AssetPath);
+
+	FSurrealPilotContextDeltaStats& GetStats() { return Stats; }
+	const FSurrealPilotContextDeltaStats& GetStats() const { return Stats; }
+
+private:
+	TMap<FString, TMap<FString, FVersion>> Versions;
+	FSurrealPilotContextDeltaStats Stats;
+};
\ No newline at end of file
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Containers/Ticker.h"
+
+/**
+ * A context message waiting in the journal for the endpoint to come back
+ */
+struct SURREALPILOT_API FSurrealPilotJournalEntry
+{
+	/** Order the message was recorded in, which is also the order it is replayed in */
+	int64 Sequence = 0;
+
+	FString Type;
+	TSharedPtr<FJsonObject> Data;
+
+	/** A newer message with the same non-empty key replaces this one */
+	FString SupersedeKey;
+
+	/** ESurrealPilotRequestPriority the message was queued with */
+	uint8 Priority = 0;
+};
+
+/**
+ * Counters for the journal since it was opened
+ */
+struct SURREALPILOT_API FSurrealPilotJournalStats
+{
+	/** Messages recorded, and those later replaced by a newer message with the same key */
+	int32 Appended = 0;
+	int32 Superseded = 0;
+
+	/** Messages removed after being delivered */
+	int32 Delivered = 0;
+
+	/** Oldest messages dropped to stay under the entry limit */
+	int32 Dropped = 0;
+
+	/** Batched appends to the file, the bytes they wrote, and rewrites that dropped dead records */
+	int32 DiskWrites = 0;
+	int64 BytesWritten = 0;
+	int32 Compactions = 0;
+};
+
+/**
+ * Append-only journal of context messages that could not be delivered, kept on disk so they survive an
+ * editor restart. Each line of the file is a JSON record: {"seq":N,"type":...,"key":...,"priority":N,"data":{...}}
+ * for a message, or {"done":[N,...]} for messages that were delivered. A message is superseded by a later one
+ * with the same key. Appends are buffered and written together after a short delay, and the file is rewritten
+ * with only the live messages once dead records outnumber them. Must be used from the game thread.
+ */
+class SURREALPILOT_API FSurrealPilotContextJournal
+{
+public:
+	~FSurrealPilotContextJournal();
+
+	/** Saved/SurrealPilot/ContextJournal.jsonl */
+	static FString GetDefaultPath();
+
+	/** Load the journal at FilePath, creating it on first append; flushes and replaces any journal already open */
+	void Open(const FString& InFilePath);
+
+	/** Write what is buffered and stop using the file */
+	void Close();
+
+	bool IsOpen() const { return !FilePath.IsEmpty(); }
+	const FString& GetFilePath() const { return FilePath; }
+
+	/** Record a message; it reaches the disk with the next batched write */
+	void Append(const FString& Type, const TSharedPtr<FJsonObject>& Data, const FString& SupersedeKey, uint8 Priority);
+
+	/** Oldest live messages, at most MaxEntries, in the order they were recorded */
+	TArray<FSurrealPilotJournalEntry> Peek(int32 MaxEntries) const;
+
+	/** Remove messages that have been delivered */
+	void Remove(const TArray<int64>& Sequences);
+
+	/** Messages waiting to be delivered */
+	int32 Num() const { return Entries.Num(); }
+	bool IsEmpty() const { return Entries.Num() == 0; }
+
+	/** Write buffered records to the file now */
+	void Flush();
+
+	/** Rewrite the file with only the live messages */
+	void Compact();
+
+	/** Most messages kept; the oldest are dropped beyond this */
+	void SetMaxEntries(int32 InMaxEntries) { MaxEntries = FMath::Max(1, InMaxEntries); }
+
+	/** Seconds appends wait for others before they are written together */
+	void SetFlushDelay(float InFlushDelaySeconds) { FlushDelaySeconds = FMath::Max(0.0f, InFlushDelaySeconds); }
+
+	const FSurrealPilotJournalStats& GetStats() const { return Stats; }
+
+private:
+	/** Apply one line of the file to the live messages */
+	void Load(const FString& Line);
+
+	/** Add a message, replacing an older one with the same key; returns whether one was replaced */
+	bool AddEntry(FSurrealPilotJournalEntry&& Entry);
+
+	/** Drop the live message with this sequence; returns false if there is none */
+	bool RemoveEntry(int64 Sequence);
+
+	/** Compact once dead records make up most of the file */
+	void CompactIfWasteful();
+
+	/** Once a compaction has replaced the file, drop the buffered records and count only the live messages */
+	void DiscardRewrittenRecords();
+
+	/** Add an encoded line to the write buffer, flushing when the buffer is large or scheduling a flush */
+	void BufferRecord(const TArray<uint8>& Record);
+
+	/** Record that these messages are gone, so they are not loaded again */
+	void BufferDoneRecord(const TArray<int64>& Sequences);
+
+	static TArray<uint8> EncodeEntry(const FSurrealPilotJournalEntry& Entry);
+
+private:
+	FString FilePath;
+
+	/** Live messages in sequence order */
+	TArray<FSurrealPilotJournalEntry> Entries;
+
+	/** Sequence of the live message holding each key */
+	TMap<FString, int64> SequenceByKey;
+
+	int64 LastSequence = 0;
+
+	/** Records in the file, and how many of them no longer describe a live message */
+	int32 FileRecords = 0;
+	int32 DeadRecords = 0;
+
+	/** Encoded lines not yet written */
+	TArray<uint8> WriteBuffer;
+	FTSTicker::FDelegateHandle FlushHandle;
+
+	int32 MaxEntries = 10000;
+	float FlushDelaySeconds = 1.0f;
+
+	FSurrealPilotJournalStats Stats;
+};
\ No newline at end of file
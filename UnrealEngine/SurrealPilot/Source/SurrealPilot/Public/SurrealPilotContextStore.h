@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+
+/**
+ * A context object encoded once as canonical JSON, with its content hash
+ */
+struct SURREALPILOT_API FSurrealPilotContextBlob
+{
+	/**
+	 * "sha1:<hex>" of Json without its volatile fields, empty when the blob was encoded without a hash.
+	 * Volatile fields such as "timestamp" are stamped anew on every export, so leaving them out lets an unchanged
+	 * context keep its hash; they are still sent, and a reference resolves to the copy first sent.
+	 */
+	FString Hash;
+
+	/** Condensed UTF-8 JSON with object keys in ordinal order, so equal contexts hash equally */
+	TArray<uint8> Json;
+
+	/** Encode a context object, hashing it when bHash is set */
+	static TSharedRef<const FSurrealPilotContextBlob> Encode(const TSharedPtr<FJsonObject>& Object, bool bHash);
+};
+
+/**
+ * Counters for context sent by reference instead of inline
+ */
+struct SURREALPILOT_API FSurrealPilotContextDedupStats
+{
+	/** Contexts sent as a hash reference */
+	int32 References = 0;
+
+	/** Contexts sent inline with their hash so the server can keep them */
+	int32 Uploads = 0;
+
+	/** Requests resent inline because the server no longer had a referenced context */
+	int32 Misses = 0;
+
+	/** JSON bytes of the inline uploads */
+	int64 BytesUploaded = 0;
+
+	/** JSON bytes that did not have to be sent because a reference replaced them */
+	int64 BytesSaved = 0;
+};
+
+/**
+ * Tracks which context blobs each endpoint has confirmed it stores.
+ * A server lists the hashes it kept in the X-SurrealPilot-Context-Stored response header; only those are
+ * sent by reference afterwards, so servers without content-addressed storage keep receiving inline context.
+ */
+class SURREALPILOT_API FSurrealPilotContextStore
+{
+public:
+	/** Response header listing the hashes a server stored, comma separated */
+	static const TCHAR* StoredHeader;
+
+	/** Whether BaseUrl has confirmed it stores Hash */
+	bool IsStored(const FString& BaseUrl, const FString& Hash) const;
+
+	/** Remember the hashes listed in a StoredHeader value */
+	void MarkStored(const FString& BaseUrl, const FString& HeaderValue);
+
+	/** Forget everything BaseUrl confirmed, after it failed to resolve a reference (e.g. it restarted) */
+	void Forget(const FString& BaseUrl);
+
+	FSurrealPilotContextDedupStats& GetStats() { return Stats; }
+	const FSurrealPilotContextDedupStats& GetStats() const { return Stats; }
+
+private:
+	TMap<FString, TSet<FString>> StoredHashes;
+	FSurrealPilotContextDedupStats Stats;
+};
\ No newline at end of file
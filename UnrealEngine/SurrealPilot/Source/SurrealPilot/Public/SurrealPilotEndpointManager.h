@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * What is known about one API endpoint
+ */
+struct SURREALPILOT_API FSurrealPilotEndpointStatus
+{
+	/** Base URL, e.g. http://127.0.0.1:8000 */
+	FString BaseUrl;
+
+	/** False after a failed probe or request, until a probe or request succeeds */
+	bool bHealthy = true;
+
+	/** Whether a probe has succeeded, so RoundTripSeconds is meaningful */
+	bool bMeasured = false;
+
+	/** Smoothed round-trip time of health probes */
+	double RoundTripSeconds = 0.0;
+
+	/** Failed probes and requests since the last success */
+	int32 ConsecutiveFailures = 0;
+
+	/** Probes completed, successful or not */
+	int32 Probes = 0;
+};
+
+/**
+ * Chooses which configured endpoint (desktop app, SaaS) requests go to.
+ * Endpoints are listed in order of preference. Requests go to the healthy endpoint with the lowest
+ * probe round-trip time, falling back to preference order until probes have been measured.
+ * A failure marks the endpoint unhealthy at once so the next attempt goes elsewhere; a probe or
+ * request that succeeds brings it back. The manager only keeps state; FHttpClient sends the probes.
+ */
+class SURREALPILOT_API FSurrealPilotEndpointManager
+{
+public:
+	/** Replace the endpoint list, in order of preference; state is kept for URLs already known */
+	void SetEndpoints(const TArray<FString>& BaseUrls);
+
+	/** Endpoint requests should go to now (empty when none are configured) */
+	FString GetActiveEndpoint() const;
+
+	/** Record the outcome of a health probe */
+	void RecordProbe(const FString& BaseUrl, bool bSucceeded, double RoundTripSeconds);
+
+	/** Record a request the endpoint answered without a server-side failure */
+	void RecordSuccess(const FString& BaseUrl);
+
+	/** Record a request that got no answer or a server-side failure */
+	void RecordFailure(const FString& BaseUrl);
+
+	const TArray<FSurrealPilotEndpointStatus>& GetEndpoints() const { return Endpoints; }
+
+	/** Times the active endpoint has changed */
+	int32 GetSwitchCount() const { return SwitchCount; }
+
+private:
+	FSurrealPilotEndpointStatus* FindEndpoint(const FString& BaseUrl);
+
+	/** Pick the active endpoint again after its or another endpoint's state changed */
+	void Reevaluate();
+
+private:
+	TArray<FSurrealPilotEndpointStatus> Endpoints;
+	int32 ActiveIndex = INDEX_NONE;
+	int32 SwitchCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Containers/List.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UBlueprint;
+class UEdGraph;
+struct FEdGraphEditAction;
+
+/**
+ * Counters for Blueprint graph exports served from the cache
+ */
+struct SURREALPILOT_API FSurrealPilotGraphContextCacheStats
+{
+	/** Graphs exported from the cache, and those walked again */
+	int32 Hits = 0;
+	int32 Misses = 0;
+
+	/** Fragments dropped because their graph changed */
+	int32 Invalidations = 0;
+
+	/** Fragments kept after a Blueprint-wide change because their graph's fingerprint had not changed */
+	int32 Revalidated = 0;
+
+	/** Fragments evicted to stay under the memory cap */
+	int32 Evictions = 0;
+
+	double GetHitRate() const { return Hits + Misses > 0 ? static_cast<double>(Hits) / (Hits + Misses) : 0.0; }
+};
+
+/**
+ * LRU cache of the JSON exported for each Blueprint graph, so re-exporting a large Blueprint only walks the graphs
+ * that changed since the last export.
+ * A fragment is dropped when its graph reports a change or when the graph or one of its nodes is modified. A change
+ * to the whole Blueprint (OnChanged, OnCompiled) does not say which graphs it touched, so it only marks the
+ * Blueprint's fragments to be checked against a fingerprint of their graph's nodes and pins on next use.
+ * Fragments are shared by every export that uses them and must not be modified. Must be used from the game thread.
+ */
+class SURREALPILOT_API FSurrealPilotGraphContextCache
+{
+public:
+	~FSurrealPilotGraphContextCache();
+
+	/** The fragment for Graph if it is still fresh, or null */
+	TSharedPtr<FJsonObject> Find(const UEdGraph* Graph);
+
+	/** The fragment for Graph, or Export's result, which is cached for Owner's next export */
+	TSharedPtr<FJsonObject> FindOrExport(UBlueprint* Owner, UEdGraph* Graph, TFunctionRef<TSharedPtr<FJsonObject>()> Export);
+
+	/** Cache Fragment for Owner's next export of Graph, after Find missed; Fingerprint is the graph's when it was exported */
+	void Add(UBlueprint* Owner, UEdGraph* Graph, const TSharedPtr<FJsonObject>& Fragment, uint32 Fingerprint);
+
+	/** Drop Graph's fragment */
+	void Invalidate(const UEdGraph* Graph);
+
+	/** Drop every fragment and stop listening for changes */
+	void Clear();
+
+	/** Memory the fragments may take; the least recently used are evicted beyond it */
+	void SetMaxBytes(int64 InMaxBytes);
+
+	/** Fragments kept and their estimated size */
+	int32 Num() const { return Entries.Num(); }
+	int64 GetBytes() const { return Bytes; }
+
+	const FSurrealPilotGraphContextCacheStats& GetStats() const { return Stats; }
+	FSurrealPilotGraphContextCacheStats& GetStats() { return Stats; }
+
+	/** Hash of everything a graph's exported fragment holds: its nodes' positions, titles and member names, and their pins */
+	static uint32 ComputeFingerprint(const UEdGraph* Graph);
+
+	/** Approximate memory held by a JSON object, for the cap */
+	static int64 EstimateBytes(const TSharedPtr<FJsonObject>& Object);
+
+private:
+	struct FEntry
+	{
+		TSharedPtr<FJsonObject> Fragment;
+		int64 Bytes = 0;
+
+		/** Fingerprint of the graph when it was exported, checked when the entry is suspect */
+		uint32 Fingerprint = 0;
+		bool bSuspect = false;
+
+		TWeakObjectPtr<UEdGraph> Graph;
+		FObjectKey Owner;
+		FDelegateHandle GraphChangedHandle;
+
+		/** Position in LruOrder */
+		TDoubleLinkedList<FObjectKey>::TDoubleLinkedListNode* Node = nullptr;
+	};
+
+	/** Change notifications for a Blueprint with cached graphs */
+	struct FOwnerWatch
+	{
+		TWeakObjectPtr<UBlueprint> Blueprint;
+		FDelegateHandle ChangedHandle;
+		FDelegateHandle CompiledHandle;
+		int32 Graphs = 0;
+	};
+
+	void Remove(const FObjectKey& GraphKey);
+
+	void OnGraphChanged(const FEdGraphEditAction& Action, FObjectKey GraphKey);
+	void OnBlueprintChanged(UBlueprint* Blueprint);
+	void OnObjectModified(UObject* Object);
+
+	TMap<FObjectKey, FEntry> Entries;
+
+	/** Graph keys from most to least recently used */
+	TDoubleLinkedList<FObjectKey> LruOrder;
+
+	TMap<FObjectKey, FOwnerWatch> Owners;
+	FDelegateHandle ObjectModifiedHandle;
+
+	int64 Bytes = 0;
+	int64 MaxBytes = 64 * 1024 * 1024;
+
+	FSurrealPilotGraphContextCacheStats Stats;
+};
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+
+/**
+ * Log-bucketed histogram for latencies, sizes and rates.
+ * Buckets are a quarter octave wide (about 19%), so percentiles are accurate to within that
+ * while memory stays fixed no matter how many values are added.
+ */
+class SURREALPILOT_API FSurrealPilotHistogram
+{
+public:
+	FSurrealPilotHistogram();
+
+	void Add(double Value);
+
+	int64 GetCount() const { return Count; }
+	double GetMin() const { return Count > 0 ? Min : 0.0; }
+	double GetMax() const { return Count > 0 ? Max : 0.0; }
+	double GetMean() const { return Count > 0 ? Sum / Count : 0.0; }
+
+	/** Approximate value below which Percentile percent (0-100) of the values fall */
+	double GetPercentile(double Percentile) const;
+
+	void Reset();
+
+	/** {count, min, mean, p50, p95, p99, max} */
+	TSharedRef<FJsonObject> ToJson() const;
+
+private:
+	static int32 GetBucketIndex(double Value);
+	static double GetBucketValue(int32 BucketIndex);
+
+private:
+	TArray<uint32> Buckets;
+	int64 Count;
+	double Sum;
+	double Min;
+	double Max;
+};
+
+/**
+ * Measurements for one completed HTTP attempt
+ */
+struct SURREALPILOT_API FSurrealPilotRequestSample
+{
+	FString Verb;
+	FString BaseUrl;
+
+	/** Path such as /api/chat */
+	FString Route;
+
+	/** AI provider for chat requests, empty otherwise */
+	FString Provider;
+
+	/** 0 when no response arrived */
+	int32 ResponseCode = 0;
+
+	/** Seconds from sending to the first response header, negative when none arrived */
+	double FirstByteSeconds = -1.0;
+
+	/** Seconds from sending to the first streamed SSE event, negative when none was streamed */
+	double FirstEventSeconds = -1.0;
+
+	/** Seconds from sending to completion */
+	double TotalSeconds = 0.0;
+
+	int64 RequestBytes = 0;
+	int64 ResponseBytes = 0;
+
+	/** SSE events delivered while the response was streaming */
+	int32 EventCount = 0;
+
+	/** One-line summary for debug logging */
+	FString ToString() const;
+};
+
+/**
+ * Histograms for one endpoint, route and provider
+ */
+struct SURREALPILOT_API FSurrealPilotEndpointMetrics
+{
+	FString BaseUrl;
+	FString Route;
+	FString Provider;
+
+	int32 Requests = 0;
+
+	/** Attempts that got no response or a non-2xx status */
+	int32 Failures = 0;
+
+	FSurrealPilotHistogram FirstByteMs;
+	FSurrealPilotHistogram FirstEventMs;
+	FSurrealPilotHistogram TotalMs;
+	FSurrealPilotHistogram RequestBytes;
+	FSurrealPilotHistogram ResponseBytes;
+	FSurrealPilotHistogram EventsPerSecond;
+
+	TSharedRef<FJsonObject> ToJson() const;
+};
+
+/**
+ * Latency and throughput histograms for the HTTP layer, per endpoint, route and provider.
+ * The HTTP module does not report DNS or connect timings, so health-probe round trips to each
+ * endpoint stand in for connection cost. Must be used from the game thread.
+ */
+class SURREALPILOT_API FSurrealPilotHttpMetrics
+{
+public:
+	/** Add a completed attempt and publish it to the stats system */
+	void Record(const FSurrealPilotRequestSample& Sample);
+
+	/** Add a health-probe round trip for an endpoint */
+	void RecordProbe(const FString& BaseUrl, double RoundTripSeconds);
+
+	/** Histograms for one series, or null if nothing has been recorded for it */
+	const FSurrealPilotEndpointMetrics* Find(const FString& BaseUrl, const FString& Route, const FString& Provider = FString()) const;
+
+	/** Every series and probe histogram as {"series":[...],"probes":{...}} */
+	TSharedRef<FJsonObject> ToJson() const;
+
+	/** Human-readable table for the console */
+	FString ToReport() const;
+
+	void Reset();
+
+private:
+	static FString MakeKey(const FString& BaseUrl, const FString& Route, const FString& Provider);
+
+private:
+	TMap<FString, FSurrealPilotEndpointMetrics> Series;
+	TMap<FString, FSurrealPilotHistogram> ProbeRoundTripMs;
+};
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+
+/**
+ * Condensed JSON writer that encodes straight into a UTF-8 byte buffer.
+ * Used to build request bodies without an intermediate UTF-16 FString, so the finished
+ * buffer can be handed to IHttpRequest::SetContent by move.
+ */
+class SURREALPILOT_API FSurrealPilotJsonWriter
+{
+public:
+	/**
+	 * @param InitialCapacity Bytes to reserve up front (e.g. the size of the previous payload of the same kind)
+	 */
+	explicit FSurrealPilotJsonWriter(int32 InitialCapacity = 0);
+
+	/** Begin an object as an array element or as the root value */
+	void BeginObject();
+
+	/** Begin an object as a field of the enclosing object */
+	void BeginObject(FStringView Key);
+
+	/** End the current object */
+	void EndObject();
+
+	/** Begin an array as an array element or as the root value */
+	void BeginArray();
+
+	/** Begin an array as a field of the enclosing object */
+	void BeginArray(FStringView Key);
+
+	/** End the current array */
+	void EndArray();
+
+	/** Write a string field / array element */
+	void WriteString(FStringView Key, FStringView Value);
+	void WriteString(FStringView Value);
+
+	/** Write an integer field / array element */
+	void WriteInteger(FStringView Key, int64 Value);
+	void WriteInteger(int64 Value);
+
+	/** Write a floating point field / array element */
+	void WriteNumber(FStringView Key, double Value);
+	void WriteNumber(double Value);
+
+	/** Write a boolean field / array element */
+	void WriteBool(FStringView Key, bool bValue);
+	void WriteBool(bool bValue);
+
+	/** Write a null field / array element */
+	void WriteNull(FStringView Key);
+	void WriteNull();
+
+	/** Serialize a JSON DOM value as a field / array element, without going through FString */
+	void WriteJsonValue(FStringView Key, const TSharedPtr<FJsonValue>& Value);
+	void WriteJsonValue(const TSharedPtr<FJsonValue>& Value);
+
+	/** Serialize a JSON DOM object as a field / array element (null if the object is invalid) */
+	void WriteJsonObject(FStringView Key, const TSharedPtr<FJsonObject>& Object);
+	void WriteJsonObject(const TSharedPtr<FJsonObject>& Object);
+
+	/** Splice an already-encoded UTF-8 JSON value in as a field / array element */
+	void WriteRawValue(FStringView Key, TArrayView<const uint8> Utf8Json);
+	void WriteRawValue(TArrayView<const uint8> Utf8Json);
+
+	/** Write object fields in ordinal key order instead of insertion order, so equal objects encode to equal bytes */
+	void SetSortKeys(bool bInSortKeys) { bSortKeys = bInSortKeys; }
+
+	/** The encoded bytes written so far */
+	const TArray<uint8>& GetBuffer() const { return Buffer; }
+
+	/** Take ownership of the encoded bytes, leaving the writer empty */
+	TArray<uint8> MoveBuffer();
+
+	/** Bytes copied into the buffer, including copies made when the buffer had to grow */
+	int64 GetBytesCopied() const { return BytesWritten + BytesMovedByGrowth; }
+
+	/** Number of times the buffer had to grow */
+	int32 GetGrowthCount() const { return GrowthCount; }
+
+	/** Largest allocation the writer has held */
+	SIZE_T GetPeakAllocatedSize() const { return PeakAllocatedSize; }
+
+private:
+	/** Emit the comma separating this value from the previous one in the current container */
+	void BeginValue();
+
+	/** Emit the separator and "Key": for a field of the current object */
+	void WriteKey(FStringView Key);
+
+	void WriteEscapedString(FStringView Value);
+	void WriteNumberOnly(double Value);
+	void WriteJsonValueOnly(const TSharedPtr<FJsonValue>& Value);
+	void WriteJsonObjectOnly(const FJsonObject& Object);
+
+	void Append(const void* Data, int32 Num);
+	void AppendByte(uint8 Byte);
+	void Reserve(int32 AdditionalBytes);
+
+private:
+	TArray<uint8> Buffer;
+
+	/** Per open container: whether a value has already been written (so the next needs a comma) */
+	TArray<bool, TInlineAllocator<32>> ContainerHasValue;
+
+	bool bSortKeys;
+	int64 BytesWritten;
+	int64 BytesMovedByGrowth;
+	int32 GrowthCount;
+	SIZE_T PeakAllocatedSize;
+};
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "HAL/ThreadSafeCounter.h"
+
+struct FFileChangeData;
+
+/**
+ * Immutable in-memory view of ~/.surrealpilot/config.json
+ */
+struct SURREALPILOT_API FSurrealPilotLocalConfigSnapshot
+{
+	/** Whether the file existed and parsed as JSON */
+	bool bLoaded = false;
+
+	/** API key for SaaS authentication */
+	FString ApiKey;
+
+	/** Precomputed Authorization header value, empty when no key is configured */
+	FString AuthorizationHeader;
+
+	/** Desktop API port, 0 when the file does not specify one */
+	int32 Port = 0;
+
+	/** Preferred provider id (openai, anthropic, gemini, ollama), empty when unset */
+	FString PreferredProvider;
+
+	/** The parsed file, for fields without a dedicated member */
+	TSharedPtr<FJsonObject> Json;
+};
+
+/**
+ * Shared cache of the local SurrealPilot config file.
+ * The file is parsed once and re-read only after a directory watcher (or, before the watcher
+ * is available, a throttled timestamp check) reports a change, so request setup does no disk I/O.
+ */
+class SURREALPILOT_API FSurrealPilotLocalConfig
+{
+public:
+	/** Start watching the config directory for changes */
+	static void Initialize();
+
+	/** Stop watching the config directory */
+	static void Shutdown();
+
+	/** Get the shared instance (created on first use, since settings may load before the module starts) */
+	static FSurrealPilotLocalConfig& Get();
+
+	/** Current snapshot; reloads from disk only if the file is known or suspected to have changed */
+	TSharedRef<const FSurrealPilotLocalConfigSnapshot> GetSnapshot();
+
+	/** Write the config file and refresh the snapshot */
+	bool Save(const TSharedRef<FJsonObject>& ConfigJson);
+
+	/** Force the next GetSnapshot call to re-read the file */
+	void Invalidate();
+
+	/** Absolute path of the config file */
+	const FString& GetConfigPath() const { return ConfigPath; }
+
+	/** Number of times the config file has been read from disk */
+	int32 GetFileReadCount() const { return FileReadCount.GetValue(); }
+
+	~FSurrealPilotLocalConfig();
+
+private:
+	FSurrealPilotLocalConfig();
+
+	/** Parse the file into a new snapshot (caller holds SnapshotLock) */
+	void Reload();
+
+	/** Whether the file must be re-read before returning the snapshot (caller holds SnapshotLock) */
+	bool NeedsReload();
+
+	void RegisterDirectoryWatcher();
+	void UnregisterDirectoryWatcher();
+	void OnConfigDirectoryChanged(const TArray<FFileChangeData>& FileChanges);
+
+	/** Resolve ~/.surrealpilot/config.json on Windows, macOS and Linux */
+	static FString ResolveConfigPath();
+
+private:
+	static TUniquePtr<FSurrealPilotLocalConfig> Instance;
+
+	FString ConfigPath;
+
+	FCriticalSection SnapshotLock;
+	TSharedRef<const FSurrealPilotLocalConfigSnapshot> Snapshot;
+
+	/** Set by the directory watcher or Invalidate when the snapshot is stale */
+	bool bDirty;
+
+	/** Timestamp of the file when it was last read */
+	FDateTime LoadedTimestamp;
+
+	/** Last time the timestamp was polled (only used while no watcher is registered) */
+	double LastTimestampCheckTime;
+
+	/** Directory watcher registration */
+	FDelegateHandle WatcherHandle;
+	FString WatchedDirectory;
+
+	FThreadSafeCounter FileReadCount;
+};
\ No newline at end of file
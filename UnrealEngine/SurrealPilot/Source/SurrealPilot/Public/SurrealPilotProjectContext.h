@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+
+class UBlueprint;
+
+/**
+ * Counters for the project-wide Blueprint summary
+ */
+struct SURREALPILOT_API FSurrealPilotProjectContextStats
+{
+	/** Full passes over the Asset Registry, and Blueprints summarized again because they changed */
+	int32 Scans = 0;
+	int32 Refreshed = 0;
+
+	/** Where the variables and functions in the last export came from */
+	int32 MembersFromLoaded = 0;
+	int32 MembersFromCache = 0;
+	int32 MembersUnknown = 0;
+};
+
+/**
+ * Summary of every Blueprint under a content root - parent class, interfaces, variables and function signatures -
+ * built without loading a package.
+ * Parent classes and interfaces come from the tags each Blueprint saves to the Asset Registry. The registry has no
+ * readable tag for variables and functions, so those are read from Blueprints that are loaded anyway and remembered,
+ * on disk too, with a hash of the asset's tags: an unloaded Blueprint whose tags still match gets them from there,
+ * and one that has never been loaded is summarized without them.
+ * After the first export only the Blueprints the Asset Registry or the compiler reported as changed are summarized
+ * again. Must be used from the game thread.
+ */
+class SURREALPILOT_API FSurrealPilotProjectContext
+{
+public:
+	FSurrealPilotProjectContext();
+	~FSurrealPilotProjectContext();
+
+	/**
+	 * The summary as UTF-8 JSON, {"type":"Project","root","complete","blueprintCount","blueprints":[...]};
+	 * "complete" is false while the Asset Registry is still discovering assets
+	 */
+	TArray<uint8> Export(const FString& InRootPath);
+
+	/** Write the remembered variables and functions to disk, if they changed */
+	void SaveMemberCache();
+
+	/** Forget every summary and stop listening for changes; the remembered members are kept */
+	void Reset();
+
+	/** File the remembered members are kept in */
+	void SetMemberCachePath(const FString& InMemberCachePath);
+	static FString GetDefaultMemberCachePath();
+
+	/** Blueprints summarized */
+	int32 Num() const { return Entries.Num(); }
+
+	const FSurrealPilotProjectContextStats& GetStats() const { return Stats; }
+
+	/** Hash of the tags a Blueprint's members are checked against, or 0 when it has none to check */
+	static uint32 HashMemberTags(const FAssetData& AssetData);
+
+private:
+	enum class EMembersSource : uint8
+	{
+		Loaded,
+		Cache,
+		Unknown
+	};
+
+	struct FEntry
+	{
+		/** The Blueprint's summary, encoded */
+		TArray<uint8> Json;
+		EMembersSource MembersSource = EMembersSource::Unknown;
+	};
+
+	/** A Blueprint's variables and functions, encoded as JSON arrays */
+	struct FMembers
+	{
+		/** HashMemberTags of the asset when they were read */
+		uint32 TagHash = 0;
+		TArray<uint8> Variables;
+		TArray<uint8> Functions;
+	};
+
+	void Scan();
+	void RefreshDirty();
+	void Summarize(const FAssetData& AssetData);
+	bool IsUnderRoot(const FAssetData& AssetData) const;
+
+	static void ReadMembers(UBlueprint* Blueprint, FMembers& OutMembers);
+	void LoadMemberCache();
+
+	void StartListening();
+	void StopListening();
+	void MarkDirty(const FAssetData& AssetData);
+	void OnAssetRemoved(const FAssetData& AssetData);
+	void OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+	void OnBlueprintPreCompile(UBlueprint* Blueprint);
+	void OnFilesLoaded();
+
+	/** Summaries by Blueprint object path */
+	TMap<FString, FEntry> Entries;
+
+	/** Object paths to summarize again on the next export */
+	TSet<FString> Dirty;
+
+	/** Remembered members by Blueprint object path */
+	TMap<FString, FMembers> Members;
+
+	FString RootPath;
+	bool bScanned = false;
+
+	FString MemberCachePath;
+	bool bMemberCacheLoaded = false;
+	bool bMemberCacheDirty = false;
+
+	/** Size of the last export, to size the next one's buffer */
+	int32 LastExportBytes = 0;
+
+	FDelegateHandle AssetAddedHandle;
+	FDelegateHandle AssetRemovedHandle;
+	FDelegateHandle AssetRenamedHandle;
+	FDelegateHandle AssetUpdatedHandle;
+	FDelegateHandle FilesLoadedHandle;
+	FDelegateHandle PreCompileHandle;
+
+	FSurrealPilotProjectContextStats Stats;
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Interfaces/IHttpRequest.h"
+
+enum class ESurrealPilotRequestStatus : uint8
+{
+	/** Waiting for a scheduler slot or for a retry */
+	Queued,
+
+	/** On the wire */
+	InFlight,
+
+	/** Completed with a 2xx response */
+	Succeeded,
+
+	/** Completed with an error after any retries */
+	Failed,
+
+	/** Cancelled by the caller or superseded by a newer request; no further callbacks run */
+	Cancelled,
+
+	/** The deadline passed first; the error callback runs once */
+	TimedOut
+};
+
+/**
+ * State shared between a request handle and FHttpClient
+ */
+struct SURREALPILOT_API FSurrealPilotRequestState
+{
+	ESurrealPilotRequestStatus Status = ESurrealPilotRequestStatus::Queued;
+
+	/** Attempt handed to the scheduler and not yet completed */
+	FHttpRequestPtr CurrentRequest;
+
+	/** Stops the request; passed its current attempt (null between attempts) and the final status, Cancelled or TimedOut */
+	TFunction<void(FHttpRequestPtr, ESurrealPilotRequestStatus)> Abort;
+
+	FTSTicker::FDelegateHandle DeadlineHandle;
+
+	/** Whether a large response is parsed on a worker, and the request only finishes once it has been delivered */
+	bool bFinishesOnDelivery = false;
+
+	bool IsFinished() const { return Status != ESurrealPilotRequestStatus::Queued && Status != ESurrealPilotRequestStatus::InFlight; }
+};
+
+/**
+ * Handle to a request sent through FHttpClient.
+ * Copies share the same request. Dropping every handle does not cancel the request.
+ */
+class SURREALPILOT_API FSurrealPilotRequestHandle
+{
+public:
+	FSurrealPilotRequestHandle() = default;
+
+	/** Whether this handle refers to a request */
+	bool IsValid() const { return State.IsValid(); }
+
+	/** Current status (Failed for an invalid handle) */
+	ESurrealPilotRequestStatus GetStatus() const;
+
+	/** Whether the request has reached a final status */
+	bool IsFinished() const;
+
+	/** Stop the request and release its connection or queue slot; its callbacks will not run */
+	void Cancel();
+
+	/** Fail the request with a timeout if it has not finished this many seconds from now, retries included */
+	void SetDeadline(double SecondsFromNow);
+
+private:
+	friend class FHttpClient;
+
+	explicit FSurrealPilotRequestHandle(const TSharedRef<FSurrealPilotRequestState>& InState)
+		: State(InState)
+	{
+	}
+
+	/** Record a final status and drop the deadline and current attempt */
+	static void Finish(FSurrealPilotRequestState& InState, ESurrealPilotRequestStatus FinalStatus);
+
+	/** Stop a request that is still running with a final status */
+	static void Stop(const TSharedRef<FSurrealPilotRequestState>& InState, ESurrealPilotRequestStatus FinalStatus);
+
+	TSharedPtr<FSurrealPilotRequestState> State;
+};
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+
+/** Priority classes for outgoing requests, most urgent first */
+enum class ESurrealPilotRequestPriority : uint8
+{
+	/** Chat the user is waiting on */
+	InteractiveChat,
+
+	/** Results of applying a patch, which the chat is waiting to continue from */
+	PatchFeedback,
+
+	/** Context exports and editor notifications */
+	BackgroundContext,
+
+	/** Connectivity probes */
+	HealthCheck,
+
+	Count
+};
+
+/**
+ * Queue and wait-time counters for one priority class
+ */
+struct SURREALPILOT_API FSurrealPilotSchedulerClassStats
+{
+	/** Requests waiting for a slot */
+	int32 Queued = 0;
+
+	/** Requests that have been started and not yet completed */
+	int32 InFlight = 0;
+
+	/** Largest queue depth seen */
+	int32 PeakQueued = 0;
+
+	/** Requests started so far */
+	int32 Dispatched = 0;
+
+	/** Time requests spent queued before starting */
+	double TotalWaitSeconds = 0.0;
+	double MaxWaitSeconds = 0.0;
+
+	double GetAverageWaitSeconds() const { return Dispatched > 0 ? TotalWaitSeconds / Dispatched : 0.0; }
+};
+
+/**
+ * Starts HTTP requests in priority order while capping how many run at once, per class and in total,
+ * so a burst of background uploads cannot hold up the chat request the user is waiting on.
+ * Must be used from the game thread (where HTTP completion delegates run).
+ */
+class SURREALPILOT_API FSurrealPilotRequestScheduler
+{
+public:
+	FSurrealPilotRequestScheduler();
+
+	/** Start the request now if a slot is free, otherwise queue it; the completion delegate must already be bound */
+	void Submit(ESurrealPilotRequestPriority Priority, FHttpRequestPtr Request);
+
+	/** Drop a request that is still queued; returns false if it has already started (or was never submitted) */
+	bool Cancel(FHttpRequestPtr Request);
+
+	/** Cap the requests of one class that may be in flight at once */
+	void SetMaxInFlight(ESurrealPilotRequestPriority Priority, int32 MaxInFlight);
+
+	/** Cap the requests of all classes that may be in flight at once */
+	void SetMaxTotalInFlight(int32 MaxInFlight);
+
+	/** Counters for one class */
+	const FSurrealPilotSchedulerClassStats& GetStats(ESurrealPilotRequestPriority Priority) const { return Stats[static_cast<int32>(Priority)]; }
+
+	/** Requests in flight across all classes */
+	int32 GetTotalInFlight() const { return TotalInFlight; }
+
+	/** Requests queued across all classes */
+	int32 GetTotalQueued() const;
+
+	/** Clear the wait-time and peak counters (queue and in-flight counts are kept) */
+	void ResetStats();
+
+private:
+	struct FQueuedRequest
+	{
+		FHttpRequestPtr Request;
+		double EnqueueTime = 0.0;
+	};
+
+	/** Whether a request of this class may start now */
+	bool HasFreeSlot(int32 ClassIndex) const;
+
+	/** Start queued requests, highest priority first, while slots are free */
+	void PumpQueues();
+
+	void Dispatch(int32 ClassIndex, FQueuedRequest&& Queued);
+	void OnRequestFinished(int32 ClassIndex);
+
+	/** Publish queue depth and in-flight counts to the stats system */
+	void UpdateStatCounters() const;
+
+private:
+	static constexpr int32 ClassCount = static_cast<int32>(ESurrealPilotRequestPriority::Count);
+
+	/** FIFO queue per class */
+	TArray<FQueuedRequest> Queues[ClassCount];
+
+	int32 MaxInFlight[ClassCount];
+	int32 MaxTotalInFlight;
+	int32 TotalInFlight;
+
+	FSurrealPilotSchedulerClassStats Stats[ClassCount];
+};
\ No newline at end of file
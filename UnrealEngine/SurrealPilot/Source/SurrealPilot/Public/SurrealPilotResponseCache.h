@@ -0,0 +1,137 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Containers/List.h"
+
+/**
+ * A chat answer as it was streamed, kept so an identical request can be answered without the provider
+ */
+struct SURREALPILOT_API FSurrealPilotCachedResponse
+{
+	/** Data of each SSE event, in order */
+	TArray<FString> Chunks;
+
+	/** Seconds the original request took from sending to its last event */
+	double LatencySeconds = 0.0;
+
+	/** Wall-clock seconds (Unix time) when the answer was recorded, for the time to live */
+	double CreatedSeconds = 0.0;
+};
+
+/**
+ * Counters for chat requests looked up in the response cache
+ */
+struct SURREALPILOT_API FSurrealPilotResponseCacheStats
+{
+	/** Requests looked up, and those answered from memory or from disk */
+	int32 Lookups = 0;
+	int32 MemoryHits = 0;
+	int32 DiskHits = 0;
+
+	/** Entries found but past their time to live */
+	int32 Expired = 0;
+
+	/** Answers recorded, and entries evicted to stay under the size caps */
+	int32 Stores = 0;
+	int32 Evictions = 0;
+
+	/** Provider latency the hits did not have to wait for */
+	double SavedSeconds = 0.0;
+
+	double GetHitRate() const { return Lookups > 0 ? static_cast<double>(MemoryHits + DiskHits) / Lookups : 0.0; }
+};
+
+/**
+ * Two-tier LRU cache of chat answers keyed by provider, messages and context.
+ * Recently used answers stay in memory; every answer is also written to one JSON file per key under the disk
+ * directory so it survives an editor restart. Each tier evicts its least recently used entries beyond its size
+ * cap, and entries older than the time to live are ignored and removed. Must be used from the game thread.
+ */
+class SURREALPILOT_API FSurrealPilotResponseCache
+{
+public:
+	/** Saved/SurrealPilot/ResponseCache */
+	static FString GetDefaultDirectory();
+
+	/** Wall-clock seconds (Unix time), the clock entries are dated with */
+	static double GetWallClockSeconds();
+
+	/** "sha1:<hex>" of the provider, the messages and the context's content hash */
+	static FString MakeKey(const FString& Provider, const TArray<TSharedPtr<FJsonObject>>& Messages, const FString& ContextHash);
+
+	/** Set the size caps, the time to live and the disk directory; a cap of 0 turns that tier off */
+	void Configure(int64 InMaxMemoryBytes, int64 InMaxDiskBytes, double InTtlSeconds, const FString& InDiskDirectory);
+
+	/** Look up an answer that is still fresh at Now, promoting a disk hit to memory */
+	bool Find(const FString& Key, double Now, FSurrealPilotCachedResponse& OutResponse);
+
+	/** Record an answer in both tiers, replacing any older one for the key */
+	void Add(const FString& Key, const FSurrealPilotCachedResponse& Response);
+
+	/** Drop every entry, on disk too */
+	void Clear();
+
+	/** Entries and bytes held in each tier */
+	int32 GetMemoryEntryCount() const { return MemoryEntries.Num(); }
+	int64 GetMemoryBytes() const { return MemoryBytes; }
+	int32 GetDiskEntryCount() const { return DiskEntries.Num(); }
+	int64 GetDiskBytes() const { return DiskBytes; }
+
+	const FSurrealPilotResponseCacheStats& GetStats() const { return Stats; }
+	FSurrealPilotResponseCacheStats& GetStats() { return Stats; }
+
+private:
+	struct FMemoryEntry
+	{
+		FSurrealPilotCachedResponse Response;
+		int64 Bytes = 0;
+
+		/** Position in LruOrder */
+		TDoubleLinkedList<FString>::TDoubleLinkedListNode* Node = nullptr;
+	};
+
+	struct FDiskEntry
+	{
+		int64 Bytes = 0;
+
+		/** Wall-clock seconds of the last write or hit */
+		double LastUsedSeconds = 0.0;
+	};
+
+	/** Add to the memory tier as most recently used, evicting the least recently used beyond the cap */
+	void AddToMemory(const FString& Key, const FSurrealPilotCachedResponse& Response);
+	void RemoveFromMemory(const FString& Key);
+
+	/** Read an entry from the disk tier; false if there is none or it cannot be parsed */
+	bool LoadFromDisk(const FString& Key, FSurrealPilotCachedResponse& OutResponse);
+	void RemoveFromDisk(const FString& Key);
+
+	/** Delete the least recently used files until the disk tier fits its cap */
+	void TrimDisk();
+
+	/** List the files already in the disk directory, the first time the disk tier is used */
+	void LoadDiskIndex();
+
+	FString GetEntryPath(const FString& Key) const;
+
+	static int64 GetResponseBytes(const FSurrealPilotCachedResponse& Response);
+
+private:
+	/** Memory tier, and its keys from most to least recently used */
+	TMap<FString, FMemoryEntry> MemoryEntries;
+	TDoubleLinkedList<FString> LruOrder;
+	int64 MemoryBytes = 0;
+
+	/** Disk tier, by key */
+	TMap<FString, FDiskEntry> DiskEntries;
+	int64 DiskBytes = 0;
+	bool bDiskIndexLoaded = false;
+
+	int64 MaxMemoryBytes = 16 * 1024 * 1024;
+	int64 MaxDiskBytes = 256 * 1024 * 1024;
+	double TtlSeconds = 24.0 * 60.0 * 60.0;
+	FString DiskDirectory;
+
+	FSurrealPilotResponseCacheStats Stats;
+};
\ No newline at end of file
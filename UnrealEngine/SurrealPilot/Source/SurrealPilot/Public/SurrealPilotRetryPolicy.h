@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpResponse.h"
+
+/**
+ * When and how long to wait before re-sending a failed request.
+ * Delays use exponential backoff with full jitter unless the server sends Retry-After.
+ */
+struct SURREALPILOT_API FSurrealPilotRetryPolicy
+{
+	/** Retries after the first attempt */
+	int32 MaxRetries = 3;
+
+	/** Backoff ceiling for the first retry; doubles on each further retry */
+	double BaseDelaySeconds = 0.5;
+
+	/** Upper bound for any delay; a Retry-After beyond it is not waited out */
+	double MaxDelaySeconds = 30.0;
+
+	/** Whether the outcome of an attempt is worth retrying (connection failures, 408, 429, 502, 503, 504) */
+	static bool IsRetryable(const FHttpResponsePtr& Response, bool bWasSuccessful);
+
+	/** Whether a status code is worth retrying (408, 429, 502, 503, 504) */
+	static bool IsRetryableStatus(int32 ResponseCode);
+
+	/**
+	 * Delay before retry number RetryNumber (1 for the first retry).
+	 * @return false if the request should not be retried (Retry-After longer than MaxDelaySeconds)
+	 */
+	bool GetRetryDelay(int32 RetryNumber, const FHttpResponsePtr& Response, FRandomStream& Random, double& OutDelaySeconds) const;
+
+	/** Parse a Retry-After header given as delay-seconds or an HTTP-date */
+	static bool ParseRetryAfter(const FString& HeaderValue, const FDateTime& UtcNow, double& OutSeconds);
+};
\ No newline at end of file
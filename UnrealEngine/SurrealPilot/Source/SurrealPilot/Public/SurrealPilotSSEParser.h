@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A single dispatched Server-Sent Event
+ */
+struct SURREALPILOT_API FSurrealPilotSSEEvent
+{
+	/** Event type from the "event:" field, "message" when the server did not send one */
+	FString Event;
+
+	/** Last event ID seen on the stream (persists across events, per the SSE spec) */
+	FString Id;
+
+	/** Event payload; multiple "data:" lines are joined with a line feed */
+	FString Data;
+
+	/** Reconnection time from the "retry:" field, INDEX_NONE if this event did not carry one */
+	int32 RetryMilliseconds = INDEX_NONE;
+};
+
+/**
+ * Resumable Server-Sent Events parser that works directly on UTF-8 byte spans.
+ * Lines split across network reads are carried over between Feed calls, and strings are
+ * only allocated when a complete event is dispatched.
+ */
+class SURREALPILOT_API FSurrealPilotSSEParser
+{
+public:
+	FSurrealPilotSSEParser();
+
+	/**
+	 * Parse the next span of the stream
+	 * @param Data UTF-8 bytes received since the previous call
+	 * @param Num Number of bytes in Data
+	 * @param OnEvent Called once for every event completed by this span
+	 */
+	void Feed(const uint8* Data, int32 Num, TFunctionRef<void(const FSurrealPilotSSEEvent&)> OnEvent);
+
+	/**
+	 * Signal the end of the stream. A trailing unterminated line is processed and any pending
+	 * data is dispatched, since some servers close the connection without a final blank line.
+	 */
+	void Finish(TFunctionRef<void(const FSurrealPilotSSEEvent&)> OnEvent);
+
+	/** Forget all state so the parser can be reused for a new stream */
+	void Reset();
+
+private:
+	/** Process one line (without its terminator) */
+	void ProcessLine(const uint8* Line, int32 Num, TFunctionRef<void(const FSurrealPilotSSEEvent&)> OnEvent);
+
+	/** Dispatch the buffered event, if it carries any data */
+	void DispatchEvent(TFunctionRef<void(const FSurrealPilotSSEEvent&)> OnEvent);
+
+	/** Convert a UTF-8 span into an FString with a single allocation */
+	static FString Utf8ToString(const uint8* Data, int32 Num);
+
+private:
+	/** Partial line carried over from the previous span (only used when a line crosses a read boundary) */
+	TArray<uint8> LineBuffer;
+
+	/** Accumulated "data:" values of the current event */
+	TArray<uint8> DataBuffer;
+
+	/** "event:" value of the current event */
+	TArray<uint8> EventTypeBuffer;
+
+	/** Last "id:" value seen on the stream */
+	TArray<uint8> LastEventIdBuffer;
+
+	/** "retry:" value of the current event */
+	int32 PendingRetryMilliseconds;
+
+	/** Whether the current event has seen at least one "data:" field */
+	bool bHasData;
+
+	/** The previous span ended in CR, so a leading LF belongs to the same terminator */
+	bool bSkipLeadingLineFeed;
+
+	/** Nothing has been parsed yet, so a UTF-8 byte order mark may still need skipping */
+	bool bAtStreamStart;
+};
\ No newline at end of file
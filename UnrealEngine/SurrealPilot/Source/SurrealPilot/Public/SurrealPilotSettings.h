@@ -13,6 +13,21 @@ enum class EAIProvider : uint8
 	Ollama		UMETA(DisplayName = "Local Ollama")
 };
 
+UENUM(BlueprintType)
+enum class ESurrealPilotRequestCompression : uint8
+{
+	None				UMETA(DisplayName = "None"),
+	Gzip				UMETA(DisplayName = "gzip"),
+	DeflateDictionary	UMETA(DisplayName = "deflate (SurrealPilot dictionary)")
+};
+
+UENUM(BlueprintType)
+enum class ESurrealPilotContextEncoding : uint8
+{
+	Json			UMETA(DisplayName = "JSON"),
+	CompactBinary	UMETA(DisplayName = "Compact Binary")
+};
+
 /**
  * Settings for SurrealPilot plugin
  */
@@ -41,6 +56,14 @@ public:
 	UPROPERTY(config, EditAnywhere, Category = "Connection", meta = (DisplayName = "Desktop API Port", ClampMin = "1024", ClampMax = "65535"))
 	int32 DesktopApiPort = 8000;
 
+	/** How often the desktop and SaaS endpoints are probed for health and round-trip time (0 disables periodic probes; needs an editor restart) */
+	UPROPERTY(config, EditAnywhere, Category = "Connection", meta = (DisplayName = "Endpoint Probe Interval (seconds)", ClampMin = "0.0", ClampMax = "300.0"))
+	float EndpointProbeIntervalSeconds = 10.0f;
+
+	/** How long a health probe may take before the endpoint is considered down */
+	UPROPERTY(config, EditAnywhere, Category = "Connection", meta = (DisplayName = "Endpoint Probe Timeout (seconds)", ClampMin = "0.1", ClampMax = "30.0"))
+	float EndpointProbeTimeoutSeconds = 2.0f;
+
 	/** Enable automatic context export on Blueprint compilation errors */
 	UPROPERTY(config, EditAnywhere, Category = "Context Export", meta = (DisplayName = "Auto Export on Compile Errors"))
 	bool bAutoExportOnCompileErrors = true;
@@ -65,10 +88,121 @@ public:
 	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "HTTP Request Timeout", ClampMin = "5", ClampMax = "300"))
 	int32 HttpTimeoutSeconds = 30;
 
+	/** Most requests that may be in flight at once; chat requests are started ahead of queued background work */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Max Concurrent Requests", ClampMin = "1", ClampMax = "32"))
+	int32 MaxConcurrentRequests = 6;
+
+	/** Most context uploads that may be in flight at once, leaving the remaining slots for chat */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Max Concurrent Background Requests", ClampMin = "1", ClampMax = "32"))
+	int32 MaxConcurrentBackgroundRequests = 2;
+
+	/** How many times a request is re-sent after a connection failure, 408, 429, 502, 503 or 504 */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Max Request Retries", ClampMin = "0", ClampMax = "10"))
+	int32 MaxRequestRetries = 3;
+
+	/** Backoff before the first retry; doubles for each further retry, with random jitter */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Retry Base Delay (seconds)", ClampMin = "0.0", ClampMax = "10.0"))
+	float RetryBaseDelaySeconds = 0.5f;
+
+	/** Longest wait before a retry; a server Retry-After beyond this is not waited out */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Retry Max Delay (seconds)", ClampMin = "0.0", ClampMax = "300.0"))
+	float RetryMaxDelaySeconds = 30.0f;
+
+	/** Consecutive failures after which requests to an endpoint fail immediately */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Circuit Breaker Failure Threshold", ClampMin = "1", ClampMax = "100"))
+	int32 CircuitBreakerFailureThreshold = 5;
+
+	/** How long an endpoint is failed fast before a single probe request is let through */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Circuit Breaker Cooldown (seconds)", ClampMin = "0.0", ClampMax = "600.0"))
+	float CircuitBreakerCooldownSeconds = 15.0f;
+
 	/** Enable streaming responses */
 	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Enable Streaming Responses"))
 	bool bEnableStreamingResponses = true;
 
+	/** Collect context notifications into batch requests instead of sending each one immediately */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Batch Context Uploads"))
+	bool bBatchContextUploads = true;
+
+	/** How long a context notification may wait for others before the batch is sent */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Context Batch Window (seconds)", ClampMin = "0.0", ClampMax = "5.0", EditCondition = "bBatchContextUploads"))
+	float ContextBatchWindowSeconds = 0.25f;
+
+	/** A batch is sent as soon as it holds this many notifications */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Max Context Batch Size", ClampMin = "1", ClampMax = "1000", EditCondition = "bBatchContextUploads"))
+	int32 ContextBatchMaxItems = 50;
+
+	/** Hash context and send it by reference once the server confirms it has a copy, instead of uploading it with every request */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Deduplicate Context Uploads"))
+	bool bEnableContextDedup = true;
+
+	/** Send edits to an asset the server already has as a delta against its copy instead of re-sending the whole export */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Send Context Deltas"))
+	bool bEnableContextDeltas = true;
+
+	/** Compress chat and context request bodies; falls back to plain JSON if the server rejects it */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Request Compression"))
+	ESurrealPilotRequestCompression RequestCompression = ESurrealPilotRequestCompression::None;
+
+	/** Request bodies smaller than this are sent uncompressed */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Min Compressed Body Size (bytes)", ClampMin = "0", EditCondition = "RequestCompression != ESurrealPilotRequestCompression::None"))
+	int32 MinCompressedBodyBytes = 1024;
+
+	/** Encoding of context export requests sent over HTTP; falls back to JSON if the server rejects Compact Binary */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Context Encoding"))
+	ESurrealPilotContextEncoding ContextEncoding = ESurrealPilotContextEncoding::Json;
+
+	/** Count context tokens locally and trim chat context to fit the provider's budget before sending it */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Budget Context Tokens"))
+	bool bEnableContextTokenBudget = true;
+
+	/** Tokens of context (and chat messages) each provider is sent at most; providers not listed use the "default" entry */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Context Token Budgets", EditCondition = "bEnableContextTokenBudget"))
+	TMap<FString, int32> ContextTokenBudgets =
+	{
+		{ TEXT("openai"), 100000 },
+		{ TEXT("anthropic"), 150000 },
+		{ TEXT("gemini"), 500000 },
+		{ TEXT("ollama"), 6000 },
+		{ TEXT("default"), 32000 },
+	};
+
+	/** Keep a WebSocket open to the desktop app and send chat and context over it; requests use HTTP while it is down */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Use WebSocket Channel"))
+	bool bEnableWebSocketChannel = false;
+
+	/** Keep context the endpoint could not take in Saved/SurrealPilot and send it once the endpoint is back */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Journal Undelivered Context"))
+	bool bEnableOfflineContextJournal = true;
+
+	/** Context messages the journal keeps at most; the oldest are dropped beyond this */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Journal Max Messages", ClampMin = "1", EditCondition = "bEnableOfflineContextJournal"))
+	int32 OfflineContextJournalMaxEntries = 10000;
+
+	/** Answer a chat request identical to an earlier one (same provider, messages and context) from a local cache instead of the provider */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Cache Chat Responses"))
+	bool bEnableResponseCache = false;
+
+	/** Seconds a cached answer is used for; 0 keeps answers until they are evicted */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Response Cache Time To Live (s)", ClampMin = "0", EditCondition = "bEnableResponseCache"))
+	float ResponseCacheTtlSeconds = 86400.0f;
+
+	/** Memory kept for recently used answers */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Response Cache Memory (MB)", ClampMin = "0", EditCondition = "bEnableResponseCache"))
+	int32 ResponseCacheMemoryMB = 16;
+
+	/** Disk kept for answers in Saved/SurrealPilot/ResponseCache, so they survive an editor restart; 0 keeps them in memory only */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Response Cache Disk (MB)", ClampMin = "0", EditCondition = "bEnableResponseCache"))
+	int32 ResponseCacheDiskMB = 256;
+
+	/** Memory kept for exported Blueprint graphs, so re-exporting a Blueprint only walks the graphs that changed; 0 walks every graph on every export */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Blueprint Context Cache (MB)", ClampMin = "0"))
+	int32 BlueprintContextCacheMemoryMB = 64;
+
+	/** Format a Blueprint's graphs on worker threads once they have been read on the game thread */
+	UPROPERTY(config, EditAnywhere, Category = "Advanced", meta = (DisplayName = "Parallel Blueprint Export"))
+	bool bParallelBlueprintExport = true;
+
 	/** API key for SaaS authentication (stored in local config, not in project settings) */
 	UPROPERTY(Transient, meta = (DisplayName = "API Key (Local Only)"))
 	FString ApiKey;
@@ -86,6 +220,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "SurrealPilot")
 	FString GetEffectiveApiUrl() const;
 
+	/** Token budget for chat context sent to a provider */
+	int32 GetContextTokenBudget(const FString& Provider) const;
+
 	/** Test connection to the API */
 	UFUNCTION(BlueprintCallable, Category = "SurrealPilot")
 	void TestApiConnection();
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Local byte-pair-encoding token counter, so context can be sized before it is sent.
+ *
+ * Each provider maps to a vocabulary name. When Resources/Tokenizers/<name>.tiktoken exists in the plugin
+ * (the tiktoken rank format: one base64 token and its rank per line) tokens are counted exactly with BPE
+ * merges; otherwise they are estimated from the same pre-tokenization with per-provider calibration, which
+ * needs no vocabulary and is close enough to budget against.
+ */
+class SURREALPILOT_API FSurrealPilotTokenizer
+{
+public:
+	/** Tokenizer for a provider id (openai, anthropic, gemini, ollama); shared and safe to use from any thread */
+	static TSharedRef<const FSurrealPilotTokenizer> ForProvider(const FString& Provider);
+
+	/** Load a vocabulary in the tiktoken rank format; null if the file is missing or malformed */
+	static TSharedPtr<FSurrealPilotTokenizer> LoadVocabulary(const FString& Name, const FString& FilePath);
+
+	/** Build a tokenizer from in-memory ranks, each token given as its raw bytes */
+	static TSharedRef<FSurrealPilotTokenizer> FromRanks(const FString& Name, const TArray<TPair<TArray<uint8>, int32>>& Ranks);
+
+	/** Build an estimating tokenizer; TokensPerWordPiece scales its estimates to the provider's vocabulary */
+	static TSharedRef<FSurrealPilotTokenizer> MakeEstimator(const FString& Name, double TokensPerWordPiece = 1.0);
+
+	/** Number of tokens in UTF-8 text */
+	int32 CountTokens(TArrayView<const uint8> Utf8) const;
+
+	/** Number of tokens in text */
+	int32 CountTokens(FStringView Text) const;
+
+	/** Token ids of UTF-8 text; empty for an estimating tokenizer, which has no ids */
+	TArray<int32> Encode(TArrayView<const uint8> Utf8) const;
+
+	/** Vocabulary name, e.g. o200k_base */
+	const FString& GetName() const { return Name; }
+
+	/** Whether counts come from a real vocabulary rather than an estimate */
+	bool IsExact() const { return Ranks.Num() > 0; }
+
+	/**
+	 * Split UTF-8 text into the pieces BPE runs on, approximating the tiktoken pre-tokenizer: words with their
+	 * leading space or punctuation, contractions, runs of up to three digits, punctuation runs and whitespace.
+	 * Calls Visit with the offset and length of each piece.
+	 */
+	static void SplitPieces(TArrayView<const uint8> Utf8, TFunctionRef<void(int32, int32)> Visit);
+
+private:
+	FSurrealPilotTokenizer() = default;
+
+	/** Tokens in one piece, appending their ids to OutTokens when it is set */
+	int32 EncodePiece(const uint8* Piece, int32 Num, TArray<int32>* OutTokens) const;
+
+	/** Estimated tokens in one piece */
+	int32 EstimatePiece(const uint8* Piece, int32 Num) const;
+
+	/** Rank of a byte sequence, INDEX_NONE if it is not a token */
+	int32 FindRank(const uint8* Bytes, int32 Num) const;
+
+	/** A byte sequence inside TokenBytes */
+	struct FTokenKey
+	{
+		const uint8* Data = nullptr;
+		int32 Num = 0;
+
+		bool operator==(const FTokenKey& Other) const
+		{
+			return Num == Other.Num && FMemory::Memcmp(Data, Other.Data, Num) == 0;
+		}
+
+		friend uint32 GetTypeHash(const FTokenKey& Key)
+		{
+			return FCrc::MemCrc32(Key.Data, Key.Num);
+		}
+	};
+
+private:
+	FString Name;
+
+	/** Bytes of every token, back to back; the keys of Ranks point into it */
+	TArray<uint8> TokenBytes;
+
+	TMap<FTokenKey, int32> Ranks;
+
+	/** Estimator calibration: tokens per word-sized piece */
+	double TokensPerWordPiece = 1.0;
+};
\ No newline at end of file
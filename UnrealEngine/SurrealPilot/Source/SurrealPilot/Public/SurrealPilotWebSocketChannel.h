@@ -0,0 +1,163 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Containers/Ticker.h"
+#include "SurrealPilotRetryPolicy.h"
+
+class IWebSocket;
+
+enum class ESurrealPilotChannelState : uint8
+{
+	/** Not wanted, or closed for good */
+	Closed,
+
+	/** Handshake in progress, or waiting to reconnect */
+	Connecting,
+
+	/** Open and carrying requests */
+	Connected
+};
+
+/**
+ * A frame the server sent for one request on the channel
+ */
+struct SURREALPILOT_API FSurrealPilotChannelFrame
+{
+	/** "event" for a streamed chat event, "response" for the final frame of a request */
+	FString Op;
+
+	/** Data of an event, as it would appear after "data:" in an SSE stream */
+	FString Data;
+
+	/** Status code, response headers and JSON body of a response */
+	int32 Status = 0;
+	TMap<FString, FString> Headers;
+	TSharedPtr<FJsonObject> Body;
+
+	/** UTF-8 bytes of the whole frame */
+	int32 FrameBytes = 0;
+};
+
+/**
+ * Counters for the channel's connection and traffic
+ */
+struct SURREALPILOT_API FSurrealPilotChannelStats
+{
+	/** Successful handshakes, and connections that ended or failed to open */
+	int32 Connects = 0;
+	int32 Disconnects = 0;
+	int32 FailedConnects = 0;
+
+	/** Requests sent over the channel, and those still waiting on it when the connection dropped */
+	int32 Requests = 0;
+	int32 RequestsLost = 0;
+
+	/** Requests the client sent over HTTP instead after the channel could not complete them */
+	int32 HttpFallbacks = 0;
+
+	/** Server-initiated messages received */
+	int32 Pushes = 0;
+};
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnSurrealPilotChannelPush, const FString& /*Type*/, const TSharedPtr<FJsonObject>& /*Body*/);
+
+/**
+ * Persistent WebSocket to the desktop app that multiplexes requests and carries messages the server pushes.
+ *
+ * Each request goes out as {"id":N,"op":"request","path":"/api/chat","body":{...}}; the server answers with any
+ * number of {"id":N,"op":"event","data":"..."} frames and one {"id":N,"op":"response","status":200,"headers":{...},
+ * "body":{...}}. Pushes arrive as {"op":"push","type":"patch","body":{...}}. The connection is re-established with
+ * exponential backoff whenever it drops, until Close is called. Must be used from the game thread.
+ */
+class SURREALPILOT_API FSurrealPilotWebSocketChannel
+{
+public:
+	/** Called with each frame of a request, the last being its response */
+	using FOnFrame = TFunction<void(const FSurrealPilotChannelFrame&)>;
+
+	/** Called instead if the connection drops before the response arrives */
+	using FOnLost = TFunction<void()>;
+
+	/** Path the desktop app serves the channel on */
+	static const TCHAR* const ChannelPath;
+
+	/** Subprotocol sent in the handshake */
+	static const TCHAR* const Protocol;
+
+	~FSurrealPilotWebSocketChannel();
+
+	/**
+	 * Connect to the channel of an API base URL (http becomes ws, https wss). A connection to another URL is
+	 * replaced, and requests waiting on it are reported lost.
+	 */
+	void Open(const FString& InBaseUrl, const TMap<FString, FString>& InHeaders);
+
+	/** Disconnect and stop reconnecting; requests still waiting are dropped without callbacks */
+	void Close();
+
+	bool IsConnected() const { return State == ESurrealPilotChannelState::Connected; }
+	ESurrealPilotChannelState GetState() const { return State; }
+
+	/** API base URL the channel belongs to, empty when closed */
+	const FString& GetBaseUrl() const { return BaseUrl; }
+
+	/** ws:// or wss:// URL of the channel */
+	static FString MakeChannelUrl(const FString& ApiBaseUrl);
+
+	/** Send a request whose body is UTF-8 JSON; returns its id, or INDEX_NONE if the channel is not connected */
+	int32 Send(const FString& Path, TArrayView<const uint8> JsonBody, FOnFrame OnFrame, FOnLost OnLost);
+
+	/** Stop waiting for a request and tell the server it is no longer wanted */
+	void Cancel(int32 RequestId);
+
+	/** Requests waiting for their response */
+	int32 GetPendingCount() const { return Pending.Num(); }
+
+	/** Server-initiated messages, by type */
+	FOnSurrealPilotChannelPush& OnPush() { return PushDelegate; }
+
+	const FSurrealPilotChannelStats& GetStats() const { return Stats; }
+	FSurrealPilotChannelStats& GetStats() { return Stats; }
+
+private:
+	struct FPendingRequest
+	{
+		FOnFrame OnFrame;
+		FOnLost OnLost;
+	};
+
+	void Connect();
+	void Disconnect();
+	void ScheduleReconnect();
+
+	void HandleConnected();
+	void HandleConnectionError(const FString& Error);
+	void HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean);
+	void HandleMessage(const FString& Message);
+
+	/** The connection is gone: report every waiting request as lost and try again later */
+	void HandleDisconnect();
+
+	/** Call OnLost for requests that were waiting on a connection that is gone */
+	void ReportLost(TMap<int32, FPendingRequest>&& Lost);
+
+private:
+	TSharedPtr<IWebSocket> Socket;
+	ESurrealPilotChannelState State = ESurrealPilotChannelState::Closed;
+
+	FString BaseUrl;
+	TMap<FString, FString> Headers;
+
+	int32 LastRequestId = 0;
+	TMap<int32, FPendingRequest> Pending;
+
+	/** Backoff between reconnection attempts, reset by a successful handshake */
+	FSurrealPilotRetryPolicy ReconnectPolicy;
+	FRandomStream ReconnectRandom;
+	int32 ReconnectAttempts = 0;
+	FTSTicker::FDelegateHandle ReconnectHandle;
+
+	FOnSurrealPilotChannelPush PushDelegate;
+	FSurrealPilotChannelStats Stats;
+};
\ No newline at end of file